@@ -164,13 +164,14 @@ class ArchiveFileSystem : public SubsystemInterface
 	virtual void					closeAllFiles( void ) = 0;									///< Close all files associated with ArchiveFiles
 	virtual Bool					doesFileExist(const Char *filename) const;		///< return true if that file exists in an archive file somewhere.
 
-	void					getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList &filenameList, Bool searchSubdirectories) const; ///< search the given directory for files matching the searchName (egs. *.ini, *.rep).  Possibly search subdirectories.  Scans each Archive file.
+	virtual void	getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList &filenameList, Bool searchSubdirectories) const; ///< search the given directory for files matching the searchName (egs. *.ini, *.rep).  Possibly search subdirectories.  Scans each Archive file.
 	Bool					getFileInfo(const AsciiString& filename, FileInfo *fileInfo) const; ///< see FileSystem.h
+	Bool					getFileLocation(const AsciiString& filename, AsciiString *archiveFilename, UnsignedInt *offset, UnsignedInt *size) const; ///< which archive the file is in, and where in it
 	
 	virtual Bool	loadBigFilesFromDirectory(AsciiString dir, AsciiString fileMask, Bool overwrite = FALSE) = 0;
 
 	// Unprotected this for copy-protection routines
-	AsciiString						getArchiveFilenameForFile(const AsciiString& filename) const;
+	virtual AsciiString		getArchiveFilenameForFile(const AsciiString& filename) const;
 	
 	void loadMods( void );
 
@@ -100,6 +100,10 @@
 	
 	extern Bool g_logObjectCRCs;
 
+	extern Bool g_verifySelfContainedUpdates;
+
+	extern Bool g_verifyIncrementalCRC;
+
 #else // DEBUG_CRC
 
 	#define DUMPVEL {}
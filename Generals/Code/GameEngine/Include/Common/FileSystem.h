@@ -57,6 +57,10 @@
 //           Forward References
 //----------------------------------------------------------------------------
 class File;
+class FileReadRequest;
+struct FileReadQueue;
+
+//#define TEST_FILE_READ_QUEUE			///< read every INI file in the background and check it matches what openFile() gives
 
 //----------------------------------------------------------------------------
 //           Type Defines
@@ -105,6 +109,22 @@ struct FileInfo {
 	Int timestampLow;
 };
 
+/// What the file system did between FileSystem::beginLoad() and FileSystem::endLoad()
+struct FileLoadStats
+{
+	Int						m_filesOpened;						///< files opened for reading
+	Int						m_prefetchHits;						///< ... that had been read in the background
+	Int						m_prefetchStalls;					///< ... of those, ones that were still being read when they were asked for
+	Int						m_prefetchUnused;					///< files read in the background that nobody asked for
+	UnsignedInt64	m_bytesPrefetched;				///< read in the background
+	UnsignedInt64	m_bytesOpenedDirectly;		///< in files that weren't prefetched, and were opened the usual way
+	UnsignedInt64	m_stallMicroseconds;			///< waiting on background reads
+	UnsignedInt64	m_openMicroseconds;				///< opening files the usual way
+	UnsignedInt64	m_loadMicroseconds;				///< the whole load
+
+	void clear() { memset(this, 0, sizeof(*this)); }
+};
+
 //===============================
 // FileSystem
 //===============================
@@ -136,9 +156,40 @@ public:
 	Bool areMusicFilesOnCD();
 	void loadMusicFilesFromCD();
 	void unloadMusicFilesFromCD();
+
+	// Background reads.  The whole file is read into memory on one of the I/O threads.
+	FileReadRequest* requestFile( const Char *filename );				///< start reading the file.  NULL if there's no such file
+	Bool isRequestDone( const FileReadRequest *request ) const;	///< TRUE once the read has finished, or failed
+	File* finishRequest( FileReadRequest *request );						///< wait for the read if need be, and hand the file over as a RAMFile.  The request is gone after this.
+	void cancelRequest( FileReadRequest *request );							///< don't want the file after all.  The request is gone after this.
+
+	void prefetchFiles( const std::vector<AsciiString>& filenames );	///< read these in the background, and have openFile() hand them out from memory
+	void clearPrefetchedFiles( void );													///< forget prefetched files nobody has opened
+
+	void beginLoad( const AsciiString& loadName );		///< start timing a load, and prefetch whatever the last load with this name opened
+	void endLoad( void );															///< remember what this load opened for next time, and report how it went
+	const FileLoadStats& getLoadStats( void ) const { return m_loadStats; }
+
 protected:
+	typedef std::map<AsciiString, FileReadRequest*> PrefetchedFileMap;
+
+	FileReadRequest* makeRequest( const Char *filename, Bool prefetch );	///< work out where the file's data is
+	File* openPrefetchedFile( const Char *filename, Int access );			///< NULL if it wasn't prefetched
+	AsciiString getLoadManifestFilename( const AsciiString& loadName ) const;
+
+#ifdef TEST_FILE_READ_QUEUE
+	void doReadQueueTest( void );
+#endif
 
+	FileReadQueue				*m_readQueue;				///< I/O threads, and the reads waiting for them
+	PrefetchedFileMap		m_prefetchedFiles;	///< by lower case name with backslashes
 
+	Bool								m_loading;					///< between beginLoad() and endLoad()
+	AsciiString					m_loadName;
+	UnsignedInt64				m_loadStartTime;
+	FilenameList				m_loadFilesSeen;
+	std::vector<AsciiString>	m_loadFiles;			///< everything opened during the load, in order
+	FileLoadStats				m_loadStats;
 };
 
 extern FileSystem*	TheFileSystem;
@@ -59,6 +59,19 @@
 	#define MEMORYPOOL_DEBUG
 #endif
 
+// per-thread magazines of free blocks sit in front of every pool, so most allocs and frees don't
+// need TheMemoryPoolCriticalSection. the debug bookkeeping is done per allocation and leans on
+// that lock, so debug builds go straight to the blobs as before.
+#if !defined(MEMORYPOOL_DEBUG) && !defined(DISABLE_MEMORYPOOL_MAGAZINES)
+	#define MEMORYPOOL_MAGAZINES
+#endif
+
+/*
+	Times multithreaded alloc/free on a few of the busiest pools, with and without the
+	magazines, ten seconds into a game.
+*/
+//#define TEST_MEMORYPOOL_MAGAZINES
+
 // SYSTEM INCLUDES ////////////////////////////////////////////////////////////
 
 #include <new>
@@ -212,6 +225,7 @@ class MemoryPool;
 class MemoryPoolFactory;
 class DynamicMemoryAllocator;
 class BlockCheckpointInfo;
+struct MemoryPoolMagazine;
 
 // TYPE DEFINES ///////////////////////////////////////////////////////////////
 
@@ -289,12 +303,17 @@ private:
 	Int								m_allocationSize;						///< size of the blocks allocated by this pool, in bytes
 	Int								m_initialAllocationCount;		///< number of blocks to be allocated in initial blob
 	Int								m_overflowAllocationCount;	///< number of blocks to be allocated in any subsequent blob(s)
-	Int								m_usedBlocksInPool;					///< total number of blocks in use in the pool.
+	Int								m_usedBlocksInPool;					///< total number of blocks in use in the pool (including any sitting in magazines).
 	Int								m_totalBlocksInPool;				///< total number of blocks in all blobs of this pool (used or not).
 	Int								m_peakUsedBlocksInPool;			///< high-water mark of m_usedBlocksInPool
+	Int								m_overflowBlobsCreated;			///< number of overflow blobs this pool has had to add since init
 	MemoryPoolBlob		*m_firstBlob;								///< head of linked list: first blob for this pool.
 	MemoryPoolBlob		*m_lastBlob;								///< tail of linked list: last blob for this pool. (needed for efficiency)
 	MemoryPoolBlob		*m_firstBlobWithFreeBlocks;	///< first blob in this pool that has at least one unallocated block.
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine	*m_magazines;							///< one magazine of free blocks per thread slot (null if the pool can't grow)
+	void							*m_magazineMemory;					///< what m_magazines was carved out of
+#endif
 
 private:
 	/// create a new blob with the given number of blocks.
@@ -303,6 +322,23 @@ private:
 	/// destroy a blob.
 	Int freeBlob(MemoryPoolBlob *blob);
 
+	/// take a free block out of the blobs, adding a blob if need be (and allowed). caller must hold TheMemoryPoolCriticalSection.
+	MemoryPoolSingleBlock *takeBlockFromBlobs(Bool allowGrowth DECLARE_LITERALSTRING_ARG2);
+
+	/// put a block back into its blob. caller must hold TheMemoryPoolCriticalSection.
+	void returnBlockToBlobs(MemoryPoolSingleBlock *block);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	/// return this thread's magazine for the pool, or null if it should use the blobs directly.
+	MemoryPoolMagazine *getMagazine();
+
+	/// move up to count blocks from the blobs into the magazine. caller must hold TheMemoryPoolCriticalSection.
+	void refillMagazine(MemoryPoolMagazine *magazine, Int count);
+
+	/// move up to count blocks from the magazine back into the blobs. caller must hold TheMemoryPoolCriticalSection.
+	void drainMagazine(MemoryPoolMagazine *magazine, Int count);
+#endif
+
 public:
 
 	// 'public' funcs that are really only for use by MemoryPoolFactory
@@ -349,7 +385,7 @@ public:
 	/// return the number of free (available) blocks in this pool.
 	Int getFreeBlockCount();
 
-	/// return the number of blocks in use in this pool.
+	/// return the number of blocks in use in this pool. blocks sitting in a thread's magazine count as used.
 	Int getUsedBlockCount();
 
 	/// return the total number of blocks in this pool. [ == getFreeBlockCount() + getUsedBlockCount() ]
@@ -361,6 +397,12 @@ public:
 	/// return the initial allocation count for this pool
 	Int getInitialBlockCount();
 
+	/// return the overflow allocation count for this pool
+	Int getOverflowBlockCount();
+
+	/// return the number of overflow blobs this pool has had to add since it was initialized
+	Int getOverflowBlobCount();
+
 	Int countBlobsInPool();
 
 	/// if this pool has any empty blobs, return them to the system.
@@ -369,6 +411,10 @@ public:
 	/// destroy all blocks and blobs in this pool.
 	void reset();
 
+	/** put the blocks in every thread's magazine back into the blobs. this is only safe when
+		no other thread is using the pool (at reset or shutdown, say). */
+	void flushMagazines();
+
 	#ifdef MEMORYPOOL_DEBUG
 		/// return true iff this block was allocated by this pool.
 		Bool debugIsBlockInPool(void *pBlock);
@@ -392,7 +438,7 @@ private:
 	MemoryPoolFactory					*m_factory;						///< the factory that created us
 	DynamicMemoryAllocator		*m_nextDmaInFactory;	///< linked list node, managed by factory
 	Int												m_numPools;						///< number of subpools (up to MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS)
-	Int												m_usedBlocksInDma;		///< total number of blocks allocated, from subpools and "raw"
+	Int												m_rawBlocksInDma;			///< number of "raw" blocks allocated directly from the system
 	MemoryPool								*m_pools[MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS];	///< the subpools
 	MemoryPoolSingleBlock			*m_rawBlocks;					///< linked list of "raw" blocks allocated directly from system
 
@@ -522,6 +568,9 @@ public:
 	/// return the pool with the given name. if no such pool exists, return null.
 	MemoryPool *findMemoryPool(const char *poolName);
 
+	/// return the first pool in the factory; use MemoryPool::getNextPoolInList() to walk the rest.
+	MemoryPool *getFirstMemoryPool() { return m_firstPoolInFactory; }
+
 	/// destroy the given pool.
 	void destroyMemoryPool(MemoryPool *pMemoryPool);
 
@@ -562,6 +611,9 @@ public:
 		void debugResetCheckpoints();
 
 	#endif
+	#ifdef TEST_MEMORYPOOL_MAGAZINES
+		void doMagazineTest();
+	#endif
 };
 
 // how many bytes are we allowed to 'waste' per pool allocation before the debug code starts yelling at us...
@@ -804,6 +856,8 @@ inline Int MemoryPool::getUsedBlockCount() { return m_usedBlocksInPool; }
 inline Int MemoryPool::getTotalBlockCount() { return m_totalBlocksInPool; }
 inline Int MemoryPool::getPeakBlockCount() { return m_peakUsedBlocksInPool; }
 inline Int MemoryPool::getInitialBlockCount() { return m_initialAllocationCount; }
+inline Int MemoryPool::getOverflowBlockCount() { return m_overflowAllocationCount; }
+inline Int MemoryPool::getOverflowBlobCount() { return m_overflowBlobsCreated; }
 
 // ----------------------------------------------------------------------------
 inline DynamicMemoryAllocator *DynamicMemoryAllocator::getNextDmaInList() { return m_nextDmaInFactory; }
@@ -867,6 +921,15 @@ extern void userMemoryManagerInitPools();
 */
 extern void userMemoryAdjustPoolSize(const char *poolName, Int& initialAllocationCount, Int& overflowAllocationCount);
 
+/**
+	Write the high-water mark of every pool out as a pool size profile (MemoryPoolProfile.ini, next
+	to MemoryPools.ini), which the next launch uses to size the pools in place of the compiled-in
+	table and MemoryPools.ini. Also writes MemoryPoolProfile.csv, comparing the blobs and unused
+	memory this session's peaks would have cost without the profile and with it. Lives in
+	MemoryInit.cpp, alongside the size tables it reads.
+*/
+extern void writeMemoryPoolProfile();
+
 #ifdef __cplusplus
 
 #ifndef _OPERATOR_NEW_DEFINED_
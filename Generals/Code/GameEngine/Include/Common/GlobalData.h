@@ -414,6 +414,8 @@ public:
 	UnsignedInt m_unlookPersistDuration;	///< How long after unlook until the sighting info executes the undo
 
 	Bool m_shouldUpdateTGAToDDS;					///< Should we attempt to update old TGAs to DDS stuff on loadup?
+	Bool m_prefetchLoadFiles;							///< Read the files the last load of a map opened in the background, before they're asked for
+	Bool m_recordPoolProfile;							///< Write the peak usage of every memory pool to MemoryPoolProfile.ini on exit
 	
 	UnsignedInt m_doubleClickTimeMS;	///< What is the maximum amount of time that can seperate two clicks in order
 																		///< for us to generate a double click message?
@@ -44,6 +44,13 @@ class Xfer;
 class File;
 enum ScienceType;
 
+/*
+	Times tokenizing every file under Data\INI, the old way (a character at a time through
+	File::read, then strtok) against the way we do it now, and logs MB/s for both, along with
+	how long engine init took to load all its INI files.
+*/
+//#define TEST_INI_LOAD
+
 //-------------------------------------------------------------------------------------------------
 /** These control the behavior of loading the INI data into items */
 //-------------------------------------------------------------------------------------------------
@@ -259,6 +266,10 @@ public:
 	void initFromINI( void *what, const FieldParse* parseTable );
 	void initFromINIMulti( void *what, const MultiIniFieldParse& parseTableList );
 	void initFromINIMultiProc( void *what, BuildMultiIniFieldProc proc );
+
+#ifdef TEST_INI_LOAD
+	static void doLoadTest( UnsignedInt initTime );
+#endif
 	
 	static void parseUnsignedByte( INI *ini, void *instance, void *store, const void* userData );
 	static void parseShort( INI *ini, void *instance, void *store, const void* userData );
@@ -393,14 +404,19 @@ protected:
 	void unPrepFile();
 
 	void readLine( void );
-
-//	FILE *m_file;															///< file pointer of file currently loading
-	File *m_file;															///< file pointer of file currently loading
+	char *nextToken( const char *seps );
+
+	char *m_fileData;													///< entire contents of the file currently loading, NULL if none
+	char *m_fileEnd;													///< end of m_fileData (there is always one spare byte here)
+	char *m_readPos;													///< start of the next line to read
+	char m_readPosChar;												///< the char at m_readPos, which we overwrite to end the current line
+	char *m_line;															///< current line, whitespace flattened to spaces, comment cut off
+	Int m_lineLength;													///< length of m_line, not counting the terminator
+	char *m_tokenPos;													///< where the next token search starts, like strtok's
 	AsciiString m_filename;										///< filename of file currently loading
 	INILoadType m_loadType;										///< load time for current file
 	UnsignedInt m_lineNum;										///< current line number that's been read
-	char m_buffer[ INI_MAX_CHARS_PER_LINE ];	///< buffer to read file contents into
-	const char *m_seps;												///< for strtok parsing
+	const char *m_seps;												///< for token parsing
 	const char *m_sepsPercent;								///< m_seps with percent delimiter as well
 	const char *m_sepsColon;									///< m_seps with colon delimiter as well
 	const char *m_sepsQuote;									///< token to represent a quoted ascii string
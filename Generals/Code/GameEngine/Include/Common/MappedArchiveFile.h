@@ -0,0 +1,88 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------
+//
+// Project:    RTS
+//
+// Module:     IO
+//
+// File name:  Common/MappedArchiveFile.h
+//
+//----------------------------------------------------------------------------
+
+
+#ifndef __MAPPEDARCHIVEFILE_H
+#define __MAPPEDARCHIVEFILE_H
+
+
+
+//----------------------------------------------------------------------------
+//           Includes                                                      
+//----------------------------------------------------------------------------
+
+#include "Common/RAMFile.h"
+
+//----------------------------------------------------------------------------
+//           Type Defines
+//----------------------------------------------------------------------------
+
+//===============================
+// MappedArchiveFile
+//===============================
+/**
+  *	A file inside an archive that has been mapped into memory.  It reads straight out
+	* of the archive's image rather than out of its own copy, so opening one doesn't
+	* touch the disk or allocate anything.  The archive must stay open for as long as
+	* the file does.
+	*/
+//===============================
+
+class MappedArchiveFile : public RAMFile
+{
+	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(MappedArchiveFile, "MappedArchiveFile")		
+	public:
+		
+		MappedArchiveFile();
+		//virtual				~MappedArchiveFile();
+
+		virtual void	close( void );																			///< Close the file
+		virtual Int		write( const void *buffer, Int bytes );							///< Write the specified number of bytes from the buffer: See File::write
+
+		virtual Bool	open( File *file );																	///< Open file for fast RAM access
+		virtual Bool	openFromArchive(File *archiveFile, const AsciiString& filename, Int offset, Int size); ///< not used, see openFromImage()
+		Bool					openFromImage(const AsciiString& filename, const char *data, Int size);	///< look at size bytes of the archive's image, starting at data
+
+		virtual char* readEntireAndClose();																///< has to make a copy, since the data belongs to the archive
+};
+
+
+
+
+//----------------------------------------------------------------------------
+//           Inlining                                                       
+//----------------------------------------------------------------------------
+
+
+#endif // __MAPPEDARCHIVEFILE_H
@@ -28,6 +28,10 @@
 #include "Common/SystemTime.h"
 #include "GameNetwork/GameInfo.h"
 
+// Uncomment to record a long replay full of made up commands when the recorder starts, and
+// check it comes out the same as writing it straight to disk would.
+//#define TEST_REPLAY_WRITER
+
 /**
   * The ReplayGameInfo class holds information about the replay game and
 	* the contents of its slot list for reconstructing multiplayer games.
@@ -52,6 +56,21 @@ enum RecorderModeType {
 };
 
 class CRCInfo;
+struct ReplayWriter;
+
+/// How the background replay writer has got on since recording started
+struct ReplayWriterStats
+{
+	Int						m_buffersWritten;					///< frame buffers the writer thread has written out
+	UnsignedInt64	m_bytesWritten;
+	Int						m_stalls;									///< times the logic thread had to wait for the writer
+	UnsignedInt64	m_stallMicroseconds;			///< ... and how long it waited in all
+	UnsignedInt64	m_maxStallMicroseconds;		///< ... and the longest single wait
+	UnsignedInt64	m_writeMicroseconds;			///< time the writer thread spent writing
+	Int						m_maxQueued;							///< most buffers ever waiting to be written at once
+
+	void clear() { memset(this, 0, sizeof(*this)); }
+};
 
 class RecorderClass : public SubsystemInterface {
 public:
@@ -123,9 +142,20 @@ public:
 	void cleanUpReplayFile( void );										///< after a crash, send replay/debug info to a central repository
 
 	void stopRecording();															///< Stop recording and close m_file.
+	void flushRecording();														///< Wait until everything recorded so far is on disk.  Called from the GameEngine catch blocks.
+	const ReplayWriterStats& getWriterStats() const { return m_writerStats; }
+#ifdef TEST_REPLAY_WRITER
+	void doReplayWriterTest();
+#endif
 protected:
 	void startRecording(GameDifficulty diff, Int originalGameMode, Int rankPoints, Int maxFPS);					///< Start recording to m_file.
-	void writeToFile(GameMessage *msg);								///< Write this GameMessage to m_file.
+	void writeToFile(GameMessage *msg, UnsignedInt frame);	///< Add this GameMessage to the record buffer.
+	void writeBytes(const void *data, Int len);				///< Add raw bytes to the record buffer.
+	void finishRecordFrame();													///< Done with this logic frame, commands or not.
+	void submitRecordBuffer();												///< Hand the record buffer to the writer thread.
+	void patchFile(UnsignedInt offset, const void *data, Int len);	///< Overwrite part of the header.
+	void startWriter();
+	void stopWriter();																///< Write out everything still pending, and stop the writer thread.
 
 	void logGameStart(AsciiString options);
 	void logGameEnd( void );
@@ -153,6 +183,11 @@ protected:
 	Int m_originalGameMode; // valid in replays
 
 	UnsignedInt m_nextFrame;												///< The Frame that the next message is to be executed on.  This can be -1.
+
+	ReplayWriter *m_writer;													///< writes m_file on its own thread while recording
+	std::vector<UnsignedByte> m_recordBuffer;				///< commands not yet handed to m_writer
+	Int m_framesBuffered;														///< logic frames since m_recordBuffer was last submitted
+	ReplayWriterStats m_writerStats;
 };
 
 extern RecorderClass *TheRecorder;
@@ -0,0 +1,70 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// WorkerThreadPool.h /////////////////////////////////////////////////////////
+// A small pool of worker threads used to spread independent jobs across cores.
+// The calling thread always takes part in the work, so a pool with no workers
+// simply runs everything inline.
+
+#ifndef __WORKERTHREADPOOL_H__
+#define __WORKERTHREADPOOL_H__
+
+/**
+ * Job callback for WorkerThreadPool::parallelFor.  jobIndex runs from 0 to numJobs-1.
+ * workerIndex is 0 for the thread that called parallelFor, and 1..getNumThreads()-1 for
+ * the pool threads, so it can be used to index per thread scratch data.
+ */
+typedef void (*WorkerJobProc)( Int jobIndex, Int workerIndex, void *userData );
+
+struct WorkerThreadPoolImpl;
+
+class WorkerThreadPool
+{
+public:
+	enum { MAX_WORKER_THREADS = 7 };
+
+	WorkerThreadPool( Int numWorkers );
+	~WorkerThreadPool();
+
+	/// Number of threads that take part in a parallelFor, including the calling thread.
+	Int getNumThreads( void ) const;
+
+	/** Run proc for every job index, and return once all of them are done.  Jobs must not
+		touch shared state that other jobs write.  A nested call from inside a job runs inline. */
+	void parallelFor( Int numJobs, WorkerJobProc proc, void *userData );
+
+	/// Index of the pool thread we are running on, 0 for any thread that isn't part of a pool.
+	static Int getCurrentWorkerIndex( void );
+
+	/// One worker per spare hardware thread, capped at MAX_WORKER_THREADS.
+	static Int getDefaultWorkerCount( void );
+
+private:
+	WorkerThreadPoolImpl *m_impl;
+};
+
+// the singleton
+extern WorkerThreadPool *TheWorkerThreadPool;
+
+#endif // __WORKERTHREADPOOL_H__
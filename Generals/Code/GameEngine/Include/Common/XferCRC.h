@@ -37,6 +37,8 @@
 // FORWARD REFERENCES /////////////////////////////////////////////////////////////////////////////
 class Snapshot;
 
+//#define TEST_XFER_CRC	///< check the CRC against the original word-at-a-time version, and time both
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 class XferCRC : public Xfer
@@ -56,6 +58,22 @@ public:
 
 	virtual void xferSnapshot( Snapshot *snapshot );		///< entry point for xfering a snapshot
 
+	// These are all whole 32-bit fields laid out back to back, so CRCing the struct in one go gives
+	// exactly the same result as the field at a time versions in Xfer, without a call per field.
+	virtual void xferCoord3D( Coord3D *coord3D );
+	virtual void xferICoord3D( ICoord3D *iCoord3D );
+	virtual void xferRegion3D( Region3D *region3D );
+	virtual void xferIRegion3D( IRegion3D *iRegion3D );
+	virtual void xferCoord2D( Coord2D *coord2D );
+	virtual void xferICoord2D( ICoord2D *iCoord2D );
+	virtual void xferRegion2D( Region2D *region2D );
+	virtual void xferIRegion2D( IRegion2D *iRegion2D );
+	virtual void xferRealRange( RealRange *realRange );
+	virtual void xferRGBColor( RGBColor *rgbColor );
+	virtual void xferRGBAColorReal( RGBAColorReal *rgbaColorReal );
+	virtual void xferRGBAColorInt( RGBAColorInt *rgbaColorInt );
+	virtual void xferMatrix3D( Matrix3D* mtx );
+
 	// Xfer CRC methods
 	virtual UnsignedInt getCRC( void );										///< get computed CRC in network byte order
 
@@ -69,5 +87,37 @@ protected:
 
 };
 
+#ifdef TEST_XFER_CRC
+//-------------------------------------------------------------------------------------------------
+/** The CRC exactly as it used to be done, a field and a word at a time, to check XferCRC against */
+//-------------------------------------------------------------------------------------------------
+class XferCRCReference : public XferCRC
+{
+
+public:
+
+	virtual void xferCoord3D( Coord3D *coord3D ) { Xfer::xferCoord3D( coord3D ); }
+	virtual void xferICoord3D( ICoord3D *iCoord3D ) { Xfer::xferICoord3D( iCoord3D ); }
+	virtual void xferRegion3D( Region3D *region3D ) { Xfer::xferRegion3D( region3D ); }
+	virtual void xferIRegion3D( IRegion3D *iRegion3D ) { Xfer::xferIRegion3D( iRegion3D ); }
+	virtual void xferCoord2D( Coord2D *coord2D ) { Xfer::xferCoord2D( coord2D ); }
+	virtual void xferICoord2D( ICoord2D *iCoord2D ) { Xfer::xferICoord2D( iCoord2D ); }
+	virtual void xferRegion2D( Region2D *region2D ) { Xfer::xferRegion2D( region2D ); }
+	virtual void xferIRegion2D( IRegion2D *iRegion2D ) { Xfer::xferIRegion2D( iRegion2D ); }
+	virtual void xferRealRange( RealRange *realRange ) { Xfer::xferRealRange( realRange ); }
+	virtual void xferRGBColor( RGBColor *rgbColor ) { Xfer::xferRGBColor( rgbColor ); }
+	virtual void xferRGBAColorReal( RGBAColorReal *rgbaColorReal ) { Xfer::xferRGBAColorReal( rgbaColorReal ); }
+	virtual void xferRGBAColorInt( RGBAColorInt *rgbaColorInt ) { Xfer::xferRGBAColorInt( rgbaColorInt ); }
+	virtual void xferMatrix3D( Matrix3D* mtx ) { Xfer::xferMatrix3D( mtx ); }
+
+protected:
+
+	virtual void xferImplementation( void *data, Int dataSize );
+
+};
+
+extern void doXferCRCTest( void );
+#endif
+
 #endif // __XFERDISKWRITE_H_
 
@@ -42,6 +42,11 @@
 #include "WWMath/matrix3d.h"		///< @todo Replace with our own matrix library
 #include "Common/STLTypedefs.h"
 
+/*
+	Spawns a pile of particle systems, and times updating them with the per-system work
+	done once per system (as it is now) and once per particle (as it used to be).
+*/
+//#define TEST_PARTICLE_UPDATE
  
 /// @todo Once the client framerate is decoupled, the frame counters within will have to become time-based
  
@@ -60,6 +65,18 @@ enum ParticleSystemID
 	INVALID_PARTICLE_SYSTEM_ID = 0
 };
 
+namespace rts 
+{
+	template<> struct hash<ParticleSystemID>
+	{
+		size_t operator()(ParticleSystemID id) const
+		{ 
+			std::hash<UnsignedInt> tmp;
+			return tmp((UnsignedInt)id);
+		}
+	};
+}
+
 #define MAX_VOLUME_PARTICLE_DEPTH ( 16 )
 #define DEFAULT_VOLUME_PARTICLE_DEPTH ( 0 )//The Default is not to do the volume thing!
 #define OPTIMUM_VOLUME_PARTICLE_DEPTH ( 6 )
@@ -159,6 +176,21 @@ protected:
 };
 
 
+/**
+ * Everything a Particle needs from its system to update, worked out once per system per
+ * frame, instead of once per particle.
+ */
+struct ParticleUpdateContext
+{
+	Real							m_gravity;									///< acceleration along Z
+	Coord3D						m_driftVelocity;						///< added to every particle's position
+	Bool							m_doWind;										///< false if the system has no wind motion
+	Coord3D						m_windCenter;								///< system position, including whatever we're attached to
+	Real							m_windCos;									///< direction of the wind
+	Real							m_windSin;
+	UnsignedInt				m_frame;										///< current client frame
+};
+
 /**
  * An individual particle created by a ParticleSystem.
  * NOTE: Particles cannot exist without a parent particle system.
@@ -173,8 +205,8 @@ public:
 
 	Particle( ParticleSystem *system, const ParticleInfo *data );
 
-	Bool update( void );												///< update this particle's behavior - return false if dead
-	void doWindMotion( void );									///< do wind motion (if present) from particle system
+	Bool update( const ParticleUpdateContext &ctx );	///< update this particle's behavior - return false if dead
+	void doWindMotion( const ParticleUpdateContext &ctx );	///< do wind motion (if present) from particle system
 
 	void applyForce( const Coord3D *force );		///< add the given acceleration
 	void detachDrawable( void ) { m_drawable = NULL; }	///< detach the Drawable pointer from this particle
@@ -561,6 +593,7 @@ public:
 
 	virtual Bool update( Int localPlayerIndex );								///< update this particle system, return false if dead
 	void updateWindMotion( void );							///< update wind motion
+	void fillUpdateContext( ParticleUpdateContext *ctx );	///< work out what our particles need to update
 
 	void setControlParticle( Particle *p );			///< set control particle
 
@@ -724,6 +757,7 @@ public:
 
 	typedef std::list<ParticleSystem*> ParticleSystemList;
 	typedef std::list<ParticleSystem*>::iterator ParticleSystemListIt;
+	typedef std::unordered_map<ParticleSystemID, ParticleSystemListIt, rts::hash<ParticleSystemID>, rts::equal_to<ParticleSystemID> > ParticleSystemIDMap;
     typedef std::unordered_map<AsciiString, ParticleSystemTemplate *, rts::hash<AsciiString>, rts::equal_to<AsciiString> > TemplateMap;
 
 	ParticleSystemManager( void );
@@ -788,6 +822,7 @@ public:
 	// these are only for use by partcle systems to link and unlink themselves
 	void friend_addParticleSystem( ParticleSystem *particleSystemToAdd );
 	void friend_removeParticleSystem( ParticleSystem *particleSystemToRemove );
+	void friend_changeParticleSystemID( ParticleSystem *particleSystem, ParticleSystemID oldID );
 
 protected:
 
@@ -802,6 +837,7 @@ protected:
 	ParticleSystemID m_uniqueSystemID;					///< unique system ID to assign to each system created
 
 	ParticleSystemList m_allParticleSystemList;
+	ParticleSystemIDMap m_systemMap;						///< where to find each system in m_allParticleSystemList, by ID
 
 	UnsignedInt m_particleCount;
 	UnsignedInt m_fieldParticleCount; ///< this does not need to be xfered, since it is evaluated every frame
@@ -812,6 +848,11 @@ protected:
 
 private:
 	TemplateMap m_templateMap;		///< a hash map of all particle system templates
+
+#ifdef TEST_PARTICLE_UPDATE
+	Bool m_ranParticleUpdateTest;
+	void doParticleUpdateTest();
+#endif
 };
 
 /// The particle system manager singleton
@@ -48,6 +48,14 @@ class PathfindZoneManager;
 
 #define INFANTRY_MOVES_THROUGH_INFANTRY
 
+// Records the first few hundred findPath requests on a map, then replays them and logs
+// searches per second.
+//#define TEST_PATHFIND_SPEED
+
+// Makes random cell type changes, and checks the incremental zone update against a full
+// zone calculation after each one.
+//#define TEST_INCREMENTAL_ZONES
+
 //----------------------------------------------------------------------------------------------------------
 
 /**
@@ -199,10 +207,16 @@ protected:
 enum {MAX_WALL_PIECES = 128};
 
 class PathfindCell;
+class PathfindSearchContext;
 
+/**
+ * The part of a cell's state that outlives a search - goal & position units and obstacles.
+ * Only cells that are occupied or blocked have one; they come out of a fixed size pool.
+ */
 class PathfindCellInfo
 {
 	friend class PathfindCell;
+	friend class PathfindSearchContext;
 public:
 	static void allocateCellInfos(void);
 	static void releaseCellInfos(void);
@@ -210,18 +224,16 @@ public:
 	static PathfindCellInfo * getACellInfo(PathfindCell *cell, const ICoord2D &pos);
 	static void releaseACellInfo(PathfindCellInfo *theInfo);
 
+	static Int getNumInUse(void) {return s_numInUse;}
+
 protected:
 	static PathfindCellInfo *s_infoArray;
 	static PathfindCellInfo *s_firstFree;							///< 
+	static Int s_numInUse;														///< Infos handed out of the pool.
 
-
-	PathfindCellInfo *m_nextOpen, *m_prevOpen;						///< for A* "open" list, shared by closed list
-
-	PathfindCellInfo *m_pathParent;												///< "parent" cell from pathfinder
+	PathfindCellInfo *m_nextFree;													///< free list link
 	PathfindCell *m_cell;															///< Cell this info belongs to currently.
 
-	UnsignedShort m_totalCost, m_costSoFar;	///< cost estimates for A* search
-
 	/// have to include cell's coordinates, since cells are often accessed via pointer only
 	ICoord2D m_pos;
 	
@@ -232,12 +244,208 @@ protected:
 	ObjectID m_obstacleID;	///< the object ID who overlaps this cell
 	
 	UnsignedInt m_isFree:1;
-	UnsignedInt m_blockedByAlly:1;///< True if this cell is blocked by an allied unit.
 	UnsignedInt m_obstacleIsFence:1;///< True if occupied by a fence.
 	UnsignedInt m_obstacleIsTransparent:1;///< True if obstacle is transparent (undefined if obstacleid is invalid)
+};
+
+/**
+ * The A* bookkeeping for one cell during one search.  Nodes belong to a PathfindSearchContext,
+ * so searches running in different contexts never see each other's open & closed lists.
+ */
+struct PathfindSearchNode
+{
+	PathfindSearchNode *m_nextOpen, *m_prevOpen;						///< for A* "open" list, shared by closed list
+	PathfindSearchNode *m_pathParent;												///< "parent" cell from pathfinder
+	PathfindCell *m_cell;															///< Cell this node belongs to currently.
+
+	ICoord2D m_pos;
+
+	UnsignedShort m_totalCost, m_costSoFar;	///< cost estimates for A* search
+
+	UnsignedInt m_blockedByAlly:1;///< True if this cell is blocked by an allied unit.
 	/// @todo Do we need both mark values in this cell?  Can't store a single value and compare it?
 	UnsignedInt m_open:1;													///< place for marking this cell as on the open list
 	UnsignedInt m_closed:1;												///< place for marking this cell as on the closed list
+	UnsignedInt m_usesPoolSlot:1;									///< True if this node counts against the cell info pool.
+	UnsignedInt m_isReleased:1;										///< Dropped from the lookup before the search ended.
+};
+typedef PathfindSearchNode *PathfindSearchNodeP;
+
+/**
+ * Identifies a hierarchical search well enough to reuse its corridor - the zone blocks the 
+ * path went through.  Any start and goal in the same block zones can get through the same blocks.
+ */
+struct PathfindCorridorKey
+{
+	ICoord2D									m_fromBlock;
+	UnsignedShort							m_fromZone;				///< Block zone of the start cell.
+	ICoord2D									m_toBlock;
+	UnsignedShort							m_toZone;					///< Block zone of the goal cell.
+	LocomotorSurfaceTypeMask	m_surfaces;
+	Bool											m_crusher;
+	Bool											m_isHuman;				///< Humans are kept inside the logical extent.
+
+	Bool operator==(const PathfindCorridorKey &other) const
+	{
+		return m_fromBlock.x == other.m_fromBlock.x && m_fromBlock.y == other.m_fromBlock.y && 
+			m_fromZone == other.m_fromZone && m_toBlock.x == other.m_toBlock.x && 
+			m_toBlock.y == other.m_toBlock.y && m_toZone == other.m_toZone &&
+			m_surfaces == other.m_surfaces && m_crusher == other.m_crusher && m_isHuman == other.m_isHuman;
+	}
+};
+
+/**
+ * What one findPath did with the corridor cache.  A speculative search only reads the cache,
+ * and this is played back onto it if the result is used, so the cache sees the same
+ * requests in the same order as in a serial run.
+ */
+struct PathfindCorridorUse
+{
+	Bool								m_lookedUp;
+	PathfindCorridorKey	m_key;
+	UnsignedInt					m_stamp;									///< Entry found, 0 for a miss.
+	Bool								m_failed;									///< The cached corridor didn't lead to a path.
+	Bool								m_stored;									///< A new corridor was found and should be kept.
+};
+
+/**
+ * A small LRU cache of hierarchical corridors, so a group of units sent to the same place
+ * doesn't repeat the same hierarchical search.  Entries are stamped with the pathfinder's
+ * structure serial, so anything that changes obstacles or bridges invalidates them all.
+ */
+class PathfindCorridorCache
+{
+public:
+	enum {MAX_ENTRIES = 64};
+	enum {MAX_CORRIDOR_BLOCKS = 128};
+
+	PathfindCorridorCache(void);
+
+	void clear(void);
+	UnsignedInt lookup(const PathfindCorridorKey &key, UnsignedInt structureSerial) const;	///< Stamp of the matching entry, or 0.
+	void touch(UnsignedInt stamp);									///< Mark an entry as most recently used.
+	void remove(UnsignedInt stamp);
+	void store(const PathfindCorridorKey &key, UnsignedInt structureSerial, const Bool *passable, Int numPassableBlocks);
+	Int getCorridor(UnsignedInt stamp, const Int **blocks) const;	///< Passable block indices for an entry.
+
+protected:
+	struct Entry
+	{
+		PathfindCorridorKey	m_key;
+		UnsignedInt					m_structureSerial;
+		UnsignedInt					m_stamp;								///< Unique per store, 0 if the entry is empty.
+		UnsignedInt					m_lastUsed;
+		Int									m_numBlocks;
+		Int									m_blocks[MAX_CORRIDOR_BLOCKS];
+	};
+	Int findEntry(UnsignedInt stamp) const;
+
+	Entry				m_entries[MAX_ENTRIES];
+	UnsignedInt	m_nextStamp;
+	UnsignedInt	m_useCounter;
+};
+
+/**
+ * Scratch state for A* searches - the open & closed lists, the search nodes, and the
+ * hierarchical passable flags.  The pathfinder searches in its own context on the logic
+ * thread; the pathfind queue hands each worker thread a context of its own, so several
+ * searches can run at once.  PathfindCell looks its node up in the calling thread's context.
+ *
+ * Nodes are bump allocated out of blocks that are kept from search to search, and the cell
+ * lookup is stamped with a generation number, so ending a search just bumps the generation
+ * and rewinds the blocks no matter how many cells it looked at.
+ */
+class PathfindSearchContext
+{
+	friend class PathfindCell;
+public:
+	PathfindSearchContext(void);
+	~PathfindSearchContext(void);
+
+	static PathfindSearchContext *getCurrent(void) {return s_current;}
+	static void setCurrent(PathfindSearchContext *context) {s_current = context;}
+
+	void setNumCells(Int numCells);				///< Size the cell lookup for a new map.  Releases all nodes.
+	void releaseAllNodes(void);						///< Drop every node, linked or not.
+	Int endSearch(void);									///< Drop every node, and return how many were on the open or closed list.
+
+	inline PathfindSearchNode *getNode(UnsignedInt cellIndex) const 
+	{
+		const NodeLookup &lookup = m_lookup[cellIndex];
+		return lookup.m_generation == m_generation ? lookup.m_node : NULL;
+	}
+	PathfindSearchNode *allocateNode(PathfindCell *cell, const ICoord2D &pos, Bool usesPoolSlot);
+	void releaseNode(PathfindSearchNode *node);
+
+	/// Keep count of the nodes on the open & closed lists, so endSearch doesn't have to walk them.
+	inline void nodeListed(void) {m_numListedNodes++;}
+	inline void nodeUnlisted(void) {m_numListedNodes--;}
+
+	void setNumPassableBlocks(Int numBlocks);
+	void copyPassableFlags(const Bool *flags, Int numBlocks);
+	const Bool *getPassableFlags(void) const {return m_passable;}
+	Int getNumPassableBlocks(void) const {return m_numPassableBlocks;}
+	inline Bool isBlockPassable(Int ndx) const {return m_passable[ndx];}
+	inline void setBlockPassable(Int ndx, Bool passable) {m_passable[ndx] = passable; m_passableWritten = true;}
+
+	/// Grow the touched region to include the given cells.
+	inline void touch(Int x, Int y) 
+	{
+		if (x<m_touched.lo.x) m_touched.lo.x = x;
+		if (y<m_touched.lo.y) m_touched.lo.y = y;
+		if (x>m_touched.hi.x) m_touched.hi.x = x;
+		if (y>m_touched.hi.y) m_touched.hi.y = y;
+	}
+	void clearTouched(void);
+
+	Int getNumPoolNodes(void) const {return m_numPoolNodes;}
+	Int getNumLiveNodes(void) const {return m_numLiveNodes;}
+	Int getNumNodeBlocks(void) const {return m_numNodeBlocks;}
+
+public:
+	PathfindCell *m_openList;											///< Cells ready to be explored
+	PathfindCell *m_closedList;										///< Cells already explored
+	Bool m_isTunneling;														///< True if path started in an obstacle
+	ObjectID m_ignoreObstacleID;									///< Ignore the given obstacle
+
+	// Bookkeeping used to decide if a speculative search gives the same answer as a live one.
+	Bool m_isSpeculative;													///< True while running ahead of the queue on a worker.
+	Int m_poolBase;																///< Pool slots held by nodes in other contexts.
+	Int m_peakPoolNodes;													///< Most pool slots held at once.
+	Bool m_ranOutOfNodes;													///< True if a node allocation failed because the pool was empty.
+	Int m_cellsReleased;													///< Cells released by cleanOpenAndClosedLists.
+	Int m_failedPathfinds;												///< Failed searches not yet reported to the game logic.
+	IRegion2D m_touched;													///< Cells the search looked at.
+	Bool m_passableWritten;												///< True if the passable flags were changed.
+	PathfindCorridorUse m_corridorUse;						///< Corridor cache use, held for playback.
+
+protected:
+	enum {NODES_PER_BLOCK = 1024};
+	struct NodeBlock
+	{
+		PathfindSearchNode	m_nodes[NODES_PER_BLOCK];
+		NodeBlock						*m_next;
+	};
+	struct NodeLookup
+	{
+		PathfindSearchNode	*m_node;
+		UnsignedInt					m_generation;							///< m_node is only good if this matches the context's generation.
+	};
+
+	static thread_local PathfindSearchContext *s_current;
+
+	NodeLookup *m_lookup;													///< Search node for each cell, indexed by PathfindCell::getIndex().
+	Int m_numCells;
+	UnsignedInt m_generation;											///< Bumped at the end of every search.
+	NodeBlock *m_nodeBlocks;											///< Every block this context has used.
+	NodeBlock *m_curBlock;												///< Block being allocated from.
+	Int m_curBlockUsed;														///< Nodes used in m_curBlock.
+	Int m_numNodeBlocks;
+	Int m_numPoolNodes;														///< Nodes that hold a cell info pool slot.
+	Int m_numLiveNodes;
+	Int m_numListedNodes;													///< Nodes on the open or closed list.
+	Bool *m_passable;															///< Hierarchical passable flag per zone block.
+	Int m_numPassableBlocks;
 };
 
 /**
@@ -308,40 +516,34 @@ public:
 	/// remove self from "closed" list
 	PathfindCell *removeFromClosedList( PathfindCell *list );	
 
-	/// remove all cells from closed list.
-	static Int releaseClosedList( PathfindCell *list );	
+	inline PathfindCell *getNextOpen(void) {PathfindSearchNode *node = getNode(); return node->m_nextOpen?node->m_nextOpen->m_cell:NULL;}
 
-	/// remove all cells from closed list.
-	static Int releaseOpenList( PathfindCell *list );	
+	inline UnsignedShort getXIndex(void) const {PathfindSearchNode *node = getNode(); return node?node->m_pos.x:m_info->m_pos.x;}
+	inline UnsignedShort getYIndex(void) const {PathfindSearchNode *node = getNode(); return node?node->m_pos.y:m_info->m_pos.y;}
 
-	inline PathfindCell *getNextOpen(void) {return m_info->m_nextOpen?m_info->m_nextOpen->m_cell:NULL;}
+	inline Bool isBlockedByAlly(void) const {PathfindSearchNode *node = getNode(); return node?node->m_blockedByAlly:false;}
+	inline void setBlockedByAlly(Bool blocked)  {touchNode()->m_blockedByAlly = (blocked!=0);}
 
-	inline UnsignedShort getXIndex(void) const {return m_info->m_pos.x;}
-	inline UnsignedShort getYIndex(void) const {return m_info->m_pos.y;}
+	inline Bool getOpen(void) const {PathfindSearchNode *node = getNode(); return node?node->m_open:false;}
+	inline Bool getClosed(void) const {PathfindSearchNode *node = getNode(); return node?node->m_closed:false;}
+	inline UnsignedInt getCostSoFar(void) const {PathfindSearchNode *node = getNode(); return node?node->m_costSoFar:0;}
+	inline UnsignedInt getTotalCost(void) const {PathfindSearchNode *node = getNode(); return node?node->m_totalCost:0;}
 
-	inline Bool isBlockedByAlly(void) const {return m_info->m_blockedByAlly;}
-	inline void setBlockedByAlly(Bool blocked)  {m_info->m_blockedByAlly = (blocked!=0);}
-
-	inline Bool getOpen(void) const {return m_info->m_open;}
-	inline Bool getClosed(void) const {return m_info->m_closed;}
-	inline UnsignedInt getCostSoFar(void) const {return m_info->m_costSoFar;}
-	inline UnsignedInt getTotalCost(void) const {return m_info->m_totalCost;}
-
-	inline void setCostSoFar(UnsignedInt cost) {m_info->m_costSoFar = cost;}
-	inline void setTotalCost(UnsignedInt cost) {m_info->m_totalCost = cost;}
+	inline void setCostSoFar(UnsignedInt cost) {touchNode()->m_costSoFar = cost;}
+	inline void setTotalCost(UnsignedInt cost) {touchNode()->m_totalCost = cost;}
 
 	void setParentCell(PathfindCell* parent);
 	void clearParentCell(void);
 	void setParentCellHierarchical(PathfindCell* parent);
-	inline PathfindCell* getParentCell(void) const {return m_info->m_pathParent?m_info->m_pathParent->m_cell:NULL;}
+	inline PathfindCell* getParentCell(void) const {PathfindSearchNode *node = getNode(); return (node && node->m_pathParent)?node->m_pathParent->m_cell:NULL;}
 
 	Bool startPathfind( PathfindCell *goalCell ); 
 	Bool getPinched(void) const {return m_pinched;}
 	void setPinched(Bool pinch) {m_pinched = pinch;	}
 
-	Bool allocateInfo(const ICoord2D &pos);
-	void releaseInfo(void);
-	Bool hasInfo(void) const {return m_info!=NULL;}
+	Bool allocateInfo(const ICoord2D &pos);	///< Get a search node for this cell, if needed.
+	void releaseInfo(void);									///< Release the search node, unless it is still on a list.
+	Bool hasInfo(void) const {return m_info!=NULL || getNode()!=NULL;}
 	UnsignedShort getZone(void) const {return m_zone;}
 	void setZone(UnsignedShort zone) {m_zone = zone;}
 	void setGoalUnit(ObjectID unit, const ICoord2D &pos );
@@ -359,8 +561,18 @@ public:
 	void setConnectLayer( PathfindLayerEnum layer ) { m_connectsToLayer = layer; }	///< set the cell layer	connect id
 	PathfindLayerEnum getConnectLayer( void ) const { return (PathfindLayerEnum)m_connectsToLayer; }				///< get the cell layer connect id
 
+	void setIndex( UnsignedInt index ) { m_index = index; }	///< set the cell's slot in the search node lookup
+	UnsignedInt getIndex( void ) const { return m_index; }
+
+	void releasePersistentInfo(void);				///< Release the goal/position/obstacle info, if nothing is using it.
+
 private:
+	inline PathfindSearchNode *getNode(void) const {return PathfindSearchContext::getCurrent()->getNode(m_index);}
+	PathfindSearchNode *touchNode(void);
+	Bool allocatePersistentInfo(const ICoord2D &pos);
+
 	PathfindCellInfo *m_info;
+	UnsignedInt m_index;				///< Slot in the search context node lookup.
 	UnsignedShort m_zone:14;			///< Zone. Each zone is a set of adjacent terrain type.  If from & to in the same zone, you can successfully pathfind.  If not,
 														// you still may be able to if you can cross multiple terrain types.
 	UnsignedShort m_aircraftGoal:1; //< This is an aircraft goal cell.
@@ -390,6 +602,7 @@ public:
 	Bool init(Bridge *theBridge, PathfindLayerEnum layer);
 	void allocateCells(const IRegion2D *extent);
 	void allocateCellsForWallLayer(const IRegion2D *extent, ObjectID *wallPieces, Int numPieces);
+	UnsignedInt setCellIndices(UnsignedInt firstIndex);	///< Number the cells for the search node lookup.
 	void classifyCells();
 	void classifyWallCells(ObjectID *wallPieces, Int numPieces);
 	Bool setDestroyed(Bool destroyed);
@@ -436,6 +649,7 @@ private:
 #define PATHFIND_CELL_SIZE_F	10.0f
 
 enum { PATHFIND_QUEUE_LEN=512};
+enum { PATHFIND_MAX_SEARCH_THREADS=8};	///< Most threads that search the pathfind queue at once.
 
 struct TCheckMovementInfo;
 
@@ -445,6 +659,28 @@ struct TCheckMovementInfo;
  * cells.  This is used in hierarchical pathfinding to find the best coarse path at the 
  * block level.
  */
+/**
+ * Two zones that touch, and the zone equivalencies that join them.  Each block keeps the links 
+ * for its own cells, so the equivalencies can be rebuilt without going over the whole map.
+ */
+struct ZoneLink
+{
+	enum {SAME_BLOCK, PREV_X_BLOCK, PREV_Y_BLOCK, BRIDGE_LAYER};	///< Where m_otherZone is.
+	enum {
+		HIERARCHICAL	= 0x01,
+		GROUND_WATER	= 0x02,
+		GROUND_RUBBLE	= 0x04,
+		GROUND_CLIFF	= 0x08,
+		TERRAIN				= 0x10,
+		CRUSHER				= 0x20
+	};
+
+	UnsignedShort m_zone;					///< Zone in this block, counted from the block's first zone.
+	UnsignedShort m_otherZone;		///< Zone in the other block, counted from its first zone, or the layer.
+	UnsignedByte	m_otherBlock;
+	UnsignedByte	m_relations;
+};
+
 class ZoneBlock
 {
 public: 
@@ -453,14 +689,26 @@ public:
 
 	void blockCalculateZones(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds);	///< Does zone calculations.  
 	UnsignedShort getEffectiveZone(LocomotorSurfaceTypeMask acceptableSurfaces, Bool crusher, UnsignedShort zone) const;
-
-	void clearMarkedPassable(void) {m_markedPassable = false;}
-	Bool isPassable(void) {return m_markedPassable;}
-	void setPassable(Bool pass) {m_markedPassable = pass;}
+	void shiftZones(Int delta);		///< Renumbers the block's zones, when a block before it changed.
 
 	Bool getInteractsWithBridge(void) const {return m_interactsWithBridge;}
 	void setInteractsWithBridge(Bool interacts) {m_interactsWithBridge = interacts;}
 
+	UnsignedShort getFirstZone(void) const {return m_firstZone;}
+	UnsignedShort getNumZones(void) const {return m_numZones;}
+
+	Bool isDirty(void) const {return m_isDirty;}
+	void setDirty(Bool dirty) {m_isDirty = dirty;}
+
+	void clearLinks(void) {m_numLinks = 0;}
+	void addLink(UnsignedShort zone, UnsignedByte otherBlock, UnsignedShort otherZone, UnsignedByte relations);
+	Int getNumLinks(void) const {return m_numLinks;}
+	const ZoneLink &getLink(Int i) const {return m_links[i];}
+
+#ifdef TEST_INCREMENTAL_ZONES
+	UnsignedInt getZoneHash(void) const;
+#endif
+
 protected:
 	void allocateZones(void);
 	void freeZones(void);
@@ -478,7 +726,11 @@ protected:
 	UnsignedShort *m_groundRubbleZones;
 	UnsignedShort *m_crusherZones;
 	Bool					m_interactsWithBridge;
-	Bool					m_markedPassable;
+	Bool					m_isDirty;								///< Cells in the block changed type since the zones were calculated.
+
+	ZoneLink			*m_links;
+	Int						m_numLinks;
+	Int						m_linksAllocated;
 };
 typedef ZoneBlock *ZoneBlockP;
 
@@ -502,8 +754,11 @@ public:
 	void reset(void);
 
 	Bool needToCalculateZones(void) const {return m_needToCalculateZones;} ///< Returns true if the zones need to be recalculated.
+	Bool needFullZoneCalculation(void) const {return m_needFullZoneCalc;} ///< Returns true if updateZones can't just do the changed blocks.
 	void markZonesDirty(void) ; ///< Called when the zones need to be recalculated.
+	void markZonesDirty(const IRegion2D &cells); ///< Called when the cells in this area changed type.
 	void calculateZones(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds);	///< Does zone calculations.  
+	void updateZones(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds);	///< Recalculates the changed blocks only, if it can.
 	UnsignedShort getEffectiveZone(LocomotorSurfaceTypeMask acceptableSurfaces, Bool crusher, UnsignedShort zone) const;
 	UnsignedShort getEffectiveTerrainZone(UnsignedShort zone) const;
 
@@ -523,11 +778,21 @@ public:
 	void setBridge(Int cellX, Int cellY, Bool bridge);
 	Bool interactsWithBridge(Int cellX, Int cellY) const;
 
+#ifdef TEST_INCREMENTAL_ZONES
+	UnsignedInt getZoneHash(PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds) const;
+#endif
+
 protected:
 	void allocateZones(void);
 	void freeZones(void);
 	void freeBlocks(void);
 
+	void getBlockBounds(const IRegion2D &globalBounds, Int xBlock, Int yBlock, IRegion2D &bounds) const;
+	Int labelBlockCells(PathfindCell **map, const IRegion2D &bounds) const;
+	void calculateBlockLinks(PathfindCell **map, const IRegion2D &globalBounds, Int xBlock, Int yBlock);
+	void calculateEquivalencies(PathfindLayer layers[]);
+	void flattenEquivalencies(void);
+
 protected:
 	ZoneBlock			*m_blockOfZoneBlocks;			///< Zone blocks - Info for hierarchical pathfinding at a "blocky" level.
 	ZoneBlock			**m_zoneBlocks;						///< Zone blocks as a matrix - contains matrix indexing into the map.
@@ -542,6 +807,10 @@ protected:
 	UnsignedShort *m_terrainZones;
 	UnsignedShort *m_crusherZones;
 	UnsignedShort *m_hierarchicalZones;
+
+	Bool					m_needFullZoneCalc;				///< True if something other than cell types changed.
+	Bool					m_haveZoneLinks;					///< True if the blocks' links are up to date.
+	IRegion2D			m_zoneBounds;							///< Bounds of the last full calculation.
 };
 
 /** 
@@ -576,6 +845,21 @@ public:
 
 };
 
+/**
+ * Per frame numbers for the pathfind queue, so the queue can be tuned.
+ */
+struct PathfindQueueStats
+{
+	Int		m_queueDepth;						///< Requests waiting when the frame started.
+	Int		m_pathsProcessed;				///< Requests processed this frame.
+	Int		m_cellsExamined;				///< Cells released by the searches this frame.
+	Int		m_speculativeSearches;	///< Searches run ahead of the queue on worker threads.
+	Int		m_speculativeHits;			///< Speculative searches that were used as is.
+	Real	m_wallTimeMS;						///< Time spent in processPathfindQueue.
+};
+
+struct PathfindSpeculation;
+
 /**
  * The Pathfinding engine itself.
  */
@@ -620,6 +904,7 @@ public:
 
 	Bool queueForPath(ObjectID id);	 ///< The object wants to request a pathfind, so put it on the list to process.
 	void processPathfindQueue(void); ///< Process some or all of the queued pathfinds.
+	const PathfindQueueStats &getQueueStats(void) const {return m_queueStats;}	///< Numbers for the last processPathfindQueue.
 	void forceMapRecalculation( );	///< Force pathfind map recomputation. If region is given, only that area is recomputed
 
 	/** Returns an aircraft path to the goal.  */
@@ -721,6 +1006,7 @@ public:
 	Int clearCellForDiameter( Bool crusher, Int cellX, Int cellY, PathfindLayerEnum layer, Int pathDiameter );		///< Return true if given position is a valid movement location
 
 protected:
+	Path *doFindPath( Object *obj, const LocomotorSet& locomotorSet, const Coord3D *from, const Coord3D *to);	///< findPath, without the speculative shortcut.
 	virtual Path *internalFindPath( Object *obj, const LocomotorSet& locomotorSet, const Coord3D *from, const Coord3D *to);	///< Find a short, valid path between given locations
 	Path *findHierarchicalPath( Bool isHuman, const LocomotorSet& locomotorSet, const Coord3D *from, const Coord3D *to, Bool crusher);	
 	Path *findClosestHierarchicalPath( Bool isHuman, const LocomotorSet& locomotorSet, const Coord3D *from, const Coord3D *to, Bool crusher);	
@@ -816,10 +1102,34 @@ protected:
 
 	void checkChangeLayers(PathfindCell *parentCell);
 
+	/// The search scratch state for the calling thread.
+	inline PathfindSearchContext &searchContext(void) {return *PathfindSearchContext::getCurrent();}
+
+	void countFailedPathfind(void);		///< Tell the game logic, or hold on to it if this is a speculative search.
+	Bool getCorridorKey(Bool isHuman, LocomotorSurfaceTypeMask surfaces, Bool crusher, 
+		const Coord3D *from, const Coord3D *to, PathfindCorridorKey &key);
+	void applyCorridorUse(const PathfindCorridorUse &use);	///< Update the corridor cache after a findPath.
+	void markStructureChanged(void) {m_structureSerial++;}	///< Obstacles, bridges or walls changed.
+	void markCellsDirty(Int cellX, Int cellY, Int radius);		///< Unit goal/position data changed around a cell.
+	void markObjectDirty(const Object *obj);
+
+	void speculatePaths(Int firstSlot, Int numSlots);	///< Search ahead of the queue on the worker threads.
+	static void speculatePathJob(Int jobIndex, Int workerIndex, void *userData);
+	Bool isSpeculationValid(const PathfindSpeculation *spec);
+	void freeSpeculations(void);
+
 #if defined _DEBUG || defined _INTERNAL
 	void doDebugIcons(void) ;
 #endif
 
+#ifdef TEST_PATHFIND_SPEED
+	void recordPathRequest(const Object *obj, const Coord3D *from, const Coord3D *to);
+	void doPathfindSpeedTest(void);
+#endif
+#ifdef TEST_INCREMENTAL_ZONES
+	void doZoneUpdateTest(void);
+#endif
+
 private:
 	/// This uses WAY too much memory.  Should at least be array of pointers to cells w/ many fewer cells
 	PathfindCell *m_blockOfMapCells;		///< Pathfinding map - contains iconic representation of the map
@@ -827,19 +1137,16 @@ private:
 	IRegion2D m_extent;														///< Grid extent limits
 	IRegion2D m_logicalExtent;										///< Logical grid extent limits
 
-	PathfindCell *m_openList;											///< Cells ready to be explored
-	PathfindCell *m_closedList;										///< Cells already explored
+	PathfindSearchContext m_mainSearch;						///< Search scratch for the logic thread.
+	PathfindSearchContext m_workerSearch[PATHFIND_MAX_SEARCH_THREADS];	///< Search scratch for speculative searches.
 
 	Bool m_isMapReady;														///< True if all cells of map have been classified
-	Bool m_isTunneling;														///< True if path started in an obstacle
 
 	Int m_frameToShowObstacles;										///< Time to redraw obstacles.  For debug output.
 
 	Coord3D debugPathPos;													///< Used for visual debugging
 	Path *debugPath;															///< Used for visual debugging
 
-	ObjectID m_ignoreObstacleID;									///< Ignore the given obstacle
-
 	PathfindZoneManager m_zoneManager;						///< Handles the pathfind zones.
 
 	PathfindLayer m_layers[LAYER_LAST+1];
@@ -856,12 +1163,43 @@ private:
 	Int						m_queuePRHead;
 	Int						m_queuePRTail;
 	Int						m_cumulativeCellsAllocated;
+
+	// Speculative searches for the current pass over the queue.
+	enum {MAX_DIRTY_RECTS = 64};
+	PathfindSpeculation	*m_speculations;				///< One per queue slot being searched ahead.
+	Int						m_numSpeculations;
+	Int						m_firstSpeculationSlot;					///< Queue slot of m_speculations[0].
+	PathfindSpeculation	*m_activeSpeculation;		///< Speculation for the request being processed.
+	UnsignedInt		m_structureSerial;							///< Bumped whenever obstacles change.
+	IRegion2D			m_dirtyRects[MAX_DIRTY_RECTS];	///< Unit changes since the speculations ran.
+	Int						m_numDirtyRects;
+	Bool					m_dirtyOverflow;
+	Int						m_avgCellsPerPath;							///< Running average, used to size the look ahead.
+
+	PathfindQueueStats	m_queueStats;
+	PathfindCorridorCache	m_corridorCache;				///< Recent hierarchical corridors for findPath.
+
+#ifdef TEST_PATHFIND_SPEED
+	enum {NUM_RECORDED_PATHS = 256};
+	struct RecordedPathRequest
+	{
+		ObjectID	m_objID;
+		Coord3D		m_from;
+		Coord3D		m_to;
+	};
+	RecordedPathRequest m_recordedPaths[NUM_RECORDED_PATHS];
+	Int						m_numRecordedPaths;
+	Bool					m_ranSpeedTest;
+#endif
+#ifdef TEST_INCREMENTAL_ZONES
+	Bool					m_ranZoneTest;
+#endif
 };
 
 
 inline void Pathfinder::setIgnoreObstacleID( ObjectID objID )
 {
-	m_ignoreObstacleID = objID;
+	searchContext().m_ignoreObstacleID = objID;
 }
 
 inline void Pathfinder::worldToGrid( const Coord3D *pos, ICoord2D *cellIndex ) 
@@ -62,6 +62,7 @@ public:
 	virtual DisabledMaskType getDisabledTypesToProcess() const { return DISABLEDMASK_ALL; }
 
 	virtual UpdateSleepTime update();	///< See if spin down is needed because we haven't shot in a while
+	virtual Bool isSelfContainedUpdate() const;
 
 protected:
 
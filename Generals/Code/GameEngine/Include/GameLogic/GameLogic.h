@@ -41,6 +41,8 @@
 #include "Common/STLTypedefs.h"
 #include "GameLogic/Module/UpdateModule.h"	// needed for DIRECT_UPDATEMODULE_ACCESS
 
+#include <thread>
+
 /*
 	At one time, we distinguished between sleepy and nonsleepy
 	update modules, and kept a separate list for each. however,
@@ -52,6 +54,24 @@
 */
 #define NO_ALLOW_NONSLEEPY_UPDATES
 
+/*
+	Times the sleepy update wheel against a plain heap, for a range of module counts,
+	the first time GameLogic::update runs.
+*/
+//#define TEST_SLEEPY_WHEEL
+
+/*
+	Times ObjectIDTable against the hash_map it replaced, and logs how much memory each
+	one uses, once the game has been running for a bit.
+*/
+//#define TEST_OBJECT_ID_TABLE
+
+/*
+	Times a frame's worth of contact list and iterator sized allocations from the pools
+	against the same from a FrameArena, once the game has been running for a bit.
+*/
+//#define TEST_FRAME_ARENA
+
 // forward declarations
 class AudioEventRTS;
 class Object;
@@ -93,8 +113,140 @@ enum
 
 /// Function pointers for use by GameLogic callback functions.
 typedef void (*GameLogicFuncPtr)( Object *obj, void *userData ); 
-typedef std::unordered_map<ObjectID, Object *, rts::hash<ObjectID>, rts::equal_to<ObjectID> > ObjectPtrHash;
-typedef ObjectPtrHash::const_iterator ObjectPtrIter;
+
+// ------------------------------------------------------------------------------------------------
+/**
+	Maps ObjectIDs to Objects. IDs are handed out in increasing order and are never reused,
+	so instead of hashing them we index straight into pages of PAGE_SIZE slots; a lookup is
+	two loads. A page is allocated when the first ID on it is used, and freed again once
+	the last object on it goes away, so the memory used follows the number of objects alive
+	rather than the number we've ever made.
+*/
+class ObjectIDTable
+{
+public:
+
+	enum 
+	{ 
+		PAGE_SHIFT = 10, 
+		PAGE_SIZE = 1 << PAGE_SHIFT, 
+		PAGE_MASK = PAGE_SIZE - 1 
+	};
+
+	ObjectIDTable();
+	~ObjectIDTable();
+
+	inline Object* find(ObjectID id) const
+	{
+		UnsignedInt page = (UnsignedInt)id >> PAGE_SHIFT;
+		if (page >= m_pages.size() || m_pages[page] == NULL)
+			return NULL;
+		return m_pages[page]->m_slots[id & PAGE_MASK];
+	}
+
+	void insert(ObjectID id, Object *obj);
+	void erase(ObjectID id, Object *obj);		///< only if 'id' still refers to 'obj'
+	void clear();
+	void iterate( GameLogicFuncPtr proc, void *userData ) const;	///< every object, in increasing ID order
+
+	Int getCount() const { return m_count; }
+	Int getPageCount() const { return m_numPagesAllocated; }
+	UnsignedInt getMemoryUsed() const;			///< in bytes
+
+private:
+
+	struct Page
+	{
+		Object*		m_slots[PAGE_SIZE];
+		Int				m_count;						///< non-null slots
+	};
+
+	std::vector<Page*>	m_pages;				///< indexed by id >> PAGE_SHIFT
+	Int									m_numPagesAllocated;
+	Int									m_count;
+};
+
+// ------------------------------------------------------------------------------------------------
+/** How much a FrameArena has handed out. */
+struct FrameArenaStats
+{
+	UnsignedInt		m_frames;									///< frames that have ended since the stats were cleared
+	Int						m_lastFrameAllocations;		///< allocations made in the frame that ended last
+	UnsignedInt		m_lastFrameBytes;					///< ... and the bytes they took
+	Int						m_peakFrameAllocations;		///< most allocations made in any one frame
+	UnsignedInt		m_peakFrameBytes;					///< most bytes taken in any one frame
+	UnsignedInt64	m_totalAllocations;
+	UnsignedInt64	m_totalBytes;
+	UnsignedInt		m_reservedBytes;					///< what the arena is holding on to right now
+
+	void clear() { memset(this, 0, sizeof(*this)); }
+};
+
+// ------------------------------------------------------------------------------------------------
+/**
+	Scratch memory for things that only live for one logic frame. Allocating is a pointer bump,
+	there is no free: everything goes at once in endFrame(). Nothing is constructed or destructed
+	for you, so only put plain data in here. Only the thread that created the arena may use it;
+	everyone else should check canAllocate() and fall back to the pools.
+
+	Memory comes from the dma in chunks. If a frame needs more than one chunk, they are swapped
+	for a single chunk big enough for that frame at endFrame(), so it settles down to one.
+*/
+class FrameArena
+{
+public:
+
+	enum 
+	{ 
+		ALIGNMENT = 8,							// all the dma promises us
+		MIN_CHUNK_SIZE = 64 * 1024 
+	};
+
+	FrameArena();
+	~FrameArena();
+
+	inline Bool canAllocate() const { return std::this_thread::get_id() == m_ownerThread; }
+
+	/// return 'bytes' of uninitialized memory, good until the next endFrame()
+	inline void *allocate(size_t bytes)
+	{
+		DEBUG_ASSERTCRASH(canAllocate(), ("FrameArena - only the thread that made the arena may use it"));
+		bytes = (bytes + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+		++m_frameAllocations;
+		m_frameBytes += (UnsignedInt)bytes;
+		if ((size_t)(m_end - m_cur) < bytes)
+			return allocateFromNewChunk(bytes);
+		void *p = m_cur;
+		m_cur += bytes;
+		return p;
+	}
+
+	void endFrame();							///< throw away everything allocated since the last call
+
+	const FrameArenaStats& getStats() const { return m_stats; }
+	void clearStats();
+
+private:
+
+	struct Chunk
+	{
+		Chunk*		m_next;
+		size_t		m_size;							///< bytes, including this header
+	};
+
+	void *allocateFromNewChunk(size_t bytes);
+	Chunk *newChunk(size_t size);
+	void freeChunks();
+
+	Chunk*						m_firstChunk;
+	Chunk*						m_curChunk;
+	char*							m_cur;						///< next free byte in m_curChunk
+	char*							m_end;						///< end of m_curChunk
+	Int								m_frameAllocations;
+	UnsignedInt				m_frameBytes;
+	std::thread::id		m_ownerThread;
+	FrameArenaStats		m_stats;
+};
 
 
 // ------------------------------------------------------------------------------------------------
@@ -133,6 +285,13 @@ public:
 	Real getHeight( void );													///< Returns the height of the world
 
 	Bool isInGameLogicUpdate( void ) const { return m_isInUpdate; }
+
+	/** Scratch memory that's all thrown away at the end of the current logic frame (or of the next
+		one, if we aren't in one). Only from the logic thread: check canAllocateFrameMemory() first. */
+	void *allocateFrameMemory( size_t bytes ) { return m_frameArena.allocate(bytes); }
+	Bool canAllocateFrameMemory( void ) const { return m_frameArena.canAllocate(); }
+	const FrameArenaStats& getFrameArenaStats( void ) const { return m_frameArena.getStats(); }
+
 	UnsignedInt getFrame( void );										///< Returns the current simulation frame number
 	UnsignedInt getCRC( Int mode = CRC_CACHED, AsciiString deepCRCFileName = AsciiString::TheEmptyString );		///< Returns the CRC
 
@@ -225,10 +384,13 @@ public:
 	Int getRankPointsToAddAtGameStart() const { return m_rankPointsToAddAtGameStart; }
 
 #ifdef DUMP_PERF_STATS
-	void getAIMetricsStatistics( UnsignedInt *numAI, UnsignedInt *numMoving, UnsignedInt *numAttacking, UnsignedInt *numWaitingForPath, UnsignedInt *overallFailedPathfinds );
+	void getAIMetricsStatistics( UnsignedInt *numAI, UnsignedInt *numMoving, UnsignedInt *numAttacking, UnsignedInt *numWaitingForPath, UnsignedInt *overallFailedPathfinds,
+		UnsignedInt *pathCacheHits, UnsignedInt *pathCacheMisses );
 	void resetOverallFailedPathfinds() { m_overallFailedPathfinds = 0; }
 	void incrementOverallFailedPathfinds() { m_overallFailedPathfinds++; }
 	UnsignedInt getOverallFailedPathfinds() const { return m_overallFailedPathfinds; }
+	void incrementPathCacheHits() { m_pathCacheHits++; }
+	void incrementPathCacheMisses() { m_pathCacheMisses++; }
 #endif
 	
 	// NOTE: selectObject and deselectObject should be called *only* by logical things, NEVER by the
@@ -250,14 +412,29 @@ protected:
 private:
 
 	void pushSleepyUpdate(UpdateModulePtr u);
-	UpdateModulePtr peekSleepyUpdate() const;
-	void popSleepyUpdate();
+	UpdateModulePtr peekSleepyUpdate(UnsignedInt now) const;
+	void removeSleepyUpdate(UpdateModulePtr u);
+	void advanceSleepyWheel(UnsignedInt now);
+	void clearSleepyUpdates();
+	void pushSleepyHeap(UpdateModulePtr u);
 	void eraseSleepyUpdate(Int i);
 	void rebalanceSleepyUpdate(Int i);
 	Int rebalanceParentSleepyUpdate(Int i);
 	Int rebalanceChildSleepyUpdate(Int i);
-	void remakeSleepyUpdate();
 	void validateSleepyUpdate() const;
+	void runSelfContainedUpdates(UnsignedInt now);
+#ifdef DEBUG_CRC
+	UnsignedInt calcSharedStateCRC(const Object *skip);
+#endif
+#ifdef TEST_SLEEPY_WHEEL
+	void doSleepyWheelTest();
+#endif
+#ifdef TEST_OBJECT_ID_TABLE
+	void doObjectIDTableTest();
+#endif
+#ifdef TEST_FRAME_ARENA
+	void doFrameArenaTest();
+#endif
 
 private:
 
@@ -302,13 +479,44 @@ private:
 	WindowLayout *m_background;
 
 	Object* m_objList;																			///< All of the objects in the world.
-	ObjectPtrHash m_objHash;																///< Used for ObjectID lookups
+	ObjectIDTable m_objTable;																///< Used for ObjectID lookups
+	std::vector<UnsignedInt> m_objectCRCs;									///< scratch for getCRC
+	FrameArena m_frameArena;																///< see allocateFrameMemory()
+
+	/*
+		Sleepy updates are kept in a timing wheel: one bucket per frame for the next
+		SLEEPY_WHEEL_FRAMES frames, split by phase, each bucket a list in the order things
+		were scheduled. Scheduling into (or out of) a bucket is O(1). Anything due further
+		out than that (or, in odd cases, overdue) goes in m_sleepyUpdates instead, and
+		whenever a frame comes into range its sleepers move over into the wheel.
+		Either way, modules are updated strictly by priority, and then by the order they
+		were scheduled in.
+	*/
+	enum 
+	{ 
+		SLEEPY_WHEEL_FRAMES = 256,	// must be a power of 2
+		SLEEPY_WHEEL_BUCKETS = SLEEPY_WHEEL_FRAMES * 4,	// 4 phases per frame
+		SLEEPY_IN_WHEEL = -2				// index in logic for modules in the wheel
+	};
+	UpdateModulePtr m_sleepyWheelHead[SLEEPY_WHEEL_BUCKETS];
+	UpdateModulePtr m_sleepyWheelTail[SLEEPY_WHEEL_BUCKETS];
+	UnsignedInt m_sleepyWheelFrame;													///< first frame the wheel covers
+	UnsignedInt64 m_sleepySequence;													///< bumped every time a module is scheduled
 
 	// this is a vector, but is maintained as a priority queue.
 	// never modify it directly; please use the proper access methods.
 	// (for an excellent discussion of priority queues, please see:
 	// http://dogma.net/markn/articles/pq_stl/priority.htm)
 	std::vector<UpdateModulePtr> m_sleepyUpdates;
+#ifdef TEST_SLEEPY_WHEEL
+	Bool m_ranSleepyWheelTest;
+#endif
+#ifdef TEST_OBJECT_ID_TABLE
+	Bool m_ranObjectIDTableTest;
+#endif
+#ifdef TEST_FRAME_ARENA
+	Bool m_ranFrameArenaTest;
+#endif
 	
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	// this is a plain old list, not a pq.
@@ -317,6 +525,12 @@ private:
 
 	UpdateModulePtr					 m_curUpdateModule;
 
+	// self contained updates due this frame, and what each one returned. (scratch space
+	// for runSelfContainedUpdates, kept around so we don't reallocate every frame.)
+	std::vector<UpdateModulePtr> m_selfContainedUpdates;
+	std::vector<UpdateSleepTime> m_selfContainedSleep;
+	Bool m_inSelfContainedUpdates;													///< true while the worker threads are running them
+
 	ObjectPointerList m_objectsToDestroy;										///< List of things that need to be destroyed at end of frame
 
 	ObjectID m_nextObjID;																		///< For allocating object id's
@@ -348,6 +562,8 @@ private:
 
 #ifdef DUMP_PERF_STATS
 	UnsignedInt m_overallFailedPathfinds;
+	UnsignedInt m_pathCacheHits;						///< Searches that reused a cached hierarchical corridor.
+	UnsignedInt m_pathCacheMisses;
 #endif
 
 	UnsignedInt m_frameObjectsChangedTriggerAreas;					///< Last frame objects moved into/outof trigger areas, or were created/destroyed. jba.
@@ -397,11 +613,7 @@ inline Object* GameLogic::findObjectByID( ObjectID id )
 	if( id == INVALID_ID )
 		return NULL;
 
-	ObjectPtrHash::iterator it = m_objHash.find(id);
-	if (it == m_objHash.end())
-		return NULL;
-	
-	return (*it).second;
+	return m_objTable.find(id);
 }
 
 
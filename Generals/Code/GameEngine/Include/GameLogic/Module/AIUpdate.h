@@ -445,6 +445,7 @@ private:
 
 public:
 	void doPathfind( PathfindServicesInterface *pathfinder ); 
+	Bool getPredictedPathRequest( Coord3D *destination );	///< True if doPathfind will do a plain findPath to destination.
 	void requestPath( Coord3D *destination, Bool isGoalDestination );	///< Queues a request to pathfind to destination.
 	void requestAttackPath( ObjectID victimID, const Coord3D* victimPos );	///< computes path to attack the current target, returns false if no path
 	void requestApproachPath( Coord3D *destination );	///< computes path to attack the current target, returns false if no path
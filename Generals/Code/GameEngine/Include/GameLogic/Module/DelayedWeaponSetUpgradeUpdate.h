@@ -64,6 +64,7 @@ public:
 	virtual void setDelay( UnsignedInt startingDelay );	///< Start the upgrade doing countdown
 
 	virtual UpdateSleepTime update();
+	virtual Bool isSelfContainedUpdate() const { return TRUE; }
 
 protected:
 	
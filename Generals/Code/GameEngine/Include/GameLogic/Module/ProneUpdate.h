@@ -69,6 +69,7 @@ public:
 	void goProne( const DamageInfo *damageInfo );
 
 	virtual UpdateSleepTime update();
+	virtual Bool isSelfContainedUpdate() const;
 
 protected:
 
@@ -79,6 +79,7 @@ public:
 	Bool isRadarActive() { return m_radarActive; }
 
 	virtual UpdateSleepTime update( void ); ///< Here's the actual work of Upgrading
+	virtual Bool isSelfContainedUpdate() const;
 
 protected:
 
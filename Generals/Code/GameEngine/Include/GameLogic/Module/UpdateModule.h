@@ -142,6 +142,9 @@ private:
 	// actually, it's not a real frame at all, it has phase info in the lower bits...
 	UnsignedInt m_nextCallFrameAndPhase;	
 	Int m_indexInLogic;
+	UpdateModule* m_prevInLogic;					///< neighbors in GameLogic's wake-frame bucket, if we're in one
+	UpdateModule* m_nextInLogic;
+	UnsignedInt64 m_sequenceInLogic;			///< when GameLogic last scheduled us; breaks ties between equal priorities
 
 protected:
 
@@ -179,6 +182,20 @@ public:
 		return DISABLEDMASK_NONE; 
 	}
 
+	/**
+		Return TRUE if your next update() will touch nothing but your own module and
+		the plain data of your own object. GameLogic is then free to run it on a worker
+		thread, alongside other such updates, before the rest of the frame's updates.
+		That rules out creating, destroying, or moving objects, drawables, audio, random
+		numbers, partition queries, memory pool allocations, and setWakeFrame(). This
+		is asked right before each call, so it's fine to say TRUE only when you know
+		the next update is just bookkeeping. When in doubt, leave it alone.
+	*/
+	virtual Bool isSelfContainedUpdate() const
+	{
+		return FALSE;
+	}
+
 #ifdef DIRECT_UPDATEMODULE_ACCESS
     #define UPDATEMODULE_FRIEND_DECLARATOR inline
 #else
@@ -220,6 +237,13 @@ public:
 		m_indexInLogic = i; 
 	}
 
+	UPDATEMODULE_FRIEND_DECLARATOR UpdateModule* friend_getPrevInLogic() const { return m_prevInLogic; }
+	UPDATEMODULE_FRIEND_DECLARATOR UpdateModule* friend_getNextInLogic() const { return m_nextInLogic; }
+	UPDATEMODULE_FRIEND_DECLARATOR void friend_setPrevInLogic(UpdateModule* u) { m_prevInLogic = u; }
+	UPDATEMODULE_FRIEND_DECLARATOR void friend_setNextInLogic(UpdateModule* u) { m_nextInLogic = u; }
+	UPDATEMODULE_FRIEND_DECLARATOR UnsignedInt64 friend_getSequenceInLogic() const { return m_sequenceInLogic; }
+	UPDATEMODULE_FRIEND_DECLARATOR void friend_setSequenceInLogic(UnsignedInt64 seq) { m_sequenceInLogic = seq; }
+
 	UPDATEMODULE_FRIEND_DECLARATOR const Object* friend_getObject() const 
 	{ 
 		return getObject(); 
@@ -229,7 +253,10 @@ public:
 inline UpdateModule::UpdateModule( Thing *thing, const ModuleData* moduleData ) : 
 	BehaviorModule( thing, moduleData ),
 	m_nextCallFrameAndPhase(0),
-	m_indexInLogic(-1) 
+	m_indexInLogic(-1),
+	m_prevInLogic(NULL),
+	m_nextInLogic(NULL),
+	m_sequenceInLogic(0)
 { 
 	// nothing
 }
@@ -511,8 +511,8 @@ public:
 	// @todo: inline
 	Bool hasSpecialPower( SpecialPowerType type ) const;
 
-	void setWeaponBonusCondition(WeaponBonusConditionType wst) { m_weaponBonusCondition |= (1 << wst); }
-	void clearWeaponBonusCondition(WeaponBonusConditionType wst) { m_weaponBonusCondition &= ~(1 << wst); }
+	void setWeaponBonusCondition(WeaponBonusConditionType wst) { m_weaponBonusCondition |= (1 << wst); markCRCDirty(); }
+	void clearWeaponBonusCondition(WeaponBonusConditionType wst) { m_weaponBonusCondition &= ~(1 << wst); markCRCDirty(); }
   // note, the !=0 at the end is important, to convert this into a boolean type! (srj)
 	Bool testWeaponBonusCondition(WeaponBonusConditionType wst) const { return (m_weaponBonusCondition & (1 << wst)) != 0; }
 	inline WeaponBonusConditionFlags getWeaponBonusCondition() const { return m_weaponBonusCondition; }
@@ -583,6 +583,13 @@ public:
 
 	Bool isHero() const;
 
+	/** The CRC of this object on its own, as crc() works it out.  With useCache, it is kept and
+		only redone once something it depends on changes: anything that changes what crc() looks
+		at must call markCRCDirty(), except the weapons, which have stamps of their own. */
+	UnsignedInt getObjectCRC( Bool useCache );
+	Bool isObjectCRCCached() const;										///< would getObjectCRC(TRUE) use the cached value
+	void markCRCDirty() { m_crcDirty = TRUE; }
+
 protected:
 
 	void setOrRestoreTeam( Team* team, Bool restoring );
@@ -737,6 +744,9 @@ private:
 	Coord2D												m_formationOffset;
 
 	AsciiString										m_commandSetStringOverride;///< To allow specific object to switch command sets
+
+	UnsignedInt										m_cachedCRC;							///< see getObjectCRC
+	UnsignedInt										m_cachedCRCWeaponStamps[WEAPONSLOT_COUNT];	///< stamps of the weapons m_cachedCRC was worked out from
 	
 	UnsignedInt										m_safeOcclusionFrame;	///<flag used by occlusion renderer so it knows when objects have exited their production building.
 
@@ -751,6 +761,7 @@ private:
 	Byte													m_numTriggerAreasActive;
 	Bool													m_singleUseCommandUsed;
 	Bool													m_isReceivingDifficultyBonus;
+	Bool													m_crcDirty;								///< m_cachedCRC needs doing again
 
 };  // end class Object
 
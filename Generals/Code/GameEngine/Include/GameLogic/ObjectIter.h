@@ -85,24 +85,23 @@ inline ObjectIterator::~ObjectIterator() { }
 //-------------------------------------------------------------------------------------------
 /**
 	A basic implementation of ObjectIterator, with (hidden) extensions
-	to allow for sorting by a numeric field.
+	to allow for sorting by a numeric field. Don't keep one past the end
+	of the logic frame it was filled in.
 */
 class SimpleObjectIterator : public ObjectIterator
 {
 	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(SimpleObjectIterator, "SimpleObjectIteratorPool" )		
 private:
 
-	class Clump : public MemoryPoolObject
+	/**
+		iterators are almost always thrown away in the frame they were made in, so clumps
+		are plain data that normally comes out of the logic's frame memory.
+	*/
+	struct Clump
 	{
-		MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(Clump, "SimpleObjectIteratorClumpPool" )		
-	public:
-
 		Clump			*m_nextClump;
 		Object		*m_obj;
 		Real			m_numeric;	// typically, dist-squared
-
-		Clump();
-	//~Clump();
 	};
 
 	typedef Real (*ClumpCompareProc)(Clump *a, Clump *b);
@@ -117,6 +116,7 @@ private:
 	Clump				*m_firstClump;
 	Clump				*m_curClump;
 	Int					m_clumpCount;
+	Bool				m_clumpsInFrameMemory;	///< false if we're off the logic thread, and have to use the dma
 
 	void reset();
 
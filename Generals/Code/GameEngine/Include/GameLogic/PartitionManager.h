@@ -72,6 +72,12 @@
 */
 #define FASTER_GCO
 
+/*
+	Times the cell update and collision pair gathering in PartitionManager::update,
+	with and without the worker threads, once a game has been running for a bit.
+*/
+//#define TEST_PARTITION_SPEED
+
 const Real HUGE_DIST = 1000000.0f;
 
 //-----------------------------------------------------------------------------
@@ -174,6 +180,7 @@ struct CollideLocAndNormal
 */
 //=====================================
 class PartitionContactList;
+struct PartitionContactPair;
 
 
 //=====================================
@@ -192,6 +199,7 @@ private:
 	PartitionCell							*m_cell;									///< the cell being touched
 	PartitionData							*m_module;								///< the module (and thus, Object) touching
 	CellAndObjectIntersection *m_prevCoi, *m_nextCoi;		///< if in use, next/prev in this cell. if not in use, next/prev free in this module.
+	Int												m_packedIndex;						///< if in use, where we are in the cell's packed arrays
 
 public:
 
@@ -235,6 +243,8 @@ public:
 	// only for use by PartitionCell.
 	void friend_addToCellList(CellAndObjectIntersection **pListHead);
 	void friend_removeFromCellList(CellAndObjectIntersection **pListHead);
+	Int friend_getPackedIndex() const { return m_packedIndex; }
+	void friend_setPackedIndex(Int i) { m_packedIndex = i; }
 };
 
 /**
@@ -305,14 +315,27 @@ private:
 	Short													m_cellX;						///< x-coord of this cell within the Partition Mgr coords (NOT in world coords)
 	Short													m_cellY;						///< y-coord of this cell within the Partition Mgr coords (NOT in world coords)
 
+	/*
+		A packed copy of the position and radius of everything in this cell, so range queries can
+		throw out the far away stuff without chasing COI -> PartitionData -> Object for each one.
+		Entry i is the (m_coiCount-1-i)'th COI in the list, so walking the arrays backwards visits
+		things in exactly the same order as walking the list forwards.
+	*/
+	Int														m_packedCapacity;		///< room in the packed arrays
+	Real*													m_packedPos;				///< x's, then y's, then radii, each m_packedCapacity long
+	CellAndObjectIntersection**		m_packedCoi;				///< the COI for each packed entry
+
+	UnsignedInt										m_cachedCRC;				///< see getCellCRC
+	Bool													m_crcDirty;					///< m_cachedCRC needs doing again
+
 public:
 
 	// Note, we allocate these in arrays, thus we must have a default ctor (and NOT descend from MPO)
 	PartitionCell();
 #ifdef PM_CACHE_TERRAIN_HEIGHT
-	void init(Int x, Int y, Real loZ, Real hiZ) { m_cellX = x; m_cellY = y; m_loTerrainZ = loZ; m_hiTerrainZ = hiZ; }
+	void init(Int x, Int y, Real loZ, Real hiZ) { m_cellX = x; m_cellY = y; m_loTerrainZ = loZ; m_hiTerrainZ = hiZ; m_crcDirty = TRUE; }
 #else
-	void init(Int x, Int y) { m_cellX = x; m_cellY = y; }
+	void init(Int x, Int y) { m_cellX = x; m_cellY = y; m_crcDirty = TRUE; }
 #endif
 	~PartitionCell();
 
@@ -321,6 +344,10 @@ public:
 	void xfer( Xfer *xfer );
 	void loadPostProcess( void );
 
+	/// what crc() would add up for this cell; with useCache it is only redone after the shroud changes
+	UnsignedInt getCellCRC( Bool useCache );
+	Bool isCellCRCCached() const { return !m_crcDirty; }
+
 	Int getCoiCount() const { return m_coiCount; }		///< return number of COIs touching this cell.
 	Int getCellX() const { return m_cellX; }
 	Int getCellY() const { return m_cellY; }
@@ -351,6 +378,12 @@ public:
 
 	inline CellAndObjectIntersection *getFirstCoiInCell() { return m_firstCoiInCell; }
 
+	/// the packed arrays (see m_packedPos). all are getCoiCount() long.
+	inline const Real *getPackedX() const { return m_packedPos; }
+	inline const Real *getPackedY() const { return m_packedPos + m_packedCapacity; }
+	inline const Real *getPackedRadius() const { return m_packedPos + 2*m_packedCapacity; }
+	inline CellAndObjectIntersection *getPackedCoi(Int i) const { return m_packedCoi[i]; }
+
 	#ifdef _DEBUG
 	void validateCoiList();
 	#endif
@@ -360,6 +393,14 @@ public:
 
 	// intended only for CellAndObjectIntersection.
 	void friend_removeFromCellList(CellAndObjectIntersection *coi);
+
+	// intended only for PartitionData.
+	inline void friend_setPackedPos(Int i, Real x, Real y, Real radius)
+	{
+		m_packedPos[i] = x;
+		m_packedPos[i + m_packedCapacity] = y;
+		m_packedPos[i + 2*m_packedCapacity] = radius;
+	}
 };
 
 //=====================================
@@ -391,6 +432,9 @@ private:
 	Int													m_coiArrayCount;					///< number of COIs allocated (may be more than are in use)
 	Int													m_coiInUseCount;					///< number of COIs that are actually in use
 	CellAndObjectIntersection		*m_coiArray;							///< The array of COIs 
+	PartitionCell								**m_pendingCells;					///< cells found by calcCellsTouched, not yet moved into the COIs (m_coiArrayCount of 'em)
+	Int													m_pendingCellCount;				///< number of entries in m_pendingCells
+	const PartitionCell					*m_pendingCenterCell;			///< the cell calcCellsTouched found my center in
 	Int													m_doneFlag;
 	DirtyStatus									m_dirtyStatus;
 	ObjectShroudStatus					m_shroudedness[MAX_PLAYER_COUNT];						
@@ -429,10 +473,23 @@ private:
 	/**
 		this discards all current 'touch' information (via removeAllTouchedCells) and recalculates
 		the cells touched by this module, based on the object's geometry. this will be called frequently and so
-		needs to be as efficient as possible.
+		needs to be as efficient as possible. (this is simply calcCellsTouched followed by applyCellsTouched.)
 	*/
 	void updateCellsTouched();
 
+	/**
+		work out the cells touched by this module into m_pendingCells, without changing any cell or COI.
+		this only reads the object and the partition manager, so it is safe to run for many modules
+		at once on the worker threads.
+	*/
+	void calcCellsTouched();
+
+	/**
+		discard all current 'touch' information and replace it with the cells found by the last
+		calcCellsTouched. this links the COIs into the cells, so must be run serially.
+	*/
+	void applyCellsTouched();
+
 	/**
 		If you imagine the array of Partition Cells as pixels, then this method
 		'sets' the pixel [cell] at cell coordinate (x, y).
@@ -527,6 +584,13 @@ public:
 
 	Int getControllingPlayerIndex() const;
 
+	/**
+		copy our current position into the packed arrays of the cells we touch. this has to be
+		called whenever the object's position or size changes, even by tiny amounts that
+		don't make us dirty, since the range queries rely on it being exact.
+	*/
+	void updatePackedPosition();
+
 	/**
 		enumerate the objects that share space with 'this' 
 		(ie, the objects in the same Partition Cells) and
@@ -536,6 +600,13 @@ public:
 	*/
 	void addPossibleCollisions(PartitionContactList *ctList);
 
+	/**
+		same as addPossibleCollisions, but just appends the pairs to the given array rather than
+		adding 'em to a contact list. this only reads the cells, so it may be called from the
+		worker threads as long as nobody is changing the cells at the time.
+	*/
+	void gatherPossibleCollisions(std::vector<PartitionContactPair> &pairs) const;
+
 	Object *getObject() { return m_object; }				///< return the Object that owns this module
 	const Object *getObject() const { return m_object; }				///< return the Object that owns this module
 	void friend_setObject(Object *object) { m_object = object;}	///< to be used only by the partition manager.
@@ -546,6 +617,8 @@ public:
 	
 	void friend_removeAllTouchedCells() { removeAllTouchedCells(); }	///< this is only for use by PartitionManager
 	void friend_updateCellsTouched()	{ updateCellsTouched(); } ///< this is only for use by PartitionManager
+	void friend_calcCellsTouched()	{ calcCellsTouched(); } ///< this is only for use by PartitionManager
+	void friend_applyCellsTouched()	{ applyCellsTouched(); } ///< this is only for use by PartitionManager
 	Int friend_getCoiInUseCount() { return m_coiInUseCount; } ///< this is only for use by PartitionManager
 	Bool friend_collidesWith(const PartitionData *that, CollideLocAndNormal *cinfo) const { return collidesWith(that, cinfo); }	///< this is only for use by PartitionContactList
 
@@ -1212,6 +1285,7 @@ private:
 	Int							m_cellCountY;			///< number of cells, y
 	Int							m_totalCellCount;	///< x * y
 	PartitionCell*	m_cells;					///< array of cells
+	std::vector<UnsignedInt> m_cellCRCs;	///< scratch for xferCellCRCs
 	PartitionData*	m_dirtyModules;
 	Bool						m_updatedSinceLastReset;	///< Used to force a return of OBJECTSHROUD_INVALID before update has been called.
 
@@ -1271,6 +1345,18 @@ protected:
 	friend void hLineAddValue(Int x1, Int x2, Int y, void *threatValueParms);
 	friend void hLineRemoveValue(Int x1, Int x2, Int y, void *threatValueParms);
 
+	/**
+		empty the dirty module list: recalc the cells of everything that moved, and add the
+		pairs that now share a cell to the contact list. the per-module work is spread across
+		the worker threads, but the result doesn't depend on how many there are.
+	*/
+	void updateDirtyModules(PartitionContactList *ctList);
+
+#ifdef TEST_PARTITION_SPEED
+	Bool						m_ranPartitionSpeedTest;
+	void doPartitionSpeedTest();
+#endif
+
 	void processPendingUndoShroudRevealQueue(Bool considerTimestamp = TRUE);				///< keep popping and processing untill you get to one that is in the future
 	void resetPendingUndoShroudRevealQueue();					///< Just delete everything in the queue without doing anything with them
 
@@ -1290,6 +1376,13 @@ public:
 	void xfer( Xfer *xfer );
 	void loadPostProcess( void );
 
+	/** Same idea as crc(), but adds up one CRC per cell, which is much cheaper than crc() when
+		little of the shroud has changed since last time.  It does not give the same answer as crc(). */
+	void xferCellCRCs( Xfer *xfer, Bool useCache );
+#ifdef DEBUG_CRC
+	void verifyCellCRCs( void );		///< crash if any cell's cached CRC is out of date
+#endif
+
 	inline Bool getUpdatedSinceLastReset( void ) const { return m_updatedSinceLastReset; }
 
 	void registerObject( Object *object );				///< add thing to system
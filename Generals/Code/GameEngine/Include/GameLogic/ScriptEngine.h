@@ -53,6 +53,19 @@ class ObjectTypes;
 #define SPECIAL_SCRIPT_PROFILING
 #endif
 
+/*
+	Times getUnitNamed through the name key index against the old linear scan of the
+	named object list, the first time the script engine updates a map with named units.
+	Also checks findScript and findGroup against a linear scan of the script lists.
+*/
+//#define TEST_NAMED_OBJECT_INDEX
+
+/*
+	Re-evaluates every indexed script whose cached condition result is still current, and
+	crashes if the answer has changed.  Slow.
+*/
+//#define TEST_CONDITION_INDEX
+
 // Slightly odd place to put breeze info, but the breeze info is
 // set by script, so it's as good a place as any.  john a.
 struct BreezeInfo 
@@ -121,6 +134,10 @@ typedef AllObjectTypes::iterator AllObjectTypesIt;
 typedef std::vector<NamedReveal> VecNamedReveal;
 typedef VecNamedReveal::iterator VecNamedRevealIt;
 
+typedef std::unordered_map< NameKeyType, Int, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > NamedObjectIndexMap;
+typedef std::unordered_map< NameKeyType, Script *, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > ScriptNameIndexMap;
+typedef std::unordered_map< NameKeyType, ScriptGroup *, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > ScriptGroupNameIndexMap;
+
 class AttackPriorityInfo : public MemoryPoolObject, public Snapshot
 {
 	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(AttackPriorityInfo, "AttackPriorityInfo")		
@@ -280,10 +297,13 @@ public:
 
 	virtual Object *getUnitNamed(const AsciiString& unitName); ///< Gets the named unit. May be null.
 	virtual Bool didUnitExist(const AsciiString& unitName);
+	Object *getUnitNamed(const Parameter *pUnitParm);	///< Same as above, using the parameter's interned name key.
+	Bool didUnitExist(const Parameter *pUnitParm);
 	virtual void addObjectToCache( Object* pNewObject );
 	virtual void removeObjectFromCache( Object* pDeadObject );
 	virtual void transferObjectName( const AsciiString& unitName, Object *pNewObject );
 	virtual void notifyOfObjectDestruction( Object *pDeadObject );
+	void notifyOfObjectLivenessChange( Object *pObj );	///< A named object became, or stopped being, effectively dead
 	virtual void notifyOfCompletedVideo( const AsciiString& completedVideo );	///< Notify the script engine that a video has completed
 	virtual void notifyOfTriggeredSpecialPower( Int playerIndex, const AsciiString& completedPower, ObjectID sourceObj );
 	virtual void notifyOfMidwaySpecialPower		( Int playerIndex, const AsciiString& completedPower, ObjectID sourceObj );
@@ -368,7 +388,10 @@ protected:
 	void executeScripts( Script *pScriptHead );
 	void executeScript( Script *pScript );
 	Script *findScript(const AsciiString& name);
+	Script *findScript(NameKeyType key);
 	ScriptGroup *findGroup(const AsciiString& name);
+	ScriptGroup *findGroup(NameKeyType key);
+	void rebuildScriptNameIndex( void );
 	void setSway( ScriptAction *pAction );
 	void setCounter( ScriptAction *pAction );
 	void addCounter( ScriptAction *pAction );
@@ -401,6 +424,26 @@ protected:
 
 	AttackPriorityInfo *findAttackInfo(const AsciiString& name, Bool addIfNotFound);
 
+	// For the named object index.
+	Int findNamedObject(NameKeyType key) const;
+	void pushNamedObject(const AsciiString& name, Object *pObj);
+	void renameNamedObject(Int ndx, const AsciiString& name);
+	void rebuildNamedObjectIndex( void );
+
+	// For the condition index.
+	Bool evaluateIndexedConditions( Script *pScript );
+	Int indexScriptConditions( Script *pScript );
+	void resetConditionIndex( void );
+	void invalidateAllIndexedConditions( void );
+	void invalidateIndexedConditions( std::vector<Int>& watchers );
+	void counterChanged( Int counterNdx );
+	void flagChanged( Int flagNdx );
+	void flagNameChanged( const AsciiString& flagName );
+	void namedObjectChanged( const AsciiString& unitName );
+#ifdef TEST_NAMED_OBJECT_INDEX
+	void doNamedObjectIndexTest( void );
+#endif
+
 protected:
 	/// Stuff to execute scripts sequentially
 	typedef std::vector<SequentialScript*> VecSequentialScriptPtr;
@@ -433,6 +476,31 @@ protected:
 	Team							*m_conditionTeam;				///< Team that is being used to evaluate conditions, used for THIS_TEAM
 	Object						*m_conditionObject;				///< Unit that is being used to evaluate conditions, used for THIS_OBJECT
 	VecNamedRequests	m_namedObjects;
+	NamedObjectIndexMap m_namedObjectIndex;	///< name key -> index of the first m_namedObjects entry with that name
+	ScriptNameIndexMap m_scriptNameIndex;		///< name key -> first script with that name, in side order
+	ScriptGroupNameIndexMap m_groupNameIndex;	///< name key -> first script group with that name, in side order
+	UnsignedInt				m_scriptNameIndexSerial;	///< ScriptList::getChangeSerial() when the two were built
+	Bool							m_scriptNameIndexBuilt;
+#ifdef TEST_NAMED_OBJECT_INDEX
+	Bool							m_ranNamedObjectIndexTest;
+#endif
+
+	// The condition index.  Scripts whose conditions only look at counters, flags, timers and named
+	// units remember their last result, and are only evaluated again once one of those changes.
+	struct IndexedConditions
+	{
+		Bool	m_valid;		///< m_result still holds
+		Bool	m_result;		///< what evaluateConditions returned last time
+	};
+	typedef std::vector<Int> ConditionWatchers;	///< slots in m_indexedConditions
+	typedef std::unordered_map< NameKeyType, ConditionWatchers, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > NamedUnitWatcherMap;
+
+	std::vector<IndexedConditions> m_indexedConditions;
+	ConditionWatchers	m_counterWatchers[MAX_COUNTERS];	///< scripts that compare a counter's value
+	ConditionWatchers	m_timerWatchers[MAX_COUNTERS];		///< scripts that wait for a timer to run out
+	ConditionWatchers	m_flagWatchers[MAX_FLAGS];
+	NamedUnitWatcherMap m_namedUnitWatchers;
+	UnsignedInt				m_conditionIndexEpoch;			///< bumped whenever the scripts or all their inputs are replaced
 	Bool							m_firstUpdate;			
 	Player						*m_currentPlayer;
 	Player						*m_skirmishHumanPlayer;
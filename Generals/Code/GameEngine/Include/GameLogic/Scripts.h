@@ -137,11 +137,11 @@ public:
 	ScriptGroup *duplicateAndQualify(const AsciiString& qualifier, 
 			const AsciiString& playerTemplateName, const AsciiString& newPlayerName) const;		// note, duplicates just this node, not the full list.
 
-	void setName(AsciiString name) { m_groupName = name;}
+	void setName(AsciiString name);
 	void setActive(Bool active) { m_isGroupActive = active;}
 	void setSubroutine(Bool subr) { m_isGroupSubroutine = subr;}
 	void setWarnings(Bool warnings) { m_hasWarnings = warnings;}
-	void setNextGroup(ScriptGroup *pGr) {m_nextGroup = pGr;}
+	void setNextGroup(ScriptGroup *pGr);
 
 	AsciiString getName(void) const { return m_groupName;}
 	Bool isActive(void) const { return m_isGroupActive;}
@@ -625,6 +625,8 @@ protected:	// Note - If you add any member vars, you must take them into account
 	Real				m_conditionTime;		///< Amount of time (cum) to evaluate conditions.
 	Real				m_curTime;		///< Amount of time (cum) to evaluate conditions.
 	Int					m_conditionExecutedCount; ///< Number of times conditions evaluated.
+	Int					m_conditionIndexSlot;	///< Slot in the ScriptEngine condition index, -1 if the conditions can't be indexed.
+	UnsignedInt	m_conditionIndexEpoch;	///< ScriptEngine condition index epoch the slot belongs to, 0 if not looked at yet.
 
 public:
 	Script();
@@ -634,7 +636,7 @@ public:
 			const AsciiString& playerTemplateName, const AsciiString& newPlayerName) const;		
 
 public:
-	void setName(AsciiString name) { m_scriptName = name;}
+	void setName(AsciiString name);
 	void setWarnings(Bool warnings) { m_hasWarnings = warnings;}
 	void setComment(AsciiString comment) { m_comment = comment;}
 	void setActionComment(AsciiString comment) { m_actionComment = comment;}
@@ -645,8 +647,8 @@ public:
 	void setNormal(Bool normal) { m_normal = normal;}
 	void setHard(Bool hard) { m_hard = hard;}
 	void setSubroutine(Bool subr) { m_isSubroutine = subr;}
-	void setNextScript(Script *pScr) {m_nextScript = pScr;}
-	void setOrCondition(OrCondition *pCond) {m_condition = pCond;}
+	void setNextScript(Script *pScr);
+	void setOrCondition(OrCondition *pCond) {m_condition = pCond; m_conditionIndexEpoch = 0;}
 	void setAction(ScriptAction *pAction) {m_action = pAction;}
 	void setFalseAction(ScriptAction *pAction) {m_actionFalse = pAction;}
 	void updateFrom(Script *pSrc); ///< Updates this from pSrc.  pSrc IS MODIFIED - it's guts are removed.  jba.
@@ -655,12 +657,15 @@ public:
 	void addToConditionTime(Real time) {m_conditionTime += time;}
 	void setCurTime(Real time) {m_curTime	= time;}
 	void setDelayEvalSeconds(Int delay) {m_delayEvaluationSeconds = delay;}
+	void setConditionIndexSlot(Int slot, UnsignedInt epoch) {m_conditionIndexSlot = slot; m_conditionIndexEpoch = epoch;}
 
 	UnsignedInt getFrameToEvaluate(void) {return m_frameToEvaluateAt;}
 	Int getConditionCount(void) {return m_conditionExecutedCount;}
 	Real getConditionTime(void) {return m_conditionTime;}
 	Real getCurTime(void) {return m_curTime;}
 	Int getDelayEvalSeconds(void) {return m_delayEvaluationSeconds;}
+	Int getConditionIndexSlot(void) const {return m_conditionIndexSlot;}
+	UnsignedInt getConditionIndexEpoch(void) const {return m_conditionIndexEpoch;}
 
 	AsciiString getName(void) const { return m_scriptName;}
 	AsciiString getComment(void) const {return m_comment;}
@@ -786,7 +791,8 @@ public:
 		m_paramType(type),
 		m_initialized(false),
 		m_int(val),
-		m_real(0)
+		m_real(0),
+		m_stringKey(NAMEKEY_INVALID)
 	{
 		m_coord.x=0;m_coord.y=0;m_coord.z=0;
 	}
@@ -798,12 +804,13 @@ private:
 	Real					m_real;
 	AsciiString		m_string;
 	Coord3D				m_coord;
+	mutable NameKeyType	m_stringKey;		///< interned key for m_string, NAMEKEY_INVALID until asked for
 
 protected:
 	void setInt(Int i) {m_int = i;}
 	void setReal(Real r) {m_real = r;}
 	void setCoord3D(const Coord3D *pLoc);
-	void setString(AsciiString s) {m_string = s;}
+	void setString(AsciiString s) {m_string = s; m_stringKey = NAMEKEY_INVALID;}
 
 public:
 	Int getInt(void) const {return m_int;}
@@ -814,11 +821,14 @@ public:
 	void friend_setInt(Int i) {m_int = i;}
 	void friend_setReal(Real r) {m_real = r;}
 	void friend_setCoord3D(const Coord3D *pLoc) { setCoord3D(pLoc); }
-	void friend_setString(AsciiString s) {m_string = s;}
+	void friend_setString(AsciiString s) {m_string = s; m_stringKey = NAMEKEY_INVALID;}
 
 	void qualify(const AsciiString& qualifier,const AsciiString& playerTemplateName,const AsciiString& newPlayerName);
 
 	const AsciiString& getString(void) const {return m_string;}
+	/** The NameKeyGenerator key for getString().  Identifier parameters are interned when they
+		are read, so named lookups can hash on the key instead of comparing strings. */
+	NameKeyType getStringKey(void) const;
 	AsciiString getUiText(void) const;
 
 	void WriteParameter(DataChunkOutput &chunkWriter);
@@ -1065,6 +1075,7 @@ protected:
 	ScriptGroup		*m_firstGroup;
 	Script				*m_firstScript;
 	static Int		m_curId;
+	static UnsignedInt s_changeSerial;
 
 	static ScriptList *s_readLists[MAX_PLAYER_COUNT];
 	static Int				s_numInReadList;
@@ -1077,6 +1088,10 @@ public:
 	static void updateDefaults(void);
 	static void reset(void); 
 	static Int getNextID(void) {m_curId++; return m_curId;};
+	/// Changes whenever a script or group is linked, unlinked, renamed or deleted, so anything that
+	/// keeps pointers into the script lists knows to look again.
+	static UnsignedInt getChangeSerial(void) {return s_changeSerial;}
+	static void noteChanged(void) {s_changeSerial++;}
 	
 public:
 	ScriptGroup *getScriptGroup(void) {return m_firstGroup;};
@@ -1104,5 +1119,10 @@ public:
 	static Int getReadScripts(ScriptList *scriptLists[MAX_PLAYER_COUNT]);
 };
 
+inline void ScriptGroup::setName(AsciiString name) { m_groupName = name; ScriptList::noteChanged();}
+inline void ScriptGroup::setNextGroup(ScriptGroup *pGr) {m_nextGroup = pGr; ScriptList::noteChanged();}
+inline void Script::setName(AsciiString name) { m_scriptName = name; ScriptList::noteChanged();}
+inline void Script::setNextScript(Script *pScr) {m_nextScript = pScr; ScriptList::noteChanged();}
+
 #endif
 
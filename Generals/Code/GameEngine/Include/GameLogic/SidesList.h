@@ -72,7 +72,7 @@ public:
 	BuildListInfo* getBuildList(void) {return m_pBuildList;} ///< Gets the build list.
 	void releaseBuildList(void)  {m_pBuildList=NULL;} ///< Used when the build list is passed to class Player.
 	ScriptList *getScriptList(void) {return(m_scripts);};
-	void setScriptList(ScriptList *pScriptList) {m_scripts = pScriptList;};
+	void setScriptList(ScriptList *pScriptList);
 
 	// ug, I hate having to overload stuff, but this makes it a lot easier to make copies safely
 	SidesInfo& operator=(const SidesInfo& that);	
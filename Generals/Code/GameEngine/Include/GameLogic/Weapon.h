@@ -617,8 +617,8 @@ public:
 	Real getPercentReadyToFire() const;
 
 	// do not ever use this unless you are weaponset.cpp
-	void setPossibleNextShotFrame( UnsignedInt frameNum ) { m_whenWeCanFireAgain = frameNum; }
-	void setPreAttackFinishedFrame( UnsignedInt frameNum ) { m_whenPreAttackFinished = frameNum; }
+	void setPossibleNextShotFrame( UnsignedInt frameNum ) { m_whenWeCanFireAgain = frameNum; touchCRCStamp(); }
+	void setPreAttackFinishedFrame( UnsignedInt frameNum ) { m_whenPreAttackFinished = frameNum; touchCRCStamp(); }
 
 	// we must pass the source object for these (and for ANY FUTURE ADDITIONS)
 	// so that we can take the source's weapon bonuses, if any, into account.
@@ -676,10 +676,10 @@ public:
 	//weapon template has the LeechRangeWeapon set, it means that once the unit has closed to standard weapon range
 	//it fires the weapon, and will be able to hit the target even if it moves out of range! The unit will simply
 	//stand there. This functionality is used by hack attacks.
-	void setLeechRangeActive( Bool active ) { m_leechWeaponRangeActive = active; }
+	void setLeechRangeActive( Bool active ) { m_leechWeaponRangeActive = active; touchCRCStamp(); }
 	Bool hasLeechRange() const { return m_leechWeaponRangeActive; }
 
-	void setMaxShotCount(Int maxShots) { m_maxShotCount = maxShots; }
+	void setMaxShotCount(Int maxShots) { m_maxShotCount = maxShots; touchCRCStamp(); }
 	Int getMaxShotCount() const { return m_maxShotCount; }
 
 	Bool isClearFiringLineOfSightTerrain(const Object* source, const Object* victim) const;
@@ -711,6 +711,10 @@ public:
 	void setClipPercentFull(Real percent, Bool allowReduction);
 	UnsignedInt getSuspendFXFrame( void ) const { return m_suspendFXFrame; }
 
+	/** Changes whenever anything crc() looks at might have changed.  No two weapons ever share a
+		stamp, so the owning Object can tell from the stamp alone whether its cached CRC is stale. */
+	UnsignedInt getCRCStamp() const { return m_crcStamp; }
+
 protected:
 
 	Weapon(const WeaponTemplate* tmpl, WeaponSlotType wslot);
@@ -736,7 +740,6 @@ protected:
 
 	void rebuildScatterTargets();
 
-
 private:
 	const WeaponTemplate*			m_template;									///< the kind of weapon this is
 	WeaponSlotType						m_wslot;										///< are we primary, secondary, etc. weapon? (used for projectile placement on reload)
@@ -754,9 +757,14 @@ private:
 	std::vector<Int>					m_scatterTargetsUnused;			///< A running memory of which targets I've used, so I can shoot them all at random
 	Bool											m_pitchLimited;
 	Bool											m_leechWeaponRangeActive;		///< This weapon has unlimited range until attack state is aborted!
+	UnsignedInt								m_crcStamp;
+
+	static UnsignedInt				s_lastCRCStamp;
 
 	// setter function for status that should not be used outside this class
 	void setStatus( WeaponStatus status) { m_status = status; }
+
+	void touchCRCStamp() { m_crcStamp = ++s_lastCRCStamp; }
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -45,6 +45,8 @@ Bool g_crcModuleDataFromClient = FALSE;
 Bool g_verifyClientCRC = FALSE; // verify that GameLogic CRC doesn't change from client
 Bool g_clientDeepCRC = FALSE;
 Bool g_logObjectCRCs = FALSE;
+Bool g_verifySelfContainedUpdates = FALSE; // check that self contained updates really don't touch anything else
+Bool g_verifyIncrementalCRC = FALSE; // check that cached object/cell CRCs match a fresh one every time
 #endif
 
 #if defined(_DEBUG) || defined(_INTERNAL)
@@ -282,6 +284,26 @@ Int parseLogObjectCRCs(char *args[], int argc)
 	return 1;
 }
 
+//=============================================================================
+//=============================================================================
+Int parseVerifySelfContainedUpdates(char *args[], int argc)
+{
+#ifdef DEBUG_CRC
+	g_verifySelfContainedUpdates = TRUE;
+#endif
+	return 1;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseVerifyIncrementalCRC(char *args[], int argc)
+{
+#ifdef DEBUG_CRC
+	g_verifyIncrementalCRC = TRUE;
+#endif
+	return 1;
+}
+
 //=============================================================================
 //=============================================================================
 Int parseNetCRCInterval(char *args[], int argc)
@@ -1000,6 +1022,24 @@ Int parseJumpToFrame(char *args[], int num)
 	return 1;
 }
 
+Int parsePrefetchLoadFiles(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_prefetchLoadFiles = TRUE;
+	}
+	return 1;
+}
+
+Int parseRecordPoolProfile(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_recordPoolProfile = TRUE;
+	}
+	return 1;
+}
+
 Int parseUpdateImages(char *args[], int num)
 {
 	if (TheWritableGlobalData)
@@ -1104,6 +1144,8 @@ static CommandLineParam params[] =
 	{ "-scriptDebug", parseScriptDebug },
 	{ "-playStats", parsePlayStats },
 	{ "-mod", parseMod },
+	{ "-prefetchLoadFiles", parsePrefetchLoadFiles },
+	{ "-recordPoolProfile", parseRecordPoolProfile },
 #if !defined(_PLAYTEST) || (defined(_DEBUG) || defined(_INTERNAL))
 	{ "-noaudio", parseNoAudio },
 	{ "-map", parseMapName },
@@ -1125,6 +1167,8 @@ static CommandLineParam params[] =
 	{ "-ClientDeepCRC", parseClientDeepCRC },
 	{ "-VerifyClientCRC", parseVerifyClientCRC },
 	{ "-LogObjectCRCs", parseLogObjectCRCs },
+	{ "-VerifySelfContainedUpdates", parseVerifySelfContainedUpdates },
+	{ "-VerifyIncrementalCRC", parseVerifyIncrementalCRC },
 	{ "-saveAllStats", parseSaveAllStats },
 	{ "-NetCRCInterval", parseNetCRCInterval },
 	{ "-ReplayCRCInterval", parseReplayCRCInterval },
@@ -65,6 +65,7 @@
 #include "Common/TerrainTypes.h"
 #include "Common/Upgrade.h"
 #include "Common/UserPreferences.h"
+#include "Common/WorkerThreadPool.h"
 #include "Common/Xfer.h"
 #include "Common/XferCRC.h"
 #include "Common/GameLOD.h"
@@ -212,10 +213,17 @@ GameEngine::~GameEngine()
 
 	TheGameResultsQueue->endThreads();
 
+	// the pools' high-water marks cover the whole session, so this is the place to record them
+	if (TheGlobalData->m_recordPoolProfile)
+		writeMemoryPoolProfile();
+
 	TheSubsystemList->shutdownAll();
 	delete TheSubsystemList;
 	TheSubsystemList = NULL;
 
+	delete TheWorkerThreadPool;
+	TheWorkerThreadPool = NULL;
+
 	delete TheNetwork;
 	TheNetwork = NULL;
 
@@ -253,6 +261,10 @@ void GameEngine::init( void ) {} /// @todo: I changed this to take argc & argv s
 void GameEngine::init( int argc, char *argv[] )
 {
 	try {
+#ifdef TEST_INI_LOAD
+		UnsignedInt initStart = ::GetTickCount();
+#endif
+
 		//create an INI object to use for loading stuff
 		INI ini;
 
@@ -291,6 +303,9 @@ void GameEngine::init( int argc, char *argv[] )
 		TheNameKeyGenerator = MSGNEW("GameEngineSubsystem") NameKeyGenerator;
 		TheNameKeyGenerator->init();
 
+		// not part of the subsystem list, because it should normally never be reset!
+		TheWorkerThreadPool = MSGNEW("GameEngineSubsystem") WorkerThreadPool(WorkerThreadPool::getDefaultWorkerCount());
+
 		// not part of the subsystem list, because it should normally never be reset!
 		TheCommandList = MSGNEW("GameEngineSubsystem") CommandList;
 		TheCommandList->init();
@@ -393,6 +408,10 @@ void GameEngine::init( int argc, char *argv[] )
 		TheWritableGlobalData->m_iniCRC = xferCRC.getCRC();
 		DEBUG_LOG(("INI CRC is 0x%8.8X\n", TheGlobalData->m_iniCRC));
 
+#ifdef TEST_INI_LOAD
+		INI::doLoadTest(::GetTickCount() - initStart);
+#endif
+
 		TheSubsystemList->postProcessLoadAll();
 
 		setFramesPerSecondLimit(TheGlobalData->m_framesPerSecondLimit);
@@ -661,6 +680,10 @@ void GameEngine::execute( void )
 				}
 				catch (INIException e)
 				{
+					// the replay is written in the background, so get it all out before we go
+					if (TheRecorder)
+						TheRecorder->flushRecording();
+
 					// Release CRASH doesn't return, so don't worry about executing additional code.
 					if (e.mFailureMessage)
 						RELEASE_CRASH((e.mFailureMessage));
@@ -672,6 +695,8 @@ void GameEngine::execute( void )
 					// try to save info off
 					try 
 					{
+						if (TheRecorder)
+							TheRecorder->flushRecording();
 						if (TheRecorder && TheRecorder->getMode() == RECORDERMODETYPE_RECORD && TheRecorder->isMultiplayer())
 							TheRecorder->cleanUpReplayFile();
 					}
@@ -1022,6 +1022,8 @@ GlobalData::GlobalData()
 	m_movementPenaltyDamageState = BODY_REALLYDAMAGED;
 	
 	m_shouldUpdateTGAToDDS = FALSE;
+	m_prefetchLoadFiles = FALSE;
+	m_recordPoolProfile = FALSE;
 	
 	// Default DoubleClickTime to System double click time.
 	m_doubleClickTimeMS = GetDoubleClickTime(); // Note: This is actual MS, not frames.
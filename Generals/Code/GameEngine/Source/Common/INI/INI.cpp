@@ -70,6 +70,11 @@
 
 static Xfer *s_xfer = NULL;
 
+#ifdef TEST_INI_LOAD
+static Int s_loadTestFiles = 0;				///< INI files loaded so far
+static Int s_loadTestBytes = 0;				///< size of all of them
+#endif
+
 //-------------------------------------------------------------------------------------------------
 /** This is the table of data types we can have in INI files.  To add a new data type
 	* block make a new entry in this table and add an appropriate parsing function */
@@ -178,7 +183,13 @@ Bool INI::isValidINIFilename( const char *filename )
 INI::INI( void )
 {
 
-	m_file							= NULL;
+	m_fileData					= NULL;
+	m_fileEnd						= NULL;
+	m_readPos						= NULL;
+	m_readPosChar				= 0;
+	m_line							= NULL;
+	m_lineLength				= 0;
+	m_tokenPos					= NULL;
 	m_filename					= "None";
 	m_loadType					= INI_LOAD_INVALID;
 	m_lineNum						= 0;
@@ -188,7 +199,6 @@ INI::INI( void )
 	m_sepsQuote					= "\"\n=";				///< stop at " = EOL
 	m_blockEndToken			= "END";
 	m_endOfFile					= FALSE;
-	m_buffer[0]					= 0;
 #if defined(_DEBUG) || defined(_INTERNAL)
 	m_curBlockStart[0]	= 0;
 #endif
@@ -213,6 +223,11 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 	if( dirName.isEmpty() )
 		throw INI_INVALID_DIRECTORY;
 
+#ifdef DEBUG_LOGGING
+	UnsignedInt startTime = ::GetTickCount();
+	Int numFiles = 0;
+#endif
+
 	try
 	{
 		FilenameList filenameList;
@@ -229,6 +244,9 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 			if ((tempname.find('\\') == NULL) && (tempname.find('/') == NULL)) {
 				// this file doesn't reside in a subdirectory, load it first.
 				load( *it, loadType, pXfer );
+#ifdef DEBUG_LOGGING
+				++numFiles;
+#endif
 			}
 			++it;
 		}
@@ -241,6 +259,9 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 
 			if ((tempname.find('\\') != NULL) || (tempname.find('/') != NULL)) {
 				load( *it, loadType, pXfer );
+#ifdef DEBUG_LOGGING
+				++numFiles;
+#endif
 			}
 			++it;
 		}
@@ -251,6 +272,11 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 		throw;
 	}
 
+#ifdef DEBUG_LOGGING
+	DEBUG_LOG(( "INI::loadDirectory - %s: %d files in %d ms\n",
+		dirName.str(), numFiles, ::GetTickCount() - startTime ));
+#endif
+
 }  // end loadDirectory
 
 //-------------------------------------------------------------------------------------------------
@@ -258,7 +284,7 @@ void INI::loadDirectory( AsciiString dirName, Bool subdirs, INILoadType loadType
 void INI::prepFile( AsciiString filename, INILoadType loadType )
 {
 	// if we have a file open already -- we can't do another one
-	if( m_file != NULL )
+	if( m_fileData != NULL )
 	{
 
 		DEBUG_CRASH(( "INI::load, cannot open file '%s', file already open\n", filename.str() ));
@@ -267,8 +293,8 @@ void INI::prepFile( AsciiString filename, INILoadType loadType )
 	}  // end if
 
 	// open the file
-	m_file = TheFileSystem->openFile(filename.str(), File::READ);
-	if( m_file == NULL )
+	File *file = TheFileSystem->openFile(filename.str(), File::READ);
+	if( file == NULL )
 	{
 
 		DEBUG_CRASH(( "INI::load, cannot open file '%s'\n", filename.str() ));
@@ -276,7 +302,30 @@ void INI::prepFile( AsciiString filename, INILoadType loadType )
 
 	}  // end if
 
-	m_file = m_file->convertToRAMFile();
+	//
+	// pull the whole thing into memory in one read, readLine() and the tokenizer work on it
+	// in place from there.  The spare byte on the end is so the last line always has
+	// somewhere to put its terminator
+	//
+	Int size = file->size();
+	m_fileData = NEW char[ size + 1 ];
+	size = file->read( m_fileData, size );
+	file->close();
+	if( size < 0 )
+		size = 0;
+
+	m_fileEnd = m_fileData + size;
+	*m_fileEnd = '\0';
+
+#ifdef TEST_INI_LOAD
+	++s_loadTestFiles;
+	s_loadTestBytes += size;
+#endif
+	m_readPos = m_fileData;
+	m_readPosChar = *m_readPos;
+	m_line = m_fileEnd;
+	m_lineLength = 0;
+	m_tokenPos = m_line;
 
 	// save our filename
 	m_filename = filename;
@@ -289,9 +338,14 @@ void INI::prepFile( AsciiString filename, INILoadType loadType )
 //-------------------------------------------------------------------------------------------------
 void INI::unPrepFile()
 {
-	// close the file
-	m_file->close();
-	m_file = NULL;
+	// throw away the file
+	delete [] m_fileData;
+	m_fileData = NULL;
+	m_fileEnd = NULL;
+	m_readPos = NULL;
+	m_line = NULL;
+	m_lineLength = 0;
+	m_tokenPos = NULL;
 	m_filename = "None";
 	m_loadType = INI_LOAD_INVALID;
 	m_lineNum = 0;
@@ -356,25 +410,35 @@ void INI::load( AsciiString filename, INILoadType loadType, Xfer *pXfer )
 			// read this line
 			readLine();
 
-			AsciiString currentLine = m_buffer;
+			// hang on to where the line is, tokenizing it puts terminators in it
+			const char *currentLine = m_line;
+			Int currentLineLength = m_lineLength;
 
 			// the first word is the type of data we're processing
-			const char *token = strtok( m_buffer, m_seps );
+			const char *token = getNextTokenOrNull();
 			if( token )
 			{
 				INIBlockParse parse = findBlockParse(token);
 				if (parse)
 				{
 					#if defined(_DEBUG) || defined(_INTERNAL)
-					strcpy(m_curBlockStart, m_buffer);
+					strcpy(m_curBlockStart, token);
 					#endif
 					try {
 						(*parse)( this );
 
 					} catch (...) {
 						DEBUG_CRASH(("Error parsing block '%s' in INI file '%s'\n", token, m_filename.str()) );
+
+						// put the line back the way it was before it got tokenized
+						char lineBuff[ INI_MAX_CHARS_PER_LINE ];
+						Int i;
+						for( i = 0; i < currentLineLength && i < INI_MAX_CHARS_PER_LINE - 1; ++i )
+							lineBuff[ i ] = currentLine[ i ] ? currentLine[ i ] : ' ';
+						lineBuff[ i ] = '\0';
+
 						char buff[1024];
-						sprintf(buff, "Error parsing INI file '%s' (Line: '%s')\n", m_filename.str(), currentLine.str());
+						sprintf(buff, "Error parsing INI file '%s' (Line: '%.900s')\n", m_filename.str(), lineBuff);
 
 						throw INIException(buff);
 					}
@@ -407,90 +471,155 @@ void INI::load( AsciiString filename, INILoadType loadType, Xfer *pXfer )
 
 //-------------------------------------------------------------------------------------------------
 /** Read a line from the already open file.  Any comments will be remved and
-	* therefore ignored from any given line */
+	* therefore ignored from any given line.  This doesn't copy anything, the line is fixed up
+	* where it sits in the file image and m_line points at it */
 //-------------------------------------------------------------------------------------------------
 void INI::readLine( void )
 {
-	Bool isComment = FALSE;
 
 	// sanity
-	DEBUG_ASSERTCRASH( m_file, ("readLine(), file pointer is NULL\n") );
+	DEBUG_ASSERTCRASH( m_fileData, ("readLine(), no file is loaded\n") );
+
+	// put back the char we borrowed to terminate the last line
+	*m_readPos = m_readPosChar;
 
-	// if we've reached end of file we'll just keep returning empty string in our buffer
-	if( m_endOfFile )
+	// if we've reached end of file we'll just keep returning an empty line
+	if( m_endOfFile || m_readPos == m_fileEnd )
 	{
-		m_buffer[ 0 ] = '\0';	
+
+		if( m_endOfFile == FALSE )
+		{
+			// this is the read that ran off the end of the file, which counts as a line
+			m_endOfFile = TRUE;
+			m_lineNum++;
+		}
+
+		m_readPos = m_fileEnd;
+		m_readPosChar = '\0';
+		*m_fileEnd = '\0';
+		m_line = m_fileEnd;
+		m_lineLength = 0;
+
 	}
 	else
 	{
-		// read up till the newline character or until out of space
-		Int i = 0;
-		Bool done = FALSE;
-		while( !done )
+		char *lineStart = m_readPos;
+		char *lineMax = lineStart + INI_MAX_CHARS_PER_LINE - 1;
+		if( lineMax > m_fileEnd )
+			lineMax = m_fileEnd;
+
+		//
+		// run up to the newline, making all whitespace characters actual spaces until we find
+		// a comment (or a stray terminator), which is where the line ends as far as anyone
+		// else is concerned
+		//
+		char *cutOff = NULL;
+		char *c = lineStart;
+		for( ; c < lineMax && *c != '\n'; ++c )
 		{
 
-			// read character
-			m_endOfFile = (m_file->read(m_buffer + i, 1) == 0);
-
-			// check for end of file
-			if( m_endOfFile )
-			{
-		
-				done = TRUE;
-				m_buffer[ i ] = '\0';
+			DEBUG_ASSERTCRASH(*c != '\t', ("tab characters are not allowed in INI files (%s). please check your editor settings. Line Number %d\n",m_filename.str(), getLineNum() + 1));
 
-			}  // end if
+			if( cutOff )
+				continue;
 
-			// check for new line
-			if( m_buffer[ i ] == '\n' )
-				done = TRUE;
+			if( *c == ';' || *c == '\0' )
+				cutOff = c;
+			else if( isspace( *c ) )
+				*c = ' ';
 
-			DEBUG_ASSERTCRASH(m_buffer[ i ] != '\t', ("tab characters are not allowed in INI files (%s). please check your editor settings. Line Number %d\n",m_filename.str(), getLineNum()));
+		}  // end for
 
-			// make all whitespace characters actual spaces
-			if( isspace( m_buffer[ i ] ) )
-				m_buffer[ i ] = ' ';
+		// where does the next line start
+		char *nextLine;
+		if( c < lineMax )
+		{
 
-			// if this is a semicolon, that represents the start of a comment
-			if( m_buffer[ i ] == ';' )
-				isComment = TRUE;
+			// the newline itself is part of the line, as a space, unless it's been commented out
+			if( cutOff == NULL )
+				*c = ' ';
+			nextLine = c + 1;
 
-			// if we've set the comment flag, just insert terminators in the place of each character read
-			if( isComment == TRUE )
-				m_buffer[ i ] = '\0';
+		}  // end if
+		else if( c == m_fileEnd )
+		{
 
-			//
-			// when we've become done, as the last thing just set the current index position + 1
-			// to the string terminator
-			//
-			if( done == TRUE && i + 1 < INI_MAX_CHARS_PER_LINE )
-				m_buffer[ i + 1 ] = '\0';
+			// last line, with no newline on it
+			nextLine = c;
+			m_endOfFile = TRUE;
 
-			// increase our buffer index, but watch out for the max
-			if( ++i == INI_MAX_CHARS_PER_LINE )
-				done = TRUE;
+		}  // end else if
+		else
+		{
 
-		}  // end while
+			nextLine = c;
+			DEBUG_ASSERTCRASH( 0, ("Line too long (%d) and was split, increase INI_MAX_CHARS_PER_LINE\n", 
+														 INI_MAX_CHARS_PER_LINE) );
 
-		// increase our line count
-		m_lineNum++;
+		}  // end else
 
-		// check for at the max
-		if( i == INI_MAX_CHARS_PER_LINE )
+		// terminate the line, borrowing the first char of the next one if we have to
+		m_readPos = nextLine;
+		m_readPosChar = *nextLine;
+		if( cutOff )
+		{
+			*cutOff = '\0';
+			m_lineLength = cutOff - lineStart;
+		}
+		else
 		{
+			*nextLine = '\0';
+			m_lineLength = nextLine - lineStart;
+		}
+		m_line = lineStart;
 
-			DEBUG_ASSERTCRASH( 0, ("Buffer too small (%d) and was truncated, increase INI_MAX_CHARS_PER_LINE\n", 
-														 INI_MAX_CHARS_PER_LINE) );
+		// increase our line count
+		m_lineNum++;
 
-		}  // end if
 	}
 
+	// start tokenizing from the front of the line
+	m_tokenPos = m_line;
+
 	if (s_xfer)
 	{
-		s_xfer->xferUser( m_buffer, sizeof( char ) * strlen( m_buffer ) );
+		s_xfer->xferUser( m_line, sizeof( char ) * m_lineLength );
 		//DEBUG_LOG(("Xfer val is now 0x%8.8X in %s, line %s\n", ((XferCRC *)s_xfer)->getCRC(),
-			//m_filename.str(), m_buffer));
+			//m_filename.str(), m_line));
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Pull the next token out of the current line.  This works just like strtok(), except that
+	* the position is kept in the INI instead of a hidden static */
+//-------------------------------------------------------------------------------------------------
+char *INI::nextToken( const char *seps )
+{
+	char *token = m_tokenPos;
+	if( token == NULL )
+		return NULL;
+
+	// skip leading separators
+	token += strspn( token, seps );
+	if( *token == '\0' )
+	{
+		m_tokenPos = token;
+		return NULL;
 	}
+
+	// find the end of the token and terminate it there
+	char *end = token + strcspn( token, seps );
+	if( *end != '\0' )
+	{
+		*end = '\0';
+		m_tokenPos = end + 1;
+	}
+	else
+	{
+		m_tokenPos = end;
+	}
+
+	return token;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1486,7 +1615,7 @@ void INI::initFromINIMulti( void *what, const MultiIniFieldParse& parseTableList
 		readLine();
 
 		// check for end token
-		const char* field = strtok( m_buffer, INI::getSeps() );
+		const char* field = getNextTokenOrNull();
 		if( field )
 		{
 
@@ -1555,7 +1684,7 @@ void INI::initFromINIMulti( void *what, const MultiIniFieldParse& parseTableList
 /*static*/ const char* INI::getNextToken(const char* seps)
 {
 	if (!seps) seps = getSeps();
-	const char *token = ::strtok(NULL, seps);
+	const char *token = nextToken(seps);
 	if (!token) 
 		throw INI_INVALID_DATA;
 	return token;
@@ -1565,7 +1694,7 @@ void INI::initFromINIMulti( void *what, const MultiIniFieldParse& parseTableList
 /*static*/ const char* INI::getNextTokenOrNull(const char* seps)
 {
 	if (!seps) seps = getSeps();
-	const char *token = ::strtok(NULL, seps);
+	const char *token = nextToken(seps);
 	return token;
 }
 
@@ -1971,3 +2100,106 @@ Bool INI::isEndOfBlock( char *bufferToCheck )
 
 	return retVal;
 }
+
+#ifdef TEST_INI_LOAD
+//-------------------------------------------------------------------------------------------------
+/** The way readLine() used to do it, one character per File::read() into a line buffer */
+//-------------------------------------------------------------------------------------------------
+static Bool readLineOneCharAtATime( File *file, char *buffer )
+{
+	Bool endOfFile = FALSE;
+	Bool isComment = FALSE;
+	Int i = 0;
+	Bool done = FALSE;
+	while( !done )
+	{
+		endOfFile = (file->read(buffer + i, 1) == 0);
+		if( endOfFile )
+		{
+			done = TRUE;
+			buffer[ i ] = '\0';
+		}
+		if( buffer[ i ] == '\n' )
+			done = TRUE;
+		if( isspace( buffer[ i ] ) )
+			buffer[ i ] = ' ';
+		if( buffer[ i ] == ';' )
+			isComment = TRUE;
+		if( isComment == TRUE )
+			buffer[ i ] = '\0';
+		if( done == TRUE && i + 1 < INI_MAX_CHARS_PER_LINE )
+			buffer[ i + 1 ] = '\0';
+		if( ++i == INI_MAX_CHARS_PER_LINE - 1 )
+		{
+			buffer[ i ] = '\0';
+			done = TRUE;
+		}
+	}
+	return endOfFile;
+}
+
+//-------------------------------------------------------------------------------------------------
+/*static*/ void INI::doLoadTest( UnsignedInt initTime )
+{
+	DEBUG_LOG(("INILoadTest - engine init loaded %d INI files (%d bytes), and took %d ms all told\n",
+		s_loadTestFiles, s_loadTestBytes, initTime));
+
+	FilenameList filenameList;
+	TheFileSystem->getFileListInDirectory(AsciiString("Data\\INI\\"), "*.ini", filenameList, TRUE);
+
+	for (Int pass = 0; pass < 2; ++pass)
+	{
+		Int bytes = 0;
+		Int lines = 0;
+		Int tokens = 0;
+		XferCRC crc;
+		crc.open("INILoadTest");
+
+		Int start = ::GetTickCount();
+		for (FilenameList::const_iterator it = filenameList.begin(); it != filenameList.end(); ++it)
+		{
+			if (pass == 0)
+			{
+				File *file = TheFileSystem->openFile((*it).str(), File::READ);
+				if (file == NULL)
+					continue;
+				file = file->convertToRAMFile();
+				bytes += file->size();
+
+				char buffer[ INI_MAX_CHARS_PER_LINE ];
+				Bool endOfFile = FALSE;
+				while (!endOfFile)
+				{
+					endOfFile = readLineOneCharAtATime(file, buffer);
+					++lines;
+					crc.xferUser(buffer, strlen(buffer));
+					for (const char *token = strtok(buffer, " \n\r\t="); token; token = strtok(NULL, " \n\r\t="))
+						++tokens;
+				}
+				file->close();
+			}
+			else
+			{
+				INI ini;
+				ini.prepFile(*it, INI_LOAD_OVERWRITE);
+				bytes += ini.m_fileEnd - ini.m_fileData;
+				s_xfer = &crc;
+				while (!ini.isEOF())
+				{
+					ini.readLine();
+					++lines;
+					while (ini.getNextTokenOrNull())
+						++tokens;
+				}
+				ini.unPrepFile();
+			}
+		}
+		Int elapsed = ::GetTickCount() - start;
+		crc.close();
+
+		DEBUG_LOG(("INILoadTest - %s: %d files, %d bytes, %d lines, %d tokens, CRC 0x%8.8X, %d ms (%.2f MB/s)\n",
+			pass == 0 ? "char at a time + strtok" : "whole file in place", (Int)filenameList.size(), bytes, lines, tokens,
+			crc.getCRC(), elapsed, elapsed ? (bytes / (1024.0 * 1024.0)) / (elapsed / 1000.0) : 0.0));
+	}
+}
+#endif
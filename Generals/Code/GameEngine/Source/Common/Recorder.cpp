@@ -46,6 +46,12 @@
 #include "Common/CRCDebug.h"
 #include "Common/Version.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #ifdef _INTERNAL
 // for occasional debugging...
 //#pragma optimize("", off)
@@ -65,25 +71,220 @@ static const UnsignedInt desyncOffset = framesOffset + sizeof(UnsignedInt);
 static const UnsignedInt quitEarlyOffset = desyncOffset + sizeof(Bool);
 static const UnsignedInt disconOffset = quitEarlyOffset + sizeof(Bool);
 
-void RecorderClass::logGameStart(AsciiString options)
+static const size_t RECORD_BUFFER_SIZE = 16 * 1024;		///< hand the record buffer to the writer once it has this much in it
+
+static UnsignedInt64 getMicroseconds( void )
 {
-	if (!m_file)
-		return;
+	return (UnsignedInt64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-	time(&startTime);
-	UnsignedInt fileSize = ftell(m_file);
-	// move to appropriate offset
-	if (!fseek(m_file, startTimeOffset, SEEK_SET))
+//===============================
+// ReplayWriter
+//===============================
+/**
+	* Writes the replay file on a thread of its own, so a slow disk can't hitch the
+	* logic.  The recorder hands over buffers of commands, which get appended to the
+	* file in the order they arrive, and header patches, which get written at their
+	* offset in between.  Buffers are recycled, so once things get going nothing
+	* gets allocated.
+	*/
+//===============================
+struct ReplayWriter
+{
+	enum
+	{
+		MAX_QUEUED = 64,					///< the logic waits for the writer if it gets this far behind
+		APPEND = -1,							///< Job::m_offset for data that goes on the end of the file
+	};
+
+	struct Job
 	{
-		// save off start time
-		fwrite(&startTime, sizeof(time_t), 1, m_file);
+		std::vector<UnsignedByte>	m_data;
+		Int												m_offset;		///< where in the file m_data goes, or APPEND
+	};
+
+	FILE*											m_file;
+	std::thread								m_thread;
+	std::mutex								m_mutex;
+	std::condition_variable		m_wake;				///< signalled when a job is posted, or on shutdown
+	std::condition_variable		m_done;				///< signalled whenever a job is finished
+	std::deque<Job*>					m_jobs;				///< this and the rest are guarded by m_mutex
+	std::vector<Job*>					m_freeJobs;
+	Bool											m_busy;				///< the thread is working on a job, and owns m_file till it's done
+	Bool											m_quit;
+	ReplayWriterStats					m_stats;
+
+	ReplayWriter( FILE *file ) : m_file(file), m_busy(FALSE), m_quit(FALSE)
+	{
+		m_stats.clear();
+		m_thread = std::thread(&ReplayWriter::writeLoop, this);
 	}
-	// move back to end of stream
+
+	~ReplayWriter()
+	{
+		finish();
+		for (size_t i = 0; i < m_freeJobs.size(); ++i)
+			delete m_freeJobs[i];
+	}
+
+	/// Write out anything still queued, and stop the thread.
+	void finish( void )
+	{
+		if (!m_thread.joinable())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = TRUE;
+		}
+		m_wake.notify_all();
+		m_thread.join();
+		fflush(m_file);
+	}
+
+	Bool isWriterThread( void ) const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+	void noteStall( UnsignedInt64 start )
+	{
+		UnsignedInt64 stall = getMicroseconds() - start;
+		++m_stats.m_stalls;
+		m_stats.m_stallMicroseconds += stall;
+		if (stall > m_stats.m_maxStallMicroseconds)
+			m_stats.m_maxStallMicroseconds = stall;
+	}
+
+	/// Queue data to be written.  data is swapped for an empty buffer, keeping whatever room it had.
+	void post( std::vector<UnsignedByte>& data, Int offset )
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_jobs.size() >= MAX_QUEUED)
+			{
+				UnsignedInt64 start = getMicroseconds();
+				while (m_jobs.size() >= MAX_QUEUED)
+					m_done.wait(lock);
+				noteStall(start);
+			}
+
+			Job *job;
+			if (m_freeJobs.empty())
+			{
+				job = MSGNEW("ReplayWriter") Job;
+			}
+			else
+			{
+				job = m_freeJobs.back();
+				m_freeJobs.pop_back();
+			}
+			job->m_data.swap(data);
+			job->m_offset = offset;
+			data.clear();
+
+			m_jobs.push_back(job);
+			if ((Int)m_jobs.size() > m_stats.m_maxQueued)
+				m_stats.m_maxQueued = (Int)m_jobs.size();
+		}
+		m_wake.notify_one();
+	}
+
+	/// Wait for everything queued to be written, and get it out of the stdio buffers too.
+	void flush( void )
+	{
+		if (isWriterThread())
+			return;		// crashed while writing; nothing sensible we can do
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (!m_jobs.empty() || m_busy)
+		{
+			UnsignedInt64 start = getMicroseconds();
+			while (!m_jobs.empty() || m_busy)
+				m_done.wait(lock);
+			noteStall(start);
+		}
+		fflush(m_file);
+	}
+
+	void write( Job *job )
+	{
+		if (job->m_data.empty())
+			return;
+
+		if (job->m_offset == APPEND)
+		{
+			fwrite(&job->m_data[0], job->m_data.size(), 1, m_file);
+			return;
+		}
+
+		long fileSize = ftell(m_file);
+		// move to appropriate offset
+		if (!fseek(m_file, job->m_offset, SEEK_SET))
+		{
+			fwrite(&job->m_data[0], job->m_data.size(), 1, m_file);
+		}
+		// move back to end of stream
 #ifdef DEBUG_CRASHING
-	Int res =
+		Int res =
 #endif
-		fseek(m_file, fileSize, SEEK_SET);
-	DEBUG_ASSERTCRASH(res == 0, ("Could not seek to end of file!"));
+			fseek(m_file, fileSize, SEEK_SET);
+		DEBUG_ASSERTCRASH(res == 0, ("Could not seek to end of file!"));
+	}
+
+	void writeLoop( void )
+	{
+		for (;;)
+		{
+			Job *job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (!m_quit && m_jobs.empty())
+					m_wake.wait(lock);
+				if (m_jobs.empty())
+					return;
+				job = m_jobs.front();
+				m_jobs.pop_front();
+				m_busy = TRUE;
+			}
+
+			UnsignedInt64 start = getMicroseconds();
+			write(job);
+
+			// Once we've caught up, push it out to the OS, so a crash loses as little as possible.
+			Bool caughtUp;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				caughtUp = m_jobs.empty();
+			}
+			if (caughtUp)
+				fflush(m_file);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_busy = FALSE;
+				++m_stats.m_buffersWritten;
+				m_stats.m_bytesWritten += job->m_data.size();
+				m_stats.m_writeMicroseconds += getMicroseconds() - start;
+				job->m_data.clear();
+				m_freeJobs.push_back(job);
+			}
+			m_done.notify_all();
+		}
+	}
+
+	ReplayWriterStats getStats( void )
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stats;
+	}
+};
+
+void RecorderClass::logGameStart(AsciiString options)
+{
+	if (!m_file)
+		return;
+
+	time(&startTime);
+	// save off start time
+	patchFile(startTimeOffset, &startTime, sizeof(time_t));
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (TheNetwork && TheGlobalData->m_saveStats)
@@ -131,20 +332,9 @@ void RecorderClass::logPlayerDisconnect(UnicodeString player, Int slot)
 	{
 		return;
 	}
-	UnsignedInt fileSize = ftell(m_file);
-	// move to appropriate offset
-	if (!fseek(m_file, disconOffset + slot*sizeof(Bool), SEEK_SET))
-	{
-		// save off discon status
-		Bool b = TRUE;
-		fwrite(&b, sizeof(Bool), 1, m_file);
-	}
-	// move back to end of stream
-#ifdef DEBUG_CRASHING
-	Int res =
-#endif
-		fseek(m_file, fileSize, SEEK_SET);
-	DEBUG_ASSERTCRASH(res == 0, ("Could not seek to end of file!"));
+	// save off discon status
+	Bool b = TRUE;
+	patchFile(disconOffset + slot*sizeof(Bool), &b, sizeof(Bool));
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (TheGlobalData->m_saveStats)
@@ -176,20 +366,9 @@ void RecorderClass::logCRCMismatch( void )
 	if (!m_file)
 		return;
 
-	UnsignedInt fileSize = ftell(m_file);
-	// move to appropriate offset
-	if (!fseek(m_file, desyncOffset, SEEK_SET))
-	{
-		// save off desync status
-		Bool b = TRUE;
-		fwrite(&b, sizeof(Bool), 1, m_file);
-	}
-	// move back to end of stream
-#ifdef DEBUG_CRASHING
-	Int res =
-#endif
-		fseek(m_file, fileSize, SEEK_SET);
-	DEBUG_ASSERTCRASH(res == 0, ("Could not seek to end of file!"));
+	// save off desync status
+	Bool b = TRUE;
+	patchFile(desyncOffset, &b, sizeof(Bool));
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (TheGlobalData->m_saveStats)
@@ -225,25 +404,10 @@ void RecorderClass::logGameEnd( void )
 	time_t t;
 	time(&t);
 	UnsignedInt duration = TheGameLogic->getFrame();
-	UnsignedInt fileSize = ftell(m_file);
-	// move to appropriate offset
-	if (!fseek(m_file, endTimeOffset, SEEK_SET))
-	{
-		// save off end time
-		fwrite(&t, sizeof(time_t), 1, m_file);
-	}
-	// move to appropriate offset
-	if (!fseek(m_file, framesOffset, SEEK_SET))
-	{
-		// save off duration
-		fwrite(&duration, sizeof(UnsignedInt), 1, m_file);
-	}
-	// move back to end of stream
-#ifdef DEBUG_CRASHING
-	Int res =
-#endif
-		fseek(m_file, fileSize, SEEK_SET);
-	DEBUG_ASSERTCRASH(res == 0, ("Could not seek to end of file!"));
+	// save off end time
+	patchFile(endTimeOffset, &t, sizeof(time_t));
+	// save off duration
+	patchFile(framesOffset, &duration, sizeof(UnsignedInt));
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (TheNetwork && TheGlobalData->m_saveStats)
@@ -292,6 +456,7 @@ void RecorderClass::cleanUpReplayFile( void )
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (TheGlobalData->m_saveStats)
 	{
+		flushRecording();	// we're about to copy it
 		char fname[_MAX_PATH+1];
 		strncpy(fname, TheGlobalData->m_baseStatsDir.str(), _MAX_PATH);
 		strncat(fname, m_fileName.str(), _MAX_PATH - strlen(fname));
@@ -375,6 +540,9 @@ RecorderClass::RecorderClass()
 	m_nextFrame = 0;
 	m_wasDesync = FALSE;
 	//
+	m_writer = NULL;
+	m_framesBuffered = 0;
+	m_writerStats.clear();
 
 	init(); // just for the heck of it.
 }
@@ -383,6 +551,7 @@ RecorderClass::RecorderClass()
  * Destructor
  */
 RecorderClass::~RecorderClass() {
+	stopWriter();
 }
 
 /**
@@ -413,6 +582,7 @@ void RecorderClass::init() {
  * Reset the recorder to the "initialized state."
  */
 void RecorderClass::reset() {
+	stopWriter();
 	if (m_file != NULL) {
 		fclose(m_file);
 		m_file = NULL;
@@ -427,6 +597,13 @@ void RecorderClass::reset() {
  * Do the update for this frame.
  */
 void RecorderClass::update() {
+#ifdef TEST_REPLAY_WRITER
+	static Bool s_ranReplayWriterTest = FALSE;
+	if (!s_ranReplayWriterTest && m_file == NULL) {
+		s_ranReplayWriterTest = TRUE;
+		doReplayWriterTest();
+	}
+#endif
 	if (m_mode == RECORDERMODETYPE_RECORD || m_mode == RECORDERMODETYPE_NONE) {
 		updateRecord();
 	} else if (m_mode == RECORDERMODETYPE_PLAYBACK) {
@@ -479,7 +656,6 @@ void RecorderClass::stopPlayback() {
  */
 void RecorderClass::updateRecord() 
 {
-	Bool needFlush = FALSE;
 	static Int lastFrame = -1;
 	GameMessage *msg = TheCommandList->getFirstMessage();
 	while (msg != NULL) {
@@ -503,7 +679,7 @@ void RecorderClass::updateRecord()
 		} else if (msg->getType() == GameMessage::MSG_CLEAR_GAME_DATA) {
 			if (m_file != NULL) {
 				lastFrame = -1;
-				writeToFile(msg);
+				writeToFile(msg, TheGameLogic->getFrame());
 				stopRecording();
 			}
 			m_fileName.clear();
@@ -512,17 +688,122 @@ void RecorderClass::updateRecord()
 				if ((msg->getType() > GameMessage::MSG_BEGIN_NETWORK_MESSAGES) &&
 						(msg->getType() < GameMessage::MSG_END_NETWORK_MESSAGES)) {
 					// Only write the important messages to the file.
-					writeToFile(msg);
-					needFlush = TRUE;
+					writeToFile(msg, TheGameLogic->getFrame());
 				}
 			}
 		}
 		msg = msg->next();
 	}
 
-	if (needFlush) {
-		fflush(m_file);
+	if (m_file != NULL) {
+		finishRecordFrame();
+	}
+}
+
+/**
+ * Called once every logic frame while recording. Hands the commands over to the writer thread
+ * once there's a decent amount, or they've been sitting here for a second of game time. If the
+ * game throws, the GameEngine catch blocks flush whatever is left.
+ */
+void RecorderClass::finishRecordFrame()
+{
+	++m_framesBuffered;
+	if (m_recordBuffer.size() >= RECORD_BUFFER_SIZE || m_framesBuffered >= LOGICFRAMES_PER_SECOND) {
+		submitRecordBuffer();
+	}
+}
+
+/**
+ * Hand everything in the record buffer to the writer thread, which appends it to the file.
+ */
+void RecorderClass::submitRecordBuffer()
+{
+	m_framesBuffered = 0;
+	if (m_recordBuffer.empty())
+		return;
+
+	if (m_writer) {
+		m_writer->post(m_recordBuffer, ReplayWriter::APPEND);
+	} else if (m_file != NULL) {
+		fwrite(&m_recordBuffer[0], m_recordBuffer.size(), 1, m_file);
+		m_recordBuffer.clear();
+	}
+}
+
+/**
+ * Overwrite part of the file (the header), then carry on at the end. Goes through the writer
+ * thread when there is one, so it lands in the right place relative to the commands.
+ */
+void RecorderClass::patchFile(UnsignedInt offset, const void *data, Int len)
+{
+	if (m_writer) {
+		std::vector<UnsignedByte> patch((const UnsignedByte *)data, (const UnsignedByte *)data + len);
+		m_writer->post(patch, (Int)offset);
+		return;
+	}
+
+	UnsignedInt fileSize = ftell(m_file);
+	// move to appropriate offset
+	if (!fseek(m_file, offset, SEEK_SET))
+	{
+		fwrite(data, len, 1, m_file);
+	}
+	// move back to end of stream
+#ifdef DEBUG_CRASHING
+	Int res =
+#endif
+		fseek(m_file, fileSize, SEEK_SET);
+	DEBUG_ASSERTCRASH(res == 0, ("Could not seek to end of file!"));
+}
+
+/**
+ * Start the writer thread. From here on, nothing but the writer touches m_file.
+ */
+void RecorderClass::startWriter()
+{
+	DEBUG_ASSERTCRASH(m_writer == NULL, ("Replay writer already running"));
+	m_writerStats.clear();
+	m_framesBuffered = 0;
+	m_recordBuffer.reserve(RECORD_BUFFER_SIZE * 2);
+	m_writer = MSGNEW("ReplayWriter") ReplayWriter(m_file);
+}
+
+/**
+ * Write out whatever is still buffered or queued, and stop the writer thread.
+ */
+void RecorderClass::stopWriter()
+{
+	if (m_writer == NULL)
+		return;
+
+	submitRecordBuffer();
+	m_writer->finish();
+	m_writerStats = m_writer->getStats();
+	delete m_writer;
+	m_writer = NULL;
+	m_recordBuffer.clear();
+
+	DEBUG_LOG(("RecorderClass - wrote %u KB in %d buffers (%u ms writing); the logic waited on the writer %d times, %u ms in all, %u ms at most; at most %d buffers queued\n",
+		(UnsignedInt)(m_writerStats.m_bytesWritten / 1024), m_writerStats.m_buffersWritten,
+		(UnsignedInt)(m_writerStats.m_writeMicroseconds / 1000), m_writerStats.m_stalls,
+		(UnsignedInt)(m_writerStats.m_stallMicroseconds / 1000), (UnsignedInt)(m_writerStats.m_maxStallMicroseconds / 1000),
+		m_writerStats.m_maxQueued));
+}
+
+/**
+ * Make sure everything recorded so far is in the file.
+ */
+void RecorderClass::flushRecording()
+{
+	if (m_writer == NULL) {
+		if (m_file != NULL && m_mode == RECORDERMODETYPE_RECORD)
+			fflush(m_file);
+		return;
 	}
+
+	submitRecordBuffer();
+	m_writer->flush();
+	m_writerStats = m_writer->getStats();
 }
 
 /**
@@ -692,6 +973,9 @@ void RecorderClass::startRecording(GameDifficulty diff, Int originalGameMode, In
 	*/
 
 	/// @todo Need to write game options when there are some to be written.
+
+	// The header is done; the commands get written on the writer thread.
+	startWriter();
 }
 
 /**
@@ -709,6 +993,7 @@ void RecorderClass::stopRecording() {
 			m_wasDesync = FALSE;
 		}
 	}
+	stopWriter();
 	if (m_file != NULL) {
 		fclose(m_file);
 		m_file = NULL;
@@ -719,18 +1004,17 @@ void RecorderClass::stopRecording() {
 /**
  * Write this game message to the record file. This also writes the game message's execution frame.
  */
-void RecorderClass::writeToFile(GameMessage * msg) {
+void RecorderClass::writeToFile(GameMessage * msg, UnsignedInt frame) {
 	// Write the frame number for this command.
-	UnsignedInt frame = TheGameLogic->getFrame();
-	fwrite(&frame, sizeof(frame), 1, m_file);
+	writeBytes(&frame, sizeof(frame));
 
 	// Write the command type
 	GameMessage::Type type = msg->getType();
-	fwrite(&type, sizeof(type), 1, m_file);
+	writeBytes(&type, sizeof(type));
 
 	// Write the player index
 	Int playerIndex = msg->getPlayerIndex();
-	fwrite(&playerIndex, sizeof(playerIndex), 1, m_file);
+	writeBytes(&playerIndex, sizeof(playerIndex));
 
 #ifdef DEBUG_LOGGING
 	AsciiString commandName = msg->getCommandAsAsciiString();
@@ -751,15 +1035,15 @@ void RecorderClass::writeToFile(GameMessage * msg) {
 
 	GameMessageParser *parser = newInstance(GameMessageParser)(msg);
 	UnsignedByte numTypes = parser->getNumTypes();
-	fwrite(&numTypes, sizeof(numTypes), 1, m_file);
+	writeBytes(&numTypes, sizeof(numTypes));
 
 	GameMessageParserArgumentType *argType = parser->getFirstArgumentType();
 	while (argType != NULL) {
 		UnsignedByte type = (UnsignedByte)(argType->getType());
-		fwrite(&type, sizeof(type), 1, m_file);
+		writeBytes(&type, sizeof(type));
 
 		UnsignedByte argTypeCount = (UnsignedByte)(argType->getArgCount());
-		fwrite(&argTypeCount, sizeof(argTypeCount), 1, m_file);
+		writeBytes(&argTypeCount, sizeof(argTypeCount));
 
 		argType = argType->getNext();
 	}
@@ -777,36 +1061,39 @@ void RecorderClass::writeToFile(GameMessage * msg) {
 
 	parser->deleteInstance();
 	parser = NULL;
-
-	fflush(m_file); ///< @todo should this be in the final release?
 }
 
 void RecorderClass::writeArgument(GameMessageArgumentDataType type, const GameMessageArgumentType arg) {
 	if (type == ARGUMENTDATATYPE_INTEGER) {
-		fwrite(&(arg.integer), sizeof(arg.integer), 1, m_file);
+		writeBytes(&(arg.integer), sizeof(arg.integer));
 	} else if (type == ARGUMENTDATATYPE_REAL) {
-		fwrite(&(arg.real), sizeof(arg.real), 1, m_file);
+		writeBytes(&(arg.real), sizeof(arg.real));
 	} else if (type == ARGUMENTDATATYPE_BOOLEAN) {
-		fwrite(&(arg.boolean), sizeof(arg.boolean), 1, m_file);
+		writeBytes(&(arg.boolean), sizeof(arg.boolean));
 	} else if (type == ARGUMENTDATATYPE_OBJECTID) {
-		fwrite(&(arg.objectID), sizeof(arg.objectID), 1, m_file);
+		writeBytes(&(arg.objectID), sizeof(arg.objectID));
 	} else if (type == ARGUMENTDATATYPE_DRAWABLEID) {
-		fwrite(&(arg.drawableID), sizeof(arg.drawableID), 1, m_file);
+		writeBytes(&(arg.drawableID), sizeof(arg.drawableID));
 	} else if (type == ARGUMENTDATATYPE_TEAMID) {
-		fwrite(&(arg.teamID), sizeof(arg.teamID), 1, m_file);
+		writeBytes(&(arg.teamID), sizeof(arg.teamID));
 	} else if (type == ARGUMENTDATATYPE_LOCATION) {
-		fwrite(&(arg.location), sizeof(arg.location), 1, m_file);
+		writeBytes(&(arg.location), sizeof(arg.location));
 	} else if (type == ARGUMENTDATATYPE_PIXEL) {
-		fwrite(&(arg.pixel), sizeof(arg.pixel), 1, m_file);
+		writeBytes(&(arg.pixel), sizeof(arg.pixel));
 	} else if (type == ARGUMENTDATATYPE_PIXELREGION) {
-		fwrite(&(arg.pixelRegion), sizeof(arg.pixelRegion), 1, m_file);
+		writeBytes(&(arg.pixelRegion), sizeof(arg.pixelRegion));
 	} else if (type == ARGUMENTDATATYPE_TIMESTAMP) {
-		fwrite(&(arg.timestamp), sizeof(arg.timestamp), 1, m_file);
+		writeBytes(&(arg.timestamp), sizeof(arg.timestamp));
 	} else if (type == ARGUMENTDATATYPE_WIDECHAR) {
-		fwrite(&(arg.wChar), sizeof(arg.wChar), 1, m_file);
+		writeBytes(&(arg.wChar), sizeof(arg.wChar));
 	}
 }
 
+void RecorderClass::writeBytes(const void *data, Int len) {
+	const UnsignedByte *bytes = (const UnsignedByte *)data;
+	m_recordBuffer.insert(m_recordBuffer.end(), bytes, bytes + len);
+}
+
 /**
  * Read in a replay header, for (1) populating a replay listbox or (2) starting playback.  In
  * case (2), set FILE *m_file.
@@ -1611,6 +1898,159 @@ Bool RecorderClass::isMultiplayer( void )
 /**
  * Create a new recorder object.
  */
+#ifdef TEST_REPLAY_WRITER
+//-------------------------------------------------------------------------------------------------
+/** Record four hours of made up commands through the writer thread, and write the same bytes
+	straight to a second file as we go.  The two had better match.  Logs how long the logic
+	spent recording each frame, and how often it had to wait on the writer. */
+//-------------------------------------------------------------------------------------------------
+void RecorderClass::doReplayWriterTest()
+{
+	const UnsignedInt NUM_FRAMES = 4 * 60 * 60 * LOGICFRAMES_PER_SECOND;
+	const Int NUM_PLAYERS = 8;
+
+	AsciiString dir = getReplayDir();
+	TheFileSystem->createDirectory(dir);
+	AsciiString testName = dir;
+	testName.concat("ReplayWriterTest");
+	testName.concat(getReplayExtention());
+	AsciiString refName = dir;
+	refName.concat("ReplayWriterTestRef");
+	refName.concat(getReplayExtention());
+
+	FILE *refFile = fopen(refName.str(), "wb");
+	m_file = fopen(testName.str(), "wb");
+	if (m_file == NULL || refFile == NULL) {
+		DEBUG_LOG(("ReplayWriterTest - couldn't create %s\n", testName.str()));
+		if (m_file) fclose(m_file);
+		if (refFile) fclose(refFile);
+		m_file = NULL;
+		return;
+	}
+	RecorderModeType oldMode = m_mode;
+	m_mode = RECORDERMODETYPE_RECORD;
+
+	// a stand in for the header, so the patches have somewhere to go
+	char header[128];
+	memset(header, 0, sizeof(header));
+	memcpy(header, "GENREP", 6);
+	fwrite(header, sizeof(header), 1, m_file);
+	fwrite(header, sizeof(header), 1, refFile);
+	startWriter();
+
+	GameMessage *moveMsg = newInstance(GameMessage)(GameMessage::MSG_DO_MOVETO);
+	Coord3D pos = { 1234.5f, 678.25f, 10.0f };
+	moveMsg->appendLocationArgument(pos);
+	GameMessage *attackMsg = newInstance(GameMessage)(GameMessage::MSG_DO_ATTACK_OBJECT);
+	attackMsg->appendObjectIDArgument((ObjectID)1234);
+	GameMessage *groupMsg = newInstance(GameMessage)(GameMessage::MSG_CREATE_SELECTED_GROUP);
+	groupMsg->appendBooleanArgument(TRUE);
+	for (Int i = 0; i < 12; ++i)
+		groupMsg->appendObjectIDArgument((ObjectID)(100 + i));
+	GameMessage *crcMsg = newInstance(GameMessage)(GameMessage::MSG_LOGIC_CRC);
+	crcMsg->appendIntegerArgument(0x12345678);
+	GameMessage *messages[] = { moveMsg, attackMsg, groupMsg };
+
+	UnsignedInt seed = 12345;	// our own random numbers, so we don't disturb the game's
+	Int numMessages = 0;
+	UnsignedInt64 recordMicroseconds = 0;
+	UnsignedInt64 worstFrameMicroseconds = 0;
+	for (UnsignedInt frame = 0; frame < NUM_FRAMES; ++frame)
+	{
+		UnsignedInt64 start = getMicroseconds();
+		size_t oldSize = m_recordBuffer.size();
+
+		// a busy game: each player gives about two orders a second, and sends a CRC now and then
+		for (Int player = 0; player < NUM_PLAYERS; ++player)
+		{
+			seed = seed * 1664525 + 1013904223;
+			if ((seed >> 16) % 15 == 0)
+			{
+				GameMessage *msg = messages[(seed >> 8) % 3];
+				msg->friend_setPlayerIndex(player);
+				writeToFile(msg, frame);
+				++numMessages;
+			}
+			if (frame % REPLAY_CRC_INTERVAL == 0)
+			{
+				crcMsg->friend_setPlayerIndex(player);
+				writeToFile(crcMsg, frame);
+				++numMessages;
+			}
+		}
+
+		Bool wroteAny = (m_recordBuffer.size() != oldSize);
+		if (wroteAny)
+			fwrite(&m_recordBuffer[oldSize], m_recordBuffer.size() - oldSize, 1, refFile);
+
+		// every so often, somebody disconnects
+		if (frame % (10 * 60 * LOGICFRAMES_PER_SECOND) == 0)
+		{
+			Int slot = (frame / (10 * 60 * LOGICFRAMES_PER_SECOND)) % MAX_SLOTS;
+			Bool b = TRUE;
+			patchFile(disconOffset + slot*sizeof(Bool), &b, sizeof(Bool));
+
+			long refSize = ftell(refFile);
+			fseek(refFile, disconOffset + slot*sizeof(Bool), SEEK_SET);
+			fwrite(&b, sizeof(Bool), 1, refFile);
+			fseek(refFile, refSize, SEEK_SET);
+		}
+
+		finishRecordFrame();
+
+		UnsignedInt64 elapsed = getMicroseconds() - start;
+		recordMicroseconds += elapsed;
+		if (elapsed > worstFrameMicroseconds)
+			worstFrameMicroseconds = elapsed;
+	}
+
+	for (Int i = 0; i < 3; ++i)
+		messages[i]->deleteInstance();
+	crcMsg->deleteInstance();
+
+	stopWriter();
+	fclose(m_file);
+	m_file = NULL;
+	fclose(refFile);
+	m_mode = oldMode;
+
+	// now see if they match
+	Bool same = FALSE;
+	UnsignedInt fileSize = 0;
+	FILE *a = fopen(testName.str(), "rb");
+	FILE *b = fopen(refName.str(), "rb");
+	if (a && b)
+	{
+		same = TRUE;
+		char bufA[4096], bufB[4096];
+		for (;;)
+		{
+			size_t lenA = fread(bufA, 1, sizeof(bufA), a);
+			size_t lenB = fread(bufB, 1, sizeof(bufB), b);
+			if (lenA != lenB || memcmp(bufA, bufB, lenA) != 0)
+			{
+				same = FALSE;
+				break;
+			}
+			fileSize += lenA;
+			if (lenA == 0)
+				break;
+		}
+	}
+	if (a) fclose(a);
+	if (b) fclose(b);
+	remove(testName.str());
+	remove(refName.str());
+
+	DEBUG_LOG(("ReplayWriterTest - %d frames, %d commands, %u KB: %s\n", NUM_FRAMES, numMessages, fileSize / 1024,
+		same ? "matches" : "DOES NOT MATCH"));
+	DEBUG_LOG(("ReplayWriterTest - recording took %.2f us a frame on average, %u us at worst; waited on the writer %d times, %u ms in all\n",
+		(double)recordMicroseconds / NUM_FRAMES, (UnsignedInt)worstFrameMicroseconds, m_writerStats.m_stalls,
+		(UnsignedInt)(m_writerStats.m_stallMicroseconds / 1000)));
+	DEBUG_ASSERTCRASH(same, ("ReplayWriterTest - the replay written in the background doesn't match"));
+}
+#endif // TEST_REPLAY_WRITER
+
 RecorderClass * createRecorder() {
 	return NEW RecorderClass;
 }
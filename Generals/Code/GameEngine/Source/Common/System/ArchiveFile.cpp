@@ -89,7 +89,7 @@ ArchiveFile::~ArchiveFile()
 	}
 }
 
-ArchiveFile::ArchiveFile() 
+ArchiveFile::ArchiveFile() : m_file(NULL)
 {
 	m_rootDirectory.clear();
 }
@@ -196,6 +196,11 @@ void ArchiveFile::attachFile(File *file)
 	m_file = file;
 }
 
+Bool ArchiveFile::searchStringMatches(const AsciiString& str, const AsciiString& searchString)
+{
+	return SearchStringMatches(str, searchString);
+}
+
 const ArchivedFileInfo * ArchiveFile::getArchivedFileInfo(const AsciiString& filename) const
 {
 	AsciiString path;
@@ -233,3 +238,15 @@ const ArchivedFileInfo * ArchiveFile::getArchivedFileInfo(const AsciiString& fil
 	}
 
 }
+
+Bool ArchiveFile::getFileLocation(const AsciiString& filename, UnsignedInt *offset, UnsignedInt *size) const
+{
+	const ArchivedFileInfo *fileInfo = getArchivedFileInfo(filename);
+	if (fileInfo == NULL) {
+		return FALSE;
+	}
+
+	*offset = fileInfo->m_offset;
+	*size = fileInfo->m_size;
+	return TRUE;
+}
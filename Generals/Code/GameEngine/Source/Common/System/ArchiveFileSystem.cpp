@@ -264,6 +264,21 @@ Bool ArchiveFileSystem::getFileInfo(const AsciiString& filename, FileInfo *fileI
 	}
 }
 
+Bool ArchiveFileSystem::getFileLocation(const AsciiString& filename, AsciiString *archiveFilename, UnsignedInt *offset, UnsignedInt *size) const
+{
+	if (filename.getLength() <= 0) {
+		return FALSE;
+	}
+
+	*archiveFilename = getArchiveFilenameForFile(filename);
+	ArchiveFileMap::const_iterator it = m_archiveFileMap.find(*archiveFilename);
+	if (it == m_archiveFileMap.end()) {
+		return FALSE;
+	}
+
+	return it->second->getFileLocation(filename, offset, size);
+}
+
 AsciiString ArchiveFileSystem::getArchiveFilenameForFile(const AsciiString& filename) const
 {
 	AsciiString path;
@@ -49,8 +49,10 @@
 #include "Common/FileSystem.h"
 #include "Common/File.h"
 
-#include "Common/PerfTimer.h"
-enum { NUM_TIMES = 1 };
+#include <chrono>
+#include <vector>
+
+enum { NUM_TIMES = 3 };
 
 struct CompData
 {
@@ -59,43 +61,99 @@ public:
 	Int compressedSize[COMPRESSION_MAX+1];
 };
 
-#define TEST_COMPRESSION_MIN COMPRESSION_BTREE
+struct CompTimes
+{
+	double compressSeconds;
+	double decompressSeconds;
+};
+
+#define TEST_COMPRESSION_MIN COMPRESSION_MIN
 #define TEST_COMPRESSION_MAX COMPRESSION_MAX
 
-void DoCompressTest( void )
+static double secondsSince( std::chrono::steady_clock::time_point start )
 {
-	
-	Int i;
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// stream callbacks that write to, and read back from, a memory buffer
+struct StreamTestBuffer
+{
+	std::vector<UnsignedByte> data;
+	Int readPos;
+};
 
-	/*
-	PerfGather *s_compressGathers[TEST_COMPRESSION_MAX+1];
-	PerfGather *s_decompressGathers[TEST_COMPRESSION_MAX+1];
-	for (i = TEST_COMPRESSION_MIN; i < TEST_COMPRESSION_MAX+1; ++i)
+static Bool streamTestWrite( const void *data, Int len, void *userData )
+{
+	StreamTestBuffer *buf = (StreamTestBuffer *)userData;
+	const UnsignedByte *bytes = (const UnsignedByte *)data;
+	buf->data.insert(buf->data.end(), bytes, bytes + len);
+	return TRUE;
+}
+
+static Int streamTestRead( void *data, Int len, void *userData )
+{
+	StreamTestBuffer *buf = (StreamTestBuffer *)userData;
+	Int avail = (Int)buf->data.size() - buf->readPos;
+	if (len > avail)
+		len = avail;
+	memcpy(data, &buf->data[0] + buf->readPos, len);
+	buf->readPos += len;
+	return len;
+}
+
+/// push buf through a stream writer in odd sized pieces, read it back the same way, and check it
+static void doStreamTest( CompressionType compType, const UnsignedByte *buf, Int origSize )
+{
+	StreamTestBuffer stream;
+	stream.readPos = 0;
+
+	CompressionStreamWriter writer(compType, streamTestWrite, &stream, 64*1024);
+	for (Int pos = 0; pos < origSize; pos += 10007)
 	{
-		s_compressGathers[i] = new PerfGather(CompressionManager::getCompressionNameByType((CompressionType)i));
-		s_decompressGathers[i] = new PerfGather(CompressionManager::getDecompressionNameByType((CompressionType)i));
+		Int len = origSize - pos;
+		writer.write(buf + pos, len < 10007 ? len : 10007);
 	}
-	*/
+	Bool ok = writer.finish();
+	DEBUG_ASSERTCRASH(ok, ("Stream compression with %s failed\n", CompressionManager::getCompressionNameByType(compType)));
+
+	std::vector<UnsignedByte> readBack(origSize + 1);
+	CompressionStreamReader reader(streamTestRead, &stream);
+	Int readLen = 0;
+	for (;;)
+	{
+		Int len = origSize + 1 - readLen;
+		Int got = reader.read(&readBack[0] + readLen, len < 4093 ? len : 4093);
+		if (got <= 0)
+			break;
+		readLen += got;
+	}
+
+	DEBUG_LOG(("Stream: %d bytes -> %d bytes, read back %d\n", writer.getBytesIn(), writer.getBytesOut(), readLen));
+	DEBUG_ASSERTCRASH(readLen == origSize && memcmp(buf, &readBack[0], origSize) == 0,
+		("Stream round trip with %s doesn't match the original\n", CompressionManager::getCompressionNameByType(compType)));
+}
+
+void DoCompressTest( void )
+{
+	Int i;
 
 	std::map<AsciiString, CompData> s_sizes;
+	CompTimes times[TEST_COMPRESSION_MAX+1];
+	memset(times, 0, sizeof(times));
 
-	std::map<AsciiString, MapMetaData>::const_iterator it = TheMapCache->find("userdata\\maps\\_usa01\\_usa01.map");
-	if (it != TheMapCache->end())
+	for (std::map<AsciiString, MapMetaData>::const_iterator it = TheMapCache->begin(); it != TheMapCache->end(); ++it)
 	{
-		//if (it->second.m_isOfficial)
-		//{
-			//++it;
-			//continue;
-		//}
-		//static Int count = 0;
-		//if (count++ > 2)
-			//break;
 		File *f = TheFileSystem->openFile(it->first.str());
 		if (f)
 		{
 			DEBUG_LOG(("***************************\nTesting '%s'\n\n", it->first.str()));
 			Int origSize = f->size();
 			UnsignedByte *buf = (UnsignedByte *)f->readEntireAndClose();
+			if (origSize <= 0 || buf == NULL)
+			{
+				delete[] buf;
+				continue;
+			}
 			UnsignedByte *uncompressedBuf = NEW UnsignedByte[origSize];
 
 			CompData d = s_sizes[it->first];
@@ -105,7 +163,7 @@ void DoCompressTest( void )
 			for (i=TEST_COMPRESSION_MIN; i<=TEST_COMPRESSION_MAX; ++i)
 			{
 				DEBUG_LOG(("=================================================\n"));
-				DEBUG_LOG(("Compression Test %d\n", i));
+				DEBUG_LOG(("Compression Test %s\n", CompressionManager::getCompressionNameByType((CompressionType)i)));
 
 				Int maxCompressedSize = CompressionManager::getMaxCompressedSize( origSize, (CompressionType)i );
 				DEBUG_LOG(("Orig size is %d, max compressed size is %d bytes\n", origSize, maxCompressedSize));
@@ -114,16 +172,17 @@ void DoCompressTest( void )
 				memset(compressedBuf, 0, maxCompressedSize);
 				memset(uncompressedBuf, 0, origSize);
 
-				Int compressedLen, decompressedLen;
+				Int compressedLen = 0, decompressedLen = 0;
 
 				for (Int j=0; j < NUM_TIMES; ++j) 
 				{
-					//s_compressGathers[i]->startTimer();
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 					compressedLen = CompressionManager::compressData((CompressionType)i, buf, origSize, compressedBuf, maxCompressedSize);
-					//s_compressGathers[i]->stopTimer();
-					//s_decompressGathers[i]->startTimer();
+					times[i].compressSeconds += secondsSince(start);
+
+					start = std::chrono::steady_clock::now();
 					decompressedLen = CompressionManager::decompressData(compressedBuf, compressedLen, uncompressedBuf, origSize);
-					//s_decompressGathers[i]->stopTimer();
+					times[i].decompressSeconds += secondsSince(start);
 				}
 				d.compressedSize[i] = compressedLen;
 				DEBUG_LOG(("Compressed len is %d (%g%% of original size)\n", compressedLen, (double)compressedLen/(double)origSize*100.0));
@@ -140,13 +199,13 @@ void DoCompressTest( void )
 					}
 				}
 
-				delete compressedBuf;
+				doStreamTest((CompressionType)i, buf, origSize);
+
+				delete[] compressedBuf;
 				compressedBuf = NULL;
 			}
 
-			DEBUG_LOG(("d = %d -> %d\n", d.origSize, d.compressedSize[i]));
 			s_sizes[it->first] = d;
-			DEBUG_LOG(("s_sizes[%s] = %d -> %d\n", it->first.str(), s_sizes[it->first].origSize, s_sizes[it->first].compressedSize[i]));
 
 			delete[] buf;
 			buf = NULL;
@@ -154,8 +213,6 @@ void DoCompressTest( void )
 			delete[] uncompressedBuf;
 			uncompressedBuf = NULL;
 		}
-
-		++it;
 	}
 
 	for (i=TEST_COMPRESSION_MIN; i<=TEST_COMPRESSION_MAX; ++i)
@@ -175,30 +232,21 @@ void DoCompressTest( void )
 			totalUncompressedBytes += d.origSize;
 			totalCompressedBytes += d.compressedSize[i];
 		}
+		if (totalUncompressedBytes == 0)
+			continue;
+
+		double megabytes = (double)totalUncompressedBytes * NUM_TIMES / (1024.0 * 1024.0);
 		DEBUG_LOG(("***************************************************\n"));
 		DEBUG_LOG(("Compression method %s:\n", CompressionManager::getCompressionNameByType((CompressionType)i)));
 		DEBUG_LOG(("%d bytes compressed to %d (%g%%)\n", totalUncompressedBytes, totalCompressedBytes,
 			totalCompressedBytes/(Real)totalUncompressedBytes*100.0f));
 		DEBUG_LOG(("Min ratio: %g%%, Max ratio: %g%%\n",
 			minCompression*100.0f, maxCompression*100.0f));
+		DEBUG_LOG(("Compress %g MB/s, decompress %g MB/s\n",
+			times[i].compressSeconds > 0.0 ? megabytes / times[i].compressSeconds : 0.0,
+			times[i].decompressSeconds > 0.0 ? megabytes / times[i].decompressSeconds : 0.0));
 		DEBUG_LOG(("\n"));
 	}
-
-	/*
-	PerfGather::dumpAll(10000);
-	PerfGather::resetAll();
-	CopyFile( "AAAPerfStats.csv", "AAACompressPerfStats.csv", FALSE );
-
-	for (i = TEST_COMPRESSION_MIN; i < TEST_COMPRESSION_MAX+1; ++i) 
-	{
-		delete s_compressGathers[i];
-		s_compressGathers[i] = NULL;
-
-		delete s_decompressGathers[i];
-		s_decompressGathers[i] = NULL;
-	}
-	*/
-
 }
 
 #endif // TEST_COMPRESSION
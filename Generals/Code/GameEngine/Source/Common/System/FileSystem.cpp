@@ -52,8 +52,17 @@
 #include "Common/ArchiveFileSystem.h"
 #include "Common/CDManager.h"
 #include "Common/GameAudio.h"
+#include "Common/GlobalData.h"
 #include "Common/LocalFileSystem.h"
 #include "Common/PerfTimer.h"
+#include "Common/RAMFile.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 
 DECLARE_PERF_TIMER(FileSystem)
@@ -68,13 +77,220 @@ DECLARE_PERF_TIMER(FileSystem)
 //         Defines                                                         
 //----------------------------------------------------------------------------
 
-
+enum { NUM_IO_THREADS = 2 };											///< reads are disk bound, more threads than this just fight over the disk
+static const UnsignedInt MAX_PREFETCH_BYTES = 64 * 1024 * 1024;		///< prefetched data waiting to be opened is held to this
+static const char *LOAD_MANIFEST_DIR = "LoadManifests\\";
 
 //----------------------------------------------------------------------------
 //         Private Types                                                     
 //----------------------------------------------------------------------------
 
+//===============================
+// FileReadRequest
+//===============================
+/**
+	* One file being read in the background.  Where to read it from is worked out
+	* on the main thread when the request is made, so the I/O threads only ever do
+	* plain reads and never touch the file systems.
+	*/
+//===============================
+class FileReadRequest
+{
+public:
+	enum State
+	{
+		PENDING,		///< waiting for an I/O thread
+		READING,
+		DONE,				///< m_data is the file, or NULL if the read failed
+	};
+
+	AsciiString		m_name;					///< what the File gets called
+	std::string		m_path;					///< file on disk that holds the data, only this and what follows are looked at by the I/O threads
+	UnsignedInt		m_offset;
+	UnsignedInt		m_size;
+	Bool					m_prefetch;			///< counts against MAX_PREFETCH_BYTES once it's started, until it's opened
+
+	State					m_state;				///< this and the rest are guarded by FileReadQueue::m_mutex
+	Bool					m_counted;			///< m_size is in FileReadQueue::m_prefetchBytes
+	Char					*m_data;
+
+	FileReadRequest() : m_offset(0), m_size(0), m_prefetch(FALSE), m_state(PENDING), m_counted(FALSE), m_data(NULL) {}
+};
+
+//===============================
+// FileReadQueue
+//===============================
+/**
+	* The I/O threads.  Requests someone is going to wait for go ahead of
+	* prefetches, and prefetching stops while MAX_PREFETCH_BYTES of prefetched
+	* data is waiting to be opened.
+	*/
+//===============================
+struct FileReadQueue
+{
+	std::vector<std::thread>			m_threads;
+	std::mutex										m_mutex;
+	std::condition_variable				m_wake;					///< signalled when there's a read to do, room for a prefetch, or on shutdown
+	std::condition_variable				m_done;					///< signalled whenever a read finishes
+	std::deque<FileReadRequest*>	m_requests;
+	std::deque<FileReadRequest*>	m_prefetches;
+	UnsignedInt										m_prefetchBytes;	///< prefetched data being read, or waiting to be opened
+	UnsignedInt64									m_bytesRead;
+	Bool													m_quit;
+
+	FileReadQueue() : m_prefetchBytes(0), m_bytesRead(0), m_quit(FALSE)
+	{
+		for (Int i = 0; i < NUM_IO_THREADS; ++i)
+		{
+			m_threads.push_back(std::thread(&FileReadQueue::ioLoop, this));
+		}
+	}
+
+	~FileReadQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = TRUE;
+		}
+		m_wake.notify_all();
+		for (size_t i = 0; i < m_threads.size(); ++i)
+		{
+			m_threads[i].join();
+		}
+	}
+
+	void add( FileReadRequest *request )
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (request->m_prefetch)
+				m_prefetches.push_back(request);
+			else
+				m_requests.push_back(request);
+		}
+		m_wake.notify_one();
+	}
+
+	/// Take the request back if no I/O thread has started on it, leaving it done with no data.
+	/// Returns FALSE if one has.
+	Bool remove( FileReadRequest *request )
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (request->m_state != FileReadRequest::PENDING)
+			return FALSE;
+
+		// a prefetch someone waited on has moved to the front of m_requests
+		std::deque<FileReadRequest*>::iterator it = std::find(m_prefetches.begin(), m_prefetches.end(), request);
+		if (it != m_prefetches.end())
+			m_prefetches.erase(it);
+		else
+			m_requests.erase(std::find(m_requests.begin(), m_requests.end(), request));
+		request->m_state = FileReadRequest::DONE;
+		return TRUE;
+	}
+
+	Bool isDone( const FileReadRequest *request )
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return request->m_state == FileReadRequest::DONE;
+	}
+
+	/// Wait for the request to finish.  Returns TRUE if we had to.
+	Bool wait( FileReadRequest *request )
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (request->m_state == FileReadRequest::DONE)
+			return FALSE;
+
+		// nobody's going to get to it in time, so it goes to the front
+		std::deque<FileReadRequest*>::iterator it = std::find(m_prefetches.begin(), m_prefetches.end(), request);
+		if (it != m_prefetches.end())
+		{
+			m_prefetches.erase(it);
+			m_requests.push_front(request);
+			m_wake.notify_one();
+		}
+		while (request->m_state != FileReadRequest::DONE)
+			m_done.wait(lock);
+		return TRUE;
+	}
+
+	/// A prefetched file has been opened or thrown away, so it stops counting against the limit.
+	void releasePrefetch( FileReadRequest *request )
+	{
+		if (!request->m_prefetch)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (request->m_counted)
+				m_prefetchBytes -= request->m_size;
+			request->m_counted = FALSE;
+			request->m_prefetch = FALSE;
+		}
+		m_wake.notify_all();
+	}
 
+	/// next read to do, or NULL if there's nothing we're allowed to start.  m_mutex must be held.
+	FileReadRequest* nextRequest( void )
+	{
+		FileReadRequest *request = NULL;
+		if (!m_requests.empty())
+		{
+			request = m_requests.front();
+			m_requests.pop_front();
+		}
+		else if (!m_prefetches.empty() && (m_prefetchBytes == 0 || m_prefetchBytes + m_prefetches.front()->m_size <= MAX_PREFETCH_BYTES))
+		{
+			request = m_prefetches.front();
+			m_prefetches.pop_front();
+			m_prefetchBytes += request->m_size;
+			request->m_counted = TRUE;
+		}
+
+		if (request)
+			request->m_state = FileReadRequest::READING;
+		return request;
+	}
+
+	void ioLoop( void )
+	{
+		for (;;)
+		{
+			FileReadRequest *request = NULL;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (!m_quit && (request = nextRequest()) == NULL)
+					m_wake.wait(lock);
+				if (m_quit)
+					return;
+			}
+
+			Char *data = MSGNEW("FileReadRequest") Char[request->m_size > 0 ? request->m_size : 1];
+			UnsignedInt bytesRead = 0;
+			FILE *fp = fopen(request->m_path.c_str(), "rb");
+			if (fp)
+			{
+				if (fseek(fp, (long)request->m_offset, SEEK_SET) == 0)
+					bytesRead = (UnsignedInt)fread(data, 1, request->m_size, fp);
+				fclose(fp);
+			}
+			if (bytesRead != request->m_size)
+			{
+				delete [] data;
+				data = NULL;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				request->m_data = data;
+				request->m_state = FileReadRequest::DONE;
+				m_bytesRead += bytesRead;
+			}
+			m_done.notify_all();
+		}
+	}
+};
 
 //----------------------------------------------------------------------------
 //         Private Data                                                     
@@ -111,6 +327,22 @@ FileSystem	*TheFileSystem = NULL;
 //         Private Functions                                               
 //----------------------------------------------------------------------------
 
+static UnsignedInt64 getMicroseconds( void )
+{
+	return (UnsignedInt64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Prefetched files are looked up the way the archives store them, lower case with backslashes.
+static AsciiString makePrefetchKey( const Char *filename )
+{
+	std::string key(filename);
+	for (size_t i = 0; i < key.size(); ++i)
+	{
+		key[i] = (key[i] == '/') ? '\\' : (Char)tolower(key[i]);
+	}
+	return AsciiString(key.c_str());
+}
+
 
 //----------------------------------------------------------------------------
 //         Public Functions                                                
@@ -121,9 +353,9 @@ FileSystem	*TheFileSystem = NULL;
 // FileSystem::FileSystem
 //============================================================================
 
-FileSystem::FileSystem()
+FileSystem::FileSystem() : m_readQueue(NULL), m_loading(FALSE), m_loadStartTime(0)
 {
-
+	m_loadStats.clear();
 }
 
 //============================================================================
@@ -132,7 +364,9 @@ FileSystem::FileSystem()
 
 FileSystem::~FileSystem()
 {
-
+	clearPrefetchedFiles();
+	delete m_readQueue;
+	m_readQueue = NULL;
 }
 
 //============================================================================
@@ -143,6 +377,15 @@ void		FileSystem::init( void )
 {
 	TheLocalFileSystem->init();
 	TheArchiveFileSystem->init();
+
+	if (m_readQueue == NULL)
+	{
+		m_readQueue = MSGNEW("FileReadQueue") FileReadQueue;
+	}
+
+#ifdef TEST_FILE_READ_QUEUE
+	doReadQueueTest();
+#endif
 }
 
 //============================================================================
@@ -163,6 +406,7 @@ void		FileSystem::update( void )
 void		FileSystem::reset( void )
 {
 	USE_PERF_TIMER(FileSystem)
+	clearPrefetchedFiles();
 	TheLocalFileSystem->reset();
 	TheArchiveFileSystem->reset();
 }
@@ -176,6 +420,19 @@ File*		FileSystem::openFile( const Char *filename, Int access )
 	USE_PERF_TIMER(FileSystem)
 	File *file = NULL;
 
+	if ( !m_prefetchedFiles.empty() )
+	{
+		file = openPrefetchedFile( filename, access );
+		if ( file != NULL )
+		{
+			return file;
+		}
+	}
+
+	// during a load, every file read is counted, and remembered so it can be prefetched next time
+	Bool counting = m_loading && (access & (File::WRITE | File::STREAMING)) == 0;
+	UnsignedInt64 startTime = counting ? getMicroseconds() : 0;
+
 	if ( TheLocalFileSystem != NULL )
 	{
 		file = TheLocalFileSystem->openFile( filename, access );
@@ -186,9 +443,343 @@ File*		FileSystem::openFile( const Char *filename, Int access )
 		file = TheArchiveFileSystem->openFile( filename );
 	}
 
+	if ( counting && file != NULL )
+	{
+		m_loadStats.m_openMicroseconds += getMicroseconds() - startTime;
+		m_loadStats.m_bytesOpenedDirectly += file->size();
+		++m_loadStats.m_filesOpened;
+		if ( m_loadFilesSeen.insert( AsciiString( filename ) ).second )
+		{
+			m_loadFiles.push_back( AsciiString( filename ) );
+		}
+	}
+
 	return file;
 }
 
+//============================================================================
+// FileSystem::openPrefetchedFile
+//============================================================================
+
+File*		FileSystem::openPrefetchedFile( const Char *filename, Int access )
+{
+	PrefetchedFileMap::iterator it = m_prefetchedFiles.find( makePrefetchKey( filename ) );
+	if ( it == m_prefetchedFiles.end() )
+	{
+		return NULL;
+	}
+
+	FileReadRequest *request = it->second;
+	m_prefetchedFiles.erase( it );
+
+	// anything but a plain read goes the usual way, and if nobody has started on the read,
+	// we might as well do it ourselves
+	if ( (access & (File::WRITE | File::STREAMING)) != 0 || m_readQueue->remove( request ) )
+	{
+		m_readQueue->releasePrefetch( request );
+		cancelRequest( request );
+		return NULL;
+	}
+
+	UnsignedInt64 startTime = getMicroseconds();
+	if ( m_readQueue->wait( request ) )
+	{
+		m_loadStats.m_stallMicroseconds += getMicroseconds() - startTime;
+		++m_loadStats.m_prefetchStalls;
+	}
+	m_readQueue->releasePrefetch( request );
+
+	// the read failing isn't our problem, the usual way will report it
+	File *file = finishRequest( request );
+	if ( file != NULL && m_loading )
+	{
+		++m_loadStats.m_prefetchHits;
+		++m_loadStats.m_filesOpened;
+		if ( m_loadFilesSeen.insert( AsciiString( filename ) ).second )
+		{
+			m_loadFiles.push_back( AsciiString( filename ) );
+		}
+	}
+	return file;
+}
+
+//============================================================================
+// FileSystem::makeRequest
+//============================================================================
+
+FileReadRequest*	FileSystem::makeRequest( const Char *filename, Bool prefetch )
+{
+	FileReadRequest *request = NULL;
+	FileInfo fileInfo;
+	AsciiString archiveFilename;
+	UnsignedInt offset = 0;
+	UnsignedInt size = 0;
+
+	// same order as openFile(), loose files first
+	if ( TheLocalFileSystem->doesFileExist( filename ) && TheLocalFileSystem->getFileInfo( AsciiString( filename ), &fileInfo ) )
+	{
+		request = MSGNEW("FileReadRequest") FileReadRequest;
+		request->m_name = filename;
+		request->m_path = filename;
+		request->m_size = (UnsignedInt)fileInfo.sizeLow;
+	}
+	else if ( TheArchiveFileSystem->getFileLocation( AsciiString( filename ), &archiveFilename, &offset, &size ) )
+	{
+		// archived files have always gone by just their file name
+		const Char *name = strrchr( filename, '\\' );
+		const Char *altName = strrchr( filename, '/' );
+		if ( altName > name )
+			name = altName;
+
+		request = MSGNEW("FileReadRequest") FileReadRequest;
+		request->m_name = name ? name + 1 : filename;
+		request->m_path = archiveFilename.str();
+		request->m_offset = offset;
+		request->m_size = size;
+	}
+
+	if ( request )
+	{
+		request->m_prefetch = prefetch;
+	}
+	return request;
+}
+
+//============================================================================
+// FileSystem::requestFile
+//============================================================================
+
+FileReadRequest*	FileSystem::requestFile( const Char *filename )
+{
+	DEBUG_ASSERTCRASH( m_readQueue != NULL, ("FileSystem::requestFile - the file system hasn't been initialized") );
+	FileReadRequest *request = makeRequest( filename, FALSE );
+	if ( request )
+	{
+		m_readQueue->add( request );
+	}
+	return request;
+}
+
+//============================================================================
+// FileSystem::isRequestDone
+//============================================================================
+
+Bool	FileSystem::isRequestDone( const FileReadRequest *request ) const
+{
+	return m_readQueue->isDone( request );
+}
+
+//============================================================================
+// FileSystem::finishRequest
+//============================================================================
+
+File*		FileSystem::finishRequest( FileReadRequest *request )
+{
+	m_readQueue->wait( request );
+
+	RAMFile *file = NULL;
+	if ( request->m_data != NULL )
+	{
+		file = newInstance( RAMFile );
+		file->deleteOnClose();
+		if ( file->openFromBuffer( request->m_name, request->m_data, (Int)request->m_size ) == FALSE )
+		{
+			file->close();
+			file = NULL;
+		}
+		request->m_data = NULL;
+	}
+
+	delete request;
+	return file;
+}
+
+//============================================================================
+// FileSystem::cancelRequest
+//============================================================================
+
+void		FileSystem::cancelRequest( FileReadRequest *request )
+{
+	// once an I/O thread has it, it has to finish before the request can go
+	if ( !m_readQueue->remove( request ) )
+	{
+		m_readQueue->wait( request );
+	}
+
+	delete [] request->m_data;
+	delete request;
+}
+
+//============================================================================
+// FileSystem::prefetchFiles
+//============================================================================
+
+void		FileSystem::prefetchFiles( const std::vector<AsciiString>& filenames )
+{
+	if ( m_readQueue == NULL )
+	{
+		return;
+	}
+
+	for ( size_t i = 0; i < filenames.size(); ++i )
+	{
+		AsciiString key = makePrefetchKey( filenames[i].str() );
+		if ( m_prefetchedFiles.find( key ) != m_prefetchedFiles.end() )
+		{
+			continue;
+		}
+
+		FileReadRequest *request = makeRequest( filenames[i].str(), TRUE );
+		if ( request == NULL || request->m_size > MAX_PREFETCH_BYTES )
+		{
+			delete request;
+			continue;
+		}
+
+		m_prefetchedFiles[key] = request;
+		m_readQueue->add( request );
+	}
+}
+
+//============================================================================
+// FileSystem::clearPrefetchedFiles
+//============================================================================
+
+void		FileSystem::clearPrefetchedFiles( void )
+{
+	for ( PrefetchedFileMap::iterator it = m_prefetchedFiles.begin(); it != m_prefetchedFiles.end(); ++it )
+	{
+		if ( m_loading )
+		{
+			++m_loadStats.m_prefetchUnused;
+		}
+		m_readQueue->releasePrefetch( it->second );
+		cancelRequest( it->second );
+	}
+	m_prefetchedFiles.clear();
+}
+
+//============================================================================
+// FileSystem::getLoadManifestFilename
+//============================================================================
+
+AsciiString	FileSystem::getLoadManifestFilename( const AsciiString& loadName ) const
+{
+	// flatten the name of the map into a file name
+	std::string name( loadName.str() );
+	for ( size_t i = 0; i < name.size(); ++i )
+	{
+		if ( name[i] == '\\' || name[i] == '/' || name[i] == ':' )
+			name[i] = '_';
+	}
+
+	AsciiString filename;
+	filename.format( "%s%s%s.txt", TheGlobalData->getPath_UserData().str(), LOAD_MANIFEST_DIR, name.c_str() );
+	return filename;
+}
+
+//============================================================================
+// FileSystem::beginLoad
+//============================================================================
+/**
+	* Start counting what a load reads, and how long it spends doing it.  If a load
+	* with the same name has been done before, the files it opened are read in the
+	* background, in the order it opened them, so they're in memory when they're wanted.
+	*/
+void		FileSystem::beginLoad( const AsciiString& loadName )
+{
+	if ( m_loading )
+	{
+		endLoad();
+	}
+
+	clearPrefetchedFiles();
+	m_loadStats.clear();
+	m_loadName = loadName;
+	m_loadFiles.clear();
+	m_loadFilesSeen.clear();
+	m_loadStartTime = getMicroseconds();
+
+	if ( TheGlobalData != NULL && TheGlobalData->m_prefetchLoadFiles && !loadName.isEmpty() )
+	{
+		std::vector<AsciiString> manifest;
+		File *file = openFile( getLoadManifestFilename( loadName ).str(), File::READ | File::BINARY );
+		if ( file )
+		{
+			// one file name a line
+			Int size = file->size();
+			char *data = file->readEntireAndClose();
+			const char *line = data;
+			for ( const char *c = data; c <= data + size; ++c )
+			{
+				if ( c == data + size || *c == '\n' || *c == '\r' )
+				{
+					if ( c > line )
+					{
+						manifest.push_back( AsciiString( std::string( line, c ).c_str() ) );
+					}
+					line = c + 1;
+				}
+			}
+			delete [] data;
+		}
+
+		prefetchFiles( manifest );
+		DEBUG_LOG(( "FileSystem::beginLoad - %s: prefetching %d of the %d files the last load opened\n",
+			loadName.str(), (Int)m_prefetchedFiles.size(), (Int)manifest.size() ));
+	}
+
+	m_loading = TRUE;
+}
+
+//============================================================================
+// FileSystem::endLoad
+//============================================================================
+
+void		FileSystem::endLoad( void )
+{
+	if ( !m_loading )
+	{
+		return;
+	}
+
+	clearPrefetchedFiles();
+	m_loading = FALSE;
+
+	m_loadStats.m_loadMicroseconds = getMicroseconds() - m_loadStartTime;
+	{
+		std::lock_guard<std::mutex> lock( m_readQueue->m_mutex );
+		m_loadStats.m_bytesPrefetched = m_readQueue->m_bytesRead;
+		m_readQueue->m_bytesRead = 0;
+	}
+
+	if ( TheGlobalData != NULL && TheGlobalData->m_prefetchLoadFiles && !m_loadName.isEmpty() && !m_loadFiles.empty() )
+	{
+		AsciiString directory = TheGlobalData->getPath_UserData();
+		directory.concat( LOAD_MANIFEST_DIR );
+		createDirectory( directory );
+
+		File *file = openFile( getLoadManifestFilename( m_loadName ).str(), File::WRITE | File::CREATE | File::TRUNCATE | File::BINARY );
+		if ( file )
+		{
+			for ( size_t i = 0; i < m_loadFiles.size(); ++i )
+			{
+				file->write( m_loadFiles[i].str(), m_loadFiles[i].getLength() );
+				file->write( "\n", 1 );
+			}
+			file->close();
+		}
+	}
+
+	DEBUG_LOG(( "FileSystem::endLoad - %s: %d files opened, %d prefetched (%d%%, %d had to wait), %d prefetched and not used\n",
+		m_loadName.str(), m_loadStats.m_filesOpened, m_loadStats.m_prefetchHits,
+		m_loadStats.m_filesOpened ? (m_loadStats.m_prefetchHits * 100) / m_loadStats.m_filesOpened : 0,
+		m_loadStats.m_prefetchStalls, m_loadStats.m_prefetchUnused ));
+	DEBUG_LOG(( "FileSystem::endLoad - %s: %u KB read in the background, %u KB opened directly, %u ms waiting on the background reads, %u ms opening files, %u ms in all\n",
+		m_loadName.str(), (UnsignedInt)(m_loadStats.m_bytesPrefetched / 1024), (UnsignedInt)(m_loadStats.m_bytesOpenedDirectly / 1024),
+		(UnsignedInt)(m_loadStats.m_stallMicroseconds / 1000), (UnsignedInt)(m_loadStats.m_openMicroseconds / 1000), (UnsignedInt)(m_loadStats.m_loadMicroseconds / 1000) ));
+}
+
 //============================================================================
 // FileSystem::doesFileExist
 //============================================================================
@@ -322,3 +913,73 @@ void FileSystem::unloadMusicFilesFromCD()
 
 	TheArchiveFileSystem->closeArchiveFile( MUSIC_BIG );
 }
+
+#ifdef TEST_FILE_READ_QUEUE
+//============================================================================
+// FileSystem::doReadQueueTest
+//============================================================================
+/**
+	* Read every INI file in the background, first as requests and then as prefetches,
+	* and check each one comes out the same as opening it the usual way.
+	*/
+void		FileSystem::doReadQueueTest( void )
+{
+	FilenameList filenameList;
+	getFileListInDirectory( AsciiString( "Data\\INI\\" ), AsciiString( "*.ini" ), filenameList, TRUE );
+
+	std::vector<AsciiString> filenames( filenameList.begin(), filenameList.end() );
+	std::vector<FileReadRequest*> requests;
+	for ( size_t i = 0; i < filenames.size(); ++i )
+	{
+		requests.push_back( requestFile( filenames[i].str() ) );
+	}
+
+	// every other one is thrown away, which mustn't upset the rest
+	Int failures = 0;
+	for ( size_t i = 0; i < filenames.size(); ++i )
+	{
+		if ( requests[i] == NULL )
+		{
+			DEBUG_CRASH(( "ReadQueueTest - %s is listed, but couldn't be requested", filenames[i].str() ));
+			++failures;
+			continue;
+		}
+
+		if ( i & 1 )
+		{
+			cancelRequest( requests[i] );
+			continue;
+		}
+
+		File *requested = finishRequest( requests[i] );
+		File *opened = openFile( filenames[i].str(), File::READ | File::BINARY );
+		Int requestedSize = requested ? requested->size() : -1;
+		Int openedSize = opened ? opened->size() : -2;
+		char *requestedData = requested ? requested->readEntireAndClose() : NULL;
+		char *openedData = opened ? opened->readEntireAndClose() : NULL;
+		if ( requestedSize != openedSize || memcmp( requestedData, openedData, requestedSize ) != 0 )
+		{
+			DEBUG_CRASH(( "ReadQueueTest - %s doesn't come out the same when it's requested", filenames[i].str() ));
+			++failures;
+		}
+		delete [] requestedData;
+		delete [] openedData;
+	}
+
+	// and again as a load, where openFile() should find them all prefetched
+	beginLoad( AsciiString::TheEmptyString );
+	prefetchFiles( filenames );
+	for ( size_t i = 0; i < filenames.size(); ++i )
+	{
+		File *file = openFile( filenames[i].str(), File::READ | File::BINARY );
+		if ( file )
+		{
+			file->close();
+		}
+	}
+	Int prefetchHits = m_loadStats.m_prefetchHits;
+	endLoad();
+
+	DEBUG_LOG(( "ReadQueueTest - %d INI files, %d failed, %d came from the prefetch\n", (Int)filenames.size(), failures, prefetchHits ));
+}
+#endif
@@ -46,6 +46,15 @@
 
 #include <new>
 #include <cstdlib>
+#ifdef MEMORYPOOL_MAGAZINES
+#include <atomic>
+#include <cstdint>
+#endif
+#ifdef TEST_MEMORYPOOL_MAGAZINES
+#include <chrono>
+#include <thread>
+#include <vector>
+#endif
 #ifdef MEMORYPOOL_DEBUG
 #include <mutex>
 #include <unordered_map>
@@ -183,6 +192,20 @@ namespace
 
 #endif
 
+#ifdef MEMORYPOOL_MAGAZINES
+
+	enum
+	{
+		MAX_MAGAZINE_THREADS			= 16,		///< threads past this many always go to the blobs
+		MAGAZINE_CAPACITY					= 32,		///< a magazine holding more blocks than this gets drained
+		MAGAZINE_BATCH						= 16,		///< number of blocks moved by each refill or drain
+		MAGAZINE_STRIDE						= 64,		///< bytes per magazine, so no two threads share a cache line
+		MAGAZINE_SLOT_NONE				= -1,		///< every slot was taken when this thread asked for one
+		MAGAZINE_SLOT_UNASSIGNED	= -2		///< this thread hasn't asked for a slot yet
+	};
+
+#endif
+
 // ----------------------------------------------------------------------------
 // PRIVATE DATA 
 // ----------------------------------------------------------------------------
@@ -227,6 +250,33 @@ namespace
 #endif
 
 
+#endif
+
+#ifdef MEMORYPOOL_MAGAZINES
+
+	/// only ever cleared by the magazine test, to time the plain locked path.
+	static std::atomic<Bool> theMagazinesEnabled(true);
+
+	/// one bit per magazine slot. a thread keeps its slot until it exits.
+	static std::atomic<UnsignedInt> theMagazineSlotsInUse(0);
+
+	/** 
+		the calling thread's magazine slot. the slot is given back when the thread exits, but the
+		blocks in its magazines stay put for whichever thread takes the slot next.
+	*/
+	struct MagazineSlot
+	{
+		Int m_slot;
+
+		MagazineSlot() : m_slot(MAGAZINE_SLOT_UNASSIGNED) { }
+		~MagazineSlot()
+		{
+			if (m_slot >= 0)
+				theMagazineSlotsInUse.fetch_and(~(1u << m_slot));
+		}
+	};
+	static thread_local MagazineSlot theMagazineSlot;
+
 #endif
 
 static Bool thePreMainInitFlag = false;
@@ -249,6 +299,9 @@ static void doStackDumpOutput(const char* m);
 static void doStackDump(void **stacktrace, int size);
 #endif
 static void preMainInitMemoryManager();
+#ifdef MEMORYPOOL_MAGAZINES
+static Int getMagazineSlot();
+#endif
 
 // ----------------------------------------------------------------------------
 // PRIVATE FUNCTIONS 
@@ -261,6 +314,33 @@ static Int roundUpMemBound(Int i)
 	return (i + (MEM_BOUND_ALIGNMENT-1)) & ~(MEM_BOUND_ALIGNMENT-1);
 }
 
+#ifdef MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+/** 
+	return the calling thread's magazine slot, claiming a free one the first time
+	the thread asks. returns MAGAZINE_SLOT_NONE if they're all taken.
+*/
+static Int getMagazineSlot()
+{
+	Int slot = theMagazineSlot.m_slot;
+	if (slot == MAGAZINE_SLOT_UNASSIGNED)
+	{
+		slot = MAGAZINE_SLOT_NONE;
+		for (Int i = 0; i < MAX_MAGAZINE_THREADS; ++i)
+		{
+			UnsignedInt bit = 1u << i;
+			if ((theMagazineSlotsInUse.fetch_or(bit) & bit) == 0)
+			{
+				slot = i;
+				break;
+			}
+		}
+		theMagazineSlot.m_slot = slot;
+	}
+	return slot;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 /**
 	identical to sysAllocateDoNotZero, except that the memory block returned
@@ -570,6 +650,22 @@ public:
 
 };
 
+// ----------------------------------------------------------------------------
+#ifdef MEMORYPOOL_MAGAZINES
+/**
+	A short stack of free blocks that sits in front of a pool's blobs. Every pool has one of these
+	per thread slot, and only the thread holding the slot ever touches it, so taking a block from
+	(or giving one back to) a magazine needs no lock. As far as the blobs are concerned, blocks in
+	a magazine are in use; they only go back to their blobs when the magazine is drained.
+*/
+struct MemoryPoolMagazine
+{
+	MemoryPoolSingleBlock		*m_firstBlock;			///< top of the stack, linked thru the blocks' next-free ptrs
+	Int											m_count;						///< number of blocks on the stack
+	char										m_pad[MAGAZINE_STRIDE - sizeof(MemoryPoolSingleBlock *) - sizeof(Int)];
+};
+#endif
+
 // ----------------------------------------------------------------------------
 // PUBLIC DATA 
 // ----------------------------------------------------------------------------
@@ -1565,9 +1661,14 @@ MemoryPool::MemoryPool() :
 	m_usedBlocksInPool(0),
 	m_totalBlocksInPool(0),
 	m_peakUsedBlocksInPool(0),
+	m_overflowBlobsCreated(0),
 	m_firstBlob(NULL),
 	m_lastBlob(NULL),
 	m_firstBlobWithFreeBlocks(NULL)
+#ifdef MEMORYPOOL_MAGAZINES
+	, m_magazines(NULL),
+	m_magazineMemory(NULL)
+#endif
 {
 }
 
@@ -1586,10 +1687,21 @@ void MemoryPool::init(MemoryPoolFactory *factory, const char *poolName, Int allo
 	m_usedBlocksInPool = 0;
 	m_totalBlocksInPool = 0;
 	m_peakUsedBlocksInPool = 0;
+	m_overflowBlobsCreated = 0;
 	m_firstBlob = NULL;
 	m_lastBlob = NULL;
 	m_firstBlobWithFreeBlocks = NULL;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// a pool that can't grow can't afford to have its last free blocks stuck in
+	// some other thread's magazine, so it always goes to the blobs.
+	if (m_magazines == NULL && m_overflowAllocationCount > 0)
+	{
+		m_magazineMemory = ::sysAllocate(MAX_MAGAZINE_THREADS*sizeof(MemoryPoolMagazine) + MAGAZINE_STRIDE);	// zeroed, so every magazine starts empty
+		m_magazines = (MemoryPoolMagazine *)(((uintptr_t)m_magazineMemory + MAGAZINE_STRIDE-1) & ~(uintptr_t)(MAGAZINE_STRIDE-1));
+	}
+#endif
+
 	// go ahead and init the initial block here (will throw on failure)
 	createBlob(m_initialAllocationCount);
 }
@@ -1600,12 +1712,20 @@ void MemoryPool::init(MemoryPoolFactory *factory, const char *poolName, Int allo
 */
 MemoryPool::~MemoryPool()
 {   
+	flushMagazines();
+
 	// toss everything. we could do this slightly more efficiently,
 	// but not really worth the extra code to do so.
 	while (m_firstBlob) 
 	{
 		freeBlob(m_firstBlob);
 	}
+
+#ifdef MEMORYPOOL_MAGAZINES
+	::sysFree(m_magazineMemory);
+	m_magazineMemory = NULL;
+	m_magazines = NULL;
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -1683,14 +1803,13 @@ Int MemoryPool::freeBlob(MemoryPoolBlob* blob)
 
 //-----------------------------------------------------------------------------
 /**
-	allocate a block from this pool and return it, but don't bother zeroing
-	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
-	function will never return null.
+	take a free block out of the blobs and count it as used. if no blob has a free
+	block, add an overflow blob -- or, if allowGrowth is false, return null. throws
+	ERROR_OUT_OF_MEMORY if the pool needs to grow but isn't allowed to.
+	the caller must hold TheMemoryPoolCriticalSection.
 */
-void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+MemoryPoolSingleBlock *MemoryPool::takeBlockFromBlobs(Bool allowGrowth DECLARE_LITERALSTRING_ARG2)
 {
-	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
-
 	if (m_firstBlobWithFreeBlocks != NULL && !m_firstBlobWithFreeBlocks->hasAnyFreeBlocks()) 
 	{
 		// hmm... the current 'free' blob has nothing available. look and see if there
@@ -1711,13 +1830,18 @@ void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG
 	// allocate an overflow block.
 	if (m_firstBlobWithFreeBlocks == NULL) 
 	{
-		if (m_overflowAllocationCount == 0)
+		if (!allowGrowth)
+		{
+			return NULL;
+		}
+		else if (m_overflowAllocationCount == 0)
 		{
 			throw ERROR_OUT_OF_MEMORY;	// this pool is not allowed to grow
 		}
 		else 
 		{
 			createBlob(m_overflowAllocationCount); // throws on failure
+			++m_overflowBlobsCreated;
 		}
 	}
 	
@@ -1728,17 +1852,151 @@ void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG
 	MemoryPoolSingleBlock *block = blob->allocateSingleBlock(PASS_LITERALSTRING_ARG1);
 	DEBUG_ASSERTCRASH(block, ("should not fail here"));
 
+	// bookkeeping
+	++m_usedBlocksInPool;
+	if (m_peakUsedBlocksInPool < m_usedBlocksInPool)
+		m_peakUsedBlocksInPool = m_usedBlocksInPool;
+
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give a block back to its blob, and count it as free again.
+	the caller must hold TheMemoryPoolCriticalSection.
+*/
+void MemoryPool::returnBlockToBlobs(MemoryPoolSingleBlock *block)
+{
+	MemoryPoolBlob *blob = block->getOwningBlob();
+
+	blob->freeSingleBlock(block);
+	
+	// if we want to free the blobs as they become empty, do that here.
+	// normally we don't bother, but just in case this is ever desired, here's how you'd do it...
+	//
+	// if (blob->m_usedBlocksInBlob == 0) 
+	// {
+	//	freeBlob(blob);
+	//	return;
+	//} 
+	
+	if (!m_firstBlobWithFreeBlocks)
+		m_firstBlobWithFreeBlocks = blob;
+
+	// bookkeeping
+	--m_usedBlocksInPool;
+}
+
+#ifdef MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+/**
+	return the calling thread's magazine for this pool, or null if the thread
+	has no slot (or the pool has no magazines) and must go to the blobs.
+*/
+inline MemoryPoolMagazine *MemoryPool::getMagazine()
+{
+	if (m_magazines == NULL || !theMagazinesEnabled.load(std::memory_order_relaxed))
+		return NULL;
+
+	Int slot = getMagazineSlot();
+	return (slot >= 0) ? &m_magazines[slot] : NULL;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	move up to count free blocks from the blobs into the magazine. only the first
+	block is allowed to grow the pool; after that we make do with what's already
+	free, so a refill never adds a blob before anybody actually needs it.
+	the caller must hold TheMemoryPoolCriticalSection.
+*/
+void MemoryPool::refillMagazine(MemoryPoolMagazine *magazine, Int count)
+{
+	for (Int i = 0; i < count; ++i)
+	{
+		MemoryPoolSingleBlock *block = takeBlockFromBlobs(i == 0);	// throws on failure
+		if (block == NULL)
+			break;
+
+		block->setNextFreeBlock(magazine->m_firstBlock);
+		magazine->m_firstBlock = block;
+		++magazine->m_count;
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	move up to count blocks from the magazine back into their blobs.
+	the caller must hold TheMemoryPoolCriticalSection.
+*/
+void MemoryPool::drainMagazine(MemoryPoolMagazine *magazine, Int count)
+{
+	for (; count > 0 && magazine->m_firstBlock != NULL; --count)
+	{
+		MemoryPoolSingleBlock *block = magazine->m_firstBlock;
+		magazine->m_firstBlock = block->getNextFreeBlock();
+		--magazine->m_count;
+
+		returnBlockToBlobs(block);
+	}
+}
+#endif
+
+//-----------------------------------------------------------------------------
+/**
+	put the blocks in every thread's magazine back into the blobs. the other threads'
+	magazines are theirs alone while they're running, so this must only be called when
+	nobody else is using the pool.
+*/
+void MemoryPool::flushMagazines()
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	if (m_magazines == NULL)
+		return;
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	for (Int i = 0; i < MAX_MAGAZINE_THREADS; ++i)
+	{
+		drainMagazine(&m_magazines[i], m_magazines[i].m_count);
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/**
+	allocate a block from this pool and return it, but don't bother zeroing
+	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
+	function will never return null.
+*/
+void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine *magazine = getMagazine();
+	if (magazine)
+	{
+		if (magazine->m_count == 0)
+		{
+			ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+			refillMagazine(magazine, MAGAZINE_BATCH);	// throws on failure
+		}
+
+		MemoryPoolSingleBlock *block = magazine->m_firstBlock;
+		magazine->m_firstBlock = block->getNextFreeBlock();
+		--magazine->m_count;
+		return block->getUserData();
+	}
+#endif
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	MemoryPoolSingleBlock *block = takeBlockFromBlobs(TRUE PASS_LITERALSTRING_ARG2);	// throws on failure
+
 #ifdef MEMORYPOOL_CHECKPOINTING
 	BlockCheckpointInfo *bi = debugAddCheckpointInfo(block->debugGetLiteralTagString(), m_factory->getCurCheckpoint(), getAllocationSize());
 	if (bi)
 		block->debugSetCheckpointInfo(bi);
 #endif
 
-	// bookkeeping
-	++m_usedBlocksInPool;
-	if (m_peakUsedBlocksInPool < m_usedBlocksInPool)
-		m_peakUsedBlocksInPool = m_usedBlocksInPool;
-
 #ifdef MEMORYPOOL_DEBUG
 	m_factory->adjustTotals(debugLiteralTagString, 1*getAllocationSize(), 0);
 	#ifdef USE_FILLER_VALUE
@@ -1774,15 +2032,29 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;	// my, that was easy
 
+	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
+	DEBUG_ASSERTCRASH(block->getOwningBlob() && block->getOwningBlob()->getOwningPool() == this, ("block does not belong to this pool"));
+
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine *magazine = getMagazine();
+	if (magazine)
+	{
+		block->setNextFreeBlock(magazine->m_firstBlock);
+		magazine->m_firstBlock = block;
+		if (++magazine->m_count > MAGAZINE_CAPACITY)
+		{
+			ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+			drainMagazine(magazine, MAGAZINE_BATCH);
+		}
+		return;
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
-	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
-	MemoryPoolBlob *blob = block->getOwningBlob();
 #ifdef MEMORYPOOL_DEBUG
 	const char* tagString = block->debugGetLiteralTagString();
 #endif
-	
-	DEBUG_ASSERTCRASH(blob && blob->getOwningPool() == this, ("block does not belong to this pool"));
 
 #ifdef MEMORYPOOL_CHECKPOINTING
 	BlockCheckpointInfo *bi = block->debugGetCheckpointInfo();
@@ -1791,22 +2063,7 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 		bi->debugSetFreepoint(m_factory->getCurCheckpoint());
 #endif
 
-	blob->freeSingleBlock(block);
-	
-	// if we want to free the blobs as they become empty, do that here.
-	// normally we don't bother, but just in case this is ever desired, here's how you'd do it...
-	//
-	// if (blob->m_usedBlocksInBlob == 0) 
-	// {
-	//	freeBlob(blob);
-	//	return;
-	//} 
-	
-	if (!m_firstBlobWithFreeBlocks)
-		m_firstBlobWithFreeBlocks = blob;
-
-	// bookkeeping
-	--m_usedBlocksInPool;
+	returnBlockToBlobs(block);
 
 #ifdef MEMORYPOOL_DEBUG
 	m_factory->adjustTotals(tagString, -1*getAllocationSize(), 0);
@@ -1835,6 +2092,14 @@ Int MemoryPool::releaseEmpties()
 {
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// our own magazine may be all that's keeping a blob alive. (the other threads' magazines
+	// are still in use, so those blobs will just have to wait.)
+	MemoryPoolMagazine *magazine = getMagazine();
+	if (magazine)
+		drainMagazine(magazine, magazine->m_count);
+#endif
+
 	Int released = 0;
 
 	for (MemoryPoolBlob* blob = m_firstBlob; blob;) 
@@ -1856,6 +2121,9 @@ void MemoryPool::reset()
 {
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
+	// nobody can be using the pool while it's reset, so it's safe to take back every magazine.
+	flushMagazines();
+
 	// toss everything. we could do this slightly more efficiently,
 	// but not really worth the extra code to do so.
 	while (m_firstBlob) 
@@ -2066,7 +2334,7 @@ DynamicMemoryAllocator::DynamicMemoryAllocator() :
 	m_factory(NULL),
 	m_nextDmaInFactory(NULL),
 	m_numPools(0),
-	m_usedBlocksInDma(0),
+	m_rawBlocksInDma(0),
 	m_rawBlocks(NULL)
 {
 	for (Int i = 0; i < MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS; i++)
@@ -2102,7 +2370,7 @@ void DynamicMemoryAllocator::init(MemoryPoolFactory *factory, Int numSubPools, c
 	m_numPools = numSubPools;
 	if (m_numPools > MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS)
 		m_numPools = MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS;
-	m_usedBlocksInDma = 0;
+	m_rawBlocksInDma = 0;
 	for (Int i = 0; i < m_numPools; i++)
 	{
 		DEBUG_ASSERTCRASH(i == 0 || pParms[i].allocationSize > pParms[i-1].allocationSize, ("alloc size must increase monotonically for DMA"));
@@ -2116,7 +2384,7 @@ void DynamicMemoryAllocator::init(MemoryPoolFactory *factory, Int numSubPools, c
 */
 DynamicMemoryAllocator::~DynamicMemoryAllocator()
 {
-	DEBUG_ASSERTCRASH(m_usedBlocksInDma == 0, ("destroying a nonempty dma"));
+	DEBUG_ASSERTCRASH(m_rawBlocksInDma == 0, ("destroying a nonempty dma"));	// (the subpools check their own blocks)
 
 	/// @todo this may cause double-destruction of the subpools -- test & fix
 	for (Int i = 0; i < m_numPools; i++) 
@@ -2220,6 +2488,14 @@ void DynamicMemoryAllocator::debugIgnoreLeaksForThisBlock(void* pBlockPtr)
 */
 void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes DECLARE_LITERALSTRING_ARG2)
 {
+#ifdef MEMORYPOOL_MAGAZINES
+	// the subpools do their own locking (mostly none, thanks to the magazines), so only
+	// the raw blocks need the dma's lock.
+	MemoryPool *subPool = findPoolForSize(numBytes);
+	if (subPool != NULL)
+		return subPool->allocateBlockDoNotZeroImplementation(PASS_LITERALSTRING_ARG1);
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
 
 	void *result = NULL;
@@ -2254,6 +2530,7 @@ void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes
 	{
 		// too big for our pools -- just go right to the metal.
 		MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::rawAllocateSingleBlock(&m_rawBlocks, numBytes, m_factory PASS_LITERALSTRING_ARG2);
+		++m_rawBlocksInDma;
 
 #ifdef MEMORYPOOL_CHECKPOINTING
 		BlockCheckpointInfo *bi = debugAddCheckpointInfo(block->debugGetLiteralTagString(), m_factory->getCurCheckpoint(), numBytes);
@@ -2294,8 +2571,6 @@ void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes
 }
 #endif MEMORYPOOL_DEBUG
 
-	++m_usedBlocksInDma;
-	DEBUG_ASSERTCRASH(m_usedBlocksInDma >= 0, ("negative count for m_usedBlocksInDma"));
 #ifdef MEMORYPOOL_DEBUG
 	#ifdef USE_FILLER_VALUE
 	{
@@ -2329,6 +2604,18 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// as with allocation, only the raw blocks need the dma's lock.
+	{
+		MemoryPoolSingleBlock *subPoolBlock = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
+		if (subPoolBlock->getOwningBlob())
+		{
+			subPoolBlock->getOwningBlob()->getOwningPool()->freeBlock(pBlockPtr);
+			return;
+		}
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
 
 #ifdef MEMORYPOOL_CHECK_BLOCK_OWNERSHIP
@@ -2392,9 +2679,9 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 
 		::sysFree((void *)block);
 
+		--m_rawBlocksInDma;
+		DEBUG_ASSERTCRASH(m_rawBlocksInDma >= 0, ("negative count for m_rawBlocksInDma"));
 	}
-	--m_usedBlocksInDma;
-	DEBUG_ASSERTCRASH(m_usedBlocksInDma >= 0, ("negative count for m_usedBlocksInDma"));
 
 #ifdef INTENSE_DMA_BOOKKEEPING
 	if (isMemoryManagerOfficiallyInited() && doingIntenseDMA == 0)
@@ -2437,7 +2724,7 @@ void DynamicMemoryAllocator::reset()
 	while (m_rawBlocks)
 		freeBytes(m_rawBlocks->getUserData());
 
-	m_usedBlocksInDma = 0;
+	m_rawBlocksInDma = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -2749,6 +3036,8 @@ void MemoryPoolFactory::destroyMemoryPool(MemoryPool *pMemoryPool)
 	if (!pMemoryPool)
 		return;
 
+	// blocks parked in magazines count as used, so hand them back before checking
+	pMemoryPool->flushMagazines();
 	DEBUG_ASSERTCRASH(pMemoryPool->getUsedBlockCount() == 0, ("destroying a nonempty pool"));
 
 	pMemoryPool->removeFromList(&m_firstPoolInFactory);
@@ -3278,6 +3567,115 @@ void MemoryPoolFactory::debugMemoryReport(Int flags, Int startCheckpoint, Int en
 }
 #endif
 
+#ifdef TEST_MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+struct MagazineTestThread
+{
+	MemoryPool	*m_pool;
+	Int					m_marker;		///< written into every block this thread holds
+	Int					m_errors;		///< blocks whose marker got changed under us
+};
+
+//-----------------------------------------------------------------------------
+/**
+	a burst of allocs, then the frees in a different order -- roughly what a frame
+	does to the message and contact pools. every block is stamped while we hold it,
+	so a block handed to two threads at once shows up as an error.
+*/
+static void magazineTestThreadProc(MagazineTestThread *t)
+{
+	enum { HELD = 48, ROUNDS = 20000 };
+	void *held[HELD];
+	for (Int round = 0; round < ROUNDS; ++round)
+	{
+		for (Int i = 0; i < HELD; ++i)
+		{
+			held[i] = t->m_pool->allocateBlockDoNotZero("MagazineTest");
+			*(Int *)held[i] = t->m_marker;
+		}
+		for (Int i = 0; i < HELD; ++i)
+		{
+			Int j = (i * 7) % HELD;
+			if (*(Int *)held[j] != t->m_marker)
+				++t->m_errors;
+			t->m_pool->freeBlock(held[j]);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	time alloc/free from 1, 2, 4... threads on a few of the busiest pools, going
+	straight to the blobs and then thru the magazines, and log the results.
+*/
+void MemoryPoolFactory::doMagazineTest()
+{
+	static const char *const poolNames[] = { "GameMessage", "SimpleObjectIteratorPool", "NameKeyBucketPool" };
+
+	// the locked path needs a real lock to be worth timing, and tools may not have set one up
+	CriticalSection testCriticalSection;
+	CriticalSection *oldCriticalSection = TheMemoryPoolCriticalSection;
+	if (TheMemoryPoolCriticalSection == NULL)
+		TheMemoryPoolCriticalSection = &testCriticalSection;
+
+	Int maxThreads = (Int)std::thread::hardware_concurrency();
+	if (maxThreads < 1)
+		maxThreads = 1;
+	if (maxThreads > 8)
+		maxThreads = 8;
+
+	for (Int p = 0; p < sizeof(poolNames)/sizeof(poolNames[0]); ++p)
+	{
+		MemoryPool *pool = findMemoryPool(poolNames[p]);
+		if (pool == NULL)
+		{
+			DEBUG_LOG(("MagazineTest - pool %s hasn't been created yet, skipping it\n", poolNames[p]));
+			continue;
+		}
+
+		for (Int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+		{
+			Int64 elapsed[2] = { 0, 0 };
+			Int errors = 0;
+			for (Int pass = 0; pass < 2; ++pass)
+			{
+			#ifdef MEMORYPOOL_MAGAZINES
+				theMagazinesEnabled = (pass == 1);
+			#endif
+
+				std::vector<MagazineTestThread> testThreads(numThreads);
+				std::vector<std::thread> threads;
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (Int i = 0; i < numThreads; ++i)
+				{
+					testThreads[i].m_pool = pool;
+					testThreads[i].m_marker = 0x4d470000 | i;
+					testThreads[i].m_errors = 0;
+					threads.push_back(std::thread(magazineTestThreadProc, &testThreads[i]));
+				}
+				for (Int i = 0; i < numThreads; ++i)
+				{
+					threads[i].join();
+					errors += testThreads[i].m_errors;
+				}
+				elapsed[pass] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			DEBUG_LOG(("MagazineTest - %s, %d threads: locked %d us, magazines %d us (%.2fx), %d errors\n",
+				poolNames[p], numThreads, (Int)elapsed[0], (Int)elapsed[1],
+				elapsed[1] > 0 ? (Real)elapsed[0] / (Real)elapsed[1] : 0.0f, errors));
+		}
+	}
+
+#ifdef MEMORYPOOL_MAGAZINES
+	theMagazinesEnabled = true;
+#else
+	DEBUG_LOG(("MagazineTest - magazines are compiled out of this build, so both passes were locked\n"));
+#endif
+	TheMemoryPoolCriticalSection = oldCriticalSection;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // GLOBAL FUNCTIONS
 //-----------------------------------------------------------------------------
@@ -0,0 +1,144 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------
+//
+// Project:   RTS
+//
+// Module:    IO
+//
+// File name: MappedArchiveFile.cpp
+//
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+//         Includes                                                      
+//----------------------------------------------------------------------------
+
+#include "PreRTS.h"
+#include <string.h>
+#include "Common/AsciiString.h"
+#include "Common/MappedArchiveFile.h"
+
+//=================================================================
+// MappedArchiveFile::MappedArchiveFile
+//=================================================================
+
+MappedArchiveFile::MappedArchiveFile()
+{
+}
+
+//=================================================================
+// MappedArchiveFile::~MappedArchiveFile	
+//=================================================================
+
+MappedArchiveFile::~MappedArchiveFile()
+{
+	// the data belongs to the archive, don't let RAMFile delete it
+	m_data = NULL;
+	File::close();
+}
+
+//============================================================================
+// MappedArchiveFile::open
+//============================================================================
+
+Bool MappedArchiveFile::open( File * /*file*/ )
+{
+	DEBUG_CRASH(("MappedArchiveFile can only be opened from an archive image.\n"));
+	return FALSE;
+}
+
+//============================================================================
+// MappedArchiveFile::openFromArchive
+//============================================================================
+
+Bool MappedArchiveFile::openFromArchive(File * /*archiveFile*/, const AsciiString& /*filename*/, Int /*offset*/, Int /*size*/) 
+{
+	DEBUG_CRASH(("MappedArchiveFile can only be opened from an archive image.\n"));
+	return FALSE;
+}
+
+//============================================================================
+// MappedArchiveFile::openFromImage
+//============================================================================
+
+Bool MappedArchiveFile::openFromImage(const AsciiString& filename, const char *data, Int size) 
+{
+	if (data == NULL || size < 0) {
+		return FALSE;
+	}
+
+	if (File::open(filename.str(), File::READ | File::BINARY) == FALSE) {
+		return FALSE;
+	}
+
+	// RAMFile never writes through m_data, so we can look at the archive's image directly
+	m_data = (Char *)data;
+	m_size = size;
+	m_pos = 0;
+	m_nameStr = filename;
+	return TRUE;
+}
+
+//=================================================================
+// MappedArchiveFile::close 	
+//=================================================================
+
+void MappedArchiveFile::close( void )
+{
+	m_data = NULL;
+	File::close();
+}
+
+//=================================================================
+// MappedArchiveFile::write 
+//=================================================================
+
+Int MappedArchiveFile::write( const void * /*buffer*/, Int /*bytes*/ )
+{
+	DEBUG_CRASH(("Cannot write to archived files.\n"));
+	return -1;
+}
+
+//=================================================================
+// MappedArchiveFile::readEntireAndClose
+//=================================================================
+
+char* MappedArchiveFile::readEntireAndClose()
+{
+	if (m_data == NULL)
+	{
+		DEBUG_CRASH(("m_data is NULL in MappedArchiveFile::readEntireAndClose -- should not happen!\n"));
+		return NEW char[1];	// just to avoid crashing...
+	}
+
+	// the caller owns what we hand back, so it has to be a copy
+	char* tmp = NEW char[ m_size ];
+	memcpy(tmp, m_data, m_size);
+
+	close();
+
+	return tmp;
+}
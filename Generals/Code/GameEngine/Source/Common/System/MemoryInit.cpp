@@ -43,12 +43,8 @@
 // ----------------------------------------------------------------------------
 #include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
 
-#include <array>
 #include <cstdio>
 #include <cstring>
-#include <filesystem>
-#include <string>
-#include <system_error>
 
 // SYSTEM INCLUDES
 
@@ -63,23 +59,33 @@
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 #endif
 
+//-----------------------------------------------------------------------------
+// not const -- we might override from INI
+static PoolInitRec dmaParms[] = 
+{
+	// name, allocsize, initialcount, overflowcount
+	{ "dmaPool_16", 16,			65536,	1024 },
+	{ "dmaPool_32", 32,			150000,	1024 },
+	{ "dmaPool_64", 64,			60000,	1024 },
+	{ "dmaPool_128", 128,		32768,	1024 },
+	{ "dmaPool_256", 256,		8192,		1024 },
+	{ "dmaPool_512", 512,		8192,		1024 },
+	{ "dmaPool_1024", 1024, 24000,	1024 }
+};
+
+enum { NUM_DMA_POOLS = sizeof(dmaParms)/sizeof(dmaParms[0]) };
+
+static void loadPoolSizeFiles();
+
 //-----------------------------------------------------------------------------
 void userMemoryManagerGetDmaParms(Int *numSubPools, const PoolInitRec **pParms)
 {
-	static const PoolInitRec defaultDMA[7] = 
-	{
-		// name, allocsize, initialcount, overflowcount
-		{ "dmaPool_16", 16,			65536,	1024 },
-		{ "dmaPool_32", 32,			150000,	1024 },
-		{ "dmaPool_64", 64,			60000,	1024 },
-		{ "dmaPool_128", 128,		32768,	1024 },
-		{ "dmaPool_256", 256,		8192,		1024 },
-		{ "dmaPool_512", 512,		8192,		1024 },
-		{ "dmaPool_1024", 1024, 24000,	1024 }
-	};
-
-	*numSubPools = 7;
-	*pParms = defaultDMA;
+	// the dma is created before any of the named pools, so this is our first chance
+	// to apply MemoryPools.ini (and any recorded profile) to its subpools.
+	loadPoolSizeFiles();
+
+	*numSubPools = NUM_DMA_POOLS;
+	*pParms = dmaParms;
 }
 
 //-----------------------------------------------------------------------------
@@ -90,12 +96,27 @@ struct PoolSizeRec
 	Int overflow;
 };
 
+//-----------------------------------------------------------------------------
+// what the pool profile needs to know about each PoolSizeRec; kept alongside, not in it, so
+// the size tables stay plain name/initial/overflow triples.
+struct PoolProfileRec
+{
+	Int baseInitial;				///< initial as of MemoryPools.ini, before MemoryPoolProfile.ini got at it
+	Int baseOverflow;				///< overflow as of MemoryPools.ini, before MemoryPoolProfile.ini got at it
+	Int recordedPeak;				///< peak usage recorded in MemoryPoolProfile.ini by earlier sessions, 0 if none
+	Bool profileWritten;		///< used by writeMemoryPoolProfile()
+};
+
+//-----------------------------------------------------------------------------
+// the dma's subpools, filled in from dmaParms so the INI files can size them like any other pool
+static PoolSizeRec dmaSizes[NUM_DMA_POOLS];
+static PoolProfileRec dmaProfiles[NUM_DMA_POOLS];
+
 //-----------------------------------------------------------------------------
 // And please be careful of duplicates.  They are not rejected.
 // not const -- we might override from INI
 static PoolSizeRec sizes[] = 
 {
-	{ "PartitionContactListNode", 2048, 512 },
 	{ "BattleshipUpdate", 32, 32 },
 	{ "FlyToDestAndDestroyUpdate", 32, 32 },
 	{ "MusicTrack", 32, 32 },
@@ -160,7 +181,6 @@ static PoolSizeRec sizes[] =
 	{ "LocomotorTemplate", 128, 32	},
 	{ "ObjectPool", 4096, 32 },
 	{ "SimpleObjectIteratorPool", 32, 32 },
-	{ "SimpleObjectIteratorClumpPool", 4096, 32 },
 	{ "PartitionDataPool", 4096, 32 },
 	{ "BuildEntry", 32, 32 },
 	{ "Weapon", 4096, 32 },
@@ -518,6 +538,7 @@ static PoolSizeRec sizes[] =
 	{ "SequentialScript", 32, 32 },
 	{ "Win32LocalFile", 1024, 256 },
 	{ "RAMFile", 32, 32 },
+	{ "MappedArchiveFile", 32, 32 },
 	{ "BattlePlanBonuses", 32, 32 },
 	{ "KindOfPercentProductionChange", 32, 32 },
 	{ "UserParser", 4096, 256 },
@@ -679,6 +700,9 @@ static PoolSizeRec sizes[] =
 	{ 0, 0, 0 }
 };
 
+// one per entry in sizes[], sentinel included
+static PoolProfileRec sizeProfiles[sizeof(sizes) / sizeof(sizes[0])];
+
 //-----------------------------------------------------------------------------
 void userMemoryAdjustPoolSize(const char *poolName, Int& initialAllocationCount, Int& overflowAllocationCount)
 {
@@ -710,89 +734,313 @@ static Int roundUpMemBound(Int i)
 }
 
 //-----------------------------------------------------------------------------
-void userMemoryManagerInitPools()
+static PoolSizeRec* findPoolSizeRec(const char *poolName)
+{
+	for (PoolSizeRec* p = sizes; p->name != NULL; ++p)
+	{
+		if (stricmp(p->name, poolName) == 0)
+			return p;
+	}
+
+	for (Int i = 0; i < NUM_DMA_POOLS; ++i)
+	{
+		if (stricmp(dmaSizes[i].name, poolName) == 0)
+			return &dmaSizes[i];
+	}
+
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+static PoolProfileRec* getPoolProfileRec(const PoolSizeRec* p)
+{
+	if (p >= dmaSizes && p < dmaSizes + NUM_DMA_POOLS)
+		return &dmaProfiles[p - dmaSizes];
+	return &sizeProfiles[p - sizes];
+}
+
+//-----------------------------------------------------------------------------
+enum { POOL_SIZE_PATH_LEN = 4096 };
+
+//-----------------------------------------------------------------------------
+static Bool poolSizeFileExists(const char *path)
+{
+	FILE* fp = std::fopen(path, "r");
+	if (fp == NULL)
+		return false;
+	std::fclose(fp);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	return the directory (with trailing slash) that MemoryPools.ini and MemoryPoolProfile.ini live in.
+	since we're called prior to main, the cur dir might not be what we expect, so look next to the
+	executable first, then under the cur dir. this runs before the dma exists, so it must not
+	touch the heap: char buffers only.
+*/
+static void getPoolSizeFileDir(char *dir, Int dirLen)
+{
+	char exeDir[POOL_SIZE_PATH_LEN];
+	exeDir[0] = 0;
+
+	const DWORD length = ::GetModuleFileName(NULL, exeDir, sizeof(exeDir));
+	if (length > 0 && length < sizeof(exeDir))
+	{
+		char *slash = std::strrchr(exeDir, '/');
+		char *backslash = std::strrchr(exeDir, '\\');
+		if (backslash > slash)
+			slash = backslash;
+		if (slash)
+			slash[1] = 0;
+		else
+			exeDir[0] = 0;
+	}
+	else
+	{
+		exeDir[0] = 0;
+	}
+
+	char candidate[POOL_SIZE_PATH_LEN];
+	if (exeDir[0] != 0)
+	{
+		std::snprintf(candidate, sizeof(candidate), "%sData/INI/MemoryPools.ini", exeDir);
+		if (poolSizeFileExists(candidate))
+		{
+			std::snprintf(dir, dirLen, "%sData/INI/", exeDir);
+			return;
+		}
+	}
+
+	if (poolSizeFileExists("Data/INI/MemoryPools.ini") || exeDir[0] == 0)
+		std::snprintf(dir, dirLen, "Data/INI/");
+	else
+		std::snprintf(dir, dirLen, "%sData/INI/", exeDir);
+}
+
+//-----------------------------------------------------------------------------
+/**
+	read pool sizes from the given file, one "name initial overflow" line per pool. a recorded
+	profile has a fourth column with the peak it was sized from; anything after that is ignored.
+*/
+static void readPoolSizeFile(const char *path)
+{
+	FILE* fp = std::fopen(path, "r");
+	if (fp == NULL)
+		return;
+
+	char buffer[1024];
+	char poolName[256];
+	int initial, overflow, peak;
+	while (std::fgets(buffer, sizeof(buffer), fp))
+	{
+		if (buffer[0] == ';')
+			continue;
+
+		const int fields = std::sscanf(buffer, "%255s %d %d %d", poolName, &initial, &overflow, &peak);
+		if (fields < 3)
+			continue;
+
+		PoolSizeRec* p = findPoolSizeRec(poolName);
+		if (p == NULL)
+			continue;
+
+		// currently, these must be multiples of 4. so round up.
+		p->initial = roundUpMemBound(initial);
+		p->overflow = roundUpMemBound(overflow);
+		if (fields == 4)
+			getPoolProfileRec(p)->recordedPeak = peak;
+	}
+	std::fclose(fp);
+}
+
+//-----------------------------------------------------------------------------
+static void loadPoolSizeFiles()
 {
 	// note that we MUST use stdio stuff here, and not the normal game file system
 	// (with bigfile support, etc), because that relies on memory pools, which
 	// aren't yet initialized properly! so rely ONLY on straight stdio stuff here.
 	// (not even AsciiString. thanks.)
-	
-	// since we're called prior to main, the cur dir might not be what
-	// we expect. Resolve the location of the memory pool configuration relative to the executable when possible.
-	auto resolveMemoryPoolConfig = []() -> std::filesystem::path
+	static Bool loaded = false;
+	if (loaded)
+		return;
+	loaded = true;
+
+	for (Int i = 0; i < NUM_DMA_POOLS; ++i)
 	{
-		namespace fs = std::filesystem;
-		std::array<char, 4096> modulePath{};
-		fs::path baseDir;
-		const auto length = ::GetModuleFileName(nullptr, modulePath.data(), static_cast<unsigned long>(modulePath.size()));
-		if (length > 0)
-		{
-			baseDir = fs::path(modulePath.data()).parent_path();
-		}
-		else
-		{
-			std::error_code ec;
-			baseDir = fs::current_path(ec);
-			if (ec)
-			{
-				baseDir.clear();
-			}
-		}
-		auto buildPath = [](const fs::path& root) {
-			fs::path result = root;
-			result /= "Data";
-			result /= "INI";
-			result /= "MemoryPools.ini";
-			return result;
-		};
-
-		std::error_code ec;
-		if (!baseDir.empty())
-		{
-			fs::path candidate = buildPath(baseDir);
-			if (fs::exists(candidate, ec))
-			{
-				return candidate;
-			}
-		}
+		dmaSizes[i].name = dmaParms[i].poolName;
+		dmaSizes[i].initial = dmaParms[i].initialAllocationCount;
+		dmaSizes[i].overflow = dmaParms[i].overflowAllocationCount;
+	}
 
-		fs::path fallback = buildPath(fs::path{});
-		if (fs::exists(fallback, ec))
-		{
-			return fallback;
-		}
+	char dir[POOL_SIZE_PATH_LEN];
+	getPoolSizeFileDir(dir, sizeof(dir));
+
+	char path[POOL_SIZE_PATH_LEN];
+	std::snprintf(path, sizeof(path), "%sMemoryPools.ini", dir);
+	readPoolSizeFile(path);
+
+	// remember what the sizes would be without a profile, so a new profile can keep the
+	// MemoryPools.ini overflow and the report can compare against what we'd get without it.
+	for (PoolSizeRec* p = sizes; p->name != NULL; ++p)
+	{
+		getPoolProfileRec(p)->baseInitial = p->initial;
+		getPoolProfileRec(p)->baseOverflow = p->overflow;
+	}
+	for (Int i = 0; i < NUM_DMA_POOLS; ++i)
+	{
+		dmaProfiles[i].baseInitial = dmaSizes[i].initial;
+		dmaProfiles[i].baseOverflow = dmaSizes[i].overflow;
+	}
+
+	// a recorded profile is read last, so it wins over MemoryPools.ini. delete it to go back.
+	std::snprintf(path, sizeof(path), "%sMemoryPoolProfile.ini", dir);
+	readPoolSizeFile(path);
+
+	for (Int i = 0; i < NUM_DMA_POOLS; ++i)
+	{
+		dmaParms[i].initialAllocationCount = dmaSizes[i].initial;
+		dmaParms[i].overflowAllocationCount = dmaSizes[i].overflow;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void userMemoryManagerInitPools()
+{
+	// normally already done by userMemoryManagerGetDmaParms().
+	loadPoolSizeFiles();
+}
+
+//-----------------------------------------------------------------------------
+/**
+	predict how a pool sized with the given counts would have coped with the given peak: how many
+	blobs it would have needed (every overflow blob is another separate chunk of system memory,
+	so this is our measure of fragmentation), and how many blocks would have sat unused at the peak.
+*/
+static void predictPoolCost(Int peak, Int initial, Int overflow, Int& blobs, Int& unusedBlocks)
+{
+	Int capacity = initial;
+	blobs = 1;
+	if (peak > initial && overflow > 0)
+	{
+		const Int overflowBlobs = (peak - initial + overflow - 1) / overflow;
+		blobs += overflowBlobs;
+		capacity += overflowBlobs * overflow;
+	}
+	unusedBlocks = (capacity > peak) ? capacity - peak : 0;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	a pool that wasn't created this session keeps whatever an earlier session recorded for it.
+	returns the number of lines written, and clears profileWritten for next time.
+*/
+static Int finishPoolProfileRec(FILE* profile, PoolSizeRec* p)
+{
+	PoolProfileRec* prof = getPoolProfileRec(p);
+	Int written = 0;
+	if (!prof->profileWritten && prof->recordedPeak > 0)
+	{
+		std::fprintf(profile, "%s %d %d %d 0\n", p->name, p->initial, prof->baseOverflow, prof->recordedPeak);
+		written = 1;
+	}
+	prof->profileWritten = false;
+	return written;
+}
+
+//-----------------------------------------------------------------------------
+void writeMemoryPoolProfile()
+{
+	if (TheMemoryPoolFactory == NULL)
+		return;
+
+	// headroom on top of the recorded peak, as a fraction of it (1/8 == 12.5%)
+	const Int PROFILE_HEADROOM_DIVISOR = 8;
+
+	char dir[POOL_SIZE_PATH_LEN];
+	getPoolSizeFileDir(dir, sizeof(dir));
+
+	char path[POOL_SIZE_PATH_LEN];
+	std::snprintf(path, sizeof(path), "%sMemoryPoolProfile.ini", dir);
 
-		return baseDir.empty() ? fallback : buildPath(baseDir);
-	};
+	FILE* profile = std::fopen(path, "w");
+	if (profile == NULL)
+	{
+		DEBUG_CRASH(("could not create pool profile %s", path));
+		return;
+	}
+
+	FILE* report = std::fopen("MemoryPoolProfile.csv", "w");
+
+	std::fprintf(profile, "; MemoryPoolProfile.ini -- pool sizes recorded from peak usage by -recordPoolProfile.\n");
+	std::fprintf(profile, "; read after MemoryPools.ini, and wins over it. delete this file to go back to the MemoryPools.ini sizes.\n");
+	std::fprintf(profile, "; pool initial overflow peak overflowBlobsThisSession\n");
+	if (report)
+		std::fprintf(report, "Pool,BlockSize,Peak,BaseInitial,BaseOverflow,BaseBlobs,BaseUnusedKB,ProfileInitial,ProfileOverflow,ProfileBlobs,ProfileUnusedKB,ThisSessionInitial,ThisSessionBlobs\n");
 
-	const std::filesystem::path configPath = resolveMemoryPoolConfig();
-	const std::string configPathString = configPath.string();
-	FILE* fp = std::fopen(configPathString.c_str(), "r");
-	if (fp)
+	Int numPools = 0;
+	Int totalBaseBlobs = 0, totalBaseUnused = 0;
+	Int totalProfileBlobs = 0, totalProfileUnused = 0;
+	Int totalSessionBlobs = 0;
+
+	for (MemoryPool *pool = TheMemoryPoolFactory->getFirstMemoryPool(); pool; pool = pool->getNextPoolInList())
 	{
-		char poolName[256];
-		int initial, overflow;
-		std::array<char, 1024> buffer{};
-		while (std::fgets(buffer.data(), static_cast<int>(buffer.size()), fp))
+		PoolSizeRec* p = findPoolSizeRec(pool->getPoolName());
+		if (p == NULL)
+			continue;	// sized explicitly by whoever created it, so the tables have no say
+		PoolProfileRec* prof = getPoolProfileRec(p);
+		if (prof->profileWritten)
+			continue;
+
+		// keep the larger of this session's peak and the one recorded before, so that the
+		// profile covers every session that's been recorded into it, not just the last.
+		const Int sessionPeak = pool->getPeakBlockCount();
+		const Int peak = (sessionPeak > prof->recordedPeak) ? sessionPeak : prof->recordedPeak;
+		if (peak <= 0)
+			continue;
+
+		const Int initial = roundUpMemBound(peak + peak / PROFILE_HEADROOM_DIVISOR);
+		const Int overflow = prof->baseOverflow;
+		const Int sessionBlobs = 1 + pool->getOverflowBlobCount();
+
+		std::fprintf(profile, "%s %d %d %d %d\n", p->name, initial, overflow, peak, pool->getOverflowBlobCount());
+		prof->profileWritten = true;
+		++numPools;
+
+		Int baseBlobs, baseUnused, profileBlobs, profileUnused;
+		predictPoolCost(sessionPeak, prof->baseInitial, prof->baseOverflow, baseBlobs, baseUnused);
+		predictPoolCost(sessionPeak, initial, overflow, profileBlobs, profileUnused);
+
+		const Int blockSize = pool->getAllocationSize();
+		totalBaseBlobs += baseBlobs;
+		totalBaseUnused += baseUnused * blockSize / 1024;
+		totalProfileBlobs += profileBlobs;
+		totalProfileUnused += profileUnused * blockSize / 1024;
+		totalSessionBlobs += sessionBlobs;
+
+		if (report)
 		{
-			if (buffer[0] == ';')
-				continue;
-			if (std::sscanf(buffer.data(), "%s %d %d", poolName, &initial, &overflow) == 3)
-			{
-				for (PoolSizeRec* p = sizes; p->name != NULL; ++p)
-				{
-					if (stricmp(p->name, poolName) == 0)
-					{
-						// currently, these must be multiples of 4. so round up.
-						p->initial = roundUpMemBound(initial);
-						p->overflow = roundUpMemBound(overflow);
-						break;  // from for-p
-					}
-				}
-			}
+			std::fprintf(report, "%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", p->name, blockSize, sessionPeak,
+				prof->baseInitial, prof->baseOverflow, baseBlobs, baseUnused * blockSize / 1024,
+				initial, overflow, profileBlobs, profileUnused * blockSize / 1024,
+				pool->getInitialBlockCount(), sessionBlobs);
 		}
-		std::fclose(fp);
 	}
 
-}
+	for (PoolSizeRec* p = sizes; p->name != NULL; ++p)
+		numPools += finishPoolProfileRec(profile, p);
+	for (Int i = 0; i < NUM_DMA_POOLS; ++i)
+		numPools += finishPoolProfileRec(profile, &dmaSizes[i]);
 
+	if (report)
+	{
+		std::fprintf(report, "TOTAL,,,,,%d,%d,,,%d,%d,,%d\n", totalBaseBlobs, totalBaseUnused,
+			totalProfileBlobs, totalProfileUnused, totalSessionBlobs);
+		std::fclose(report);
+	}
+	std::fclose(profile);
+
+	DEBUG_LOG(("MemoryPoolProfile - recorded %d pools to %s\n", numPools, path));
+	DEBUG_LOG(("MemoryPoolProfile - with this session's peaks, the MemoryPools.ini sizes need %d blobs (%d KB unused at peak), the profile sizes %d blobs (%d KB unused); this session used %d blobs\n",
+		totalBaseBlobs, totalBaseUnused, totalProfileBlobs, totalProfileUnused, totalSessionBlobs));
+}
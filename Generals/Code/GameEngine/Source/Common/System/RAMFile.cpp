@@ -235,6 +235,35 @@ Bool RAMFile::openFromArchive(File *archiveFile, const AsciiString& filename, In
 	return TRUE;
 }
 
+//============================================================================
+// RAMFile::openFromBuffer
+//============================================================================
+/**
+	* Use data as the file's contents without copying it.  The RAMFile owns it
+	* from here on, and deletes it when closed, so it must have come from new[].
+	*/
+Bool RAMFile::openFromBuffer(const AsciiString& filename, Char *data, Int size)
+{
+	if (data == NULL) {
+		return FALSE;
+	}
+
+	if (File::open(filename.str(), File::READ | File::BINARY) == FALSE) {
+		delete[] data;
+		return FALSE;
+	}
+
+	if (m_data != NULL) {
+		delete[] m_data;
+	}
+	m_data = data;
+	m_size = size;
+	m_pos = 0;
+	m_nameStr = filename;
+
+	return TRUE;
+}
+
 //=================================================================
 // RAMFile::close 	
 //=================================================================
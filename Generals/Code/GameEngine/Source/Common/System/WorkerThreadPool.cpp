@@ -0,0 +1,194 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FILE: WorkerThreadPool.cpp /////////////////////////////////////////////////////////////////////
+// Desc:   Fork/join pool of worker threads
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES ///////////////////////////////////////////////////////////////////////////////////////
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/WorkerThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// GLOBALS ////////////////////////////////////////////////////////////////////////////////////////
+WorkerThreadPool *TheWorkerThreadPool = NULL;
+
+static thread_local Int s_workerIndex = 0;					///< pool thread we are running on, 0 if none
+static thread_local Bool s_insideParallelFor = FALSE;	///< true while this thread is running jobs
+
+// PRIVATE ////////////////////////////////////////////////////////////////////////////////////////
+struct WorkerThreadPoolImpl
+{
+	std::vector<std::thread>	m_threads;
+	std::mutex								m_mutex;
+	std::condition_variable		m_wake;						///< signalled when a batch is posted, or on shutdown
+	std::condition_variable		m_done;						///< signalled when the last worker finishes a batch
+	std::mutex								m_callerMutex;		///< only one thread may post a batch at a time
+
+	UnsignedInt								m_batch;					///< bumped every time a batch is posted
+	Int												m_workersBusy;		///< workers that haven't finished the current batch
+	Bool											m_quit;
+
+	WorkerJobProc							m_proc;
+	void*											m_userData;
+	Int												m_numJobs;
+	std::atomic<Int>					m_nextJob;
+
+	WorkerThreadPoolImpl() : m_batch(0), m_workersBusy(0), m_quit(FALSE),
+		m_proc(NULL), m_userData(NULL), m_numJobs(0), m_nextJob(0) {}
+
+	void runJobs( Int workerIndex )
+	{
+		for (;;)
+		{
+			Int job = m_nextJob.fetch_add(1);
+			if (job >= m_numJobs)
+				break;
+			m_proc(job, workerIndex, m_userData);
+		}
+	}
+
+	void workerLoop( Int workerIndex )
+	{
+		s_workerIndex = workerIndex;
+		s_insideParallelFor = TRUE;
+		UnsignedInt seenBatch = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (!m_quit && m_batch == seenBatch)
+					m_wake.wait(lock);
+				if (m_quit)
+					return;
+				seenBatch = m_batch;
+			}
+
+			runJobs(workerIndex);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_workersBusy == 0)
+					m_done.notify_all();
+			}
+		}
+	}
+};
+
+//-------------------------------------------------------------------------------------------------
+WorkerThreadPool::WorkerThreadPool( Int numWorkers ) : m_impl(NULL)
+{
+	if (numWorkers > MAX_WORKER_THREADS)
+		numWorkers = MAX_WORKER_THREADS;
+
+	m_impl = MSGNEW("WorkerThreadPool") WorkerThreadPoolImpl;
+	for (Int i = 0; i < numWorkers; ++i)
+	{
+		m_impl->m_threads.push_back(std::thread(&WorkerThreadPoolImpl::workerLoop, m_impl, i+1));
+	}
+	DEBUG_LOG(("WorkerThreadPool - started %d worker threads\n", numWorkers));
+}
+
+//-------------------------------------------------------------------------------------------------
+WorkerThreadPool::~WorkerThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+		m_impl->m_quit = TRUE;
+	}
+	m_impl->m_wake.notify_all();
+	for (size_t i = 0; i < m_impl->m_threads.size(); ++i)
+	{
+		m_impl->m_threads[i].join();
+	}
+	delete m_impl;
+	m_impl = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int WorkerThreadPool::getNumThreads( void ) const
+{
+	return (Int)m_impl->m_threads.size() + 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+void WorkerThreadPool::parallelFor( Int numJobs, WorkerJobProc proc, void *userData )
+{
+	if (numJobs <= 0)
+		return;
+
+	if (m_impl->m_threads.empty() || numJobs == 1 || s_insideParallelFor)
+	{
+		// Nothing to gain from waking the workers (or we are one of them), so just run inline.
+		for (Int i = 0; i < numJobs; ++i)
+			proc(i, s_workerIndex, userData);
+		return;
+	}
+
+	std::lock_guard<std::mutex> callerLock(m_impl->m_callerMutex);
+	s_insideParallelFor = TRUE;
+	{
+		std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+		m_impl->m_proc = proc;
+		m_impl->m_userData = userData;
+		m_impl->m_numJobs = numJobs;
+		m_impl->m_nextJob = 0;
+		m_impl->m_workersBusy = (Int)m_impl->m_threads.size();
+		++m_impl->m_batch;
+	}
+	m_impl->m_wake.notify_all();
+
+	m_impl->runJobs(0);
+
+	{
+		std::unique_lock<std::mutex> lock(m_impl->m_mutex);
+		while (m_impl->m_workersBusy > 0)
+			m_impl->m_done.wait(lock);
+	}
+	s_insideParallelFor = FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int WorkerThreadPool::getCurrentWorkerIndex( void )
+{
+	return s_workerIndex;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int WorkerThreadPool::getDefaultWorkerCount( void )
+{
+	Int numCores = (Int)std::thread::hardware_concurrency();
+	Int numWorkers = numCores - 1;
+	if (numWorkers < 0)
+		numWorkers = 0;
+	if (numWorkers > MAX_WORKER_THREADS)
+		numWorkers = MAX_WORKER_THREADS;
+	return numWorkers;
+}
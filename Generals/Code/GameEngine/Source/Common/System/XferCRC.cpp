@@ -36,6 +36,30 @@
 #include "Common/Snapshot.h"
 #include "winsock2.h" // for htonl
 
+#ifdef TEST_XFER_CRC
+#include <chrono>
+#include <vector>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+/** One step of the CRC: addCRC() below, with the byte swap already done.  Shifting left and adding
+	the old high bit back in is a rotate, which the compiler turns into a single instruction.
+	Every step rotates the result of the last one, so there's no splitting the work into lanes;
+	all we can do is keep the loop tight. */
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt crcStep( UnsignedInt crc, UnsignedInt val )
+{
+	return ((crc << 1) | (crc >> 31)) + val;
+}
+
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt loadWord( const UnsignedByte *p )
+{
+	UnsignedInt val;
+	memcpy( &val, p, sizeof( val ) );	// the data isn't always aligned
+	return htonl( val );
+}
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 XferCRC::XferCRC( void )
@@ -145,28 +169,143 @@ void XferCRC::xferImplementation( void *data, Int dataSize )
 		return;
 	}
 
-	const UnsignedInt *uintPtr = (const UnsignedInt *) (data);
+	const UnsignedByte *c = (const UnsignedByte *)data;
+	UnsignedInt crc = m_crc;
 
-	for (Int i=0 ; i<dataSize/4 ; i++)
+	Int numWords = dataSize / 4;
+	for ( ; numWords >= 4; numWords -= 4, c += 16)
 	{
-		addCRC (*uintPtr++);
+		crc = crcStep( crc, loadWord( c ) );
+		crc = crcStep( crc, loadWord( c + 4 ) );
+		crc = crcStep( crc, loadWord( c + 8 ) );
+		crc = crcStep( crc, loadWord( c + 12 ) );
+	}
+	for ( ; numWords > 0; --numWords, c += 4)
+	{
+		crc = crcStep( crc, loadWord( c ) );
 	}
 
+	// the leftover bytes were always swapped twice (once here, once in addCRC), so they go in as is
 	int leftover = dataSize & 3;
 	if (leftover)
 	{
 		UnsignedInt val = 0;
-		const unsigned char *c = (const unsigned char *)uintPtr;
 		for (Int i=0; i<leftover; i++)
 		{
 			val += (c[i] << (i*8));
 		}
-		val = htonl(val);
-		addCRC (val);
+		crc = crcStep( crc, val );
 	}
+
+	m_crc = crc;
 	
 }  // end xferImplementation
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferCoord3D( Coord3D *coord3D )
+{
+	xferImplementation( coord3D, sizeof( Coord3D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferICoord3D( ICoord3D *iCoord3D )
+{
+	xferImplementation( iCoord3D, sizeof( ICoord3D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferRegion3D( Region3D *region3D )
+{
+	xferImplementation( region3D, sizeof( Region3D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferIRegion3D( IRegion3D *iRegion3D )
+{
+	xferImplementation( iRegion3D, sizeof( IRegion3D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferCoord2D( Coord2D *coord2D )
+{
+	xferImplementation( coord2D, sizeof( Coord2D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferICoord2D( ICoord2D *iCoord2D )
+{
+	xferImplementation( iCoord2D, sizeof( ICoord2D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferRegion2D( Region2D *region2D )
+{
+	xferImplementation( region2D, sizeof( Region2D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferIRegion2D( IRegion2D *iRegion2D )
+{
+	xferImplementation( iRegion2D, sizeof( IRegion2D ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferRealRange( RealRange *realRange )
+{
+	xferImplementation( realRange, sizeof( RealRange ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferRGBColor( RGBColor *rgbColor )
+{
+	xferImplementation( rgbColor, sizeof( RGBColor ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferRGBAColorReal( RGBAColorReal *rgbaColorReal )
+{
+	xferImplementation( rgbaColorReal, sizeof( RGBAColorReal ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferRGBAColorInt( RGBAColorInt *rgbaColorInt )
+{
+	xferImplementation( rgbaColorInt, sizeof( RGBAColorInt ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+/** The version byte, then the three rows as they sit in memory */
+// ------------------------------------------------------------------------------------------------
+void XferCRC::xferMatrix3D( Matrix3D* mtx )
+{
+	const XferVersion currentVersion = 1;
+	XferVersion version = currentVersion;
+	xferVersion( &version, currentVersion );
+
+	xferImplementation( &(*mtx)[0], sizeof( Vector4 ) * 3 );
+}
+
+// if any of these ever grow padding, or a field that isn't 32 bits, batching them would change the CRC
+static_assert( sizeof( Coord3D ) == 3 * sizeof( Real ) && sizeof( ICoord3D ) == 3 * sizeof( Int ), "XferCRC batching" );
+static_assert( sizeof( Region3D ) == 2 * sizeof( Coord3D ) && sizeof( IRegion3D ) == 2 * sizeof( ICoord3D ), "XferCRC batching" );
+static_assert( sizeof( Coord2D ) == 2 * sizeof( Real ) && sizeof( ICoord2D ) == 2 * sizeof( Int ), "XferCRC batching" );
+static_assert( sizeof( Region2D ) == 2 * sizeof( Coord2D ) && sizeof( IRegion2D ) == 2 * sizeof( ICoord2D ), "XferCRC batching" );
+static_assert( sizeof( RealRange ) == 2 * sizeof( Real ) && sizeof( RGBColor ) == 3 * sizeof( Real ), "XferCRC batching" );
+static_assert( sizeof( RGBAColorReal ) == 4 * sizeof( Real ) && sizeof( RGBAColorInt ) == 4 * sizeof( UnsignedInt ), "XferCRC batching" );
+static_assert( sizeof( Vector4 ) == 4 * sizeof( Real ) && sizeof( Real ) == 4 && sizeof( Int ) == 4, "XferCRC batching" );
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 void XferCRC::skip( Int dataSize )
@@ -183,6 +322,110 @@ UnsignedInt XferCRC::getCRC( void )
 
 }  // end skip
 
+#ifdef TEST_XFER_CRC
+//-------------------------------------------------------------------------------------------------
+/** The original word at a time loop, through addCRC */
+//-------------------------------------------------------------------------------------------------
+void XferCRCReference::xferImplementation( void *data, Int dataSize )
+{
+
+	if (!data || dataSize < 1)
+	{
+		return;
+	}
+
+	const UnsignedInt *uintPtr = (const UnsignedInt *) (data);
+
+	for (Int i=0 ; i<dataSize/4 ; i++)
+	{
+		UnsignedInt val;
+		memcpy( &val, uintPtr++, sizeof( val ) );
+		addCRC (val);
+	}
+
+	int leftover = dataSize & 3;
+	if (leftover)
+	{
+		UnsignedInt val = 0;
+		const unsigned char *c = (const unsigned char *)uintPtr;
+		for (Int i=0; i<leftover; i++)
+		{
+			val += (c[i] << (i*8));
+		}
+		val = htonl(val);
+		addCRC (val);
+	}
+	
+}  // end xferImplementation
+
+//-------------------------------------------------------------------------------------------------
+/** Push the same data through both versions, at every length and alignment, with the struct xfers
+	mixed in, and check the CRCs match.  Then time a big buffer through each. */
+//-------------------------------------------------------------------------------------------------
+void doXferCRCTest( void )
+{
+	std::vector<UnsignedByte> data( 1024*1024 + 16 );
+	UnsignedInt seed = 0x12345678;
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		data[i] = (UnsignedByte)(seed >> 24);
+	}
+
+	Int mismatches = 0;
+	for (Int offset = 0; offset < 4; ++offset)
+	{
+		for (Int len = 0; len < 200; ++len)
+		{
+			XferCRC fast;
+			XferCRCReference ref;
+			fast.open( "test" );
+			ref.open( "test" );
+
+			Coord3D pos;
+			memcpy( &pos, &data[len], sizeof( pos ) );
+			Matrix3D mtx;
+			memcpy( &mtx[0], &data[len + 16], sizeof( Vector4 ) * 3 );
+			Bool flag = (len & 1) ? TRUE : FALSE;
+
+			fast.xferUser( &data[offset], len );
+			fast.xferCoord3D( &pos );
+			fast.xferBool( &flag );
+			fast.xferMatrix3D( &mtx );
+			ref.xferUser( &data[offset], len );
+			ref.xferCoord3D( &pos );
+			ref.xferBool( &flag );
+			ref.xferMatrix3D( &mtx );
+
+			if (fast.getCRC() != ref.getCRC())
+				++mismatches;
+		}
+	}
+	DEBUG_ASSERTCRASH( mismatches == 0, ("XferCRC doesn't match the reference CRC in %d cases\n", mismatches) );
+
+	enum { NUM_PASSES = 50 };
+	XferCRC fast;
+	XferCRCReference ref;
+	fast.open( "test" );
+	ref.open( "test" );
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (Int pass = 0; pass < NUM_PASSES; ++pass)
+		ref.xferUser( &data[1], 1024*1024 );
+	double refSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	start = std::chrono::steady_clock::now();
+	for (Int pass = 0; pass < NUM_PASSES; ++pass)
+		fast.xferUser( &data[1], 1024*1024 );
+	double fastSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	DEBUG_ASSERTCRASH( fast.getCRC() == ref.getCRC(), ("XferCRC doesn't match the reference CRC on the big buffer\n") );
+	DEBUG_LOG(( "XferCRC test - %d mismatches, %dMB in %.2fms (reference %.2fms), %.2fx\n",
+		mismatches, NUM_PASSES, fastSeconds * 1000.0, refSeconds * 1000.0,
+		fastSeconds > 0.0 ? refSeconds / fastSeconds : 0.0 ));
+}
+#endif // TEST_XFER_CRC
+
 
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
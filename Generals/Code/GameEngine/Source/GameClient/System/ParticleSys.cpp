@@ -65,6 +65,10 @@
 // the singleton
 ParticleSystemManager *TheParticleSystemManager = NULL;
 
+#ifdef TEST_PARTICLE_UPDATE
+static Bool s_fillUpdateContextPerParticle = FALSE;	///< redo the per system work for every particle, for timing
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -399,8 +403,12 @@ void Particle::applyForce( const Coord3D *force )
 // ------------------------------------------------------------------------------------------------
 /** Update the behavior of an individual particle */
 // ------------------------------------------------------------------------------------------------
-Bool Particle::update( void )
+Bool Particle::update( const ParticleUpdateContext &ctx )
 {
+	// apply 'gravity' force
+	if (ctx.m_gravity != 0.0f)
+		m_accel.z += ctx.m_gravity;
+
 	// integrate acceleration into velocity
 	m_vel.x += m_accel.x;
 	m_vel.y += m_accel.y;
@@ -411,13 +419,13 @@ Bool Particle::update( void )
 	m_vel.z *= m_velDamping;
 
 	// integrate velocity into position
-	const Coord3D *driftVel = m_system->getDriftVelocity();
-	m_pos.x += m_vel.x + driftVel->x;
-	m_pos.y += m_vel.y + driftVel->y;
-	m_pos.z += m_vel.z + driftVel->z;
+	m_pos.x += m_vel.x + ctx.m_driftVelocity.x;
+	m_pos.y += m_vel.y + ctx.m_driftVelocity.y;
+	m_pos.z += m_vel.z + ctx.m_driftVelocity.z;
 
 	// integrate the wind (if specified) into position
-	doWindMotion();
+	if (ctx.m_doWind)
+		doWindMotion( ctx );
 
 	// update orientation
 	m_angleX += m_angularRateX;
@@ -461,7 +469,7 @@ Bool Particle::update( void )
 
 	if (m_alphaTargetKey < MAX_KEYFRAMES && m_alphaKey[ m_alphaTargetKey ].frame)
 	{
-		if (TheGameClient->getFrame() - m_createTimestamp >= m_alphaKey[ m_alphaTargetKey ].frame)
+		if (ctx.m_frame - m_createTimestamp >= m_alphaKey[ m_alphaTargetKey ].frame)
 		{
 			m_alpha = m_alphaKey[ m_alphaTargetKey ].value;
 			m_alphaTargetKey++;
@@ -486,7 +494,7 @@ Bool Particle::update( void )
 
 	if (m_colorTargetKey < MAX_KEYFRAMES && m_colorKey[ m_colorTargetKey ].frame)
 	{
-		if (TheGameClient->getFrame() - m_createTimestamp >= m_colorKey[ m_colorTargetKey ].frame)
+		if (ctx.m_frame - m_createTimestamp >= m_colorKey[ m_colorTargetKey ].frame)
 		{
 			// can't set, because of colorscale
 			// m_color = m_colorKey[ m_colorTargetKey ].color;
@@ -553,52 +561,9 @@ Bool Particle::update( void )
 // ------------------------------------------------------------------------------------------------
 /** Do wind motion as specified by the particle system template, if present */
 // ------------------------------------------------------------------------------------------------
-void Particle::doWindMotion( void )
+void Particle::doWindMotion( const ParticleUpdateContext &ctx )
 {
-	ParticleSystemInfo::WindMotion windMotion = m_system->getWindMotion();
-
-	// see if we should even do anything
-	if( windMotion == ParticleSystemInfo::WIND_MOTION_NOT_USED )
-		return;
-
-	// get the angle of the wind
-	Real windAngle = m_system->getWindAngle();
-
-	// get the system position
-	Coord3D systemPos;
-	m_system->getPosition( &systemPos );
-
-	// when we're attached objects and drawables we offset by that position as well
-	if( ObjectID attachedObj = m_system->getAttachedObject() )
-	{
-		Object *obj = TheGameLogic->findObjectByID( attachedObj );
-
-		if( obj )
-		{
-			const Coord3D *objPos = obj->getPosition();
-
-			systemPos.x += objPos->x;
-			systemPos.y += objPos->y;
-			systemPos.z += objPos->z;
-
-		}  // end if
-
-	}  // end if
-	else if( DrawableID attachedDraw = m_system->getAttachedDrawable() )
-	{
-		Drawable *draw = TheGameClient->findDrawableByID( attachedDraw );
-
-		if( draw )
-		{
-			const Coord3D *drawPos = draw->getPosition();
-
-			systemPos.x += drawPos->x;
-			systemPos.y += drawPos->y;
-			systemPos.z += drawPos->z;
-
-		}  // end if
-
-	}  // end else if
+	const Coord3D &systemPos = ctx.m_windCenter;
 
 	//
 	// compute a vector from the system position in the world to the particle ... we will use
@@ -630,8 +595,8 @@ void Particle::doWindMotion( void )
 																		(noForceDistance - fullForceDistance)));
 
 		// integate the wind motion into the position
-		m_pos.x += (Cos( windAngle ) * windForceStrength);
-		m_pos.y += (Sin( windAngle ) * windForceStrength);
+		m_pos.x += (ctx.m_windCos * windForceStrength);
+		m_pos.y += (ctx.m_windSin * windForceStrength);
 
 	}  // end if
 
@@ -2140,22 +2105,19 @@ Bool ParticleSystem::update( Int localPlayerIndex  )
 	//
 	// Update all particles in the system
 	//
+	ParticleUpdateContext ctx;
+	fillUpdateContext( &ctx );
+
 	Particle *p = m_systemParticlesHead;
 	Particle *oldParticle;
 	while (p)
 	{
+#ifdef TEST_PARTICLE_UPDATE
+		if (s_fillUpdateContextPerParticle)
+			fillUpdateContext( &ctx );
+#endif
 
-		// apply 'gravity' force
-		if (m_gravity != 0.0f)
-		{
-			Coord3D force;
-			force.x = 0.0f;
-			force.y = 0.0f;
-			force.z = m_gravity;
-			p->applyForce( &force );
-		}
-
-		if (p->update() == false)
+		if (p->update( ctx ) == false)
 		{
 			oldParticle = p;
 			p = p->m_systemNext;
@@ -2327,6 +2289,61 @@ void ParticleSystem::updateWindMotion( void )
 
 }  // end updateWindMotion
 
+// ------------------------------------------------------------------------------------------------
+/** Work out everything our particles need from us this frame.  None of this changes while
+	* the particles are updated, so there is no need for each particle to look it up itself. */
+// ------------------------------------------------------------------------------------------------
+void ParticleSystem::fillUpdateContext( ParticleUpdateContext *ctx )
+{
+	ctx->m_gravity = m_gravity;
+	ctx->m_driftVelocity = m_driftVelocity;
+	ctx->m_frame = TheGameClient->getFrame();
+
+	ctx->m_doWind = (m_windMotion != ParticleSystemInfo::WIND_MOTION_NOT_USED);
+	if( ctx->m_doWind == FALSE )
+		return;
+
+	ctx->m_windCos = Cos( m_windAngle );
+	ctx->m_windSin = Sin( m_windAngle );
+
+	// the wind blows from the system position
+	Coord3D *systemPos = &ctx->m_windCenter;
+	getPosition( systemPos );
+
+	// when we're attached objects and drawables we offset by that position as well
+	if( ObjectID attachedObj = getAttachedObject() )
+	{
+		Object *obj = TheGameLogic->findObjectByID( attachedObj );
+
+		if( obj )
+		{
+			const Coord3D *objPos = obj->getPosition();
+
+			systemPos->x += objPos->x;
+			systemPos->y += objPos->y;
+			systemPos->z += objPos->z;
+
+		}  // end if
+
+	}  // end if
+	else if( DrawableID attachedDraw = getAttachedDrawable() )
+	{
+		Drawable *draw = TheGameClient->findDrawableByID( attachedDraw );
+
+		if( draw )
+		{
+			const Coord3D *drawPos = draw->getPosition();
+
+			systemPos->x += drawPos->x;
+			systemPos->y += drawPos->y;
+			systemPos->z += drawPos->z;
+
+		}  // end if
+
+	}  // end else if
+
+}  // end fillUpdateContext
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 void ParticleSystem::addParticle( Particle *particleToAdd )
@@ -2502,8 +2519,11 @@ void ParticleSystem::xfer( Xfer *xfer )
 	// base class info
 	ParticleSystemInfo::xfer( xfer );
 
-	// particle system ID
+	// particle system ID, the manager finds us by ID so tell it if it changed
+	ParticleSystemID oldSystemID = m_systemID;
 	xfer->xferUser( &m_systemID, sizeof( ParticleSystemID ) );
+	if( m_systemID != oldSystemID )
+		TheParticleSystemManager->friend_changeParticleSystemID( this, oldSystemID );
 
 	// attached to drawable id
 	xfer->xferDrawableID( &m_attachedToDrawableID );
@@ -2935,6 +2955,10 @@ ParticleSystemManager::ParticleSystemManager( void )
 	m_particleSystemCount = 0;
 	//
 
+#ifdef TEST_PARTICLE_UPDATE
+	m_ranParticleUpdateTest = FALSE;
+#endif
+
 	for( Int i = 0; i < NUM_PARTICLE_PRIORITIES; ++i )
 	{
 		
@@ -3012,9 +3036,16 @@ void ParticleSystemManager::reset( void )
 	m_fieldParticleCount = 0;
 	m_particleSystemCount = 0;
 
+	DEBUG_ASSERTCRASH( m_systemMap.empty(), ("RESET: ParticleSystem ID map is not empty!\n") );
+	m_systemMap.clear();
+
 	m_uniqueSystemID = INVALID_PARTICLE_SYSTEM_ID;
 	
 	m_lastLogicFrameUpdate = -1;
+
+#ifdef TEST_PARTICLE_UPDATE
+	m_ranParticleUpdateTest = FALSE;
+#endif
 	// leave templates as-is
 }
 
@@ -3031,6 +3062,14 @@ void ParticleSystemManager::update( void )
 	// update the last logic frame.
 	m_lastLogicFrameUpdate = TheGameLogic->getFrame();
 
+#ifdef TEST_PARTICLE_UPDATE
+	if (!m_ranParticleUpdateTest && m_lastLogicFrameUpdate > LOGICFRAMES_PER_SECOND*5)
+	{
+		m_ranParticleUpdateTest = TRUE;
+		doParticleUpdateTest();
+	}
+#endif
+
 	//USE_PERF_TIMER(ParticleSystemManager)
 	ParticleSystem *sys;
 
@@ -3095,20 +3134,11 @@ ParticleSystem *ParticleSystemManager::findParticleSystem( ParticleSystemID id )
 	if (id == INVALID_PARTICLE_SYSTEM_ID)
 		return NULL;	// my, that was easy
 
-	ParticleSystem *system = NULL;
-
-	for( ParticleSystemListIt it = m_allParticleSystemList.begin(); it != m_allParticleSystemList.end(); ++it ) {
-		system = *it;
-		if (!system) {
-			continue;
-		}
-
-		if( system->getSystemID() == id ) {
-			return system;
-		}
-	}
+	ParticleSystemIDMap::const_iterator it = m_systemMap.find( id );
+	if (it == m_systemMap.end())
+		return NULL;
 
-	return NULL;
+	return *it->second;
 
 }  // end findParticleSystem
 
@@ -3275,6 +3305,7 @@ void ParticleSystemManager::removeParticle( Particle *particleToRemove)
 void ParticleSystemManager::friend_addParticleSystem( ParticleSystem *particleSystemToAdd )
 {
 	m_allParticleSystemList.push_back(particleSystemToAdd);
+	m_systemMap[ particleSystemToAdd->getSystemID() ] = --m_allParticleSystemList.end();
 	++m_particleSystemCount;
 }
 
@@ -3283,14 +3314,36 @@ void ParticleSystemManager::friend_addParticleSystem( ParticleSystem *particleSy
 // ------------------------------------------------------------------------------------------------
 void ParticleSystemManager::friend_removeParticleSystem( ParticleSystem *particleSystemToRemove )
 {
-	ParticleSystemListIt it = std::find(m_allParticleSystemList.begin(), m_allParticleSystemList.end(), particleSystemToRemove);
-	if (it != m_allParticleSystemList.end()) {
-		m_allParticleSystemList.erase(it);
+	ParticleSystemIDMap::iterator mapIt = m_systemMap.find( particleSystemToRemove->getSystemID() );
+	if (mapIt != m_systemMap.end() && *mapIt->second == particleSystemToRemove) {
+		m_allParticleSystemList.erase(mapIt->second);
+		m_systemMap.erase(mapIt);
 		--m_particleSystemCount;
 	}
 
 }
 
+// ------------------------------------------------------------------------------------------------
+/** A particle system has been given a new ID (this happens when loading), so file it under
+	* the new one. */
+// ------------------------------------------------------------------------------------------------
+void ParticleSystemManager::friend_changeParticleSystemID( ParticleSystem *particleSystem, ParticleSystemID oldID )
+{
+	ParticleSystemIDMap::iterator mapIt = m_systemMap.find( oldID );
+	if (mapIt == m_systemMap.end() || *mapIt->second != particleSystem) {
+		DEBUG_CRASH(("friend_changeParticleSystemID - system %d is not in the ID map\n", oldID));
+		return;
+	}
+
+	ParticleSystemListIt it = mapIt->second;
+	m_systemMap.erase(mapIt);
+
+	DEBUG_ASSERTCRASH(m_systemMap.find(particleSystem->getSystemID()) == m_systemMap.end(), 
+		("friend_changeParticleSystemID - ID %d is already taken\n", particleSystem->getSystemID()));
+	m_systemMap[ particleSystem->getSystemID() ] = it;
+
+}
+
 // ------------------------------------------------------------------------------------------------
 /** Remove the oldest N number of particles from the lowest priority lists first.  We will
  * not remove particles from any priorities higher or equal to the priorityCap parameter. */
@@ -3298,26 +3351,103 @@ void ParticleSystemManager::friend_removeParticleSystem( ParticleSystem *particl
 Int ParticleSystemManager::removeOldestParticles( UnsignedInt count, 
 																									ParticlePriorityType priorityCap )
 {
-	Int countToRemove = count;
+	UnsignedInt removed = 0;
 
-	while (count-- && getParticleCount()) 
+	// each list is oldest first, so just eat the heads until we've removed enough
+	for( Int i = PARTICLE_PRIORITY_LOWEST; i < priorityCap && removed < count; ++i )
 	{
-		for( Int i = PARTICLE_PRIORITY_LOWEST;
-				 i < priorityCap;
-				 ++i )
+		while( m_allParticlesHead[ i ] && removed < count )
 		{
-			if( m_allParticlesHead[ i ] ) 
-			{
-				m_allParticlesHead[ i ]->deleteInstance();
-				break;  // exit for
-			}
+			m_allParticlesHead[ i ]->deleteInstance();
+			++removed;
 		}
 	}
 
 	// return the number of particles actually removed
-	return countToRemove - count;
+	return removed;
+
+}
+
+#ifdef TEST_PARTICLE_UPDATE
+// ------------------------------------------------------------------------------------------------
+void ParticleSystemManager::doParticleUpdateTest()
+{
+	const Int NUM_SYSTEMS = 500;
+	const Int NUM_FRAMES = 300;
+
+	// drawable particles would be timing the drawables, not us.
+	std::vector<const ParticleSystemTemplate *> templates;
+	for (TemplateMap::iterator it = m_templateMap.begin(); it != m_templateMap.end(); ++it)
+	{
+		if (it->second->m_particleType != ParticleSystemInfo::DRAWABLE)
+			templates.push_back(it->second);
+	}
+	if (templates.empty())
+		return;
+
+	// hang some of them off objects, so the wind has something to look up.
+	std::vector<Object *> objects;
+	for (Object *obj = TheGameLogic->getFirstObject(); obj; obj = obj->getNextObject())
+		objects.push_back(obj);
 
+	for (Int pass = 0; pass < 2; ++pass)
+	{
+		s_fillUpdateContextPerParticle = (pass == 1);
+
+		std::vector<ParticleSystem *> systems;
+		for (Int i = 0; i < NUM_SYSTEMS; ++i)
+		{
+			ParticleSystem *sys = createParticleSystem(templates[i % templates.size()], FALSE);
+			if (!sys)
+				continue;
+			if (!objects.empty() && (i & 1))
+			{
+				sys->attachToObject(objects[(i / 2) % objects.size()]);
+			}
+			else
+			{
+				Coord3D pos;
+				pos.x = (Real)((i % 25) * 50);
+				pos.y = (Real)((i / 25) * 50);
+				pos.z = 0.0f;
+				sys->setPosition(&pos);
+			}
+			systems.push_back(sys);
+		}
+
+		UnsignedInt particlesUpdated = 0;
+		Int start = ::GetTickCount();
+		for (Int frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			for (size_t i = 0; i < systems.size(); ++i)
+			{
+				ParticleSystem *sys = systems[i];
+				if (!sys)
+					continue;
+				particlesUpdated += sys->getParticleCount();
+				if (sys->update(m_localPlayerIndex) == false)
+				{
+					sys->deleteInstance();
+					systems[i] = NULL;
+				}
+			}
+		}
+		Int elapsed = ::GetTickCount() - start;
+
+		for (size_t i = 0; i < systems.size(); ++i)
+		{
+			if (systems[i])
+				systems[i]->deleteInstance();
+		}
+
+		DEBUG_LOG(("ParticleUpdateTest - %s: %d systems, %d frames, %d particle updates in %d ms (%d per ms)\n",
+			pass == 0 ? "per system" : "per particle", NUM_SYSTEMS, NUM_FRAMES, particlesUpdated, elapsed,
+			elapsed ? particlesUpdated / elapsed : particlesUpdated));
+	}
+
+	s_fillUpdateContextPerParticle = FALSE;
 }
+#endif
 
 // ------------------------------------------------------------------------------------------------
 /** Preload particle system textures */
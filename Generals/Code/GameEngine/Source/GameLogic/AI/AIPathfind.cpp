@@ -36,6 +36,7 @@
 #include "Common/LatchRestore.h"	 
 #include "Common/ThingTemplate.h"
 #include "Common/ThingFactory.h"							 
+#include "Common/WorkerThreadPool.h"
 
 #include "GameClient/Line2D.h"
 
@@ -93,6 +94,53 @@ struct TCheckMovementInfo
 	Bool							allyGoal;
 };
 
+/**
+ * A findPath run ahead of the pathfind queue on a worker thread.  The request is what
+ * AIUpdateInterface::getPredictedPathRequest said the unit would ask for, and the result is
+ * used in place of a live search only if the request matches and nothing the search looked
+ * at has changed since.  Everything else about the search is recorded so it can be replayed
+ * onto the logic thread's state, and the game comes out the same as a serial run.
+ */
+struct PathfindSpeculation
+{
+	enum {MAX_SPECULATIONS = 32};
+	enum {SPECULATION_MARGIN = 6};		///< Cells around the searched area a unit change can reach.
+
+	// Request
+	Bool						m_valid;										///< True if a search was run for this slot.
+	ObjectID				m_objID;
+	const LocomotorSet *m_locomotorSet;
+	LocomotorSurfaceTypeMask m_surfaces;
+	Coord3D					m_from;
+	Coord3D					m_to;
+	ObjectID				m_ignoreObstacleID;
+	PathfindLayerEnum m_layer;
+	UnsignedByte		m_crusherLevel;
+	Bool						m_canPathThroughUnits;
+	Bool						m_startTunneling;						///< Pathfinder::m_isTunneling when the search started.
+
+	// Result
+	Path						*m_path;
+	Bool						m_isTunneling;
+	Int							m_cellsReleased;
+	Int							m_failedPathfinds;
+	PathfindCorridorUse m_corridorUse;
+	Bool						*m_passable;								///< Hierarchical passable flags, if the search wrote them.
+	Int							m_numPassable;
+
+	// What the result depends on
+	UnsignedInt			m_structureSerial;
+	IRegion2D				m_touched;
+	Int							m_startPoolInUse;						///< Cell info pool slots in use when the search started.
+	Int							m_peakPoolNodes;
+	Bool						m_ranOutOfNodes;
+	Int							m_leakedNodes;
+	Bool						m_consumed;
+
+	PathfindSpeculation(void) : m_valid(false), m_path(NULL), m_passable(NULL), m_numPassable(0), m_consumed(false) {}
+	~PathfindSpeculation(void) {delete [] m_passable;}
+};
+
 inline Int IABS(Int x) {	if (x>=0) return x; return -x;};
 
 //-----------------------------------------------------------------------------------
@@ -1087,6 +1135,7 @@ enum { PATHFIND_CELLS_PER_FRAME=5000}; // Number of cells we will search pathfin
 enum {CELL_INFOS_TO_ALLOCATE = 30000};
 PathfindCellInfo *PathfindCellInfo::s_infoArray = NULL;
 PathfindCellInfo *PathfindCellInfo::s_firstFree = NULL;						
+Int PathfindCellInfo::s_numInUse = 0;
 /**
  * Allocates a pool of pathfind cell infos.
  */
@@ -1094,11 +1143,12 @@ void PathfindCellInfo::allocateCellInfos(void)
 {
 	releaseCellInfos();
 	s_infoArray = MSGNEW("PathfindCellInfo") PathfindCellInfo[CELL_INFOS_TO_ALLOCATE];	// pool[]ify
-	s_infoArray[CELL_INFOS_TO_ALLOCATE-1].m_pathParent = NULL;
+	s_infoArray[CELL_INFOS_TO_ALLOCATE-1].m_nextFree = NULL;
 	s_infoArray[CELL_INFOS_TO_ALLOCATE-1].m_isFree = true;
 	s_firstFree = s_infoArray;
+	s_numInUse = 0;
 	for (Int i=0; i<CELL_INFOS_TO_ALLOCATE-1; i++) {
-		s_infoArray[i].m_pathParent = &s_infoArray[i+1];
+		s_infoArray[i].m_nextFree = &s_infoArray[i+1];
 		s_infoArray[i].m_isFree = true; 
 	}
 }
@@ -1115,12 +1165,13 @@ void PathfindCellInfo::releaseCellInfos(void)
 	while (s_firstFree) {
 		count++;
 		DEBUG_ASSERTCRASH(s_firstFree->m_isFree, ("Should be freed."));
-		s_firstFree = s_firstFree->m_pathParent;
+		s_firstFree = s_firstFree->m_nextFree;
 	}
 	DEBUG_ASSERTCRASH(count==CELL_INFOS_TO_ALLOCATE, ("Error - Allocated cellinfos."));
 	delete s_infoArray;
 	s_infoArray = NULL;
 	s_firstFree = NULL;
+	s_numInUse = 0;
 }
 
 /**
@@ -1128,28 +1179,27 @@ void PathfindCellInfo::releaseCellInfos(void)
  */
 PathfindCellInfo *PathfindCellInfo::getACellInfo(PathfindCell *cell,const ICoord2D &pos) 
 {
+	// Search nodes for cells without an info draw from the same budget, so a pathfind 
+	// can't use up the cells needed for units & obstacles.
+	if (s_numInUse + PathfindSearchContext::getCurrent()->getNumPoolNodes() >= CELL_INFOS_TO_ALLOCATE) {
+		return NULL;
+	}
 	PathfindCellInfo *info = s_firstFree;
 	if (s_firstFree) {
 		DEBUG_ASSERTCRASH(s_firstFree->m_isFree, ("Should be freed."));
-		s_firstFree = s_firstFree->m_pathParent;
+		s_firstFree = s_firstFree->m_nextFree;
+		s_numInUse++;
 		info->m_isFree = false;  // Just allocated it.
 		info->m_cell = cell;
 		info->m_pos = pos;
+		info->m_nextFree = NULL;
 
-		info->m_nextOpen = NULL;
-		info->m_prevOpen = NULL;
-		info->m_pathParent = NULL;
-		info->m_costSoFar = 0;		
-		info->m_totalCost = 0;
-		info->m_open = 0;
-		info->m_closed = 0;
 		info->m_obstacleID = INVALID_ID;
 		info->m_goalUnitID = INVALID_ID;
 		info->m_posUnitID = INVALID_ID;
 		info->m_goalAircraftID = INVALID_ID;
 		info->m_obstacleIsFence = false;
 		info->m_obstacleIsTransparent = false;
-		info->m_blockedByAlly = false;
 	}
 	return info;
 }
@@ -1162,9 +1212,369 @@ void PathfindCellInfo::releaseACellInfo(PathfindCellInfo *theInfo)
 	DEBUG_ASSERTCRASH(!theInfo->m_isFree, ("Shouldn't be free."));
 	//@ todo -fix this assert on usa04.  jba.
 	//DEBUG_ASSERTCRASH(theInfo->m_obstacleID==0, ("Shouldn't be obstacle."));
-	theInfo->m_pathParent = s_firstFree;
+	theInfo->m_nextFree = s_firstFree;
 	s_firstFree = theInfo;
 	s_firstFree->m_isFree = true;
+	s_numInUse--;
+}
+
+//-----------------------------------------------------------------------------------
+
+thread_local PathfindSearchContext *PathfindSearchContext::s_current = NULL;
+
+PathfindSearchContext::PathfindSearchContext(void) :
+	m_openList(NULL),
+	m_closedList(NULL),
+	m_isTunneling(false),
+	m_ignoreObstacleID(INVALID_ID),
+	m_isSpeculative(false),
+	m_poolBase(0),
+	m_peakPoolNodes(0),
+	m_ranOutOfNodes(false),
+	m_cellsReleased(0),
+	m_failedPathfinds(0),
+	m_passableWritten(false),
+	m_lookup(NULL),
+	m_numCells(0),
+	m_generation(1),
+	m_nodeBlocks(NULL),
+	m_curBlock(NULL),
+	m_curBlockUsed(0),
+	m_numNodeBlocks(0),
+	m_numPoolNodes(0),
+	m_numLiveNodes(0),
+	m_numListedNodes(0),
+	m_passable(NULL),
+	m_numPassableBlocks(0)
+{
+	clearTouched();
+	m_corridorUse.m_lookedUp = false;
+	m_corridorUse.m_stamp = 0;
+	m_corridorUse.m_failed = false;
+	m_corridorUse.m_stored = false;
+}
+
+PathfindSearchContext::~PathfindSearchContext(void)
+{
+	setNumCells(0);
+	while (m_nodeBlocks) {
+		NodeBlock *next = m_nodeBlocks->m_next;
+		delete m_nodeBlocks;
+		m_nodeBlocks = next;
+	}
+	m_curBlock = NULL;
+	m_numNodeBlocks = 0;
+	if (m_passable) {
+		delete [] m_passable;
+		m_passable = NULL;
+	}
+}
+
+/**
+ * Sizes the node lookup for a map with numCells cells.  Any existing nodes are dropped.
+ */
+void PathfindSearchContext::setNumCells(Int numCells)
+{
+	releaseAllNodes();
+	if (numCells == m_numCells) {
+		return;
+	}
+	if (m_lookup) {
+		delete [] m_lookup;
+		m_lookup = NULL;
+	}
+	m_numCells = numCells;
+	if (m_numCells > 0) {
+		m_lookup = MSGNEW("PathfindSearchNodes") NodeLookup[m_numCells];
+		memset(m_lookup, 0, m_numCells*sizeof(NodeLookup));
+	}
+	m_generation = 1;
+}
+
+/**
+ * Drops every node, and empties the lists.  Used when the cells themselves go away, or
+ * a search was abandoned part way.
+ */
+void PathfindSearchContext::releaseAllNodes(void)
+{
+	endSearch();
+	m_isTunneling = false;
+}
+
+/**
+ * Ends a search.  Every node goes away at once - the lookup entries go stale when the 
+ * generation changes, and the blocks are rewound for the next search.  Returns the number
+ * of nodes that were on the open or closed list, which is what the pathfind queue budgets by.
+ */
+Int PathfindSearchContext::endSearch(void)
+{
+#ifdef _DEBUG
+	Int count = 0;
+	PathfindSearchNode *node;
+	for (node = m_openList ? getNode(m_openList->getIndex()) : NULL; node; node = node->m_nextOpen) {
+		count++;
+	}
+	for (node = m_closedList ? getNode(m_closedList->getIndex()) : NULL; node; node = node->m_nextOpen) {
+		count++;
+	}
+	DEBUG_ASSERTCRASH(count == m_numListedNodes, ("Open/closed node count is off - %d, should be %d.", m_numListedNodes, count));
+#endif
+	Int numListed = m_numListedNodes;
+	m_openList = NULL;
+	m_closedList = NULL;
+	m_numListedNodes = 0;
+	m_numLiveNodes = 0;
+	m_numPoolNodes = 0;
+	m_curBlock = m_nodeBlocks;
+	m_curBlockUsed = 0;
+	m_generation++;
+	if (m_generation == 0) {
+		// Wrapped, so old stamps could match again.  Happens every few billion searches.
+		if (m_lookup) {
+			memset(m_lookup, 0, m_numCells*sizeof(NodeLookup));
+		}
+		m_generation = 1;
+	}
+	return numListed;
+}
+
+/**
+ * Gets a search node for a cell.  Nodes for cells that don't have a PathfindCellInfo count 
+ * against the info pool, the same as the infos themselves.  Returns NULL if the pool is used up.
+ */
+PathfindSearchNode *PathfindSearchContext::allocateNode(PathfindCell *cell, const ICoord2D &pos, Bool usesPoolSlot)
+{
+	if (usesPoolSlot) {
+		if (PathfindCellInfo::getNumInUse() + m_poolBase + m_numPoolNodes >= CELL_INFOS_TO_ALLOCATE) {
+			m_ranOutOfNodes = true;
+			return NULL;
+		}
+	}
+	if (m_curBlock == NULL || m_curBlockUsed == NODES_PER_BLOCK) {
+		NodeBlock *next = m_curBlock ? m_curBlock->m_next : m_nodeBlocks;
+		if (next == NULL) {
+			// Blocks are kept from search to search, so this only happens while the context
+			// grows to the biggest search it has seen.
+			next = MSGNEW("PathfindSearchNodes") NodeBlock;
+			next->m_next = NULL;
+			if (m_curBlock) {
+				m_curBlock->m_next = next;
+			}	else {
+				m_nodeBlocks = next;
+			}
+			m_numNodeBlocks++;
+		}
+		m_curBlock = next;
+		m_curBlockUsed = 0;
+	}
+	PathfindSearchNode *node = &m_curBlock->m_nodes[m_curBlockUsed++];
+
+	node->m_nextOpen = NULL;
+	node->m_prevOpen = NULL;
+	node->m_pathParent = NULL;
+	node->m_cell = cell;
+	node->m_pos = pos;
+	node->m_costSoFar = 0;		
+	node->m_totalCost = 0;
+	node->m_blockedByAlly = false;
+	node->m_open = false;
+	node->m_closed = false;
+	node->m_usesPoolSlot = usesPoolSlot;
+	node->m_isReleased = false;
+
+	NodeLookup &lookup = m_lookup[cell->getIndex()];
+	lookup.m_node = node;
+	lookup.m_generation = m_generation;
+	m_numLiveNodes++;
+	if (usesPoolSlot) {
+		m_numPoolNodes++;
+		if (m_numPoolNodes > m_peakPoolNodes) {
+			m_peakPoolNodes = m_numPoolNodes;
+		}
+	}
+	touch(pos.x, pos.y);
+	return node;
+}
+
+/**
+ * Drops a single node from the lookup.  The memory comes back when the search ends.
+ */
+void PathfindSearchContext::releaseNode(PathfindSearchNode *node)
+{
+	DEBUG_ASSERTCRASH(!node->m_isReleased, ("Shouldn't be released."));
+	m_lookup[node->m_cell->getIndex()].m_node = NULL;
+	if (node->m_usesPoolSlot) {
+		m_numPoolNodes--;
+	}
+	m_numLiveNodes--;
+	node->m_isReleased = true;
+}
+
+/**
+ * Sizes the hierarchical passable flags.  All blocks start out passable.
+ */
+void PathfindSearchContext::setNumPassableBlocks(Int numBlocks)
+{
+	if (numBlocks != m_numPassableBlocks) {
+		if (m_passable) {
+			delete [] m_passable;
+			m_passable = NULL;
+		}
+		m_numPassableBlocks = numBlocks;
+		if (m_numPassableBlocks > 0) {
+			m_passable = MSGNEW("PathfindZoneBlocks") Bool[m_numPassableBlocks];
+		}
+	}
+	for (Int i=0; i<m_numPassableBlocks; i++) {
+		m_passable[i] = true;
+	}
+}
+
+/**
+ * Copies in a set of hierarchical passable flags, from another context or a saved search.
+ */
+void PathfindSearchContext::copyPassableFlags(const Bool *flags, Int numBlocks)
+{
+	if (numBlocks != m_numPassableBlocks) {
+		setNumPassableBlocks(numBlocks);
+	}
+	if (m_numPassableBlocks > 0) {
+		memcpy(m_passable, flags, m_numPassableBlocks*sizeof(Bool));
+	}
+}
+
+/**
+ * Empties the touched region.
+ */
+void PathfindSearchContext::clearTouched(void)
+{
+	m_touched.lo.x = m_touched.lo.y = 0x7fffffff;
+	m_touched.hi.x = m_touched.hi.y = -0x7fffffff;
+}
+
+//-----------------------------------------------------------------------------------
+PathfindCorridorCache::PathfindCorridorCache(void)
+{
+	clear();
+}
+
+/**
+ * Empties the cache.
+ */
+void PathfindCorridorCache::clear(void)
+{
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		m_entries[i].m_stamp = 0;
+		m_entries[i].m_lastUsed = 0;
+		m_entries[i].m_numBlocks = 0;
+	}
+	m_nextStamp = 1;
+	m_useCounter = 0;
+}
+
+/**
+ * Returns the stamp of the entry for this key, or 0 if there isn't one that is still good.
+ */
+UnsignedInt PathfindCorridorCache::lookup(const PathfindCorridorKey &key, UnsignedInt structureSerial) const
+{
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		const Entry &entry = m_entries[i];
+		if (entry.m_stamp && entry.m_structureSerial == structureSerial && entry.m_key == key) {
+			return entry.m_stamp;
+		}
+	}
+	return 0;
+}
+
+Int PathfindCorridorCache::findEntry(UnsignedInt stamp) const
+{
+	if (stamp == 0) {
+		return -1;
+	}
+	Int i;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		if (m_entries[i].m_stamp == stamp) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void PathfindCorridorCache::touch(UnsignedInt stamp)
+{
+	Int ndx = findEntry(stamp);
+	if (ndx >= 0) {
+		m_entries[ndx].m_lastUsed = ++m_useCounter;
+	}
+}
+
+void PathfindCorridorCache::remove(UnsignedInt stamp)
+{
+	Int ndx = findEntry(stamp);
+	if (ndx >= 0) {
+		m_entries[ndx].m_stamp = 0;
+		m_entries[ndx].m_numBlocks = 0;
+	}
+}
+
+/**
+ * Gets the passable blocks of a cached corridor.  Returns the number of blocks, 0 if the entry is gone.
+ */
+Int PathfindCorridorCache::getCorridor(UnsignedInt stamp, const Int **blocks) const
+{
+	Int ndx = findEntry(stamp);
+	if (ndx < 0) {
+		*blocks = NULL;
+		return 0;
+	}
+	*blocks = m_entries[ndx].m_blocks;
+	return m_entries[ndx].m_numBlocks;
+}
+
+/**
+ * Keeps the passable blocks from a hierarchical search, replacing the least recently used entry.
+ * Corridors too long to keep are skipped - they are rare, and cost a full search anyway.
+ */
+void PathfindCorridorCache::store(const PathfindCorridorKey &key, UnsignedInt structureSerial, 
+																	const Bool *passable, Int numPassableBlocks)
+{
+	Int numBlocks = 0;
+	Int i;
+	for (i=0; i<numPassableBlocks; i++) {
+		if (passable[i]) {
+			numBlocks++;
+		}
+	}
+	if (numBlocks == 0 || numBlocks > MAX_CORRIDOR_BLOCKS) {
+		return;
+	}
+	Int victim = 0;
+	for (i=0; i<MAX_ENTRIES; i++) {
+		const Entry &entry = m_entries[i];
+		if (entry.m_stamp == 0 || entry.m_structureSerial != structureSerial) {
+			victim = i;
+			break;
+		}
+		if (entry.m_lastUsed < m_entries[victim].m_lastUsed) {
+			victim = i;
+		}
+	}
+	Entry &entry = m_entries[victim];
+	entry.m_key = key;
+	entry.m_structureSerial = structureSerial;
+	entry.m_stamp = m_nextStamp++;
+	if (m_nextStamp == 0) {
+		m_nextStamp = 1;
+	}
+	entry.m_lastUsed = ++m_useCounter;
+	entry.m_numBlocks = 0;
+	for (i=0; i<numPassableBlocks; i++) {
+		if (passable[i]) {
+			entry.m_blocks[entry.m_numBlocks++] = i;
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------------
@@ -1172,7 +1582,7 @@ void PathfindCellInfo::releaseACellInfo(PathfindCellInfo *theInfo)
 /**
  * Constructor
  */
-PathfindCell::PathfindCell( void ) :m_info(NULL)
+PathfindCell::PathfindCell( void ) :m_info(NULL), m_index(0)
 { 
 	reset();
 }
@@ -1211,22 +1621,41 @@ void PathfindCell::reset( )
 	
 }
 
+/**
+ * Gets the search node for this cell, creating one from the cell info if needed.
+ */
+PathfindSearchNode *PathfindCell::touchNode( void ) 
+{ 
+	PathfindSearchContext *context = PathfindSearchContext::getCurrent();
+	PathfindSearchNode *node = context->getNode(m_index);
+	if (node == NULL) {
+		DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
+		// Cells with an info already hold a pool slot, so this can't fail.
+		node = context->allocateNode(this, m_info->m_pos, false);
+	}
+	return node;
+}
+
 /**
  * Reset the pathfinding values in the cell.
  */
 Bool PathfindCell::startPathfind( PathfindCell *goalCell  ) 
 { 
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	m_info->m_nextOpen = NULL;
-	m_info->m_prevOpen = NULL;
-	m_info->m_pathParent = NULL;
-	m_info->m_costSoFar = 0;		// start node, no cost to get here
-	m_info->m_totalCost = 0;
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	PathfindSearchNode *node = touchNode();
+	node->m_nextOpen = NULL;
+	node->m_prevOpen = NULL;
+	node->m_pathParent = NULL;
+	node->m_costSoFar = 0;		// start node, no cost to get here
+	node->m_totalCost = 0;
 	if (goalCell) {
-		m_info->m_totalCost = costToGoal( goalCell );
+		node->m_totalCost = costToGoal( goalCell );
+	}
+	if (!node->m_open && !node->m_closed) {
+		PathfindSearchContext::getCurrent()->nodeListed();
 	}
-	m_info->m_open = TRUE;
-	m_info->m_closed = FALSE;
+	node->m_open = TRUE;
+	node->m_closed = FALSE;
 	return true;
 }
 /**
@@ -1234,10 +1663,12 @@ Bool PathfindCell::startPathfind( PathfindCell *goalCell  )
  */
 void PathfindCell::setParentCell( PathfindCell* parent  ) 
 { 
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	m_info->m_pathParent = parent->m_info;
-	Int dx = m_info->m_pos.x - parent->m_info->m_pos.x;
-	Int dy = m_info->m_pos.y - parent->m_info->m_pos.y;
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	PathfindSearchNode *node = touchNode();
+	PathfindSearchNode *parentNode = parent->touchNode();
+	node->m_pathParent = parentNode;
+	Int dx = node->m_pos.x - parentNode->m_pos.x;
+	Int dy = node->m_pos.y - parentNode->m_pos.y;
 	if (dx<-1 || dx>1 || dy<-1 || dy>1) {
 		DEBUG_CRASH(("Invalid parent index."));
 	}
@@ -1248,8 +1679,8 @@ void PathfindCell::setParentCell( PathfindCell* parent  )
  */
 void PathfindCell::setParentCellHierarchical( PathfindCell* parent  ) 
 { 
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	m_info->m_pathParent = parent->m_info;
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	touchNode()->m_pathParent = parent->touchNode();
 }
 
 /**
@@ -1257,27 +1688,69 @@ void PathfindCell::setParentCellHierarchical( PathfindCell* parent  )
  */
 void PathfindCell::clearParentCell( void  ) 
 { 
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	m_info->m_pathParent = NULL;
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	touchNode()->m_pathParent = NULL;
 }
 
 
 /**
- * Allocates an info record for a cell.
+ * Allocates a search node for a cell.  Cells with an info record get their node when
+ * the search first writes to them.
  */
 Bool PathfindCell::allocateInfo( const ICoord2D &pos ) 
+{ 
+	if (m_info) {
+		return true;
+	}
+	PathfindSearchContext *context = PathfindSearchContext::getCurrent();
+	if (context->getNode(m_index)) {
+		return true;
+	}
+	return context->allocateNode(this, pos, true) != NULL;
+}
+
+/**
+ * Releases the search node for a cell.
+ */
+void PathfindCell::releaseInfo( void ) 
+{ 
+	PathfindSearchContext *context = PathfindSearchContext::getCurrent();
+	PathfindSearchNode *node = context->getNode(m_index);
+	if (node) {
+		DEBUG_ASSERTCRASH(node->m_prevOpen==NULL && node->m_nextOpen==NULL, ("Shouldn't be linked."));
+		DEBUG_ASSERTCRASH(node->m_open==NULL && node->m_closed==NULL, ("Shouldn't be linked."));
+		if (node->m_prevOpen || node->m_nextOpen || node->m_open || node->m_closed) {
+			// Bad release.  Skip for now, better leak than crash.  jba.
+			return;
+		}
+		context->releaseNode(node);
+	}
+}
+
+/**
+ * Allocates the info record that holds units & obstacles for a cell.
+ */
+Bool PathfindCell::allocatePersistentInfo( const ICoord2D &pos ) 
 { 
 	if (!m_info) {
 		m_info = PathfindCellInfo::getACellInfo(this, pos);
+		if (m_info) {
+			// A node left over from a search hands its pool slot to the info.
+			PathfindSearchNode *node = getNode();
+			if (node && node->m_usesPoolSlot) {
+				node->m_usesPoolSlot = false;
+				PathfindSearchContext::getCurrent()->m_numPoolNodes--;
+			}
+		}
 		return (m_info != NULL);
 	} 
 	return true;
 }
 
 /**
- * Releases an info record for a cell.
+ * Releases the info record for a cell, if no units or obstacles need it.
  */
-void PathfindCell::releaseInfo( void ) 
+void PathfindCell::releasePersistentInfo( void ) 
 { 
 	if (m_type==PathfindCell::CELL_OBSTACLE) {
 		return;
@@ -1290,13 +1763,13 @@ void PathfindCell::releaseInfo( void )
 	}
 
 	if (m_info) {
-		DEBUG_ASSERTCRASH(m_info->m_prevOpen==NULL && m_info->m_nextOpen==NULL, ("Shouldn't be linked."));
-		DEBUG_ASSERTCRASH(m_info->m_open==NULL && m_info->m_closed==NULL, ("Shouldn't be linked."));
 		DEBUG_ASSERTCRASH(m_info->m_goalUnitID==INVALID_ID && m_info->m_posUnitID==INVALID_ID, ("Shouldn't be occupied."));
 		DEBUG_ASSERTCRASH(m_info->m_goalAircraftID==INVALID_ID , ("Shouldn't be occupied by aircraft."));
-		if (m_info->m_prevOpen || m_info->m_nextOpen || m_info->m_open || m_info->m_closed) {
-			// Bad release.  Skip for now, better leak than crash.  jba.
-			return;
+		PathfindSearchNode *node = getNode();
+		if (node) {
+			// A node left over from a search takes over the pool slot.
+			node->m_usesPoolSlot = true;
+			PathfindSearchContext::getCurrent()->m_numPoolNodes++;
 		}
 		PathfindCellInfo::releaseACellInfo(m_info);
 		m_info = NULL;
@@ -1316,7 +1789,7 @@ void PathfindCell::setGoalUnit(ObjectID unitID, const ICoord2D &pos )
 				// No units here.
 				DEBUG_ASSERTCRASH(m_flags==UNIT_GOAL, ("Bad flags."));
 				m_flags = NO_UNITS;
-				releaseInfo();
+				releasePersistentInfo();
 			} else{
 				m_flags = UNIT_PRESENT_MOVING;
 			}
@@ -1327,7 +1800,7 @@ void PathfindCell::setGoalUnit(ObjectID unitID, const ICoord2D &pos )
 		// adding goal.
 		if (!m_info) {
 			DEBUG_ASSERTCRASH(m_flags == NO_UNITS, ("Bad flags."));
-			allocateInfo(pos);
+			allocatePersistentInfo(pos);
 		}
 		if (!m_info) {
 			DEBUG_CRASH(("Ran out of pathfind cells - fatal error!!!!! jba. "));
@@ -1355,7 +1828,7 @@ void PathfindCell::setGoalAircraft(ObjectID unitID, const ICoord2D &pos )
 		if (m_info) {
 			m_info->m_goalAircraftID = INVALID_ID;
 			m_aircraftGoal = false;
-			releaseInfo();
+			releasePersistentInfo();
 		}	else {
 			DEBUG_ASSERTCRASH(m_aircraftGoal==false, ("Bad flags."));
 		}
@@ -1363,7 +1836,7 @@ void PathfindCell::setGoalAircraft(ObjectID unitID, const ICoord2D &pos )
 		// adding goal.
 		if (!m_info) {
 			DEBUG_ASSERTCRASH(m_aircraftGoal==false, ("Bad flags."));
-			allocateInfo(pos);
+			allocatePersistentInfo(pos);
 		}
 		if (!m_info) {
 			DEBUG_CRASH(("Ran out of pathfind cells - fatal error!!!!! jba. "));
@@ -1388,7 +1861,7 @@ void PathfindCell::setPosUnit(ObjectID unitID, const ICoord2D &pos )
 				// No units here.
 				DEBUG_ASSERTCRASH(m_flags==UNIT_PRESENT_MOVING, ("Bad flags."));
 				m_flags = NO_UNITS;
-				releaseInfo();
+				releasePersistentInfo();
 			}	else {
 				m_flags = UNIT_GOAL;
 			}
@@ -1399,7 +1872,7 @@ void PathfindCell::setPosUnit(ObjectID unitID, const ICoord2D &pos )
 		// adding goal.
 		if (!m_info) {
 			DEBUG_ASSERTCRASH(m_flags == NO_UNITS, ("Bad flags."));
-			allocateInfo(pos);
+			allocatePersistentInfo(pos);
 		}
 		if (!m_info) {
 			DEBUG_CRASH(("Ran out of pathfind cells - fatal error!!!!! jba. "));
@@ -1440,18 +1913,15 @@ void PathfindCell::setTypeAsObstacle( Object *obstacle, Bool isFence, const ICoo
 		m_type = PathfindCell::CELL_RUBBLE;
 		if (m_info) {
 			m_info->m_obstacleID = INVALID_ID;
-			releaseInfo();
+			releasePersistentInfo();
 		}
 		return;
 	}
 
 	m_type = PathfindCell::CELL_OBSTACLE ;
-	if (!m_info) {
-		m_info = PathfindCellInfo::getACellInfo(this, pos);
-		if (!m_info) {
-			DEBUG_CRASH(("Not enough PathFindCellInfos in pool."));
-			return;
-		}
+	if (!allocatePersistentInfo(pos)) {
+		DEBUG_CRASH(("Not enough PathFindCellInfos in pool."));
+		return;
 	}
 	m_info->m_obstacleID = obstacle->getID();
 	m_info->m_obstacleIsFence = isFence;
@@ -1484,59 +1954,63 @@ void PathfindCell::removeObstacle( Object *obstacle )
 	m_type = PathfindCell::CELL_CLEAR;
 	if (m_info) {
 		m_info->m_obstacleID = INVALID_ID;
-		releaseInfo();
+		releasePersistentInfo();
 	}
 }
 
 /// put self on "open" list in ascending cost order, return new list
 PathfindCell *PathfindCell::putOnSortedOpenList( PathfindCell *list )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==FALSE, ("Serious error - Invalid flags. jba"));
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	PathfindSearchNode *node = touchNode();
+	DEBUG_ASSERTCRASH(node->m_closed==FALSE && node->m_open==FALSE, ("Serious error - Invalid flags. jba"));
 	if (list == NULL)
 	{
 		list = this;
-		m_info->m_prevOpen = NULL;
-		m_info->m_nextOpen = NULL;
+		node->m_prevOpen = NULL;
+		node->m_nextOpen = NULL;
 	}
 	else
 	{
 		// insertion sort
-		PathfindCell *c, *lastCell = NULL;
-		for( c = list; c; c = c->getNextOpen() )
+		PathfindSearchNode *c, *lastNode = NULL;
+		for( c = list->getNode(); c; c = c->m_nextOpen )
 		{
-			if (c->m_info->m_totalCost > m_info->m_totalCost)
+			if (c->m_totalCost > node->m_totalCost)
 				break;
 
-			lastCell = c;
+			lastNode = c;
 		}
 
 		if (c)
 		{
 			// insert just before "c"
-			if (c->m_info->m_prevOpen)
-				c->m_info->m_prevOpen->m_nextOpen = this->m_info;
+			if (c->m_prevOpen)
+				c->m_prevOpen->m_nextOpen = node;
 			else
 				list = this;
 
-			m_info->m_prevOpen = c->m_info->m_prevOpen;
-			c->m_info->m_prevOpen = this->m_info;
+			node->m_prevOpen = c->m_prevOpen;
+			c->m_prevOpen = node;
 				
-			m_info->m_nextOpen = c->m_info;
+			node->m_nextOpen = c;
 
 		}
 		else
 		{
-			// append after "lastCell" - end of list
-			lastCell->m_info->m_nextOpen = this->m_info;
-			m_info->m_prevOpen = lastCell->m_info;
-			m_info->m_nextOpen = NULL;
+			// append after "lastNode" - end of list
+			lastNode->m_nextOpen = node;
+			node->m_prevOpen = lastNode;
+			node->m_nextOpen = NULL;
 		}
 	}
 
 	// mark newCell as being on open list
-	m_info->m_open = true;
-	m_info->m_closed = false;
+	if (!node->m_open && !node->m_closed) {
+		PathfindSearchContext::getCurrent()->nodeListed();
+	}
+	node->m_open = true;
+	node->m_closed = false;
 
 	return list;
 }
@@ -1544,86 +2018,47 @@ PathfindCell *PathfindCell::putOnSortedOpenList( PathfindCell *list )
 /// remove self from "open" list
 PathfindCell *PathfindCell::removeFromOpenList( PathfindCell *list )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==TRUE, ("Serious error - Invalid flags. jba"));
-	if (m_info->m_nextOpen)
-		m_info->m_nextOpen->m_prevOpen = m_info->m_prevOpen;
+	PathfindSearchNode *node = getNode();
+	DEBUG_ASSERTCRASH(node, ("Has to have info."));
+	DEBUG_ASSERTCRASH(node->m_closed==FALSE && node->m_open==TRUE, ("Serious error - Invalid flags. jba"));
+	if (node->m_nextOpen)
+		node->m_nextOpen->m_prevOpen = node->m_prevOpen;
 	
-	if (m_info->m_prevOpen)
-		m_info->m_prevOpen->m_nextOpen = m_info->m_nextOpen;
+	if (node->m_prevOpen)
+		node->m_prevOpen->m_nextOpen = node->m_nextOpen;
 	else
 		list = getNextOpen();
 
-	m_info->m_open = false;
-	m_info->m_nextOpen = NULL;
-	m_info->m_prevOpen = NULL;
-
-	return list;
-}
-
-/// remove all cells from "open" list
-Int PathfindCell::releaseOpenList( PathfindCell *list )
-{
-	Int count = 0;
-	while (list) {
-		count++;
-		DEBUG_ASSERTCRASH(list->m_info, ("Has to have info."));
-		DEBUG_ASSERTCRASH(list->m_info->m_closed==FALSE && list->m_info->m_open==TRUE, ("Serious error - Invalid flags. jba"));
-		PathfindCell *cur = list;
-		PathfindCellInfo *curInfo = list->m_info;
-		if (curInfo->m_nextOpen) {
-			list = curInfo->m_nextOpen->m_cell;
-		}	else {
-			list = NULL;
-		}
-		DEBUG_ASSERTCRASH(cur == curInfo->m_cell, ("Bad backpointer in PathfindCellInfo"));
-		curInfo->m_nextOpen = NULL;
-		curInfo->m_prevOpen = NULL;
-		curInfo->m_open = FALSE;
-		cur->releaseInfo();
+	node->m_open = false;
+	node->m_nextOpen = NULL;
+	node->m_prevOpen = NULL;
+	if (!node->m_closed) {
+		PathfindSearchContext::getCurrent()->nodeUnlisted();
 	}
-	return count;
-}
 
-/// remove all cells from "closed" list
-Int PathfindCell::releaseClosedList( PathfindCell *list )
-{
-	Int count = 0;
-	while (list) {
-		count++;
-		DEBUG_ASSERTCRASH(list->m_info, ("Has to have info."));
-		DEBUG_ASSERTCRASH(list->m_info->m_closed==TRUE && list->m_info->m_open==FALSE, ("Serious error - Invalid flags. jba"));
-		PathfindCell *cur = list;
-		PathfindCellInfo *curInfo = list->m_info;
-		if (curInfo->m_nextOpen) {
-			list = curInfo->m_nextOpen->m_cell;
-		}	else {
-			list = NULL;
-		}
-		DEBUG_ASSERTCRASH(cur == curInfo->m_cell, ("Bad backpointer in PathfindCellInfo"));
-		curInfo->m_nextOpen = NULL;
-		curInfo->m_prevOpen = NULL;
-		curInfo->m_closed = FALSE;
-		cur->releaseInfo();
-	}
-	return count;
+	return list;
 }
 
 /// put self on "closed" list, return new list
 PathfindCell *PathfindCell::putOnClosedList( PathfindCell *list )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==FALSE, ("Serious error - Invalid flags. jba"));
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	PathfindSearchNode *node = touchNode();
+	DEBUG_ASSERTCRASH(node->m_closed==FALSE && node->m_open==FALSE, ("Serious error - Invalid flags. jba"));
 	// only put on list if not already on it
-	if (m_info->m_closed == FALSE)
+	if (node->m_closed == FALSE)
 	{
-		m_info->m_closed = FALSE;
-		m_info->m_closed = TRUE;
+		if (!node->m_open) {
+			PathfindSearchContext::getCurrent()->nodeListed();
+		}
+		node->m_closed = FALSE;
+		node->m_closed = TRUE;
 
-		m_info->m_prevOpen = NULL;
-		m_info->m_nextOpen = list?list->m_info:NULL;
-		if (list)
-			list->m_info->m_prevOpen = this->m_info;
+		PathfindSearchNode *listNode = list ? list->getNode() : NULL;
+		node->m_prevOpen = NULL;
+		node->m_nextOpen = listNode;
+		if (listNode)
+			listNode->m_prevOpen = node;
 		
 		list = this;
 	}
@@ -1634,19 +2069,23 @@ PathfindCell *PathfindCell::putOnClosedList( PathfindCell *list )
 /// remove self from "closed" list
 PathfindCell *PathfindCell::removeFromClosedList( PathfindCell *list )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	DEBUG_ASSERTCRASH(m_info->m_closed==TRUE && m_info->m_open==FALSE, ("Serious error - Invalid flags. jba"));
-	if (m_info->m_nextOpen)
-		m_info->m_nextOpen->m_prevOpen = m_info->m_prevOpen;
+	PathfindSearchNode *node = getNode();
+	DEBUG_ASSERTCRASH(node, ("Has to have info."));
+	DEBUG_ASSERTCRASH(node->m_closed==TRUE && node->m_open==FALSE, ("Serious error - Invalid flags. jba"));
+	if (node->m_nextOpen)
+		node->m_nextOpen->m_prevOpen = node->m_prevOpen;
 	
-	if (m_info->m_prevOpen)
-		m_info->m_prevOpen->m_nextOpen = m_info->m_nextOpen;
+	if (node->m_prevOpen)
+		node->m_prevOpen->m_nextOpen = node->m_nextOpen;
 	else
 		list = getNextOpen();
 
-	m_info->m_closed = false;
-	m_info->m_nextOpen = NULL;
-	m_info->m_prevOpen = NULL;
+	node->m_closed = false;
+	node->m_nextOpen = NULL;
+	node->m_prevOpen = NULL;
+	if (!node->m_open) {
+		PathfindSearchContext::getCurrent()->nodeUnlisted();
+	}
 
 	return list;
 }
@@ -1658,9 +2097,9 @@ const Real COST_TO_DISTANCE_FACTOR_SQR = COST_TO_DISTANCE_FACTOR*COST_TO_DISTANC
 
 UnsignedInt PathfindCell::costToGoal( PathfindCell *goal )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	Int dx = m_info->m_pos.x - goal->getXIndex();
-	Int dy = m_info->m_pos.y - goal->getYIndex();
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	Int dx = getXIndex() - goal->getXIndex();
+	Int dy = getYIndex() - goal->getYIndex();
 #define NO_REAL_DIST
 #ifdef REAL_DIST
 	Int cost = COST_ORTHOGONAL*sqrt(dx*dx + dy*dy);
@@ -1682,16 +2121,16 @@ UnsignedInt PathfindCell::costToGoal( PathfindCell *goal )
 
 UnsignedInt PathfindCell::costToHierGoal( PathfindCell *goal )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
-	Int dx = m_info->m_pos.x - goal->getXIndex();
-	Int dy = m_info->m_pos.y - goal->getYIndex();
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
+	Int dx = getXIndex() - goal->getXIndex();
+	Int dy = getYIndex() - goal->getYIndex();
 	Int cost = REAL_TO_INT_FLOOR(COST_ORTHOGONAL*sqrt(dx*dx + dy*dy) + 0.5f);
 	return cost;
 }
 
 UnsignedInt PathfindCell::costSoFar( PathfindCell *parent )
 {
-	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
+	DEBUG_ASSERTCRASH(hasInfo(), ("Has to have info."));
 	// very first node in path - no turns, no cost
 	if (parent == NULL)
 		return 0;
@@ -1700,8 +2139,8 @@ UnsignedInt PathfindCell::costSoFar( PathfindCell *parent )
 	ICoord2D prevDir;
 	Int cost;
 
-	prevDir.x = parent->getXIndex() - m_info->m_pos.x;
-	prevDir.y = parent->getYIndex() - m_info->m_pos.y;
+	prevDir.x = parent->getXIndex() - getXIndex();
+	prevDir.y = parent->getYIndex() - getYIndex();
 
 	// diagonal moves cost a bit more than orthogonal ones
 	if (prevDir.x == 0 || prevDir.y == 0)
@@ -1924,6 +2363,41 @@ inline void applyBlockZone(PathfindCell &targetCell, const PathfindCell &sourceC
 
 }
 
+/// Which zone equivalencies join the zones of two neighboring cells.
+inline UnsignedByte getZoneRelations(const PathfindCell &targetCell, const PathfindCell &sourceCell)
+{
+	UnsignedByte relations = 0;
+	if (targetCell.getType() == sourceCell.getType()) relations |= ZoneLink::HIERARCHICAL;
+	if (waterGround(targetCell, sourceCell)) relations |= ZoneLink::GROUND_WATER;
+	if (groundRubble(targetCell, sourceCell)) relations |= ZoneLink::GROUND_RUBBLE;
+	if (groundCliff(targetCell, sourceCell)) relations |= ZoneLink::GROUND_CLIFF;
+	if (terrain(targetCell, sourceCell)) relations |= ZoneLink::TERRAIN;
+	if (crusherGround(targetCell, sourceCell)) relations |= ZoneLink::CRUSHER;
+	return relations;
+}
+
+/// Union-find root of a zone.  Roots are always the lowest zone in their set.
+inline Int findZoneRoot(UnsignedShort *zoneEquivalency, Int zone)
+{
+	while (zoneEquivalency[zone] != zone) {
+		zoneEquivalency[zone] = zoneEquivalency[zoneEquivalency[zone]];
+		zone = zoneEquivalency[zone];
+	}
+	return zone;
+}
+
+/// Same result as resolveZones, without going over the whole table each time.
+inline void joinZones(UnsignedShort *zoneEquivalency, Int zone1, Int zone2)
+{
+	zone1 = findZoneRoot(zoneEquivalency, zone1);
+	zone2 = findZoneRoot(zoneEquivalency, zone2);
+	if (zone1 < zone2) {
+		zoneEquivalency[zone2] = zone1;
+	}	else if (zone2 < zone1) {
+		zoneEquivalency[zone1] = zone2;
+	}
+}
+
 //------------------------  ZoneBlock  -------------------------------
 ZoneBlock::ZoneBlock() : m_firstZone(0), 
 m_numZones(0), 
@@ -1932,20 +2406,27 @@ m_groundWaterZones(NULL),
 m_groundRubbleZones(NULL), 
 m_crusherZones(NULL), 
 m_zonesAllocated(0),
-m_interactsWithBridge(FALSE)
+m_interactsWithBridge(FALSE),
+m_isDirty(FALSE),
+m_links(NULL),
+m_numLinks(0),
+m_linksAllocated(0)
 {		
 	m_cellOrigin.x = 0;
 	m_cellOrigin.y = 0;
 	//Added By Sadullah Nader
 	//Initialization(s) inserted
 	m_firstZone = 0;
-	m_markedPassable = TRUE;
 	//
 }
 
 ZoneBlock::~ZoneBlock()  
 {
 	freeZones();
+	if (m_links) {
+		delete [] m_links;
+		m_links = NULL;
+	}
 }
 
 void ZoneBlock::freeZones(void) 
@@ -1968,6 +2449,69 @@ void ZoneBlock::freeZones(void)
 	}
 }
 
+/* Renumber the zones by delta.  Gives the same result as blockCalculateZones on the renumbered
+cells, without going over them again. */
+void ZoneBlock::shiftZones(Int delta) 
+{
+	m_firstZone += delta;
+	if (m_groundCliffZones == NULL) {
+		return;
+	}
+	Int i;
+	for (i=0; i<m_zonesAllocated; i++) {
+		m_groundCliffZones[i] += delta;
+		m_groundWaterZones[i] += delta;
+		m_groundRubbleZones[i] += delta;
+		m_crusherZones[i] += delta;
+	}
+}
+
+/* Add a link, or merge the relations into the link that joins the same zones. */
+void ZoneBlock::addLink(UnsignedShort zone, UnsignedByte otherBlock, UnsignedShort otherZone, UnsignedByte relations) 
+{
+	Int i;
+	for (i=0; i<m_numLinks; i++) {
+		ZoneLink &link = m_links[i];
+		if (link.m_zone == zone && link.m_otherBlock == otherBlock && link.m_otherZone == otherZone) {
+			link.m_relations |= relations;
+			return;
+		}
+	}
+	if (m_numLinks >= m_linksAllocated) {
+		Int newSize = m_linksAllocated ? m_linksAllocated*2 : 8;
+		ZoneLink *newLinks = MSGNEW("PathfindZoneInfo") ZoneLink[newSize];
+		if (m_numLinks > 0) {
+			memcpy(newLinks, m_links, m_numLinks*sizeof(ZoneLink));
+		}
+		delete [] m_links;
+		m_links = newLinks;
+		m_linksAllocated = newSize;
+	}
+	ZoneLink &link = m_links[m_numLinks++];
+	link.m_zone = zone;
+	link.m_otherBlock = otherBlock;
+	link.m_otherZone = otherZone;
+	link.m_relations = relations;
+}
+
+#ifdef TEST_INCREMENTAL_ZONES
+UnsignedInt ZoneBlock::getZoneHash(void) const
+{
+	UnsignedInt hash = m_firstZone*31 + m_numZones;
+	hash = hash*31 + (m_interactsWithBridge ? 1 : 0);
+	if (m_numZones > 1) {
+		Int i;
+		for (i=0; i<m_numZones; i++) {
+			hash = hash*31 + m_groundCliffZones[i];
+			hash = hash*31 + m_groundWaterZones[i];
+			hash = hash*31 + m_groundRubbleZones[i];
+			hash = hash*31 + m_crusherZones[i];
+		}
+	}
+	return hash;
+}
+#endif
+
 /* Allocate zone equivalency arrays large enough to hold required entries.  If the arrays are already
 large enough, reuse.  Then calculate terrain equivalencies. */
 void ZoneBlock::blockCalculateZones(PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds) 
@@ -2137,10 +2681,13 @@ m_crusherZones(NULL),
 m_hierarchicalZones(NULL), 
 m_blockOfZoneBlocks(NULL),
 m_zoneBlocks(NULL),
-m_zonesAllocated(0)
+m_zonesAllocated(0),
+m_needFullZoneCalc(true),
+m_haveZoneLinks(false)
 {		
 	m_zoneBlockExtent.x = 0;
 	m_zoneBlockExtent.y = 0;
+	m_zoneBounds.lo.x = m_zoneBounds.lo.y = m_zoneBounds.hi.x = m_zoneBounds.hi.y = 0;
 }
 
 PathfindZoneManager::~PathfindZoneManager()  
@@ -2190,6 +2737,7 @@ void PathfindZoneManager::freeBlocks()
 	}
 	m_zoneBlockExtent.x = 0;
 	m_zoneBlockExtent.y = 0;
+	m_haveZoneLinks = false;
 }
 
 /* Allocate zone equivalency arrays large enough to hold m_maxZone entries.  If the arrays are already
@@ -2231,17 +2779,43 @@ void PathfindZoneManager::allocateBlocks(const IRegion2D &globalBounds)
 	for (i=0; i<m_zoneBlockExtent.x; i++) {
 		m_zoneBlocks[i] = &m_blockOfZoneBlocks[i*(m_zoneBlockExtent.y)];
 	}
+	PathfindSearchContext::getCurrent()->setNumPassableBlocks(m_zoneBlockExtent.x*m_zoneBlockExtent.y);
 }
 
 void PathfindZoneManager::markZonesDirty(void)  ///< Called when the zones need to be recalculated.
 {
 	m_needToCalculateZones = true;
+	m_needFullZoneCalc = true;
+} 
+
+void PathfindZoneManager::markZonesDirty(const IRegion2D &cells)  ///< Called when the cells in this area changed type.
+{
+	m_needToCalculateZones = true;
+	if (!m_haveZoneLinks) {
+		m_needFullZoneCalc = true;
+		return;
+	}
+	Int loX = (cells.lo.x - m_zoneBounds.lo.x)/ZONE_BLOCK_SIZE;
+	Int loY = (cells.lo.y - m_zoneBounds.lo.y)/ZONE_BLOCK_SIZE;
+	Int hiX = (cells.hi.x - m_zoneBounds.lo.x)/ZONE_BLOCK_SIZE;
+	Int hiY = (cells.hi.y - m_zoneBounds.lo.y)/ZONE_BLOCK_SIZE;
+	if (loX < 0) loX = 0;
+	if (loY < 0) loY = 0;
+	if (hiX >= m_zoneBlockExtent.x) hiX = m_zoneBlockExtent.x-1;
+	if (hiY >= m_zoneBlockExtent.y) hiY = m_zoneBlockExtent.y-1;
+	Int xBlock, yBlock;
+	for (xBlock=loX; xBlock<=hiX; xBlock++) {
+		for (yBlock=loY; yBlock<=hiY; yBlock++) {
+			m_zoneBlocks[xBlock][yBlock].setDirty(true);
+		}
+	}
 } 
 
 void PathfindZoneManager::reset(void)  ///< Called when the map is reset.
 {
 	freeZones();
 	freeBlocks();
+	m_needFullZoneCalc = true;
 } 
 
 /**
@@ -2499,19 +3073,18 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 		}
 	}
 
-	if (m_maxZone >= m_zonesAllocated) {
-		RELEASE_CRASH("Pathfind allocation error - fatal. see jba.");
-	}
-	for (i=1; i<m_maxZone; i++) {
-		// Flatten hierarchical zones.
-		Int zone = m_hierarchicalZones[i];
-		m_hierarchicalZones[i] = m_hierarchicalZones[zone];
+	flattenEquivalencies();
+
+	// Remember how the blocks connect, so a change to a few cells can be patched up by updateZones.
+	for (xBlock=0; xBlock<xCount; xBlock++) {
+		for (yBlock=0; yBlock<yCount; yBlock++) {
+			calculateBlockLinks(map, globalBounds, xBlock, yBlock);
+			m_zoneBlocks[xBlock][yBlock].setDirty(false);
+		}
 	}
-	flattenZones(m_groundCliffZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_groundWaterZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_groundRubbleZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_terrainZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_crusherZones, m_hierarchicalZones, m_maxZone);
+	m_zoneBounds = globalBounds;
+	m_haveZoneLinks = true;
+	m_needFullZoneCalc = false;
 
 
 #ifdef DEBUG_QPF
@@ -2551,15 +3124,346 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 	m_needToCalculateZones = false;
 }
 
+/**
+ * Final pass over the equivalency tables, once the zones in them have been joined.
+ */
+void PathfindZoneManager::flattenEquivalencies(void)
+{
+	if (m_maxZone >= m_zonesAllocated) {
+		RELEASE_CRASH("Pathfind allocation error - fatal. see jba.");
+	}
+	Int i;
+	for (i=1; i<m_maxZone; i++) {
+		// Flatten hierarchical zones.
+		Int zone = m_hierarchicalZones[i];
+		m_hierarchicalZones[i] = m_hierarchicalZones[zone];
+	}
+	flattenZones(m_groundCliffZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_groundWaterZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_groundRubbleZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_terrainZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_crusherZones, m_hierarchicalZones, m_maxZone);
+}
+
+/**
+ * Cell bounds of a zone block, inclusive.
+ */
+void PathfindZoneManager::getBlockBounds(const IRegion2D &globalBounds, Int xBlock, Int yBlock, IRegion2D &bounds) const
+{
+	bounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
+	bounds.lo.y = globalBounds.lo.y + yBlock*ZONE_BLOCK_SIZE;
+	bounds.hi.x = bounds.lo.x + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
+	bounds.hi.y = bounds.lo.y + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
+	if (bounds.hi.x > globalBounds.hi.x) {
+		bounds.hi.x = globalBounds.hi.x;
+	}
+	if (bounds.hi.y > globalBounds.hi.y) {
+		bounds.hi.y = globalBounds.hi.y;
+	}
+}
+
+/**
+ * Zones the cells of one block, the same way calculateZones does, and returns the number of zones.
+ * The cells are numbered from 0 - the caller adds the block's first zone.
+ */
+Int PathfindZoneManager::labelBlockCells(PathfindCell **map, const IRegion2D &bounds) const
+{
+	UnsignedShort zoneEquivalency[ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1];
+	UnsignedShort collapsedZones[ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1];
+	Int numZones = 1;	// zone 0 is the unset flag.
+	Int i, j;
+	for (i=0; i<ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1; i++) {
+		zoneEquivalency[i] = i;
+	}
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			PathfindCell *cell = &map[i][j];
+			cell->setZone(0);
+			if (i>bounds.lo.x) {
+				if (map[i][j].getType() == map[i-1][j].getType()) {
+					applyZone(map[i][j], map[i-1][j], zoneEquivalency, numZones);
+				}
+			}
+			if (j>bounds.lo.y) {
+				if (map[i][j].getType() == map[i][j-1].getType()) {
+					applyZone(map[i][j], map[i][j-1], zoneEquivalency, numZones);
+				}
+			}
+			if (cell->getZone()==0) {
+				cell->setZone(numZones);
+				numZones++;
+			}
+		}
+	}
+
+	// Collapse into a 0,1,2... sequence, in the order calculateZones numbers them.
+	Int count = 0;
+	collapsedZones[0] = 0;
+	for (i=1; i<numZones; i++) {
+		Int zone = zoneEquivalency[i];
+		if (zone == i) {
+			collapsedZones[i] = count;
+			++count;
+		}	else {
+			collapsedZones[i] = collapsedZones[zone];
+		}
+	}
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			map[i][j].setZone(collapsedZones[map[i][j].getZone()]);
+		}
+	}
+	return count;
+}
+
+/**
+ * Records which zones the cells in a block touch - in the block, in the blocks before it, 
+ * and on bridges - and how they are related.
+ */
+void PathfindZoneManager::calculateBlockLinks(PathfindCell **map, const IRegion2D &globalBounds, Int xBlock, Int yBlock)
+{
+	ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+	block.clearLinks();
+	IRegion2D bounds;
+	getBlockBounds(globalBounds, xBlock, yBlock, bounds);
+	Int firstZone = block.getFirstZone();
+	Int i, j;
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			const PathfindCell &cell = map[i][j];
+			UnsignedShort zone = cell.getZone() - firstZone;
+			if ( (cell.getConnectLayer() > LAYER_GROUND) && 
+				(cell.getType() == PathfindCell::CELL_CLEAR) ) {
+				block.addLink(zone, ZoneLink::BRIDGE_LAYER, cell.getConnectLayer(), ZoneLink::HIERARCHICAL);
+			}
+			if (i>globalBounds.lo.x && cell.getZone()!=map[i-1][j].getZone()) {
+				UnsignedByte relations = getZoneRelations(cell, map[i-1][j]);
+				if (relations) {
+					if (i>bounds.lo.x) {
+						block.addLink(zone, ZoneLink::SAME_BLOCK, map[i-1][j].getZone() - firstZone, relations);
+					}	else {
+						block.addLink(zone, ZoneLink::PREV_X_BLOCK, 
+							map[i-1][j].getZone() - m_zoneBlocks[xBlock-1][yBlock].getFirstZone(), relations);
+					}
+				}
+			}
+			if (j>globalBounds.lo.y && cell.getZone()!=map[i][j-1].getZone()) {
+				UnsignedByte relations = getZoneRelations(cell, map[i][j-1]);
+				if (relations) {
+					if (j>bounds.lo.y) {
+						block.addLink(zone, ZoneLink::SAME_BLOCK, map[i][j-1].getZone() - firstZone, relations);
+					}	else {
+						block.addLink(zone, ZoneLink::PREV_Y_BLOCK, 
+							map[i][j-1].getZone() - m_zoneBlocks[xBlock][yBlock-1].getFirstZone(), relations);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Builds the zone equivalency tables from the blocks' links.  Every zone ends up pointing
+ * at the lowest zone it is joined to, which is what the map scan in calculateZones gives.
+ */
+void PathfindZoneManager::calculateEquivalencies(PathfindLayer layers[])
+{
+	Int i;
+	for (i=0; i<m_zonesAllocated; i++) {
+		m_groundCliffZones[i] = i;
+		m_groundWaterZones[i] = i;
+		m_groundRubbleZones[i] = i;
+		m_terrainZones[i] = i;
+		m_crusherZones[i] = i;
+		m_hierarchicalZones[i] = i;
+	}
+
+	Int xBlock, yBlock;
+	for (xBlock=0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			const ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			Int numLinks = block.getNumLinks();
+			for (i=0; i<numLinks; i++) {
+				const ZoneLink &link = block.getLink(i);
+				Int zone = block.getFirstZone() + link.m_zone;
+				if (link.m_otherBlock == ZoneLink::BRIDGE_LAYER) {
+					joinZones(m_hierarchicalZones, zone, layers[link.m_otherZone].getZone());
+					continue;
+				}
+				const ZoneBlock *otherBlock = &block;
+				if (link.m_otherBlock == ZoneLink::PREV_X_BLOCK) {
+					otherBlock = &m_zoneBlocks[xBlock-1][yBlock];
+				}	else if (link.m_otherBlock == ZoneLink::PREV_Y_BLOCK) {
+					otherBlock = &m_zoneBlocks[xBlock][yBlock-1];
+				}
+				Int otherZone = otherBlock->getFirstZone() + link.m_otherZone;
+				if (link.m_relations & ZoneLink::HIERARCHICAL) {
+					joinZones(m_hierarchicalZones, zone, otherZone);
+				}
+				if (link.m_relations & ZoneLink::GROUND_WATER) {
+					joinZones(m_groundWaterZones, zone, otherZone);
+				}
+				if (link.m_relations & ZoneLink::GROUND_RUBBLE) {
+					joinZones(m_groundRubbleZones, zone, otherZone);
+				}
+				if (link.m_relations & ZoneLink::GROUND_CLIFF) {
+					joinZones(m_groundCliffZones, zone, otherZone);
+				}
+				if (link.m_relations & ZoneLink::TERRAIN) {
+					joinZones(m_terrainZones, zone, otherZone);
+				}
+				if (link.m_relations & ZoneLink::CRUSHER) {
+					joinZones(m_crusherZones, zone, otherZone);
+				}
+			}
+		}
+	}
+
+	// A zone's parent is always lower than it is, so one pass up the table finishes it.
+	for (i=1; i<m_maxZone; i++) {
+		m_groundCliffZones[i] = m_groundCliffZones[m_groundCliffZones[i]];
+		m_groundWaterZones[i] = m_groundWaterZones[m_groundWaterZones[i]];
+		m_groundRubbleZones[i] = m_groundRubbleZones[m_groundRubbleZones[i]];
+		m_terrainZones[i] = m_terrainZones[m_terrainZones[i]];
+		m_crusherZones[i] = m_crusherZones[m_crusherZones[i]];
+		m_hierarchicalZones[i] = m_hierarchicalZones[m_hierarchicalZones[i]];
+	}
+}
+
+/**
+ * Brings the zones up to date after markZonesDirty.  If only cell types changed, just the 
+ * blocks they are in are zoned again, and the equivalencies are rebuilt from the block links.  
+ * Zones are numbered exactly as calculateZones numbers them, so the result is the same as
+ * a full calculation - blocks after a changed one are renumbered if its zone count changed.
+ */
+void PathfindZoneManager::updateZones( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds )
+{
+	if (m_needFullZoneCalc || !m_haveZoneLinks || 
+			globalBounds.lo.x != m_zoneBounds.lo.x || globalBounds.lo.y != m_zoneBounds.lo.y ||
+			globalBounds.hi.x != m_zoneBounds.hi.x || globalBounds.hi.y != m_zoneBounds.hi.y) {
+		calculateZones(map, layers, globalBounds);
+		return;
+	}
+
+	Int i, j;
+	Int xBlock, yBlock;
+	Int nextZone = 1;	// we start using zone 0 as a flag.
+	for (xBlock=0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			IRegion2D bounds;
+			getBlockBounds(globalBounds, xBlock, yBlock, bounds);
+			if (block.isDirty()) {
+				Int numZones = labelBlockCells(map, bounds);
+				Bool interactsWithBridge = false;
+				for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+					for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+						PathfindCell *cell = &map[i][j];
+						cell->setZone(cell->getZone() + nextZone);
+						if (cell->getConnectLayer() > LAYER_GROUND) {
+							interactsWithBridge = true;
+						}
+					}
+				}
+				block.setInteractsWithBridge(interactsWithBridge);
+				block.blockCalculateZones(map, layers, bounds);
+				nextZone += numZones;
+			}	else {
+				Int delta = nextZone - block.getFirstZone();
+				if (delta != 0) {
+					for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+						for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+							map[i][j].setZone(map[i][j].getZone() + delta);
+						}
+					}
+					block.shiftZones(delta);
+				}
+				nextZone += block.getNumZones();
+			}
+		}
+	}
+
+	// Bridge layers come after all the cells.
+	for (i=0; i<=LAYER_LAST; i++) {
+		layers[i].setZone( nextZone );
+		nextZone++;
+		layers[i].applyZone();
+		if (!layers[i].isUnused() && !layers[i].isDestroyed()) {
+			ICoord2D ndx;
+			layers[i].getStartCellIndex(&ndx);
+			setBridge(ndx.x, ndx.y, true);	
+			layers[i].getEndCellIndex(&ndx);
+			setBridge(ndx.x, ndx.y, true);	
+		}
+	}
+	m_maxZone = nextZone;
+
+	// Blocks link to the zones of the blocks before them, so the blocks after a changed one 
+	// need new links too.
+	for (xBlock=0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			if (m_zoneBlocks[xBlock][yBlock].isDirty() ||
+					(xBlock>0 && m_zoneBlocks[xBlock-1][yBlock].isDirty()) ||
+					(yBlock>0 && m_zoneBlocks[xBlock][yBlock-1].isDirty())) {
+				calculateBlockLinks(map, globalBounds, xBlock, yBlock);
+			}
+		}
+	}
+	for (xBlock=0; xBlock<m_zoneBlockExtent.x; xBlock++) {
+		for (yBlock=0; yBlock<m_zoneBlockExtent.y; yBlock++) {
+			m_zoneBlocks[xBlock][yBlock].setDirty(false);
+		}
+	}
+
+	allocateZones();
+	calculateEquivalencies(layers);
+	flattenEquivalencies();
+	m_needToCalculateZones = false;
+}
+
+#ifdef TEST_INCREMENTAL_ZONES
+/**
+ * Hash of everything calculateZones works out, for comparing two ways of getting there.
+ */
+UnsignedInt PathfindZoneManager::getZoneHash(PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds) const
+{
+	UnsignedInt hash = m_maxZone;
+	Int i, j;
+	for( j=globalBounds.lo.y; j<=globalBounds.hi.y; j++ )	{
+		for( i=globalBounds.lo.x; i<=globalBounds.hi.x; i++ )	{
+			hash = hash*31 + map[i][j].getZone();
+		}
+	}
+	for (i=0; i<=LAYER_LAST; i++) {
+		hash = hash*31 + layers[i].getZone();
+	}
+	for (i=0; i<m_zoneBlockExtent.x; i++) {
+		for (j=0; j<m_zoneBlockExtent.y; j++) {
+			hash = hash*31 + m_zoneBlocks[i][j].getZoneHash();
+		}
+	}
+	for (i=0; i<m_maxZone; i++) {
+		hash = hash*31 + m_groundCliffZones[i];
+		hash = hash*31 + m_groundWaterZones[i];
+		hash = hash*31 + m_groundRubbleZones[i];
+		hash = hash*31 + m_terrainZones[i];
+		hash = hash*31 + m_crusherZones[i];
+		hash = hash*31 + m_hierarchicalZones[i];
+	}
+	return hash;
+}
+#endif
+
 //
-// Clear the passable flags.
+// Clear the passable flags.  The flags are search scratch, so they live in the search context.
 //
 void PathfindZoneManager::clearPassableFlags( ) 
 {	Int blockX;
 	Int blockY;
+	PathfindSearchContext *context = PathfindSearchContext::getCurrent();
 	for (blockX = 0; blockX<m_zoneBlockExtent.x; blockX++) {
 		for (blockY = 0; blockY<m_zoneBlockExtent.y; blockY++) {
-			m_zoneBlocks[blockX][blockY].setPassable(false);
+			context->setBlockPassable(blockX*m_zoneBlockExtent.y + blockY, false);
 		}
 	}
 }
@@ -2570,9 +3474,10 @@ void PathfindZoneManager::clearPassableFlags( )
 void PathfindZoneManager::setAllPassable( ) 
 {	Int blockX;
 	Int blockY;
+	PathfindSearchContext *context = PathfindSearchContext::getCurrent();
 	for (blockX = 0; blockX<m_zoneBlockExtent.x; blockX++) {
 		for (blockY = 0; blockY<m_zoneBlockExtent.y; blockY++) {
-			m_zoneBlocks[blockX][blockY].setPassable(true);
+			context->setBlockPassable(blockX*m_zoneBlockExtent.y + blockY, true);
 		}
 	}
 }
@@ -2593,7 +3498,7 @@ void PathfindZoneManager::setPassable(Int cellX, Int cellY, Bool passable)
 		DEBUG_CRASH(("Invalid block."));
 		return;
 	}
-	m_zoneBlocks[blockX][blockY].setPassable(passable);
+	PathfindSearchContext::getCurrent()->setBlockPassable(blockX*m_zoneBlockExtent.y + blockY, passable);
 }
 
 //
@@ -2612,7 +3517,7 @@ Bool PathfindZoneManager::isPassable(Int cellX, Int cellY) const
 		DEBUG_CRASH(("Invalid block."));
 		return false;
 	}
-	return m_zoneBlocks[blockX][blockY].isPassable();
+	return PathfindSearchContext::getCurrent()->isBlockPassable(blockX*m_zoneBlockExtent.y + blockY);
 }
 
 //
@@ -2629,7 +3534,7 @@ Bool PathfindZoneManager::clipIsPassable(Int cellX, Int cellY) const
 	if (blockY<0 || blockY>=m_zoneBlockExtent.y) {
 		return false;
 	}
-	return m_zoneBlocks[blockX][blockY].isPassable();
+	return PathfindSearchContext::getCurrent()->isBlockPassable(blockX*m_zoneBlockExtent.y + blockY);
 }
 
 //
@@ -2818,6 +3723,23 @@ void PathfindLayer::reset(void)
 	m_layer = LAYER_GROUND;
 }
 
+/**
+ * Gives each cell in the layer a slot in the search node lookup, starting at firstIndex.
+ * Returns the next free slot.
+ */
+UnsignedInt PathfindLayer::setCellIndices(UnsignedInt firstIndex) 
+{
+	if (m_layerCells) {
+		Int i, j;
+		for (i=0; i<m_width; i++) {
+			for (j=0; j<m_height; j++) {
+				m_layerCells[i][j].setIndex(firstIndex++);
+			}
+		}
+	}
+	return firstIndex;
+}
+
 /**
  * Returns true if the layer is avaialble for use.
  */
@@ -3387,12 +4309,26 @@ void PathfindLayer::classifyWallMapCell( Int i, Int j , PathfindCell *cell, Obje
 Pathfinder::Pathfinder( void ) :m_map(NULL)
 {
 	debugPath = NULL;
+	PathfindSearchContext::setCurrent(&m_mainSearch);
+	m_speculations = MSGNEW("PathfindSpeculation") PathfindSpeculation[PathfindSpeculation::MAX_SPECULATIONS];
+	m_numSpeculations = 0;
+	m_firstSpeculationSlot = 0;
+	m_activeSpeculation = NULL;
+	m_structureSerial = 0;
+	m_numDirtyRects = 0;
+	m_dirtyOverflow = false;
 	PathfindCellInfo::allocateCellInfos();
 	reset();
 }
 
 Pathfinder::~Pathfinder( void )
 {
+	freeSpeculations();
+	delete [] m_speculations;
+	m_speculations = NULL;
+	if (PathfindSearchContext::getCurrent() == &m_mainSearch) {
+		PathfindSearchContext::setCurrent(NULL);
+	}
 	PathfindCellInfo::releaseCellInfos();
 }
 
@@ -3401,6 +4337,14 @@ void Pathfinder::reset( void )
 	frameToShowObstacles = 0;
 	DEBUG_LOG(("Pathfind cell is %d bytes, PathfindCellInfo is %d bytes\n", sizeof(PathfindCell), sizeof(PathfindCellInfo)));
 
+	// Search nodes point back at the cells, so drop them before the cells go.
+	freeSpeculations();
+	Int i;
+	m_mainSearch.setNumCells(0);
+	for (i=0; i<PATHFIND_MAX_SEARCH_THREADS; i++) {
+		m_workerSearch[i].setNumCells(0);
+	}
+
 	if (m_blockOfMapCells) {
 		delete []m_blockOfMapCells;
 		m_blockOfMapCells = NULL;
@@ -3410,7 +4354,6 @@ void Pathfinder::reset( void )
 		m_map = NULL;
 	}
 
-	Int i;
 	for (i=0; i<=LAYER_LAST; i++) {
 		m_layers[i].reset();
 	}
@@ -3418,17 +4361,24 @@ void Pathfinder::reset( void )
 	// reset the pathfind grid
 	m_extent.lo.x=m_extent.lo.y=m_extent.hi.x=m_extent.hi.y=0;
 	m_logicalExtent.lo.x=m_logicalExtent.lo.y=m_logicalExtent.hi.x=m_logicalExtent.hi.y=0;
-	m_openList = NULL;
-	m_closedList = NULL;
-
-	m_ignoreObstacleID = INVALID_ID;
-	m_isTunneling = false;
+	m_corridorCache.clear();
+	m_mainSearch.m_ignoreObstacleID = INVALID_ID;
+	m_mainSearch.m_isTunneling = false;
 
 	m_moveAlliesDepth = 0;
 
 	// pathfind grid cells have not been classified yet
 	m_isMapReady = false;
 	m_cumulativeCellsAllocated = 0;
+	m_avgCellsPerPath = 0;
+	memset(&m_queueStats, 0, sizeof(m_queueStats));
+#ifdef TEST_PATHFIND_SPEED
+	m_numRecordedPaths = 0;
+	m_ranSpeedTest = false;
+#endif
+#ifdef TEST_INCREMENTAL_ZONES
+	m_ranZoneTest = false;
+#endif
 
 	debugPathPos.x = 0.0f;
 	debugPathPos.y = 0.0f;
@@ -3467,6 +4417,7 @@ void Pathfinder::reset( void )
  */
 void Pathfinder::addWallPiece(Object *wallPiece)
 {
+	markStructureChanged();
 	if (m_numWallPieces<MAX_WALL_PIECES-1) {
 		m_wallPieces[m_numWallPieces] = wallPiece->getID();
 		m_numWallPieces++;
@@ -3478,6 +4429,7 @@ void Pathfinder::addWallPiece(Object *wallPiece)
  */
 void Pathfinder::removeWallPiece(Object *wallPiece)
 {
+	markStructureChanged();
 
 	// sanity
   if( wallPiece == NULL )
@@ -3565,7 +4517,7 @@ void Pathfinder::updateLayer(Object *obj, PathfindLayerEnum layer)
  */
 void Pathfinder::classifyFence( Object *obj, Bool insert )
 {
-	m_zoneManager.markZonesDirty();
+	markStructureChanged();
 	
 	const Coord3D *pos = obj->getPosition();
   Real angle = obj->getOrientation();
@@ -3574,6 +4526,15 @@ void Pathfinder::classifyFence( Object *obj, Bool insert )
  	Real halfsizeY = PATHFIND_CELL_SIZE_F/10.0f;
  	Real fenceOffset = obj->getTemplate()->getFenceXOffset();
 
+	// Only the blocks under the fence need their zones recalculated.
+	Real fenceReach = fabs(fenceOffset) + 2.0f*halfsizeX + halfsizeY;
+	IRegion2D fenceCells;
+	fenceCells.lo.x = REAL_TO_INT_FLOOR((pos->x - fenceReach)/PATHFIND_CELL_SIZE_F)-1;
+	fenceCells.lo.y = REAL_TO_INT_FLOOR((pos->y - fenceReach)/PATHFIND_CELL_SIZE_F)-1;
+	fenceCells.hi.x = REAL_TO_INT_CEIL((pos->x + fenceReach)/PATHFIND_CELL_SIZE_F)+1;
+	fenceCells.hi.y = REAL_TO_INT_CEIL((pos->y + fenceReach)/PATHFIND_CELL_SIZE_F)+1;
+	m_zoneManager.markZonesDirty(fenceCells);
+
  	Real c = (Real)Cos(angle);
  	Real s = (Real)Sin(angle);
  		
@@ -3659,6 +4620,7 @@ void Pathfinder::classifyFence( Object *obj, Bool insert )
  */
 void Pathfinder::classifyObjectFootprint( Object *obj, Bool insert )
 {
+	markStructureChanged();
 	if (obj->isKindOf(KINDOF_MINE)) {
 		return;  // don't pathfind around mines.
 	}
@@ -3735,11 +4697,11 @@ void Pathfinder::classifyObjectFootprint( Object *obj, Bool insert )
 
 void Pathfinder::internal_classifyObjectFootprint( Object *obj, Bool insert )
 {
+	markStructureChanged();
 	switch(obj->getGeometryInfo().getGeomType())
 	{
 		case GEOMETRY_BOX:
 		{
-			m_zoneManager.markZonesDirty();
 			const Coord3D *pos = obj->getPosition();
 			Real angle = obj->getOrientation();
 
@@ -3789,7 +4751,6 @@ void Pathfinder::internal_classifyObjectFootprint( Object *obj, Bool insert )
 		case GEOMETRY_SPHERE:	// not quite right, but close enough
 		case GEOMETRY_CYLINDER:
 		{
-			m_zoneManager.markZonesDirty();
 			// fill in all cells that overlap as obstacle cells
 			/// @todo This is a very inefficient circle-rasterizer
 			ICoord2D topLeft, bottomRight;
@@ -3859,7 +4820,8 @@ void Pathfinder::internal_classifyObjectFootprint( Object *obj, Bool insert )
 	if (cellBounds.hi.y > m_extent.hi.y) {
 		cellBounds.hi.y = m_extent.hi.y;
 	}
-
+	// The footprint is inside cellBounds, so only the zone blocks it covers have to be redone.
+	m_zoneManager.markZonesDirty(cellBounds);
 
 
 	// Expand building bounds 1 cell.
@@ -4055,6 +5017,7 @@ void Pathfinder::classifyMapCell( Int i, Int j , PathfindCell *cell)
 	}
 	cell->setType( type );
 	cell->releaseInfo();
+	cell->releasePersistentInfo();
 }
 
 /**
@@ -4096,9 +5059,24 @@ void Pathfinder::newMap( void )
 				m_layers[i].allocateCells(&m_extent);
 			}
 		}
-		if (m_numWallPieces>0) {
-			m_layers[LAYER_WALL].init(NULL, LAYER_WALL);
-			m_layers[LAYER_WALL].allocateCellsForWallLayer(&m_extent, m_wallPieces, m_numWallPieces);
+		if (m_numWallPieces>0) {
+			m_layers[LAYER_WALL].init(NULL, LAYER_WALL);
+			m_layers[LAYER_WALL].allocateCellsForWallLayer(&m_extent, m_wallPieces, m_numWallPieces);
+		}
+		// Number the cells, so the search contexts can find their node for each one.
+		UnsignedInt numCells = 0;
+		Int j;
+		for (i=0; i<=bounds.hi.x; i++) {
+			for (j=0; j<=bounds.hi.y; j++) {
+				m_map[i][j].setIndex(numCells++);
+			}
+		}
+		for (i=0; i<=LAYER_LAST; i++) {
+			numCells = m_layers[i].setCellIndices(numCells);
+		}
+		m_mainSearch.setNumCells(numCells);
+		for (i=0; i<PATHFIND_MAX_SEARCH_THREADS; i++) {
+			m_workerSearch[i].setNumCells(numCells);
 		}
 	}
 	classifyMap();
@@ -4117,6 +5095,7 @@ void Pathfinder::newMap( void )
  */
 void Pathfinder::classifyMap(void)
 {
+	markStructureChanged();
 
 	Int i, j;
 	// for now, sample cell corners and classify cell accordingly
@@ -4222,7 +5201,7 @@ void Pathfinder::debugShowSearch(  Bool pathFound  )
 		addIcon(NULL, 0, 0, color);	 // erase.
 	}
 
-	for( s = m_openList; s; s=s->getNextOpen() )
+	for( s = searchContext().m_openList; s; s=s->getNextOpen() )
 	{
 		// create objects to show path - they decay
 		RGBColor color;
@@ -4236,7 +5215,7 @@ void Pathfinder::debugShowSearch(  Bool pathFound  )
 		addIcon(&pos, PATHFIND_CELL_SIZE_F*.6f, 200, color);
 	}
 
-	for( s = m_closedList; s; s=s->getNextOpen() )
+	for( s = searchContext().m_closedList; s; s=s->getNextOpen() )
 	{
 		// create objects to show path - they decay
 		// create objects to show path - they decay
@@ -4323,16 +5302,14 @@ Bool Pathfinder::validMovementTerrain( PathfindLayerEnum layer, const Locomotor*
 // Releases the cells on the open & closed lists.
 //
 void Pathfinder::cleanOpenAndClosedLists(void) {
-	Int count = 0;
-	if (m_openList) {
-		count += PathfindCell::releaseOpenList(m_openList);
-		m_openList = NULL;
-	}		 
-	if (m_closedList) {
-		count += PathfindCell::releaseClosedList(m_closedList);
-		m_closedList = NULL;
-	}		 
-	m_cumulativeCellsAllocated += count;
+	PathfindSearchContext &context = searchContext();
+	Int count = context.endSearch();
+	if (context.m_isSpeculative) {
+		// Counted when (and if) the result is used, so the budget matches a serial run.
+		context.m_cellsReleased += count;
+	}	else {
+		m_cumulativeCellsAllocated += count;
+	}
 //#ifdef _DEBUG
 #if 0
 	// Check for dangling cells.
@@ -4371,7 +5348,7 @@ Bool Pathfinder::validMovementPosition( Bool isCrusher, LocomotorSurfaceTypeMask
 
 	// check if the destination cell is classified as an obstacle,
 	// and we happen to be ignoring it
-	if (toCell->isObstaclePresent( m_ignoreObstacleID ))
+	if (toCell->isObstaclePresent( searchContext().m_ignoreObstacleID ))
 		return true;
 
 	if (isCrusher && toCell->isObstacleFence()) {
@@ -4448,6 +5425,8 @@ Bool Pathfinder::checkDestination(const Object *obj, Int cellX, Int cellY, Pathf
 		checkForAircraft = obj->getAI()->isAircraftThatAdjustsDestination();
 		objID = obj->getID();
 	}
+	searchContext().touch(cellX-iRadius, cellY-iRadius);
+	searchContext().touch(cellX+numCellsAbove, cellY+numCellsAbove);
 	for (i=cellX-iRadius; i<cellX+numCellsAbove; i++) {
 		for (j=cellY-iRadius; j<cellY+numCellsAbove; j++) {
 			PathfindCell	*cell = getCell(layer, i, j);
@@ -4521,6 +5500,8 @@ Bool Pathfinder::checkForMovement(const Object *obj, TCheckMovementInfo &info)
 
 	Int numCellsAbove = info.radius;
 	if (info.centerInCell) numCellsAbove++;
+	searchContext().touch(info.cell.x-info.radius, info.cell.y-info.radius);
+	searchContext().touch(info.cell.x+numCellsAbove, info.cell.y+numCellsAbove);
 	Int i, j;
 //	Bool isInfantry = obj->isKindOf(KINDOF_INFANTRY);
 	for (i=info.cell.x-info.radius; i<info.cell.x+numCellsAbove; i++) {
@@ -5397,9 +6378,27 @@ void Pathfinder::processPathfindQueue(void)
 #endif
 
 	if (m_zoneManager.needToCalculateZones()) {
-		m_zoneManager.calculateZones(m_map, m_layers, m_extent);
-		return;
+		if (m_zoneManager.needFullZoneCalculation()) {
+			m_zoneManager.calculateZones(m_map, m_layers, m_extent);
+			return;
+		}
+		// Just some cells changed type.  Patching their blocks is quick, so carry on with the queue.
+		m_zoneManager.updateZones(m_map, m_layers, m_extent);
+	}
+
+#ifdef TEST_INCREMENTAL_ZONES
+	if (!m_ranZoneTest) {
+		m_ranZoneTest = true;
+		doZoneUpdateTest();
+	}
+#endif
+
+#ifdef TEST_PATHFIND_SPEED
+	if (m_numRecordedPaths == NUM_RECORDED_PATHS && !m_ranSpeedTest) {
+		m_ranSpeedTest = true;
+		doPathfindSpeedTest();
 	}
+#endif
 
 	// Get the current logical extent.
 	Region3D terrainExtent;
@@ -5411,12 +6410,60 @@ void Pathfinder::processPathfindQueue(void)
 	bounds.hi.y = REAL_TO_INT_FLOOR(terrainExtent.hi.y / PATHFIND_CELL_SIZE_F);
 	bounds.hi.x--;
 	bounds.hi.y--;
+	if (bounds.lo.x != m_logicalExtent.lo.x || bounds.lo.y != m_logicalExtent.lo.y ||
+			bounds.hi.x != m_logicalExtent.hi.x || bounds.hi.y != m_logicalExtent.hi.y) {
+		// Human paths are kept inside the logical extent, so corridors may no longer be good.
+		markStructureChanged();
+	}
 	m_logicalExtent = bounds;
 
+#ifdef DUMP_PERF_STATS
+	Int64 queueStartTime64;
+	GetPrecisionTimer(&queueStartTime64);
+#endif
+	m_queueStats.m_queueDepth = (m_queuePRTail - m_queuePRHead + PATHFIND_QUEUE_LEN) % PATHFIND_QUEUE_LEN;
+	m_queueStats.m_pathsProcessed = 0;
+	m_queueStats.m_speculativeSearches = 0;
+	m_queueStats.m_speculativeHits = 0;
+
+	// The frame's budget is counted in cells, never in time, so every machine processes the
+	// same requests each frame.  Spare cores search ahead of the queue instead, and a request
+	// uses the speculative answer only if it is the one a live search would have found.
+	Bool speculate = TheWorkerThreadPool && TheWorkerThreadPool->getNumThreads() > 1 && 
+		TheGlobalData->m_debugAI == AI_DEBUG_NONE;
+
 	m_cumulativeCellsAllocated = 0;	// Number of pathfind cells examined.
 	Int pathsFound = 0;
 	while (m_cumulativeCellsAllocated < PATHFIND_CELLS_PER_FRAME && 
 		m_queuePRTail!=m_queuePRHead) {
+		if (speculate && m_numSpeculations == 0) {
+			// Guess how many more requests the budget will cover this frame.
+			Int numThreads = TheWorkerThreadPool->getNumThreads();
+			Int lookAhead = 2*numThreads;
+			if (m_avgCellsPerPath > 0) {
+				lookAhead = (PATHFIND_CELLS_PER_FRAME - m_cumulativeCellsAllocated)/m_avgCellsPerPath + 1;
+				if (lookAhead > 2*numThreads) lookAhead = 2*numThreads;
+			}
+			if (lookAhead > PathfindSpeculation::MAX_SPECULATIONS) {
+				lookAhead = PathfindSpeculation::MAX_SPECULATIONS;
+			}
+			Int queueDepth = (m_queuePRTail - m_queuePRHead + PATHFIND_QUEUE_LEN) % PATHFIND_QUEUE_LEN;
+			if (lookAhead > queueDepth) {
+				lookAhead = queueDepth;
+			}
+			if (lookAhead > 1) {
+				speculatePaths(m_queuePRHead, lookAhead);
+			}
+		}
+		m_activeSpeculation = NULL;
+		if (m_numSpeculations > 0) {
+			Int specNdx = (m_queuePRHead - m_firstSpeculationSlot + PATHFIND_QUEUE_LEN) % PATHFIND_QUEUE_LEN;
+			if (specNdx < m_numSpeculations) {
+				m_activeSpeculation = &m_speculations[specNdx];
+			}
+		}
+
+		Int cellsBefore = m_cumulativeCellsAllocated;
 		Object *obj = TheGameLogic->findObjectByID(m_queuedPathfindRequests[m_queuePRHead]);
 		m_queuedPathfindRequests[m_queuePRHead] = INVALID_ID;
 		if (obj) {
@@ -5424,13 +6471,34 @@ void Pathfinder::processPathfindQueue(void)
 			if (ai) {
 				ai->doPathfind(this);
 				pathsFound++;
+				// The unit's goal & position cells probably moved.
+				markObjectDirty(obj);
 			}
 		}
+		m_activeSpeculation = NULL;
+		m_avgCellsPerPath = (3*m_avgCellsPerPath + (m_cumulativeCellsAllocated-cellsBefore))/4;
+
 		m_queuePRHead = m_queuePRHead+1;
 		if (m_queuePRHead >= PATHFIND_QUEUE_LEN) {
 			m_queuePRHead = 0;
 		}
+		if (m_numSpeculations > 0 && 
+			(m_queuePRHead - m_firstSpeculationSlot + PATHFIND_QUEUE_LEN) % PATHFIND_QUEUE_LEN >= m_numSpeculations) {
+			// Used up this batch.
+			freeSpeculations();
+		}
 	}
+	// Whatever is left over was searched against this frame's world, so throw it away.
+	freeSpeculations();
+
+	m_queueStats.m_pathsProcessed = pathsFound;
+	m_queueStats.m_cellsExamined = m_cumulativeCellsAllocated;
+#ifdef DUMP_PERF_STATS
+	Int64 queueEndTime64, queueFreq64;
+	GetPrecisionTimer(&queueEndTime64);
+	GetPrecisionTimerTicksPerSec(&queueFreq64);
+	m_queueStats.m_wallTimeMS = (Real)((double)(queueEndTime64-queueStartTime64) * 1000.0 / (double)queueFreq64);
+#endif
 	if (pathsFound>0) {
 #ifdef DEBUG_QPF
 #if defined _DEBUG || defined _INTERNAL
@@ -5452,6 +6520,463 @@ void Pathfinder::processPathfindQueue(void)
 }
 
 
+/**
+ * Tell the game logic about a failed pathfind.  A speculative search holds on to it,
+ * and findPath passes it on if the result is used.
+ */
+void Pathfinder::countFailedPathfind(void)
+{
+#ifdef DUMP_PERF_STATS
+	if (searchContext().m_isSpeculative) {
+		searchContext().m_failedPathfinds++;
+	}	else {
+		TheGameLogic->incrementOverallFailedPathfinds();
+	}
+#endif
+}
+
+/**
+ * Works out the corridor cache key for a search.  Returns false if the search can't use the
+ * cache - only ground to ground searches can.
+ */
+Bool Pathfinder::getCorridorKey(Bool isHuman, LocomotorSurfaceTypeMask surfaces, Bool crusher, 
+																const Coord3D *from, const Coord3D *to, PathfindCorridorKey &key)
+{
+	Coord3D clipFrom = *from;
+	Coord3D clipTo = *to;
+	clip(&clipFrom, &clipTo);
+	if (TheTerrainLogic->getLayerForDestination(&clipFrom) != LAYER_GROUND ||
+			TheTerrainLogic->getLayerForDestination(&clipTo) != LAYER_GROUND) {
+		return false;
+	}
+	ICoord2D fromCell, toCell;
+	worldToCell(&clipFrom, &fromCell);
+	worldToCell(&clipTo, &toCell);
+	if (getCell(LAYER_GROUND, fromCell.x, fromCell.y) == NULL || getCell(LAYER_GROUND, toCell.x, toCell.y) == NULL) {
+		return false;
+	}
+	key.m_fromBlock.x = fromCell.x/PathfindZoneManager::ZONE_BLOCK_SIZE;
+	key.m_fromBlock.y = fromCell.y/PathfindZoneManager::ZONE_BLOCK_SIZE;
+	key.m_fromZone = m_zoneManager.getBlockZone(surfaces, crusher, fromCell.x, fromCell.y, m_map);
+	key.m_toBlock.x = toCell.x/PathfindZoneManager::ZONE_BLOCK_SIZE;
+	key.m_toBlock.y = toCell.y/PathfindZoneManager::ZONE_BLOCK_SIZE;
+	key.m_toZone = m_zoneManager.getBlockZone(surfaces, crusher, toCell.x, toCell.y, m_map);
+	key.m_surfaces = surfaces;
+	key.m_crusher = crusher;
+	key.m_isHuman = isHuman;
+	return true;
+}
+
+/**
+ * Updates the corridor cache with what a findPath did.  A speculative search only reads the 
+ * cache, so it holds on to this, and findPath plays it back if the result is used.
+ */
+void Pathfinder::applyCorridorUse(const PathfindCorridorUse &use)
+{
+	if (searchContext().m_isSpeculative) {
+		searchContext().m_corridorUse = use;
+		return;
+	}
+	if (!use.m_lookedUp) {
+		return;
+	}
+	if (use.m_stamp) {
+#ifdef DUMP_PERF_STATS
+		TheGameLogic->incrementPathCacheHits();
+#endif
+		if (use.m_failed) {
+			m_corridorCache.remove(use.m_stamp);
+		}	else {
+			m_corridorCache.touch(use.m_stamp);
+		}
+	}	else {
+#ifdef DUMP_PERF_STATS
+		TheGameLogic->incrementPathCacheMisses();
+#endif
+	}
+	if (use.m_stored) {
+		m_corridorCache.store(use.m_key, m_structureSerial, searchContext().getPassableFlags(), 
+			searchContext().getNumPassableBlocks());
+	}
+}
+
+/**
+ * Unit goal or position data changed in the cells around cellX,cellY.  Any speculative
+ * search that looked near here can't be trusted any more.
+ */
+void Pathfinder::markCellsDirty(Int cellX, Int cellY, Int radius)
+{
+	if (m_numSpeculations == 0) {
+		return;
+	}
+	if (m_numDirtyRects >= MAX_DIRTY_RECTS) {
+		m_dirtyOverflow = true;
+		return;
+	}
+	IRegion2D &rect = m_dirtyRects[m_numDirtyRects++];
+	rect.lo.x = cellX - radius;
+	rect.lo.y = cellY - radius;
+	rect.hi.x = cellX + radius;
+	rect.hi.y = cellY + radius;
+}
+
+/**
+ * Marks the cells an object's footprint covers as dirty.
+ */
+void Pathfinder::markObjectDirty(const Object *obj)
+{
+	if (m_numSpeculations == 0 || obj == NULL) {
+		return;
+	}
+	Int radius;
+	Bool centerInCell;
+	getRadiusAndCenter(obj, radius, centerInCell);
+	ICoord2D cell;
+	worldToCell(obj->getPosition(), &cell);
+	markCellsDirty(cell.x, cell.y, radius+2);
+}
+
+/**
+ * Works out what the next numSlots requests in the queue will most likely ask findPath
+ * for, and searches for them on the worker threads.  Has to be called from the logic thread.
+ */
+void Pathfinder::speculatePaths(Int firstSlot, Int numSlots)
+{
+	freeSpeculations();
+	m_firstSpeculationSlot = firstSlot;
+	m_numDirtyRects = 0;
+	m_dirtyOverflow = false;
+
+	Int slot = firstSlot;
+	Int i;
+	for (i=0; i<numSlots && slot!=m_queuePRTail; i++) {
+		PathfindSpeculation *spec = &m_speculations[m_numSpeculations++];
+		spec->m_valid = false;
+		spec->m_consumed = false;
+		spec->m_path = NULL;
+		Object *obj = TheGameLogic->findObjectByID(m_queuedPathfindRequests[slot]);
+		AIUpdateInterface *ai = obj ? obj->getAIUpdateInterface() : NULL;
+		if (ai && ai->getPredictedPathRequest(&spec->m_to)) {
+			spec->m_valid = true;
+			spec->m_objID = obj->getID();
+			spec->m_locomotorSet = &ai->getLocomotorSet();
+			spec->m_surfaces = ai->getLocomotorSet().getValidSurfaces();
+			spec->m_from = *obj->getPosition();
+			spec->m_ignoreObstacleID = ai->getIgnoredObstacleID();
+			spec->m_layer = obj->getLayer();
+			spec->m_crusherLevel = obj->getCrusherLevel();
+			spec->m_canPathThroughUnits = ai->canPathThroughUnits();
+			spec->m_startTunneling = m_mainSearch.m_isTunneling;
+			spec->m_structureSerial = m_structureSerial;
+			m_queueStats.m_speculativeSearches++;
+		}
+		slot++;
+		if (slot >= PATHFIND_QUEUE_LEN) {
+			slot = 0;
+		}
+	}
+	TheWorkerThreadPool->parallelFor(m_numSpeculations, speculatePathJob, this);
+}
+
+/**
+ * Runs one speculative search, in the context that belongs to the thread it runs on.
+ */
+void Pathfinder::speculatePathJob(Int jobIndex, Int workerIndex, void *userData)
+{
+	Pathfinder *pathfinder = (Pathfinder *)userData;
+	PathfindSpeculation *spec = &pathfinder->m_speculations[jobIndex];
+	if (!spec->m_valid) {
+		return;
+	}
+	Object *obj = TheGameLogic->findObjectByID(spec->m_objID);
+	if (obj == NULL) {
+		spec->m_valid = false;
+		return;
+	}
+	DEBUG_ASSERTCRASH(workerIndex>=0 && workerIndex<PATHFIND_MAX_SEARCH_THREADS, ("Too many search threads."));
+	PathfindSearchContext *oldContext = PathfindSearchContext::getCurrent();
+	PathfindSearchContext *context = &pathfinder->m_workerSearch[workerIndex];
+	PathfindSearchContext::setCurrent(context);
+
+	const PathfindSearchContext &mainSearch = pathfinder->m_mainSearch;
+	context->copyPassableFlags(mainSearch.getPassableFlags(), mainSearch.getNumPassableBlocks());
+	context->m_passableWritten = false;
+	context->m_isSpeculative = true;
+	context->m_isTunneling = spec->m_startTunneling;
+	context->m_ignoreObstacleID = spec->m_ignoreObstacleID;
+	context->m_poolBase = mainSearch.getNumPoolNodes();
+	context->m_peakPoolNodes = 0;
+	context->m_ranOutOfNodes = false;
+	context->m_cellsReleased = 0;
+	context->m_failedPathfinds = 0;
+	context->m_corridorUse.m_lookedUp = false;
+	context->clearTouched();
+	ICoord2D cell;
+	pathfinder->worldToCell(&spec->m_from, &cell);
+	context->touch(cell.x, cell.y);
+	pathfinder->worldToCell(&spec->m_to, &cell);
+	context->touch(cell.x, cell.y);
+	spec->m_startPoolInUse = PathfindCellInfo::getNumInUse() + context->m_poolBase;
+
+	spec->m_path = pathfinder->doFindPath(obj, *spec->m_locomotorSet, &spec->m_from, &spec->m_to);
+
+	spec->m_isTunneling = context->m_isTunneling;
+	spec->m_cellsReleased = context->m_cellsReleased;
+	spec->m_failedPathfinds = context->m_failedPathfinds;
+	spec->m_corridorUse = context->m_corridorUse;
+	spec->m_touched = context->m_touched;
+	spec->m_peakPoolNodes = context->m_peakPoolNodes;
+	spec->m_ranOutOfNodes = context->m_ranOutOfNodes;
+	spec->m_leakedNodes = context->getNumLiveNodes();
+	if (context->m_passableWritten) {
+		if (spec->m_numPassable != context->getNumPassableBlocks()) {
+			delete [] spec->m_passable;
+			spec->m_numPassable = context->getNumPassableBlocks();
+			spec->m_passable = MSGNEW("PathfindSpeculation") Bool[spec->m_numPassable];
+		}
+		memcpy(spec->m_passable, context->getPassableFlags(), spec->m_numPassable*sizeof(Bool));
+	}	else {
+		delete [] spec->m_passable;
+		spec->m_passable = NULL;
+		spec->m_numPassable = 0;
+	}
+	if (spec->m_leakedNodes) {
+		context->releaseAllNodes();
+	}
+	context->m_isSpeculative = false;
+	PathfindSearchContext::setCurrent(oldContext);
+}
+
+/**
+ * True if a live search for the speculation's request would give the same answer now.
+ * It would if no obstacles changed, no unit data changed near anything the search looked
+ * at, and the cell info pool couldn't have run out at a different point.
+ */
+Bool Pathfinder::isSpeculationValid(const PathfindSpeculation *spec)
+{
+	if (spec->m_structureSerial != m_structureSerial) {
+		return false;
+	}
+	if (spec->m_startTunneling != m_mainSearch.m_isTunneling) {
+		return false;
+	}
+	if (spec->m_corridorUse.m_lookedUp && 
+		m_corridorCache.lookup(spec->m_corridorUse.m_key, m_structureSerial) != spec->m_corridorUse.m_stamp) {
+		// The cache has changed since, so a live search would use a different corridor.
+		return false;
+	}
+	if (spec->m_leakedNodes > 0 || m_dirtyOverflow) {
+		return false;
+	}
+	if (m_mainSearch.getNumLiveNodes() > 0) {
+		// Nodes left over from an earlier search change what the live search would allocate.
+		return false;
+	}
+	Int inUse = PathfindCellInfo::getNumInUse() + m_mainSearch.getNumPoolNodes();
+	if (inUse != spec->m_startPoolInUse) {
+		if (spec->m_ranOutOfNodes || inUse + spec->m_peakPoolNodes >= CELL_INFOS_TO_ALLOCATE) {
+			return false;
+		}
+	}
+	IRegion2D area = spec->m_touched;
+	area.lo.x -= PathfindSpeculation::SPECULATION_MARGIN;
+	area.lo.y -= PathfindSpeculation::SPECULATION_MARGIN;
+	area.hi.x += PathfindSpeculation::SPECULATION_MARGIN;
+	area.hi.y += PathfindSpeculation::SPECULATION_MARGIN;
+	Int i;
+	for (i=0; i<m_numDirtyRects; i++) {
+		const IRegion2D &rect = m_dirtyRects[i];
+		if (rect.lo.x <= area.hi.x && rect.hi.x >= area.lo.x && 
+			rect.lo.y <= area.hi.y && rect.hi.y >= area.lo.y) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Throws away the current batch of speculative searches.
+ */
+void Pathfinder::freeSpeculations(void)
+{
+	Int i;
+	for (i=0; i<m_numSpeculations; i++) {
+		PathfindSpeculation *spec = &m_speculations[i];
+		if (spec->m_path) {
+			spec->m_path->deleteInstance();
+			spec->m_path = NULL;
+		}
+		spec->m_valid = false;
+	}
+	m_numSpeculations = 0;
+	m_numDirtyRects = 0;
+	m_dirtyOverflow = false;
+	m_activeSpeculation = NULL;
+}
+
+#ifdef TEST_PATHFIND_SPEED
+/**
+ * Remembers a findPath request, for doPathfindSpeedTest.
+ */
+void Pathfinder::recordPathRequest(const Object *obj, const Coord3D *from, const Coord3D *to)
+{
+	if (obj == NULL || m_numRecordedPaths >= NUM_RECORDED_PATHS) {
+		return;
+	}
+	RecordedPathRequest &request = m_recordedPaths[m_numRecordedPaths++];
+	request.m_objID = obj->getID();
+	request.m_from = *from;
+	request.m_to = *to;
+}
+
+/**
+ * Runs the recorded requests through the search a few times, and logs how fast it went.
+ * Puts back everything a search changes, corridor cache included, so the game carries on as
+ * if nothing happened.
+ */
+void Pathfinder::doPathfindSpeedTest(void)
+{
+	enum {NUM_PASSES = 10};
+	Int savedCellsAllocated = m_cumulativeCellsAllocated;
+	Bool savedTunneling = m_mainSearch.m_isTunneling;
+	ObjectID savedIgnoreID = m_mainSearch.m_ignoreObstacleID;
+	Int numBlocks = m_mainSearch.getNumPassableBlocks();
+	Bool *savedPassable = NULL;
+	if (numBlocks > 0) {
+		savedPassable = MSGNEW("PathfindSpeedTest") Bool[numBlocks];
+		memcpy(savedPassable, m_mainSearch.getPassableFlags(), numBlocks*sizeof(Bool));
+	}
+	// doFindPath stores and evicts corridors, so the cache goes back the way it was too.
+	PathfindCorridorCache *savedCorridors = MSGNEW("PathfindSpeedTest") PathfindCorridorCache(m_corridorCache);
+
+	Int numSearches = 0;
+	Int numFound = 0;
+	Int numCells = 0;
+	Int startTimeMS = ::GetTickCount();
+	Int pass, i;
+	for (pass=0; pass<NUM_PASSES; pass++) {
+		for (i=0; i<m_numRecordedPaths; i++) {
+			const RecordedPathRequest &request = m_recordedPaths[i];
+			Object *obj = TheGameLogic->findObjectByID(request.m_objID);
+			AIUpdateInterface *ai = obj ? obj->getAIUpdateInterface() : NULL;
+			if (ai == NULL) {
+				continue;
+			}
+			m_mainSearch.m_ignoreObstacleID = ai->getIgnoredObstacleID();
+			m_cumulativeCellsAllocated = 0;
+			Path *path = doFindPath(obj, ai->getLocomotorSet(), &request.m_from, &request.m_to);
+			numCells += m_cumulativeCellsAllocated;
+			numSearches++;
+			if (path) {
+				numFound++;
+				path->deleteInstance();
+			}
+		}
+	}
+	double seconds = (::GetTickCount()-startTimeMS)/1000.0;
+	if (seconds <= 0) {
+		seconds = 0.001;
+	}
+
+	DEBUG_LOG(("Pathfind speed test: %d searches (%d found a path), %d cells, %f sec\n", 
+		numSearches, numFound, numCells, seconds));
+	DEBUG_LOG(("  %f searches/sec, %f cells/sec, %d node blocks\n", numSearches/seconds, numCells/seconds,
+		m_mainSearch.getNumNodeBlocks()));
+
+	m_cumulativeCellsAllocated = savedCellsAllocated;
+	m_mainSearch.m_isTunneling = savedTunneling;
+	m_mainSearch.m_ignoreObstacleID = savedIgnoreID;
+	if (savedPassable) {
+		m_mainSearch.copyPassableFlags(savedPassable, numBlocks);
+		delete [] savedPassable;
+	}
+	m_corridorCache = *savedCorridors;
+	delete savedCorridors;
+}
+#endif
+
+#ifdef TEST_INCREMENTAL_ZONES
+/**
+ * Changes the type of random patches of cells, and checks that updateZones comes up with 
+ * exactly what calculateZones does each time.  Puts the cells back when it is done.
+ */
+void Pathfinder::doZoneUpdateTest(void)
+{
+	enum {NUM_EDITS = 200, MAX_EDIT_SIZE = 12};
+	static const PathfindCell::CellType editTypes[] = {PathfindCell::CELL_CLEAR, PathfindCell::CELL_WATER, 
+		PathfindCell::CELL_CLIFF, PathfindCell::CELL_RUBBLE, PathfindCell::CELL_IMPASSABLE};
+	Int width = m_extent.hi.x - m_extent.lo.x + 1;
+	Int height = m_extent.hi.y - m_extent.lo.y + 1;
+	if (width < MAX_EDIT_SIZE || height < MAX_EDIT_SIZE) {
+		return;
+	}
+	UnsignedByte *savedTypes = MSGNEW("PathfindZoneTest") UnsignedByte[width*height];
+	Int i, j;
+	for (i=0; i<width; i++) {
+		for (j=0; j<height; j++) {
+			savedTypes[i*height+j] = m_map[i+m_extent.lo.x][j+m_extent.lo.y].getType();
+		}
+	}
+
+	// Not the logic random numbers - this mustn't change the game.
+	UnsignedInt seed = 12345;
+	Int numFailed = 0;
+	Int updateMS = 0;
+	Int fullMS = 0;
+	Int edit;
+	for (edit=0; edit<NUM_EDITS; edit++) {
+		seed = seed*1103515245 + 12345;
+		IRegion2D cells;
+		cells.lo.x = m_extent.lo.x + (seed>>8)%(width-MAX_EDIT_SIZE);
+		seed = seed*1103515245 + 12345;
+		cells.lo.y = m_extent.lo.y + (seed>>8)%(height-MAX_EDIT_SIZE);
+		seed = seed*1103515245 + 12345;
+		cells.hi.x = cells.lo.x + (seed>>8)%MAX_EDIT_SIZE;
+		seed = seed*1103515245 + 12345;
+		cells.hi.y = cells.lo.y + (seed>>8)%MAX_EDIT_SIZE;
+		seed = seed*1103515245 + 12345;
+		PathfindCell::CellType type = editTypes[(seed>>8)%(sizeof(editTypes)/sizeof(editTypes[0]))];
+		for (i=cells.lo.x; i<=cells.hi.x; i++) {
+			for (j=cells.lo.y; j<=cells.hi.y; j++) {
+				if (m_map[i][j].getType() != PathfindCell::CELL_OBSTACLE) {
+					m_map[i][j].setType(type);
+				}
+			}
+		}
+
+		m_zoneManager.markZonesDirty(cells);
+		Int startMS = ::GetTickCount();
+		m_zoneManager.updateZones(m_map, m_layers, m_extent);
+		updateMS += ::GetTickCount() - startMS;
+		UnsignedInt updateHash = m_zoneManager.getZoneHash(m_map, m_layers, m_extent);
+
+		startMS = ::GetTickCount();
+		m_zoneManager.calculateZones(m_map, m_layers, m_extent);
+		fullMS += ::GetTickCount() - startMS;
+		UnsignedInt fullHash = m_zoneManager.getZoneHash(m_map, m_layers, m_extent);
+		if (updateHash != fullHash) {
+			DEBUG_LOG(("Zone update test - edit %d (%d,%d)-(%d,%d) doesn't match the full calculation.\n", 
+				edit, cells.lo.x, cells.lo.y, cells.hi.x, cells.hi.y));
+			numFailed++;
+		}
+	}
+	DEBUG_LOG(("Zone update test: %d edits, %d mismatches.  Update %d ms, full calculation %d ms.\n", 
+		NUM_EDITS, numFailed, updateMS, fullMS));
+	DEBUG_ASSERTCRASH(numFailed == 0, ("Incremental zone update doesn't match calculateZones."));
+
+	for (i=0; i<width; i++) {
+		for (j=0; j<height; j++) {
+			PathfindCell &cell = m_map[i+m_extent.lo.x][j+m_extent.lo.y];
+			if (cell.getType() != PathfindCell::CELL_OBSTACLE) {
+				cell.setType((PathfindCell::CellType)savedTypes[i*height+j]);
+			}
+		}
+	}
+	delete [] savedTypes;
+	m_zoneManager.calculateZones(m_map, m_layers, m_extent);
+}
+#endif
+
 void Pathfinder::checkChangeLayers(PathfindCell *parentCell)
 {
 		ICoord2D newCellCoord;
@@ -5487,7 +7012,7 @@ void Pathfinder::checkChangeLayers(PathfindCell *parentCell)
 					newCell->setCostSoFar(parentCell->getCostSoFar()); // same as parent cost
 					newCell->setTotalCost(parentCell->getTotalCost()) ;
 					// insert newCell in open list such that open list is sorted, smallest total path cost first
-					m_openList = newCell->putOnSortedOpenList( m_openList );
+					searchContext().m_openList = newCell->putOnSortedOpenList( searchContext().m_openList );
 
 				}
 			}
@@ -5510,7 +7035,7 @@ struct ExamineCellsStruct
 {
 	ExamineCellsStruct* d = (ExamineCellsStruct*)userData;
 	Bool isCrusher = d->obj ? d->obj->getCrusherLevel() > 0 : false;
-	if (d->thePathfinder->m_isTunneling) return 1; // abort.
+	if (d->thePathfinder->searchContext().m_isTunneling) return 1; // abort.
 	if (from && to) {
 			if (!d->thePathfinder->validMovementPosition( isCrusher, d->theLoco->getValidSurfaces(), to, from )) {
 				return 1;
@@ -5591,14 +7116,14 @@ struct ExamineCellsStruct
 
 			// if to was on closed list, remove it from the list
 			if (to->getClosed())
-				d->thePathfinder->m_closedList = to->removeFromClosedList( d->thePathfinder->m_closedList );
+				d->thePathfinder->searchContext().m_closedList = to->removeFromClosedList( d->thePathfinder->searchContext().m_closedList );
 
 			// if the to was already on the open list, remove it so it can be re-inserted in order
 			if (to->getOpen())
-				d->thePathfinder->m_openList = to->removeFromOpenList( d->thePathfinder->m_openList );
+				d->thePathfinder->searchContext().m_openList = to->removeFromOpenList( d->thePathfinder->searchContext().m_openList );
 
 			// insert to in open list such that open list is sorted, smallest total path cost first
-			d->thePathfinder->m_openList = to->putOnSortedOpenList( d->thePathfinder->m_openList );
+			d->thePathfinder->searchContext().m_openList = to->putOnSortedOpenList( d->thePathfinder->searchContext().m_openList );
 	}
 
 	return 0;	// keep going
@@ -5616,7 +7141,7 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 			canPathThroughUnits = obj->getAIUpdateInterface()->canPathThroughUnits();
 		}
 		Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
-		if (attackDistance==NO_ATTACK && !m_isTunneling && !locomotorSet.isDownhillOnly() && goalCell) {
+		if (attackDistance==NO_ATTACK && !searchContext().m_isTunneling && !locomotorSet.isDownhillOnly() && goalCell) {
 			ExamineCellsStruct info;
 			info.thePathfinder = this;
 			info.theLoco = &locomotorSet;
@@ -5731,7 +7256,7 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 						}
 					}
 				}
-				if (!movementValid && !m_isTunneling) {
+				if (!movementValid && !searchContext().m_isTunneling) {
 					continue;
 				}
 			}	
@@ -5752,14 +7277,14 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 			if (dx>1+radius) info.considerTransient = false;
 			if (dy>1+radius) info.considerTransient = false;
 			if (!checkForMovement(obj, info) || info.enemyFixed) {
-				if (!m_isTunneling) {
+				if (!searchContext().m_isTunneling) {
 					continue;
 				}
 				movementValid = false;
 			}	
 			if (movementValid && !newCell->getPinched()) {
 				//Note to self - only turn off tunneling after check for movement.jba. 
-				m_isTunneling = false;
+				searchContext().m_isTunneling = false;
 			}
 			if (!newCell->hasInfo()) {
 				if (!newCell->allocateInfo(newCellCoord)) {
@@ -5834,7 +7359,7 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 				if (newCell->getCostSoFar() <= newCostSoFar)
 					continue;
 			}
-			if (m_isTunneling) {
+			if (searchContext().m_isTunneling) {
 				if (!validMovementPosition( isCrusher, locomotorSet.getValidSurfaces(), newCell, parentCell )) {
 					newCostSoFar += 10*COST_ORTHOGONAL;
 				}
@@ -5842,7 +7367,7 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 			newCell->setCostSoFar(newCostSoFar);
 			// keep track of path we're building - point back to cell we moved here from
 			newCell->setParentCell(parentCell) ;
-			if (m_isTunneling) {
+			if (searchContext().m_isTunneling) {
 				costRemaining = 0; // find the closest valid cell.
 			}
 			newCell->setTotalCost(newCell->getCostSoFar() + costRemaining) ;
@@ -5853,14 +7378,14 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 
 			// if newCell was on closed list, remove it from the list
 			if (newCell->getClosed())
-				m_closedList = newCell->removeFromClosedList( m_closedList );
+				searchContext().m_closedList = newCell->removeFromClosedList( searchContext().m_closedList );
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				searchContext().m_openList = newCell->removeFromOpenList( searchContext().m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			searchContext().m_openList = newCell->putOnSortedOpenList( searchContext().m_openList );
 		}
 	return cellCount;
 }
@@ -5868,10 +7393,53 @@ Int Pathfinder::examineNeighboringCells(PathfindCell *parentCell, PathfindCell *
 
 /**
  * Find a short, valid path between given locations.
- * Uses A* algorithm.
+ * If the pathfind queue already searched for this request on a worker thread, and nothing
+ * the search depended on has changed, use that answer.  Otherwise search now.
  */
 Path *Pathfinder::findPath( Object *obj, const LocomotorSet& locomotorSet, const Coord3D *from, 
 													 const Coord3D *rawTo)
+{
+#ifdef TEST_PATHFIND_SPEED
+	recordPathRequest(obj, from, rawTo);
+#endif
+	PathfindSpeculation *spec = m_activeSpeculation;
+	if (spec && spec->m_valid && !spec->m_consumed && obj && obj->getID() == spec->m_objID &&
+		&locomotorSet == spec->m_locomotorSet && locomotorSet.getValidSurfaces() == spec->m_surfaces &&
+		from->x == spec->m_from.x && from->y == spec->m_from.y && from->z == spec->m_from.z &&
+		rawTo->x == spec->m_to.x && rawTo->y == spec->m_to.y && rawTo->z == spec->m_to.z &&
+		m_mainSearch.m_ignoreObstacleID == spec->m_ignoreObstacleID &&
+		obj->getLayer() == spec->m_layer && obj->getCrusherLevel() == spec->m_crusherLevel &&
+		obj->getAIUpdateInterface() && 
+		obj->getAIUpdateInterface()->canPathThroughUnits() == spec->m_canPathThroughUnits &&
+		isSpeculationValid(spec)) {
+		// Same request, same world - replay what the search did, and hand back its path.
+		spec->m_consumed = true;
+		m_cumulativeCellsAllocated += spec->m_cellsReleased;
+		m_mainSearch.m_isTunneling = spec->m_isTunneling;
+		if (spec->m_passable) {
+			m_mainSearch.copyPassableFlags(spec->m_passable, spec->m_numPassable);
+		}
+		applyCorridorUse(spec->m_corridorUse);
+#ifdef DUMP_PERF_STATS
+		Int i;
+		for (i=0; i<spec->m_failedPathfinds; i++) {
+			TheGameLogic->incrementOverallFailedPathfinds();
+		}
+#endif
+		m_queueStats.m_speculativeHits++;
+		Path *path = spec->m_path;
+		spec->m_path = NULL;
+		return path;
+	}
+	return doFindPath(obj, locomotorSet, from, rawTo);
+}
+
+/**
+ * Find a short, valid path between given locations.
+ * Uses A* algorithm.
+ */
+Path *Pathfinder::doFindPath( Object *obj, const LocomotorSet& locomotorSet, const Coord3D *from, 
+													 const Coord3D *rawTo)
 {
 	if (!quickDoesPathExist(locomotorSet, from, rawTo)) {
 		return NULL;
@@ -5882,14 +7450,46 @@ Path *Pathfinder::findPath( Object *obj, const LocomotorSet& locomotorSet, const
 	}
 
 	m_zoneManager.clearPassableFlags();
-	Path *hPat = findHierarchicalPath(isHuman, locomotorSet, from, rawTo, false);
-	if (hPat) {
-		hPat->deleteInstance();
-	}	else {
-		m_zoneManager.setAllPassable();
+
+	// Units sent to the same place mostly start and end in the same block zones, so try the
+	// corridor an earlier search found before doing the hierarchical search again.
+	PathfindCorridorUse use;
+	use.m_lookedUp = getCorridorKey(isHuman, locomotorSet.getValidSurfaces(), false, from, rawTo, use.m_key);
+	use.m_stamp = 0;
+	use.m_failed = false;
+	use.m_stored = false;
+	Path *pat = NULL;
+	if (use.m_lookedUp) {
+		use.m_stamp = m_corridorCache.lookup(use.m_key, m_structureSerial);
+		const Int *blocks;
+		Int numBlocks = m_corridorCache.getCorridor(use.m_stamp, &blocks);
+		if (numBlocks > 0) {
+			Int i;
+			for (i=0; i<numBlocks; i++) {
+				searchContext().setBlockPassable(blocks[i], true);
+			}
+			searchContext().m_isTunneling = false;
+			pat = internalFindPath(obj, locomotorSet, from, rawTo);
+			if (pat == NULL) {
+				// Doesn't fit through any more, so do the full search.
+				use.m_failed = true;
+				m_zoneManager.clearPassableFlags();
+			}
+		}
 	}
 
-	Path *pat = internalFindPath(obj, locomotorSet, from, rawTo);
+	if (pat == NULL) {
+		Path *hPat = findHierarchicalPath(isHuman, locomotorSet, from, rawTo, false);
+		if (hPat) {
+			hPat->deleteInstance();
+		}	else {
+			m_zoneManager.setAllPassable();
+		}
+
+		pat = internalFindPath(obj, locomotorSet, from, rawTo);
+		use.m_stored = (use.m_lookedUp && hPat != NULL && pat != NULL);
+	}
+	applyCorridorUse(use);
 	if (pat!=NULL) {
 		return pat;
 	}
@@ -5970,7 +7570,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		DEBUG_LOG(("Attempting pathfind to 0,0, generally a bug.\n"));
 		return NULL;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	if (m_isMapReady == false) {
 		return NULL;
 	}
@@ -5985,7 +7585,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		adjustTo.y += PATHFIND_CELL_SIZE_F/2;
 	}
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 
 	PathfindLayerEnum destinationLayer = TheTerrainLogic->getLayerForDestination(to);
 	// determine goal cell
@@ -6031,10 +7631,10 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 	// classified as an obstacle.  At that point, the pathfind behaves normally.
 	//
 	if (parentCell->getType() == PathfindCell::CELL_OBSTACLE)	{
-		m_isTunneling = true;
+		searchContext().m_isTunneling = true;
 	}
 	else {
-		m_isTunneling = false;
+		searchContext().m_isTunneling = false;
 	}
 
 	Int zone1, zone2;
@@ -6050,7 +7650,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		return NULL;
 	}
 
-	if (goalCell->isObstaclePresent(m_ignoreObstacleID) || m_isTunneling) {
+	if (goalCell->isObstaclePresent(searchContext().m_ignoreObstacleID) || searchContext().m_isTunneling) {
 		// Use terrain zones instead of building zones, since we are moving into or out of a building.
 		zone2 = m_zoneManager.getEffectiveTerrainZone(zone2);
 		zone2 =  m_zoneManager.getEffectiveZone(locomotorSet.getValidSurfaces(), isCrusher, zone2);
@@ -6069,7 +7669,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 
 	// sanity check - if destination is invalid, can't path there
 	if (validMovementPosition( isCrusher, destinationLayer, locomotorSet, to ) == false)	{
-		m_isTunneling = false;
+		searchContext().m_isTunneling = false;
 		goalCell->releaseInfo();
 		parentCell->releaseInfo();
 		return NULL;
@@ -6078,16 +7678,16 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 	// sanity check - if source is invalid, we have to cheat
 	if (validMovementPosition( isCrusher, layer, locomotorSet, from ) == false)	{
 		// somehow we got to an impassable location.
-		m_isTunneling = true;
+		searchContext().m_isTunneling = true;
 	}
 
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	Int cellCount = 0;
 
@@ -6095,11 +7695,11 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		if (parentCell == goalCell)
 		{
@@ -6123,7 +7723,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 			if (show)
 				debugShowSearch(true);
 
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			// construct and return path
 			Path *path =  buildActualPath( obj, locomotorSet.getValidSurfaces(), from, goalCell, centerInCell, false );
 			parentCell->releaseInfo();
@@ -6132,7 +7732,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		}	
 
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		// Check to see if we can change layers in this cell.
 		checkChangeLayers(parentCell);
@@ -6178,7 +7778,12 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		}
 	}	
 
-	if (obj) {
+	if (obj && searchContext().m_isSpeculative) {
+		// Logged when the result is used, if it is.
+#ifdef DUMP_PERF_STATS
+		countFailedPathfind();
+#endif
+	}	else if (obj) {
 		Bool valid;
 		valid = validMovementPosition( isCrusher, obj->getLayer(), locomotorSet, to ) ;
 
@@ -6186,7 +7791,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 		DEBUG_LOG(("Pathfind failed from (%f,%f) to (%f,%f), OV %d\n", from->x, from->y, to->x, to->y, valid));
 		DEBUG_LOG(("Unit '%s', time %f, cells %d\n", obj->getTemplate()->getName().str(), (::GetTickCount()-startTimeMS)/1000.0f,cellCount));
 #ifdef DUMP_PERF_STATS
-		TheGameLogic->incrementOverallFailedPathfinds();
+		countFailedPathfind();
 #endif
 #ifdef STATE_MACHINE_DEBUG
 		if( obj->getAIUpdateInterface() )
@@ -6196,7 +7801,7 @@ Path *Pathfinder::internalFindPath( Object *obj, const LocomotorSet& locomotorSe
 #endif
 	}
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	goalCell->releaseInfo();
 	cleanOpenAndClosedLists();
 	return NULL;
@@ -6384,6 +7989,7 @@ struct MADStruct
 		}
 		if (otherObj && otherObj->getAI() && !otherObj->getAI()->isMoving()) {
 			//DEBUG_LOG(("Moving ally\n"));
+			d->thePathfinder->markObjectDirty(otherObj);
 			otherObj->getAI()->aiMoveAwayFromUnit(d->obj, CMD_FROM_AI);
 		}
 	}
@@ -6450,7 +8056,7 @@ struct GroundCellsStruct
 			to->setTotalCost(to->getCostSoFar() + costRemaining) ;
 
 			// insert to in open list such that open list is sorted, smallest total path cost first
-			d->thePathfinder->m_openList = to->putOnSortedOpenList( d->thePathfinder->m_openList );
+			d->thePathfinder->searchContext().m_openList = to->putOnSortedOpenList( d->thePathfinder->searchContext().m_openList );
 	}
 
 	return 0;	// keep going
@@ -6486,7 +8092,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 		DEBUG_LOG(("Attempting pathfind to 0,0, generally a bug.\n"));
 		return NULL;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	if (m_isMapReady == false) {
 		return NULL;
 	}
@@ -6496,7 +8102,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 	Coord3D clipFrom = *from;
 	clip(&clipFrom, &adjustTo);
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 
 	PathfindLayerEnum destinationLayer = TheTerrainLogic->getLayerForDestination(to);
 	
@@ -6573,21 +8179,21 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
 	Int cellCount = 0;
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		if (parentCell == goalCell)
 		{
@@ -6601,7 +8207,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 			if (show)
 				debugShowSearch(true);
 #endif
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			// construct and return path
 			Path *path =  buildGroundPath(crusher, from, goalCell, centerInCell, pathDiameter );
 			parentCell->releaseInfo();
@@ -6610,7 +8216,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 		}	
 
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		// Check to see if we can change layers in this cell.
 		checkChangeLayers(parentCell);
@@ -6736,14 +8342,14 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 
 			// if newCell was on closed list, remove it from the list
 			if (newCell->getClosed())
-				m_closedList = newCell->removeFromClosedList( m_closedList );
+				searchContext().m_closedList = newCell->removeFromClosedList( searchContext().m_closedList );
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				searchContext().m_openList = newCell->removeFromOpenList( searchContext().m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			searchContext().m_openList = newCell->putOnSortedOpenList( searchContext().m_openList );
 		}
 
 
@@ -6792,7 +8398,7 @@ Path *Pathfinder::findGroundPath( const Coord3D *from,
 #ifdef DUMP_PERF_STATS
 	TheGameLogic->incrementOverallFailedPathfinds();
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	goalCell->releaseInfo();
 	cleanOpenAndClosedLists();
 	return NULL;
@@ -6849,7 +8455,7 @@ void Pathfinder::processHierarchicalCell( const ICoord2D &scanCell, const ICoord
 		
 		newCell->allocateInfo(scanCell);
 		if (!newCell->getClosed() && !newCell->getOpen()) {
-			m_closedList = newCell->putOnClosedList(m_closedList);
+			searchContext().m_closedList = newCell->putOnClosedList(searchContext().m_closedList);
 		}
 
 		adjNewCell->allocateInfo(adjacentCell);
@@ -6867,7 +8473,7 @@ void Pathfinder::processHierarchicalCell( const ICoord2D &scanCell, const ICoord
 		adjNewCell->setTotalCost(adjNewCell->getCostSoFar()+remCost);
 		adjNewCell->setParentCellHierarchical(parentCell);
 		// insert newCell in open list such that open list is sorted, smallest total path cost first
-		m_openList = adjNewCell->putOnSortedOpenList( m_openList );
+		searchContext().m_openList = adjNewCell->putOnSortedOpenList( searchContext().m_openList );
 
 	}
 }
@@ -6912,7 +8518,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 		DEBUG_LOG(("Attempting pathfind to 0,0, generally a bug.\n"));
 		return NULL;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	if (m_isMapReady == false) {
 		return NULL;
 	}
@@ -6922,7 +8528,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 	Coord3D clipFrom = *from;
 	clip(&clipFrom, &adjustTo);
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 
 	PathfindLayerEnum destinationLayer = TheTerrainLogic->getLayerForDestination(to);
 	
@@ -6967,7 +8573,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 	parentCell->startPathfind(goalCell);
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	Int cellCount = 0;
 
@@ -6987,9 +8593,9 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 
 	if (parentCell->getLayer()==LAYER_GROUND) {
 		// initialize "open" list to contain start cell
-		m_openList = parentCell;
+		searchContext().m_openList = parentCell;
 	}	else {
-		m_openList = parentCell;
+		searchContext().m_openList = parentCell;
 		PathfindLayerEnum layer = parentCell->getLayer();
 		// We're starting on a bridge, so link to land at the bridge end points.
 		ICoord2D ndx;
@@ -7000,8 +8606,8 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 		PathfindCell *startCell = getCell(LAYER_GROUND, ndx.x, ndx.y);
 		if (cell && startCell) {
 			// Close parent cell;
-			m_openList = parentCell->removeFromOpenList(m_openList);
-			m_closedList = parentCell->putOnClosedList(m_closedList);
+			searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
+			searchContext().m_closedList = parentCell->putOnClosedList(searchContext().m_closedList);
 			startCell->allocateInfo(ndx);
 			startCell->setParentCellHierarchical(parentCell);
 			cellCount++;
@@ -7011,7 +8617,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 			startCell->setTotalCost(remCost);
 			startCell->setParentCellHierarchical(parentCell);
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = startCell->putOnSortedOpenList( m_openList );
+			searchContext().m_openList = startCell->putOnSortedOpenList( searchContext().m_openList );
 
 			cellCount++;
 			cell->allocateInfo(toNdx);
@@ -7021,7 +8627,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 			cell->setTotalCost(remCost);
 			cell->setParentCellHierarchical(parentCell);
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = cell->putOnSortedOpenList( m_openList );
+			searchContext().m_openList = cell->putOnSortedOpenList( searchContext().m_openList );
 		}
 	}
 
@@ -7032,11 +8638,11 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		UnsignedShort parentZone;
 		if (parentCell->getLayer()==LAYER_GROUND) {
@@ -7101,7 +8707,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 						startCell->allocateInfo(ndx);
 						startCell->setParentCellHierarchical(parentCell);
 						if (!startCell->getClosed() && !startCell->getOpen()) {
-							m_closedList = startCell->putOnClosedList(m_closedList);
+							searchContext().m_closedList = startCell->putOnClosedList(searchContext().m_closedList);
 						}
 					}
 					cell->allocateInfo(toNdx);
@@ -7115,7 +8721,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 					cell->setTotalCost(cell->getCostSoFar()+remCost);
 					cell->setParentCellHierarchical(startCell);
 					// insert newCell in open list such that open list is sorted, smallest total path cost first
-					m_openList = cell->putOnSortedOpenList( m_openList );
+					searchContext().m_openList = cell->putOnSortedOpenList( searchContext().m_openList );
 
 				}
 			}
@@ -7128,7 +8734,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 			}
 			// success - found a path to the goal	 
 
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			// construct and return path
 			Path *path =  buildHierachicalPath( from, goalCell );
 #if defined _DEBUG || defined _INTERNAL
@@ -7193,7 +8799,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 		}
 
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		Int i;
 		UnsignedShort examinedZones[PathfindZoneManager::ZONE_BLOCK_SIZE];
@@ -7330,7 +8936,7 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 	}
 
 	if (closestOK && closestCell) {
-		m_isTunneling = false;
+		searchContext().m_isTunneling = false;
 		// construct and return path
 		Path *path =  buildHierachicalPath( from, closestCell );
 #if defined _DEBUG || defined _INTERNAL
@@ -7400,14 +9006,16 @@ Path *Pathfinder::internal_findHierarchicalPath( Bool isHuman, const LocomotorSu
 		}
 	}	
 
-	DEBUG_LOG(("%d ", TheGameLogic->getFrame()));
-	DEBUG_LOG(("FindHierarchicalPath failed from (%f,%f) to (%f,%f)\n", from->x, from->y, to->x, to->y));
-	DEBUG_LOG(("time %f\n", (::GetTickCount()-startTimeMS)/1000.0f));
+	if (!searchContext().m_isSpeculative) {
+		DEBUG_LOG(("%d ", TheGameLogic->getFrame()));
+		DEBUG_LOG(("FindHierarchicalPath failed from (%f,%f) to (%f,%f)\n", from->x, from->y, to->x, to->y));
+		DEBUG_LOG(("time %f\n", (::GetTickCount()-startTimeMS)/1000.0f));
+	}
 #endif
 #ifdef DUMP_PERF_STATS
-	TheGameLogic->incrementOverallFailedPathfinds();
+	countFailedPathfind();
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	goalCell->releaseInfo();
 	cleanOpenAndClosedLists();
 	return NULL;
@@ -7526,9 +9134,9 @@ Bool Pathfinder::slowDoesPathExist( Object *obj,
 		return false;
 	}
 	const LocomotorSet &locoSet = ai->getLocomotorSet();
-	m_ignoreObstacleID = ignoreObject;
+	searchContext().m_ignoreObstacleID = ignoreObject;
 	Path *path = findPath(obj, locoSet, from, to);
-	m_ignoreObstacleID = INVALID_ID;
+	searchContext().m_ignoreObstacleID = INVALID_ID;
 	Bool found = (path!=NULL);
 	if (path) {
 		path->deleteInstance();
@@ -7571,7 +9179,7 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 
 	Coord3D adjustTo = *groupDest;
 	Coord3D *to = &adjustTo;
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
@@ -7630,24 +9238,24 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		Coord3D pos;
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 		if (checkForAdjust(obj, locomotorSet, isHuman, parentCell->getXIndex(), parentCell->getYIndex(), parentCell->getLayer(), 
 			radius, center, &pos, groupDest)) { 
 			Int dx = IABS(goalCell->getXIndex()-parentCell->getXIndex());
@@ -7762,14 +9370,14 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 
 			// if newCell was on closed list, remove it from the list
 			if (newCell->getClosed())
-				m_closedList = newCell->removeFromClosedList( m_closedList );
+				searchContext().m_closedList = newCell->removeFromClosedList( searchContext().m_closedList );
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				searchContext().m_openList = newCell->removeFromOpenList( searchContext().m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			searchContext().m_openList = newCell->putOnSortedOpenList( searchContext().m_openList );
 		}
 	}
 
@@ -7781,7 +9389,7 @@ Bool Pathfinder::pathDestination( 	Object *obj, const LocomotorSet& locomotorSet
 		debugShowSearch(true);
 	}
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	cleanOpenAndClosedLists();
 	goalCell->releaseInfo();
 	return false;
@@ -7849,7 +9457,7 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 
 	Coord3D adjustTo = *rawTo;
 	Coord3D *to = &adjustTo;
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
@@ -7894,27 +9502,27 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 	parentCell->startPathfind(goalCell);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		if (parentCell==goalCell) {	 
 			Int cost = parentCell->getTotalCost();
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			cleanOpenAndClosedLists();
 			return cost;
 		}
@@ -8015,18 +9623,18 @@ Int Pathfinder::checkPathCost(Object *obj, const LocomotorSet& locomotorSet, con
 
 			// if newCell was on closed list, remove it from the list
 			if (newCell->getClosed())
-				m_closedList = newCell->removeFromClosedList( m_closedList );
+				searchContext().m_closedList = newCell->removeFromClosedList( searchContext().m_closedList );
 
 			// if the newCell was already on the open list, remove it so it can be re-inserted in order
 			if (newCell->getOpen())
-				m_openList = newCell->removeFromOpenList( m_openList );
+				searchContext().m_openList = newCell->removeFromOpenList( searchContext().m_openList );
 
 			// insert newCell in open list such that open list is sorted, smallest total path cost first
-			m_openList = newCell->putOnSortedOpenList( m_openList );
+			searchContext().m_openList = newCell->putOnSortedOpenList( searchContext().m_openList );
 		}
 	}
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	if (goalCell->hasInfo() && !goalCell->getClosed() && !goalCell->getOpen()) {
 		goalCell->releaseInfo();
 	}
@@ -8060,7 +9668,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 
 	if (m_isMapReady == false) return NULL;
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 
 	if (!obj) return NULL;
 
@@ -8078,7 +9686,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 		adjustTo.x += PATHFIND_CELL_SIZE_F/2;
 		adjustTo.y += PATHFIND_CELL_SIZE_F/2;
 	}
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	Bool isCrusher = obj ? obj->getCrusherLevel() > 0 : false;
@@ -8098,24 +9706,24 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 	}
 
 	Bool goalOnObstacle = false;
-	if (m_ignoreObstacleID != INVALID_ID) {
+	if (searchContext().m_ignoreObstacleID != INVALID_ID) {
 		// Check for object on structure.
 		// srj sez: check for obstacle on AIRFIELD... only want to do this for things
 		// that are "parked" on the airfield, but not for things hovering over an obstacle
 		// (eg, a chinook over a supply dock).
-		Object *goalObj = TheGameLogic->findObjectByID(m_ignoreObstacleID);
+		Object *goalObj = TheGameLogic->findObjectByID(searchContext().m_ignoreObstacleID);
 		if (goalObj) {
 			PathfindCell *ignoreCell = getClippedCell(goalObj->getLayer(), goalObj->getPosition());
 			if ( (goalCell->getObstacleID()==ignoreCell->getObstacleID()) && (goalCell->getObstacleID() != INVALID_ID) ) {
 				Object* newObstacle = TheGameLogic->findObjectByID(goalCell->getObstacleID());
 				if (newObstacle != NULL && newObstacle->isKindOf(KINDOF_AIRFIELD))
 				{
-					m_ignoreObstacleID = goalCell->getObstacleID();
+					searchContext().m_ignoreObstacleID = goalCell->getObstacleID();
 					goalOnObstacle = true;
 				}	
 				else 
 				{
-					if (m_ignoreObstacleID == goalCell->getObstacleID()) {
+					if (searchContext().m_ignoreObstacleID == goalCell->getObstacleID()) {
 						goalOnObstacle = true;
 					}
 				}
@@ -8131,7 +9739,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 		return NULL;
 
 	if (validMovementPosition( isCrusher, locomotorSet.getValidSurfaces(), parentCell ) == false) {
-		m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
+		searchContext().m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
 	}
 	TCheckMovementInfo info;
 	info.cell = startCellNdx;
@@ -8141,11 +9749,11 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 	info.considerTransient = blocked;
 	info.acceptableSurfaces = locomotorSet.getValidSurfaces();
 	if (!checkForMovement(obj, info) || info.enemyFixed) {
-		m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
+		searchContext().m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
 	}
 
 	Bool gotHierarchicalPath = false;
-	if (m_isTunneling) {
+	if (searchContext().m_isTunneling) {
 		m_zoneManager.setAllPassable(); // can't optimize.
 	}	else {
 		m_zoneManager.clearPassableFlags();
@@ -8157,7 +9765,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 			m_zoneManager.setAllPassable();
 		}
 	}
-	const Bool startedStuck = m_isTunneling;
+	const Bool startedStuck = searchContext().m_isTunneling;
 
 	ICoord2D pos2d;
 	worldToCell(to, &pos2d);
@@ -8177,23 +9785,23 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 	Real closestDistScreenSqr = FLT_MAX;
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 	Int count = 0;
 	//
 	// Continue search until "open" list is empty, or
 	// until goal is found.
 	//
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		Real dx;
 		Real dy;
 		Real distSqr;
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		if (parentCell == goalCell)
 		{
@@ -8209,7 +9817,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 #ifdef INTENSE_DEBUG
 			Int count = 0;
 			PathfindCell *cur;
-			for (cur = m_closedList; cur; cur=cur->getNextOpen()) {
+			for (cur = searchContext().m_closedList; cur; cur=cur->getNextOpen()) {
 				count++;
 			}
 			if (count>1000) {
@@ -8226,7 +9834,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 #endif
 			if (show)
 				debugShowSearch(true);
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			// construct and return path
 			Path *path = buildActualPath( obj, locomotorSet.getValidSurfaces(), from, goalCell, centerInCell, blocked);
 			parentCell->releaseInfo();
@@ -8235,8 +9843,8 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 			return path;
 		}	
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
-		if (!m_isTunneling && checkDestination(obj, parentCell->getXIndex(), parentCell->getYIndex(), parentCell->getLayer(), radius, centerInCell)) {
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
+		if (!searchContext().m_isTunneling && checkDestination(obj, parentCell->getXIndex(), parentCell->getYIndex(), parentCell->getLayer(), radius, centerInCell)) {
 			if (!startedStuck || validMovementPosition( isCrusher, locomotorSet.getValidSurfaces(), parentCell )) {
 				dx = IABS(goalCell->getXIndex()-parentCell->getXIndex());
 				dy = IABS(goalCell->getYIndex()-parentCell->getYIndex());
@@ -8306,7 +9914,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 		if (show)
 			debugShowSearch(true);
 
-		m_isTunneling = false;
+		searchContext().m_isTunneling = false;
 		rawTo->x = closesetCell->getXIndex()*PATHFIND_CELL_SIZE_F + PATHFIND_CELL_SIZE_F/2.0f;
 		rawTo->y = closesetCell->getYIndex()*PATHFIND_CELL_SIZE_F + PATHFIND_CELL_SIZE_F/2.0f;
 		// construct and return path
@@ -8330,7 +9938,7 @@ Path *Pathfinder::findClosestPath( Object *obj, const LocomotorSet& locomotorSet
 #ifdef DUMP_PERF_STATS
 	TheGameLogic->incrementOverallFailedPathfinds();
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	goalCell->releaseInfo();
 	cleanOpenAndClosedLists();
 	return NULL;
@@ -9028,7 +10636,7 @@ Bool Pathfinder::isLinePassable( const Object *obj, LocomotorSurfaceTypeMask acc
 																Bool allowPinched)
 {
 	LinePassableStruct info;
-	//CRCDEBUG_LOG(("Pathfinder::isLinePassable(): %d %d %d \n", m_ignoreObstacleID, m_isMapReady, m_isTunneling));
+	//CRCDEBUG_LOG(("Pathfinder::isLinePassable(): %d %d %d \n", searchContext().m_ignoreObstacleID, m_isMapReady, searchContext().m_isTunneling));
 
 	info.obj = obj;
 	info.acceptableSurfaces = acceptableSurfaces;
@@ -9065,6 +10673,7 @@ Bool Pathfinder::isGroundPathPassable( Bool isCrusher, const Coord3D& startWorld
  */
 void Pathfinder::changeBridgeState( PathfindLayerEnum layer, Bool repaired)
 {
+	markStructureChanged();
 	if (m_layers[layer].isUnused()) return;	
 	if (m_layers[layer].setDestroyed(!repaired)) {
 		m_zoneManager.markZonesDirty();
@@ -9154,6 +10763,7 @@ void Pathfinder::updateGoal( Object *obj, const Coord3D *newGoalPos, PathfindLay
 
 	obj->setDestinationLayer(layer);
 	ai->setPathfindGoalCell(newCell);
+	markCellsDirty(newCell.x, newCell.y, numCellsAbove);
 	Int i,j;
 	ICoord2D cellNdx;
 
@@ -9231,6 +10841,7 @@ void Pathfinder::updateAircraftGoal( Object *obj, const Coord3D *newGoalPos)
 	}
 
 	ai->setPathfindGoalCell(newCell);
+	markCellsDirty(newCell.x, newCell.y, numCellsAbove);
 	Int i,j;
 	ICoord2D cellNdx;
 
@@ -9280,6 +10891,7 @@ void Pathfinder::removeGoal( Object *obj)
 	ai->setPathfindGoalCell(newCell);
 	Int i,j;
 	if (goalCell.x>=0 && goalCell.y>=0) {
+		markCellsDirty(goalCell.x, goalCell.y, numCellsAbove);
 		for (i=goalCell.x-radius; i<goalCell.x+numCellsAbove; i++) {
 			for (j=goalCell.y-radius; j<goalCell.y+numCellsAbove; j++) {
 				PathfindCell	*cell = getCell(LAYER_GROUND, i, j);
@@ -9372,10 +10984,12 @@ void Pathfinder::updatePos( Object *obj, const Coord3D *newPos)
 	}
 
 	ai->setCurPathfindCell(newCell);
+	markCellsDirty(newCell.x, newCell.y, numCellsAbove);
 	Int i,j;
 	ICoord2D cellNdx;
 	//DEBUG_LOG(("Updating unit pos at cell %d, %d\n", newCell.x, newCell.y));
 	if (curCell.x>=0 && curCell.y>=0) {
+		markCellsDirty(curCell.x, curCell.y, numCellsAbove);
 		for (i=curCell.x-radius; i<curCell.x+numCellsAbove; i++) {
 			for (j=curCell.y-radius; j<curCell.y+numCellsAbove; j++) {
 				cellNdx.x = i;
@@ -9447,6 +11061,7 @@ void Pathfinder::removePos( Object *obj)
 	ICoord2D cellNdx;
 	//DEBUG_LOG(("Updating unit pos at cell %d, %d\n", newCell.x, newCell.y));
 	if (curCell.x>=0 && curCell.y>=0) {
+		markCellsDirty(curCell.x, curCell.y, numCellsAbove);
 		for (i=curCell.x-radius; i<curCell.x+numCellsAbove; i++) {
 			for (j=curCell.y-radius; j<curCell.y+numCellsAbove; j++) {
 				cellNdx.x = i;
@@ -9536,6 +11151,7 @@ if (g_UT_startTiming) return false;
 					}
 					if (otherObj && otherObj->getAI() && !otherObj->getAI()->isMoving()) {
 						//DEBUG_LOG(("Moving ally\n"));
+						markObjectDirty(otherObj);
 						otherObj->getAI()->aiMoveAwayFromUnit(obj, CMD_FROM_AI);
 					}
 				}
@@ -9573,7 +11189,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	Int radius;
 	getRadiusAndCenter(obj, radius, centerInCell);
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 
 	// determine start cell
 	ICoord2D startCellNdx;
@@ -9591,9 +11207,9 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	}
 	const LocomotorSet& locomotorSet = obj->getAIUpdateInterface()->getLocomotorSet();
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	if (validMovementPosition( isCrusher, locomotorSet.getValidSurfaces(), parentCell ) == false) {
-		m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
+		searchContext().m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
 	}
 	
 	TCheckMovementInfo info;
@@ -9604,7 +11220,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	info.considerTransient = false;
 	info.acceptableSurfaces = locomotorSet.getValidSurfaces();
 	if (!checkForMovement(obj, info) || info.enemyFixed) {
-		m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
+		searchContext().m_isTunneling = true; // We can't move from our current location.  So relax the constraints.
 	}
 
 	if (!parentCell->allocateInfo(startCellNdx)) {
@@ -9613,10 +11229,10 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	parentCell->startPathfind(NULL);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
@@ -9628,11 +11244,11 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	boxHalfWidth += otherRadius*PATHFIND_CELL_SIZE_F;
 	if (otherCenter) boxHalfWidth+=PATHFIND_CELL_SIZE_F/2;
 
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		Region2D bounds;
 		Coord3D cellCenter;
@@ -9691,7 +11307,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 			// success - found a path to the goal
 			if (false && TheGlobalData->m_debugAI)
 				debugShowSearch(true);
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			// construct and return path
 			Path *newPath = buildActualPath( obj, locomotorSet.getValidSurfaces(), obj->getPosition(), parentCell, centerInCell, false);
 			parentCell->releaseInfo();
@@ -9699,7 +11315,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 			return newPath;
 		}	
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		// Check to see if we can change layers in this cell.
 		checkChangeLayers(parentCell);
@@ -9714,7 +11330,7 @@ Path *Pathfinder::getMoveAwayFromPath(Object* obj, Object *otherObj,
 	DEBUG_LOG(("getMoveAwayFromPath pathfind failed  -- "));
 	DEBUG_LOG(("Unit '%s', time %f\n", obj->getTemplate()->getName().str(), (::GetTickCount()-startTimeMS)/1000.0f));
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	cleanOpenAndClosedLists();
 	return NULL;
 }
@@ -9741,7 +11357,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 
 	m_zoneManager.setAllPassable();
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 
 	enum {CELL_LIMIT = 2000}; // max cells to examine.
 	Int cellCount = 0;
@@ -9764,7 +11380,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 		return false; // shouldn't happen, but can't move it without an ai.
 	}
 
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	
 	if (!parentCell->allocateInfo(startCellNdx)) {
 		return false;
@@ -9772,10 +11388,10 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 	parentCell->startPathfind( NULL);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
@@ -9842,11 +11458,11 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 		return NULL;
 	}
 
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		Coord3D cellCenter;
 		adjustCoordToCell(parentCell->getXIndex(), parentCell->getYIndex(), centerInCell, cellCenter, parentCell->getLayer());
@@ -9862,7 +11478,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 			// success - found a path to the goal
 			if ( TheGlobalData->m_debugAI)
 				debugShowSearch(true);
-			m_isTunneling = false;
+			searchContext().m_isTunneling = false;
 			// construct and return path
 			Path *path = newInstance(Path);
 			PathNode *node;
@@ -9880,7 +11496,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 			return path;
 		}	
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		if (cellCount < CELL_LIMIT) {
 			// Check to see if we can change layers in this cell.
@@ -9897,7 +11513,7 @@ Path *Pathfinder::patchPath( const Object *obj, const LocomotorSet& locomotorSet
 		debugShowSearch(true);
 	}
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	if (!candidateGoal->getOpen() && !candidateGoal->getClosed())
 	{
 		// Not on one of the lists 
@@ -10010,7 +11626,7 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 
 	Int cellCount = 0;
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 
 	Int attackDistance = weapon->getAttackDistance(obj, victim, victimPos);
 	attackDistance += 3*PATHFIND_CELL_SIZE;
@@ -10051,10 +11667,10 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 	}
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
@@ -10071,11 +11687,11 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 		checkLOS = true;
 	}
 	
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		Coord3D cellCenter;
 		adjustCoordToCell(parentCell->getXIndex(), parentCell->getYIndex(), centerInCell, cellCenter, parentCell->getLayer());
@@ -10115,7 +11731,7 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 	#ifdef INTENSE_DEBUG
 				Int count = 0;
 				PathfindCell *cur;
-				for (cur = m_closedList; cur; cur=cur->getNextOpen()) {
+				for (cur = searchContext().m_closedList; cur; cur=cur->getNextOpen()) {
 					count++;
 				}
 				if (count>1000) {
@@ -10159,7 +11775,7 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 		}
 
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		if (cellCount < ATTACK_CELL_LIMIT) {
 				// Check to see if we can change layers in this cell.
@@ -10197,7 +11813,7 @@ Path *Pathfinder::findAttackPath( const Object *obj, const LocomotorSet& locomot
 #ifdef DUMP_PERF_STATS
 	TheGameLogic->incrementOverallFailedPathfinds();
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	if (goalCell->hasInfo() && !goalCell->getClosed() && !goalCell->getOpen()) {
 		goalCell->releaseInfo();
 	}
@@ -10227,7 +11843,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 		isHuman = false; // computer gets to cheat.
 	}
 
-	DEBUG_ASSERTCRASH(m_openList==NULL && m_closedList == NULL, ("Dangling lists."));
+	DEBUG_ASSERTCRASH(searchContext().m_openList==NULL && searchContext().m_closedList == NULL, ("Dangling lists."));
 	// create unique "mark" values for open and closed cells for this pathfind invocation
 
 	m_zoneManager.setAllPassable();
@@ -10246,10 +11862,10 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 	parentCell->startPathfind( NULL);
 
 	// initialize "open" list to contain start cell
-	m_openList = parentCell;
+	searchContext().m_openList = parentCell;
 
 	// "closed" list is initially empty
-	m_closedList = NULL;
+	searchContext().m_closedList = NULL;
 
 	//
 	// Continue search until "open" list is empty, or
@@ -10258,11 +11874,11 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 
 	Real farthestDistanceSqr = 0;
 
-	while( m_openList != NULL )
+	while( searchContext().m_openList != NULL )
 	{
 		// take head cell off of open list - it has lowest estimated total path cost
-		parentCell = m_openList;
-		m_openList = parentCell->removeFromOpenList(m_openList);
+		parentCell = searchContext().m_openList;
+		searchContext().m_openList = parentCell->removeFromOpenList(searchContext().m_openList);
 
 		Coord3D cellCenter;
 		adjustCoordToCell(parentCell->getXIndex(), parentCell->getYIndex(), centerInCell, cellCenter, parentCell->getLayer());
@@ -10281,7 +11897,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 		if (distSqr>repulsorDistSqr) {
 			ok = true;
 		}
-		if (m_openList == NULL && cellCount>0) {
+		if (searchContext().m_openList == NULL && cellCount>0) {
 			ok = true; // exhausted the search space, just take the last cell.
 		}
 		if (distSqr > farthestDistanceSqr) {
@@ -10301,7 +11917,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 #ifdef INTENSE_DEBUG
 			Int count = 0;
 			PathfindCell *cur;
-			for (cur = m_closedList; cur; cur=cur->getNextOpen()) {
+			for (cur = searchContext().m_closedList; cur; cur=cur->getNextOpen()) {
 				count++;
 			}
 			if (count>2000) {
@@ -10329,7 +11945,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 		}	
 
 		// put parent cell onto closed list - its evaluation is finished
-		m_closedList = parentCell->putOnClosedList( m_closedList );
+		searchContext().m_closedList = parentCell->putOnClosedList( searchContext().m_closedList );
 
 		// Check to see if we can change layers in this cell.
 		checkChangeLayers(parentCell);
@@ -10358,7 +11974,7 @@ Path *Pathfinder::findSafePath( const Object *obj, const LocomotorSet& locomotor
 #ifdef DUMP_PERF_STATS
 	TheGameLogic->incrementOverallFailedPathfinds();
 #endif
-	m_isTunneling = false;
+	searchContext().m_isTunneling = false;
 	cleanOpenAndClosedLists();
 	return false;
 }
@@ -10374,13 +11990,13 @@ void Pathfinder::crc( Xfer *xfer )
 
 	xfer->xferBool( &m_isMapReady );
 	CRCDEBUG_LOG(("m_isMapReady: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
-	xfer->xferBool( &m_isTunneling );
+	xfer->xferBool( &m_mainSearch.m_isTunneling );
 	CRCDEBUG_LOG(("m_isTunneling: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
 
 	Int obsolete1 = 0;
 	xfer->xferInt( &obsolete1 );
 
-	xfer->xferUser(&m_ignoreObstacleID, sizeof(ObjectID));
+	xfer->xferUser(&m_mainSearch.m_ignoreObstacleID, sizeof(ObjectID));
 	CRCDEBUG_LOG(("m_ignoreObstacleID: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
 
 	xfer->xferUser(m_queuedPathfindRequests, sizeof(ObjectID)*PATHFIND_QUEUE_LEN);
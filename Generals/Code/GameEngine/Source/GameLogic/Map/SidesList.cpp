@@ -95,6 +95,12 @@ void SidesInfo::init(const Dict* d)
 		m_dict = *d;
 }
 
+void SidesInfo::setScriptList(ScriptList *pScriptList)
+{
+	m_scripts = pScriptList;
+	ScriptList::noteChanged();
+}
+
 // ug, I hate having to overload stuff, but this makes it a lot easier to make copies safely
 SidesInfo& SidesInfo::operator=(const SidesInfo& that)
 {
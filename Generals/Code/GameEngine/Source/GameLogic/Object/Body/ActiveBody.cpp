@@ -968,6 +968,7 @@ void ActiveBody::internalChangeHealth( Real delta )
 
 	// change the health by the delta, it can be positive or negative
 	m_currentHealth += delta;
+	getObject()->markCRCDirty();
 
 	// high end cap
 	Real maxHealth = m_maxHealth;
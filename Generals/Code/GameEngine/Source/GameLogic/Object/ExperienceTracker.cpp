@@ -98,7 +98,10 @@ void ExperienceTracker::setMinVeterancyLevel( VeterancyLevel newLevel )
 		m_currentLevel = newLevel;
 		m_currentExperience = m_parent->getTemplate()->getExperienceRequired(m_currentLevel); //Minimum for this level
 		if (m_parent)
+		{
+			m_parent->markCRCDirty();
 			m_parent->onVeterancyLevelChanged( oldLevel, newLevel );
+		}
 	}
 }
 
@@ -114,7 +117,10 @@ void ExperienceTracker::setVeterancyLevel( VeterancyLevel newLevel )
 		m_currentLevel = newLevel;
 		m_currentExperience = m_parent->getTemplate()->getExperienceRequired(m_currentLevel); //Minimum for this level
 		if (m_parent)
+		{
+			m_parent->markCRCDirty();
 			m_parent->onVeterancyLevelChanged( oldLevel, newLevel );
+		}
 	}
 }
 
@@ -170,6 +176,7 @@ void ExperienceTracker::addExperiencePoints( Int experienceGain, Bool canScaleFo
 
 
 	m_currentExperience += amountToGain;
+	m_parent->markCRCDirty();
 
 	Int levelIndex = 0;
 	while( ( (levelIndex + 1) < LEVEL_COUNT) 
@@ -210,6 +217,7 @@ void ExperienceTracker::setExperienceAndLevel( Int experienceIn )
 	VeterancyLevel oldLevel = m_currentLevel;
 
 	m_currentExperience = experienceIn;
+	m_parent->markCRCDirty();
 
 	Int levelIndex = 0;
 	while( ( (levelIndex + 1) < LEVEL_COUNT) 
@@ -164,6 +164,16 @@ void FiringTracker::shotFired(const Weapon* weaponFired, ObjectID victimID)
 	setWakeFrame(getObject(), calcTimeToSleep());
 }
 
+//-------------------------------------------------------------------------------------------------
+Bool FiringTracker::isSelfContainedUpdate() const
+{
+	// if none of the timers are up, all update() does is work out how long to sleep.
+	UnsignedInt now = TheGameLogic->getFrame();
+	return (m_frameToForceReload == 0 || now < m_frameToForceReload)
+		&& (m_frameToStopLoopingSound == 0 || now < m_frameToStopLoopingSound)
+		&& (m_frameToStartCooldown == 0 || now <= m_frameToStartCooldown);
+}
+
 //-------------------------------------------------------------------------------------------------
 UpdateSleepTime FiringTracker::update()
 {
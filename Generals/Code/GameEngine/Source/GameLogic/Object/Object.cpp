@@ -202,7 +202,9 @@ Object::Object( const ThingTemplate *tt, ObjectStatusBits statusBits, Team *team
 	m_smcUntil(NEVER),
 	m_privateStatus(0),
 	m_formationID(NO_FORMATION_ID),
-	m_isReceivingDifficultyBonus(FALSE)
+	m_cachedCRC(0),
+	m_isReceivingDifficultyBonus(FALSE),
+	m_crcDirty(TRUE)
 {
 #if defined(_DEBUG) || defined(_INTERNAL)
 	m_hasDiedAlready = false;
@@ -262,6 +264,9 @@ Object::Object( const ThingTemplate *tt, ObjectStatusBits statusBits, Team *team
 	m_constructionPercent = CONSTRUCTION_COMPLETE;  // complete by default
 	m_objectUpgradesCompleted = 0;
 
+	for (Int i = 0; i < WEAPONSLOT_COUNT; ++i)
+		m_cachedCRCWeaponStamps[i] = 0;
+
 	m_visionRange = tt->friend_getVisionRange();
 	m_shroudClearingRange = tt->friend_getShroudClearingRange();
 	if( m_shroudClearingRange == -1.0f )
@@ -448,6 +453,7 @@ void Object::initObject()
 	m_weaponSet.updateWeaponSet(this);
 
 	m_weaponBonusCondition = 0;
+	markCRCDirty();
 
 	for (int i = 0; i < WEAPONSLOT_COUNT; ++i)
 		m_lastWeaponCondition[i] = WSF_INVALID;
@@ -719,6 +725,9 @@ void Object::setGeometryInfoZ( Real newZ )
 { 
 	// A Z change only does not need to un/register with the PartitionManager
 	m_geometryInfo.setMaxHeightAbovePosition( newZ );
+	// ...but it can change our bounding sphere.
+	if (m_partitionData)
+		m_partitionData->updatePackedPosition();
 
 	if (m_drawable)
 		m_drawable->reactToGeometryChange();
@@ -727,6 +736,7 @@ void Object::setGeometryInfoZ( Real newZ )
 //=============================================================================
 void Object::friend_setUndetectedDefector( Bool status )
 {
+	markCRCDirty();
 	if (status)
 		m_privateStatus |= UNDETECTED_DEFECTOR;
 	else
@@ -1605,6 +1615,7 @@ void Object::reactToTurretChange( WhichTurretType turret, Real oldRotation, Real
 void Object::reactToTransformChange(const Matrix3D* oldMtx, const Coord3D* oldPos, Real oldAngle)
 {
 	//USE_PERF_TIMER(Object_reactToTransformChange)
+	markCRCDirty();
         if(std::isnan(getPosition()->x) || std::isnan(getPosition()->y) || std::isnan(getPosition()->z)) {
 		DEBUG_CRASH(("Object pos is nan."));
 		TheGameLogic->destroyObject(this);
@@ -1617,6 +1628,11 @@ void Object::reactToTransformChange(const Matrix3D* oldMtx, const Coord3D* oldPo
 	Bool posDiff = isPosDifferent(oldPos, getPosition());
 	Bool angDiff = isAngleDifferent(oldAngle, getOrientation());
 
+	// even a tiny change has to go to the partition cells' packed positions, since
+	// range queries count on those being exact.
+	if (m_partitionData)
+		m_partitionData->updatePackedPosition();
+
 	if (posDiff || angDiff)
 	{
 		if (m_partitionData)
@@ -1779,11 +1795,17 @@ void Object::healCompletely()
 //-------------------------------------------------------------------------------------------------
 void Object::setEffectivelyDead(Bool dead)
 {
+	markCRCDirty();
+	Bool wasDead = isEffectivelyDead();
 	if (dead)
 		BitSet(m_privateStatus, EFFECTIVELY_DEAD);
 	else
 		BitClear(m_privateStatus, EFFECTIVELY_DEAD);
 
+	// script conditions on named units cache whether they are dead.
+	if (wasDead != isEffectivelyDead() && !m_name.isEmpty() && TheScriptEngine)
+		TheScriptEngine->notifyOfObjectLivenessChange(this);
+
 	if (dead)
 	{
 		if( m_radarData )
@@ -1794,6 +1816,7 @@ void Object::setEffectivelyDead(Bool dead)
 //-------------------------------------------------------------------------------------------------
 void Object::setCaptured(Bool isCaptured)
 {
+	markCRCDirty();
 	if (isCaptured)
 		BitSet(m_privateStatus, CAPTURED);
 	else 
@@ -2467,6 +2490,7 @@ void Object::setID( ObjectID id )
 
 	// assign new id
 	m_id = id;
+	markCRCDirty();
 
 	// add new id to lookup table
 	TheGameLogic->addObjectToLookupTable( this );
@@ -2536,6 +2560,7 @@ void Object::friend_notifyOfNewMapBoundary(void)
 		m_privateStatus &= ~OFF_MAP;
 	else
 		m_privateStatus |= OFF_MAP;
+	markCRCDirty();
 }
 
 
@@ -3481,6 +3506,50 @@ void Object::crc( Xfer *xfer )
 	
 }  // end crc
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+Bool Object::isObjectCRCCached() const
+{
+	if (m_crcDirty)
+		return FALSE;
+
+	for (Int i = 0; i < WEAPONSLOT_COUNT; ++i)
+	{
+		const Weapon *weapon = getWeaponInWeaponSlot((WeaponSlotType)i);
+		if ((weapon ? weapon->getCRCStamp() : 0) != m_cachedCRCWeaponStamps[i])
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+// ------------------------------------------------------------------------------------------------
+/** Most objects sit still most of the time, so walking every one of them for every CRC is mostly
+	wasted; instead we keep the last answer and only work it out again once it could be different. */
+// ------------------------------------------------------------------------------------------------
+UnsignedInt Object::getObjectCRC( Bool useCache )
+{
+	if (useCache && isObjectCRCCached())
+		return m_cachedCRC;
+
+	XferCRC xferCRC;
+	xferCRC.xferSnapshot( this );
+	UnsignedInt theCRC = xferCRC.getCRC();
+
+	if (useCache)
+	{
+		m_cachedCRC = theCRC;
+		m_crcDirty = FALSE;
+		for (Int i = 0; i < WEAPONSLOT_COUNT; ++i)
+		{
+			const Weapon *weapon = getWeaponInWeaponSlot((WeaponSlotType)i);
+			m_cachedCRCWeaponStamps[i] = weapon ? weapon->getCRCStamp() : 0;
+		}
+	}
+
+	return theCRC;
+}
+
 //-------------------------------------------------------------------------------------------------
 /** Object xfer implemtation
 	* Version Info:
@@ -3495,6 +3564,9 @@ void Object::crc( Xfer *xfer )
 //-------------------------------------------------------------------------------------------------
 void Object::xfer( Xfer *xfer )
 {
+
+	if( xfer->getXferMode() == XFER_LOAD )
+		markCRCDirty();
 	
 	// version
 	const XferVersion currentVersion = 7;
@@ -3926,6 +3998,7 @@ void Object::giveUpgrade( const UpgradeTemplate *upgradeT )
 	if (upgradeT)
 	{
 		BitSet( m_objectUpgradesCompleted, upgradeT->getUpgradeMask() );
+		markCRCDirty();
 
 		//
 		// iterate through all the upgrade modules of this object and call the method to
@@ -3941,6 +4014,7 @@ void Object::giveUpgrade( const UpgradeTemplate *upgradeT )
 void Object::removeUpgrade( const UpgradeTemplate *upgradeT )
 {
 	BitClear( m_objectUpgradesCompleted, upgradeT->getUpgradeMask() );
+	markCRCDirty();
 	for (BehaviorModule** module = m_behaviors; *module; ++module)
 	{
 		UpgradeModuleInterface* upgrade = (*module)->getUpgrade();
@@ -61,7 +61,9 @@
 #include "Common/Radar.h"
 #include "Common/ThingFactory.h"	// for bullet type hack
 #include "Common/ThingTemplate.h"
+#include "Common/WorkerThreadPool.h"
 #include "Common/Xfer.h"
+#include "Common/XferCRC.h"
 
 #include "GameLogic/AIPathfind.h"
 #include "GameLogic/GameLogic.h"
@@ -127,6 +129,9 @@ const Real HUGE_DIST_SQR = (HUGE_DIST*HUGE_DIST);
 //-----------------------------------------------------------------------------
 static PartitionContactList* TheContactList = NULL;
 
+/// how many dirty modules each worker job looks after in PartitionManager::updateDirtyModules.
+#define PARTITION_MODULES_PER_JOB	32
+
 //-----------------------------------------------------------------------------
 //         Local Types                                                      
 //-----------------------------------------------------------------------------
@@ -986,11 +991,12 @@ PartitionManager *ThePartitionManager = NULL;  ///< the object manager singleton
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
-class PartitionContactListNode : public MemoryPoolObject
+/**
+	contact lists only last for the frame, so the nodes are plain data that normally
+	comes out of the logic's frame memory, and is all thrown away with it.
+*/
+struct PartitionContactListNode
 {
-	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(PartitionContactListNode, "PartitionContactListNode" )
-
-public:
 	PartitionContactListNode*			m_nextHash;	///< next node with same hash value 
 	PartitionContactListNode*			m_next;			///< next node
 	PartitionData*								m_obj;			///< one object that is possibly colliding
@@ -998,8 +1004,6 @@ public:
 	Int														m_hashValue;///< index into hash table 
 };
 
-inline PartitionContactListNode::~PartitionContactListNode() { }
-
 //-----------------------------------------------------------------------------
 
 class PartitionContactList
@@ -1019,6 +1023,7 @@ private:
 
 	PartitionContactListNode* m_contactHash[PartitionContactList_SOCKET_COUNT];
 	PartitionContactListNode* m_contactList;
+	Bool m_nodesInFrameMemory;			///< false if we're off the logic thread, and have to use the dma
 
 public:
 
@@ -1026,6 +1031,7 @@ public:
 	{
 		memset(m_contactHash, 0, sizeof(m_contactHash));
 		m_contactList = NULL;
+		m_nodesInFrameMemory = TheGameLogic && TheGameLogic->canAllocateFrameMemory();
 	}
 
 	~PartitionContactList()
@@ -1058,8 +1064,58 @@ public:
 	*/
 	void removeSpecificPartitionData(PartitionData* data);
 
+#ifdef TEST_PARTITION_SPEED
+	/**
+		hash the pairs in the list (in list order), and count how many of them really
+		collide, without calling any of the collide actions.
+	*/
+	UnsignedInt calcContactListHash(Int *numContacts, Int *numCollisions) const;
+#endif
+
 };
 
+//-----------------------------------------------------------------------------
+/**
+	a possible contact found by PartitionData::gatherPossibleCollisions. the ids are
+	kept in low/high order, so that the same pair found from either end sorts together.
+*/
+struct PartitionContactPair
+{
+	ObjectID				m_lowID;
+	ObjectID				m_highID;
+	PartitionData*	m_obj;			///< the module that found the contact
+	PartitionData*	m_other;
+
+	Bool operator<(const PartitionContactPair& that) const
+	{
+		if (m_lowID != that.m_lowID)
+			return m_lowID < that.m_lowID;
+		if (m_highID != that.m_highID)
+			return m_highID < that.m_highID;
+		// if both ends found it, prefer the one found by the lower id.
+		return m_obj->getObject()->getID() < that.m_obj->getObject()->getID();
+	}
+};
+
+//-----------------------------------------------------------------------------
+/**
+	scratch space for PartitionManager::updateDirtyModules. kept around between frames
+	so we don't reallocate all of it every time.
+*/
+struct PartitionUpdateBatch
+{
+	std::vector<PartitionData*>					m_cellModules;		///< modules that need their cells recalculated
+	std::vector<PartitionData*>					m_collideModules;	///< modules that need a collision check
+	std::vector<PartitionContactPair>		m_pairs[WorkerThreadPool::MAX_WORKER_THREADS + 1];	///< per worker thread
+	std::vector<PartitionContactPair>		m_merged;
+};
+
+static PartitionUpdateBatch s_updateBatch;
+
+#ifdef TEST_PARTITION_SPEED
+static Bool s_partitionUpdateInline = FALSE;	///< the speed test uses this to time the update without the worker threads
+#endif
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -1137,6 +1193,7 @@ CellAndObjectIntersection::CellAndObjectIntersection()
 	m_module = NULL;
 	m_prevCoi = NULL;
 	m_nextCoi = NULL;
+	m_packedIndex = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -1235,6 +1292,11 @@ PartitionCell::PartitionCell()
 	//
 	m_firstCoiInCell = NULL;
 	m_coiCount = 0;
+	m_packedCapacity = 0;
+	m_packedPos = NULL;
+	m_packedCoi = NULL;
+	m_cachedCRC = 0;
+	m_crcDirty = TRUE;
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 	m_loTerrainZ = HUGE_DIST;		// huge positive
 	m_hiTerrainZ = -HUGE_DIST;	// huge negative
@@ -1264,6 +1326,8 @@ PartitionCell::~PartitionCell()
 {
 	DEBUG_ASSERTCRASH(m_firstCoiInCell == NULL && m_coiCount == 0, ("destroying a nonempty PartitionCell"));
 	// but don't destroy the Cois; they don't belong to us
+	delete [] m_packedPos;
+	delete [] m_packedCoi;
 }
 
 //-----------------------------------------------------------------------------
@@ -1279,6 +1343,7 @@ void PartitionCell::invalidateShroudedStatusForAllCois(Int playerIndex)
 void PartitionCell::addLooker(Int playerIndex)
 {
 	CellShroudStatus oldShroud = getShroudStatusForPlayer( playerIndex );
+	m_crcDirty = TRUE;
 	// The decreasing Algorithm: A 1 will go straight to -1, otherwise it just gets decremented
         m_shroudLevel[playerIndex].m_currentShroud = std::min<Int>(m_shroudLevel[playerIndex].m_currentShroud - 1, -1);
 
@@ -1310,6 +1375,7 @@ void PartitionCell::addLooker(Int playerIndex)
 void PartitionCell::removeLooker(Int playerIndex)
 {
 	CellShroudStatus oldShroud = getShroudStatusForPlayer( playerIndex );
+	m_crcDirty = TRUE;
 	// the increasing Algorithm: a -1 goes up to min(1,activeLevel), otherwise it just gets incremented
         if( m_shroudLevel[playerIndex].m_currentShroud == -1 )
                 m_shroudLevel[playerIndex].m_currentShroud = std::min<Short>(m_shroudLevel[playerIndex].m_activeShroudLevel, static_cast<Short>(1));
@@ -1346,6 +1412,7 @@ void PartitionCell::removeLooker(Int playerIndex)
 void PartitionCell::addShrouder( Int playerIndex )
 {
 	CellShroudStatus oldShroud = getShroudStatusForPlayer( playerIndex );
+	m_crcDirty = TRUE;
 	// Increasing active shroud: activeLevel gets incremented, and CS is set to 1 if at zero
 	// do the algorithm
 	m_shroudLevel[playerIndex].m_activeShroudLevel++;
@@ -1375,6 +1442,7 @@ void PartitionCell::removeShrouder( Int playerIndex )
 	// Decreasing active shroud: just decrement activeLevel.  This will never result in a client change.
 	// Either it was passive shroud and is now active, or it was being looked at and still is.
 	m_shroudLevel[playerIndex].m_activeShroudLevel--;
+	m_crcDirty = TRUE;
 	DEBUG_ASSERTCRASH( m_shroudLevel[playerIndex].m_activeShroudLevel >= 0, ("Shroud generation has gone negative.  This can't happen.") );
 }
 
@@ -1469,7 +1537,31 @@ void PartitionCell::friend_addToCellList(CellAndObjectIntersection *coi)
 {
 	if (coi)
 	{
+		if (m_coiCount >= m_packedCapacity)
+		{
+			Int newCapacity = m_packedCapacity ? m_packedCapacity * 2 : 4;
+			Real *newPos = MSGNEW("PartitionManager_Packed") Real[newCapacity * 3];
+			CellAndObjectIntersection **newCoi = MSGNEW("PartitionManager_Packed") CellAndObjectIntersection*[newCapacity];
+			if (m_coiCount)
+			{
+				memcpy(newPos, m_packedPos, m_coiCount * sizeof(Real));
+				memcpy(newPos + newCapacity, m_packedPos + m_packedCapacity, m_coiCount * sizeof(Real));
+				memcpy(newPos + 2*newCapacity, m_packedPos + 2*m_packedCapacity, m_coiCount * sizeof(Real));
+				memcpy(newCoi, m_packedCoi, m_coiCount * sizeof(CellAndObjectIntersection*));
+			}
+			delete [] m_packedPos;
+			delete [] m_packedCoi;
+			m_packedPos = newPos;
+			m_packedCoi = newCoi;
+			m_packedCapacity = newCapacity;
+		}
+
+		// the list grows at the head, so the packed arrays grow at the end. the position gets
+		// filled in by the module once it has all its cells.
 		coi->friend_addToCellList(&m_firstCoiInCell);
+		coi->friend_setPackedIndex(m_coiCount);
+		m_packedCoi[m_coiCount] = coi;
+		friend_setPackedPos(m_coiCount, 0.0f, 0.0f, 0.0f);
 		++m_coiCount;
 	}
 }
@@ -1481,6 +1573,21 @@ void PartitionCell::friend_removeFromCellList(CellAndObjectIntersection *coi)
 	{
 		coi->friend_removeFromCellList(&m_firstCoiInCell);
 		--m_coiCount;
+
+		// close up the gap, keeping everything else in the same order.
+		Int index = coi->friend_getPackedIndex();
+		DEBUG_ASSERTCRASH(index >= 0 && index <= m_coiCount && m_packedCoi[index] == coi, ("packed coi mismatch"));
+		Int numToMove = m_coiCount - index;
+		if (numToMove > 0)
+		{
+			memmove(m_packedPos + index, m_packedPos + index + 1, numToMove * sizeof(Real));
+			memmove(m_packedPos + m_packedCapacity + index, m_packedPos + m_packedCapacity + index + 1, numToMove * sizeof(Real));
+			memmove(m_packedPos + 2*m_packedCapacity + index, m_packedPos + 2*m_packedCapacity + index + 1, numToMove * sizeof(Real));
+			memmove(m_packedCoi + index, m_packedCoi + index + 1, numToMove * sizeof(CellAndObjectIntersection*));
+			for (Int i = index; i < m_coiCount; ++i)
+				m_packedCoi[i]->friend_setPackedIndex(i);
+		}
+		coi->friend_setPackedIndex(-1);
 	}
 }
 
@@ -1503,6 +1610,14 @@ void PartitionCell::validateCoiList()
 		DEBUG_ASSERTCRASH((coi == getFirstCoiInCell()) == (prevCoi == NULL) , ("coi link mismatch"));
 		DEBUG_ASSERTCRASH(nextCoi == NULL || nextCoi->getPrevCoi() == coi, ("coi link mismatch"));
 	}
+
+	Int i = m_coiCount;
+	for (CellAndObjectIntersection *coi = getFirstCoiInCell(); coi; coi = coi->getNextCoi())
+	{
+		--i;
+		DEBUG_ASSERTCRASH(i >= 0 && m_packedCoi[i] == coi && coi->friend_getPackedIndex() == i, ("packed coi mismatch"));
+	}
+	DEBUG_ASSERTCRASH(i == 0, ("packed coi count mismatch"));
 }
 #endif
 
@@ -1518,6 +1633,26 @@ void PartitionCell::crc( Xfer *xfer )
 
 }  // end crc
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+UnsignedInt PartitionCell::getCellCRC( Bool useCache )
+{
+	if (useCache && !m_crcDirty)
+		return m_cachedCRC;
+
+	XferCRC xferCRC;
+	crc( &xferCRC );
+	UnsignedInt theCRC = xferCRC.getCRC();
+
+	if (useCache)
+	{
+		m_cachedCRC = theCRC;
+		m_crcDirty = FALSE;
+	}
+
+	return theCRC;
+}
+
 // ------------------------------------------------------------------------------------------------
 /** Xfer Method */
 // ------------------------------------------------------------------------------------------------
@@ -1531,6 +1666,8 @@ void PartitionCell::xfer( Xfer *xfer )
 
 	// xfer shroud data
 	xfer->xferUser( &m_shroudLevel, sizeof( ShroudLevel ) * MAX_PLAYER_COUNT );
+	if( xfer->getXferMode() == XFER_LOAD )
+		m_crcDirty = TRUE;
 
 }  // end xfer
 
@@ -1559,6 +1696,9 @@ PartitionData::PartitionData()
 	m_coiArrayCount = 0;
 	m_coiArray = NULL;
 	m_coiInUseCount = 0;
+	m_pendingCells = NULL;
+	m_pendingCellCount = 0;
+	m_pendingCenterCell = NULL;
 	m_doneFlag = 0;
 	m_dirtyStatus = NOT_DIRTY;
 	m_lastCell = NULL;
@@ -1747,29 +1887,20 @@ void PartitionData::removeAllTouchedCells()
 // -----------------------------------------------------------------------------
 void PartitionData::addSubPixToCoverage(PartitionCell *cell)
 {
-	DEBUG_ASSERTCRASH(m_coiInUseCount < m_coiArrayCount, ("not enough cois allocated for this object"));
+	DEBUG_ASSERTCRASH(m_pendingCellCount < m_coiArrayCount, ("not enough cois allocated for this object"));
 	if (cell)
 	{			
-		// see if we already have a coi for this cell.
-		CellAndObjectIntersection *coi = m_coiArray;
-		CellAndObjectIntersection *coiToUse = NULL;
-		for (Int i = m_coiInUseCount; i; --i, ++coi)
+		// see if we already have this cell.
+		for (Int i = 0; i < m_pendingCellCount; ++i)
 		{
-			if (coi->getCell() == cell)
-			{
-				coiToUse = coi;
-				break;
-			}
-		}
-		DEBUG_ASSERTCRASH(coiToUse != NULL || m_coiInUseCount < m_coiArrayCount, ("not enough cois allocated for this object"));
-		if (coiToUse == NULL && m_coiInUseCount < m_coiArrayCount)
-		{
-			// nope, no coi for this cell, allocate a new one
-			coiToUse = &m_coiArray[m_coiInUseCount++];
+			if (m_pendingCells[i] == cell)
+				return;
 		}
-		if (coiToUse)
+		DEBUG_ASSERTCRASH(m_pendingCellCount < m_coiArrayCount, ("not enough cois allocated for this object"));
+		if (m_pendingCellCount < m_coiArrayCount)
 		{
-			coiToUse->addCoverage(cell, this);
+			// nope, it's a new one
+			m_pendingCells[m_pendingCellCount++] = cell;
 		}
 	}
 }
@@ -1852,7 +1983,7 @@ void PartitionData::doCircleFill(
 	Real radius
 )
 {
-	DEBUG_ASSERTCRASH(m_coiInUseCount == 0, ("expected no coi in use here"));
+	DEBUG_ASSERTCRASH(m_pendingCellCount == 0, ("expected no pending cells here"));
 
 	Int cellCenterX, cellCenterY;
 	ThePartitionManager->worldToCell(centerX, centerY, &cellCenterX, &cellCenterY);
@@ -1886,7 +2017,7 @@ void PartitionData::doSmallFill(
 	Real radius
 )
 {
-	DEBUG_ASSERTCRASH(m_coiInUseCount == 0, ("expected no coi in use here"));
+	DEBUG_ASSERTCRASH(m_pendingCellCount == 0, ("expected no pending cells here"));
 
 	Real halfCellSize = ThePartitionManager->getCellSize() * 0.5f;
 	if (radius > halfCellSize)
@@ -1909,17 +2040,17 @@ void PartitionData::doSmallFill(
 			PartitionCell *cell = ThePartitionManager->getCellAt(x, y);
 			if (cell)
 			{
-				m_coiArray[m_coiInUseCount++].addCoverage(cell, this);
+				m_pendingCells[m_pendingCellCount++] = cell;
 			}
 		}
 	}
 
 	#ifdef INTENSE_DEBUG
-	for (int i = 0; i < m_coiInUseCount; i++)
+	for (int i = 0; i < m_pendingCellCount; i++)
 	{
 		for (int j = 0; j < i; j++)
 		{
-			DEBUG_ASSERTCRASH(m_coiArray[i].getCell() != m_coiArray[j].getCell(), ("dup cells"));
+			DEBUG_ASSERTCRASH(m_pendingCells[i] != m_pendingCells[j], ("dup cells"));
 		}
 	}
 	#endif
@@ -1962,6 +2093,41 @@ void PartitionData::addPossibleCollisions(PartitionContactList *ctList)
 	}
 }
 
+//-----------------------------------------------------------------------------
+void PartitionData::gatherPossibleCollisions(std::vector<PartitionContactPair> &pairs) const
+{
+	// (see the comment in addPossibleCollisions about dead objects.)
+	const Object *obj = getObject();
+	if (obj == NULL)
+		return;
+	ObjectID id = obj->getID();
+
+	const CellAndObjectIntersection *myCoi = m_coiArray;
+	for (Int i = m_coiInUseCount; i > 0; --i, ++myCoi)
+	{
+		PartitionCell *cell = const_cast<CellAndObjectIntersection *>(myCoi)->getCell();
+		if (cell->getCoiCount() < 2)
+			continue;
+
+		for (CellAndObjectIntersection *coi = cell->getFirstCoiInCell(); coi; coi = coi->getNextCoi())
+		{
+			PartitionData *that = coi->getModule();
+			if (this == that || that == NULL || that->getObject() == NULL)
+				continue;
+
+			// note that a pair sharing several cells gets added once per cell; 
+			// updateDirtyModules sorts the dupes out.
+			ObjectID thatID = that->getObject()->getID();
+			PartitionContactPair pair;
+			pair.m_lowID = id < thatID ? id : thatID;
+			pair.m_highID = id < thatID ? thatID : id;
+			pair.m_obj = const_cast<PartitionData *>(this);
+			pair.m_other = that;
+			pairs.push_back(pair);
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 Bool PartitionData::collidesWith(const PartitionData *that, CollideLocAndNormal *cinfo) const
 {
@@ -2034,6 +2200,13 @@ Bool PartitionManager::geomCollidesWithGeom(const Coord3D* pos1,
 
 //-----------------------------------------------------------------------------
 void PartitionData::updateCellsTouched()
+{
+	calcCellsTouched();
+	applyCellsTouched();
+}
+
+//-----------------------------------------------------------------------------
+void PartitionData::calcCellsTouched()
 {
 	GeometryType geom;
 	Bool isSmall;
@@ -2064,7 +2237,7 @@ void PartitionData::updateCellsTouched()
 		minorRadius = m_ghostObject->getGeometryMinorRadius();
 	}
 
-	removeAllTouchedCells();
+	m_pendingCellCount = 0;
 	if (isSmall)
 	{
 		doSmallFill(pos.x, pos.y, majorRadius);
@@ -2090,7 +2263,24 @@ void PartitionData::updateCellsTouched()
 
 	Int currentCellIndexX, currentCellIndexY;
 	ThePartitionManager->worldToCell( pos.x, pos.y, &currentCellIndexX, &currentCellIndexY );
-	const PartitionCell *currentCell = ThePartitionManager->getCellAt( currentCellIndexX, currentCellIndexY );
+	m_pendingCenterCell = ThePartitionManager->getCellAt( currentCellIndexX, currentCellIndexY );
+}
+
+//-----------------------------------------------------------------------------
+void PartitionData::applyCellsTouched()
+{
+	removeAllTouchedCells();
+
+	// the order matters here, since it decides the order of the COIs in each cell.
+	for (Int i = 0; i < m_pendingCellCount; ++i)
+	{
+		m_coiArray[m_coiInUseCount++].addCoverage(m_pendingCells[i], this);
+	}
+	m_pendingCellCount = 0;
+	updatePackedPosition();
+
+	Object *obj = getObject();
+	const PartitionCell *currentCell = m_pendingCenterCell;
 	if(obj && currentCell != m_lastCell )
 	{
 		// To not expose PartitionCells, he will think in terms of points.  He will 
@@ -2119,6 +2309,36 @@ void PartitionData::updateCellsTouched()
 
 }
 
+//-----------------------------------------------------------------------------
+void PartitionData::updatePackedPosition()
+{
+	const Coord3D *pos;
+	Real radius;
+	if (m_object)
+	{
+		// the range queries use this to cover both the bounding circle and bounding sphere cases.
+		const GeometryInfo& geom = m_object->getGeometryInfo();
+		pos = m_object->getPosition();
+		radius = maxReal(geom.getBoundingCircleRadius(), geom.getBoundingSphereRadius());
+	}
+	else if (m_ghostObject)
+	{
+		// the range queries ignore anything without an object, so this doesn't need to be exact.
+		pos = m_ghostObject->getParentPosition();
+		radius = 0.0f;
+	}
+	else
+	{
+		return;
+	}
+
+	CellAndObjectIntersection *coi = m_coiArray;
+	for (Int i = m_coiInUseCount; i > 0; --i, ++coi)
+	{
+		coi->getCell()->friend_setPackedPos(coi->friend_getPackedIndex(), pos->x, pos->y, radius);
+	}
+}
+
 //-----------------------------------------------------------------------------
 void PartitionData::invalidateShroudedStatusForPlayer(Int playerIndex) 
 { 
@@ -2221,7 +2441,9 @@ void PartitionData::allocCoiArray()
 	DEBUG_ASSERTCRASH(m_coiInUseCount == 0, ("hmm, coi count mismatch"));
 	m_coiArrayCount = calcMaxCoiForObject();
 	m_coiArray = MSGNEW("PartitionManager_COI") CellAndObjectIntersection[m_coiArrayCount];	// may throw!
+	m_pendingCells = MSGNEW("PartitionManager_COI") PartitionCell*[m_coiArrayCount];	// may throw!
 	m_coiInUseCount = 0;
+	m_pendingCellCount = 0;
 	makeDirty(true);
 }
 
@@ -2230,8 +2452,11 @@ void PartitionData::freeCoiArray()
 {
 	delete [] m_coiArray;	// yes, it's OK to call this on null...
 	m_coiArray = NULL;
+	delete [] m_pendingCells;
+	m_pendingCells = NULL;
 	m_coiArrayCount = 0;
 	m_coiInUseCount = 0;
+	m_pendingCellCount = 0;
 	makeDirty(true);
 }
 
@@ -2313,7 +2538,9 @@ void PartitionData::attachToGhostObject(GhostObject* object)
 
 	m_coiArrayCount = calcMaxCoiForShape(object->getGeometryType(), object->getGeometryMajorRadius(), object->getGeometryMinorRadius(),object->getGeometrySmall());
 	m_coiArray = MSGNEW("PartitionManager_COI") CellAndObjectIntersection[m_coiArrayCount];	// may throw!
+	m_pendingCells = MSGNEW("PartitionManager_COI") PartitionCell*[m_coiArrayCount];	// may throw!
 	m_coiInUseCount = 0;
+	m_pendingCellCount = 0;
 	makeDirty(true);
 
 	if (m_ghostObject)
@@ -2391,7 +2618,11 @@ void PartitionContactList::addToContactList( PartitionData *obj, PartitionData *
 	}
 
 	// new hit 
-	PartitionContactListNode *ncd = newInstance(PartitionContactListNode);
+	PartitionContactListNode *ncd;
+	if (m_nodesInFrameMemory)
+		ncd = (PartitionContactListNode *)TheGameLogic->allocateFrameMemory(sizeof(PartitionContactListNode));
+	else
+		ncd = (PartitionContactListNode *)TheDynamicMemoryAllocator->allocateBytesDoNotZero(sizeof(PartitionContactListNode), "PartitionContactListNode");
 	ncd->m_obj = obj;
 	ncd->m_other = other;
 	ncd->m_hashValue = hashValue;
@@ -2466,15 +2697,41 @@ void PartitionContactList::removeSpecificPartitionData(PartitionData* data)
 	}
 }
 
+#ifdef TEST_PARTITION_SPEED
+//-----------------------------------------------------------------------------
+UnsignedInt PartitionContactList::calcContactListHash(Int *numContacts, Int *numCollisions) const
+{
+	UnsignedInt hash = 5381;
+	*numContacts = 0;
+	*numCollisions = 0;
+	for (const PartitionContactListNode* cd = m_contactList; cd; cd = cd->m_next)
+	{
+		if (cd->m_obj == NULL || cd->m_other == NULL)
+			continue;
+		hash = hash * 33 + cd->m_obj->getObject()->getID();
+		hash = hash * 33 + cd->m_other->getObject()->getID();
+		++(*numContacts);
+
+		CollideLocAndNormal cinfo;
+		if (cd->m_obj->friend_collidesWith(cd->m_other, &cinfo))
+			++(*numCollisions);
+	}
+	return hash;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 void PartitionContactList::resetContactList()
 {
-	// remove items from hash table 
-	PartitionContactListNode* cdnext;
-	for (PartitionContactListNode* cd = m_contactList; cd; cd = cdnext)
+	// remove items from hash table (nodes in frame memory go at the end of the frame, all at once)
+	if (!m_nodesInFrameMemory)
 	{
-		cdnext = cd->m_next;
-		cd->deleteInstance();
+		PartitionContactListNode* cdnext;
+		for (PartitionContactListNode* cd = m_contactList; cd; cd = cdnext)
+		{
+			cdnext = cd->m_next;
+			TheDynamicMemoryAllocator->freeBytes(cd);
+		}
 	}
 
 	memset(m_contactHash, 0, sizeof(m_contactHash));
@@ -2562,6 +2819,9 @@ PartitionManager::PartitionManager()
 #ifdef FASTER_GCO
 	m_maxGcoRadius = 0;
 #endif
+#ifdef TEST_PARTITION_SPEED
+	m_ranPartitionSpeedTest = false;
+#endif
 } 
 
 //-----------------------------------------------------------------------------
@@ -2677,6 +2937,9 @@ void PartitionManager::reset()
 	s_timeInClosestObjectsThisFrame = 0;
 	s_gcoPerfFrame = 0xffffffff;
 #endif
+#ifdef TEST_PARTITION_SPEED
+	m_ranPartitionSpeedTest = false;
+#endif
 
 	resetPendingUndoShroudRevealQueue();
 
@@ -2720,27 +2983,80 @@ void PartitionManager::shutdown()
 }
 
 //-----------------------------------------------------------------------------
-//DECLARE_PERF_TIMER(PartitionManager_update)
-void PartitionManager::update()
+static void calcCellsTouchedJob(Int jobIndex, Int /*workerIndex*/, void * /*userData*/)
 {
-	//USE_PERF_TIMER(PartitionManager_update)
+	std::vector<PartitionData*> &modules = s_updateBatch.m_cellModules;
+	Int first = jobIndex * PARTITION_MODULES_PER_JOB;
+	Int last = minInt(first + PARTITION_MODULES_PER_JOB, (Int)modules.size());
+	for (Int i = first; i < last; ++i)
 	{
-#ifdef INTENSE_DEBUG
-		Int cc = 0;
+		modules[i]->friend_calcCellsTouched();
+	}
+}
+
+//-----------------------------------------------------------------------------
+static void gatherPossibleCollisionsJob(Int jobIndex, Int workerIndex, void * /*userData*/)
+{
+	std::vector<PartitionData*> &modules = s_updateBatch.m_collideModules;
+	std::vector<PartitionContactPair> &pairs = s_updateBatch.m_pairs[workerIndex];
+	Int first = jobIndex * PARTITION_MODULES_PER_JOB;
+	Int last = minInt(first + PARTITION_MODULES_PER_JOB, (Int)modules.size());
+	for (Int i = first; i < last; ++i)
+	{
+		modules[i]->gatherPossibleCollisions(pairs);
+	}
+}
+
+//-----------------------------------------------------------------------------
+static void runPartitionJobs(Int numModules, WorkerJobProc proc)
+{
+	Int numJobs = (numModules + PARTITION_MODULES_PER_JOB - 1) / PARTITION_MODULES_PER_JOB;
+#ifdef TEST_PARTITION_SPEED
+	if (s_partitionUpdateInline)
+	{
+		for (Int i = 0; i < numJobs; ++i)
+			proc(i, 0, NULL);
+		return;
+	}
 #endif
-		if (!m_updatedSinceLastReset) 
-		{
-			m_updatedSinceLastReset = true;
-		}
+	if (TheWorkerThreadPool)
+	{
+		TheWorkerThreadPool->parallelFor(numJobs, proc, NULL);
+	}
+	else
+	{
+		for (Int i = 0; i < numJobs; ++i)
+			proc(i, 0, NULL);
+	}
+}
 
-		PartitionContactList ctList;
-		TheContactList = &ctList;
-		while (m_dirtyModules)
-		{
+//-----------------------------------------------------------------------------
+/*
+	This used to update the cells and then gather the contacts for each dirty module in turn.
+	Now it goes a batch at a time: the cells for the whole batch are worked out on the worker
+	threads, then hooked up serially (in dirty list order, so the cells end up exactly as they
+	used to), then the contacts for the batch are gathered on the worker threads, since by then
+	the cells are read only. The pairs from all the threads are then sorted by object id, so the
+	contact list (and thus the order of the onCollide calls) is the same no matter how many
+	threads we have, or how the jobs got split between 'em. (Note that the pairs are found
+	after the whole batch has moved, rather than one at a time, so the list isn't identical to
+	what it used to be, but it's just as deterministic.)
+*/
+void PartitionManager::updateDirtyModules(PartitionContactList *ctList)
+{
+	PartitionUpdateBatch &batch = s_updateBatch;
 #ifdef INTENSE_DEBUG
-			++cc;
+	Int cc = 0;
 #endif
 
+	// updating the cells can dirty more modules (eg, via onPartitionCellChange), so keep
+	// going till the list stays empty.
+	while (m_dirtyModules)
+	{
+		batch.m_cellModules.clear();
+		batch.m_collideModules.clear();
+		while (m_dirtyModules)
+		{
 			// save it.
 			PartitionData *dirty = m_dirtyModules;
 			DEBUG_ASSERTCRASH(dirty->getObject() != NULL || dirty->getGhostObject() != NULL, 
@@ -2753,22 +3069,161 @@ void PartitionManager::update()
 			
 			// detach it from the dirty list.
 			removeFromDirtyModules(dirty);
+#ifdef INTENSE_DEBUG
+			++cc;
+#endif
 
 			if (updateEm)
 			{
-				dirty->friend_updateCellsTouched();
+				batch.m_cellModules.push_back(dirty);
 			}
 
 			if (collideEm && !dirty->getObject()->isKindOf(KINDOF_IMMOBILE))
 			{
-				dirty->addPossibleCollisions(&ctList);
+				batch.m_collideModules.push_back(dirty);
 			}
 		}
-		
-		ctList.processContactList();
+
+		Int numCellModules = (Int)batch.m_cellModules.size();
+		runPartitionJobs(numCellModules, calcCellsTouchedJob);
+		for (Int i = 0; i < numCellModules; ++i)
+		{
+			batch.m_cellModules[i]->friend_applyCellsTouched();
+		}
+
+		Int numCollideModules = (Int)batch.m_collideModules.size();
+		if (numCollideModules == 0)
+			continue;
+
+		runPartitionJobs(numCollideModules, gatherPossibleCollisionsJob);
+
+		std::vector<PartitionContactPair> &merged = batch.m_merged;
+		merged.clear();
+		for (Int t = 0; t <= WorkerThreadPool::MAX_WORKER_THREADS; ++t)
+		{
+			merged.insert(merged.end(), batch.m_pairs[t].begin(), batch.m_pairs[t].end());
+			batch.m_pairs[t].clear();
+		}
+		std::sort(merged.begin(), merged.end());
+
+		// addToContactList puts each new pair at the front of the list, so go backwards
+		// to end up with the list in ascending id order. skip the dupes as we go
+		// (the first one in sorted order is the one we want to keep).
+		for (Int i = (Int)merged.size() - 1; i >= 0; --i)
+		{
+			if (i > 0 && merged[i-1].m_lowID == merged[i].m_lowID && merged[i-1].m_highID == merged[i].m_highID)
+				continue;
+			ctList->addToContactList(merged[i].m_obj, merged[i].m_other);
+		}
+	}
 #ifdef INTENSE_DEBUG
-		DEBUG_ASSERTLOG(cc==0,("updated partition info for %d objects\n",cc));
+	DEBUG_ASSERTLOG(cc==0,("updated partition info for %d objects\n",cc));
+#endif
+}
+
+#ifdef TEST_PARTITION_SPEED
+//-----------------------------------------------------------------------------
+/*
+	Move a bunch of units a cell over and back again, and time the partition update that
+	follows, first inline and then on the worker threads, and make sure both come up with
+	the same contact lists. Every unit ends up exactly where it started; the only lasting
+	effect is that everyone's shroudedness gets invalidated (which happens every time
+	anything moves anyway).
+*/
+void PartitionManager::doPartitionSpeedTest()
+{
+	const Int NUM_PASSES = 20;	// must be even, so everyone ends up back where they started
+	const Int MAX_MOVERS = 500;
+
+	Int numModules = 0;
+	std::vector<Object*> movers;
+	std::vector<Coord3D> home;
+	for (PartitionData *mod = m_moduleList; mod; mod = mod->getNext())
+	{
+		++numModules;
+		Object *obj = mod->getObject();
+		if (obj && !obj->isKindOf(KINDOF_IMMOBILE) && (Int)movers.size() < MAX_MOVERS)
+		{
+			movers.push_back(obj);
+			home.push_back(*obj->getPosition());
+		}
+	}
+
+	// get rid of whatever is dirty right now, so each pass starts from the same place.
+	{
+		PartitionContactList ctList;
+		TheContactList = &ctList;
+		updateDirtyModules(&ctList);
+		TheContactList = NULL;
+	}
+
+	UnsignedInt hash[2];
+	Int numContacts[2], numCollisions[2];
+	UnsignedInt time[2];
+	for (Int mode = 0; mode < 2; ++mode)
+	{
+		s_partitionUpdateInline = (mode == 0);
+		hash[mode] = 0;
+		numContacts[mode] = numCollisions[mode] = 0;
+		time[mode] = 0;
+		for (Int pass = 0; pass < NUM_PASSES; ++pass)
+		{
+			// moving them is what dirties their modules, same as it would in the game.
+			for (size_t i = 0; i < movers.size(); ++i)
+			{
+				Coord3D pos = home[i];
+				if ((pass & 1) == 0)
+					pos.x += m_cellSize;
+				movers[i]->setPosition(&pos);
+			}
+
+			PartitionContactList ctList;
+			TheContactList = &ctList;
+			UnsignedInt startTime = ::GetTickCount();
+			updateDirtyModules(&ctList);
+			time[mode] += ::GetTickCount() - startTime;
+			Int passContacts, passCollisions;
+			hash[mode] = hash[mode] * 31 + ctList.calcContactListHash(&passContacts, &passCollisions);
+			numContacts[mode] += passContacts;
+			numCollisions[mode] += passCollisions;
+			TheContactList = NULL;
+		}
+	}
+	s_partitionUpdateInline = FALSE;
+
+	DEBUG_LOG(("PartitionSpeedTest - %d modules, %d moved, %d contacts and %d real collisions over %d passes\n",
+		numModules, (Int)movers.size(), numContacts[0], numCollisions[0], NUM_PASSES));
+	DEBUG_LOG(("PartitionSpeedTest - inline %f ms/pass, %d threads %f ms/pass\n",
+		time[0] / (Real)NUM_PASSES, TheWorkerThreadPool ? TheWorkerThreadPool->getNumThreads() : 1, time[1] / (Real)NUM_PASSES));
+	DEBUG_ASSERTCRASH(hash[0] == hash[1] && numContacts[0] == numContacts[1] && numCollisions[0] == numCollisions[1],
+		("PartitionSpeedTest - contact list depends on the thread count (%08x vs %08x)", hash[0], hash[1]));
+}
 #endif
+
+//-----------------------------------------------------------------------------
+//DECLARE_PERF_TIMER(PartitionManager_update)
+void PartitionManager::update()
+{
+	//USE_PERF_TIMER(PartitionManager_update)
+	{
+		if (!m_updatedSinceLastReset) 
+		{
+			m_updatedSinceLastReset = true;
+		}
+
+#ifdef TEST_PARTITION_SPEED
+		if (!m_ranPartitionSpeedTest && TheGameLogic->getFrame() > LOGICFRAMES_PER_SECOND*10)
+		{
+			m_ranPartitionSpeedTest = true;
+			doPartitionSpeedTest();
+		}
+#endif
+
+		PartitionContactList ctList;
+		TheContactList = &ctList;
+		updateDirtyModules(&ctList);
+		
+		ctList.processContactList();
 		TheContactList = NULL;
 
 		processPendingUndoShroudRevealQueue();
@@ -3258,6 +3713,28 @@ Object *PartitionManager::getClosestObjects(
 	static Int theIterFlag = 1;	// nonzero, thanks
 	++theIterFlag;
 
+	/*
+		Before looking at an object for real, we check the cell's packed copy of its position
+		and radius against a (deliberately generous) 2d bound, and skip it if it can't possibly
+		pass the distProc. None of the distProcs can give a distance smaller than the 2d
+		center distance less both radii, so this never throws out anything the distProc would
+		keep, and the things we do look at get looked at in the same order as always.
+	*/
+	const Real PACKED_SLOP = 1.0f;	// covers any roundoff differences with the distProcs
+	Bool useRadius = (dc == FROM_BOUNDINGSPHERE_2D || dc == FROM_BOUNDINGSPHERE_3D);
+	Real radiusScale = useRadius ? 1.0f : 0.0f;
+	Real myRadius = 0.0f;
+	if (useRadius && objToUse)
+	{
+		const GeometryInfo& geom = objToUse->getGeometryInfo();
+		myRadius = maxReal(geom.getBoundingCircleRadius(), geom.getBoundingSphereRadius());
+	}
+	Real reach = sqrtf(closestDistSqr) + myRadius + PACKED_SLOP;
+	Real reachDistSqr = closestDistSqr;
+
+	enum { PACKED_CHUNK = 32 };
+	UnsignedByte packedPass[PACKED_CHUNK];
+
 	/*
 		m_radiusVec[curRadius] contains a list of the cells (foo) that could
 		contain objects that are <= (curRadius * cellSize) distance away from cell (0,0).
@@ -3273,53 +3750,84 @@ Object *PartitionManager::getClosestObjects(
 			if (thisCell == NULL)
 				continue;
 
-			for (CellAndObjectIntersection *thisCoi = thisCell->getFirstCoiInCell(); thisCoi; thisCoi = thisCoi->getNextCoi())
-			{
-				PartitionData *thisMod = thisCoi->getModule();
-				Object *thisObj = thisMod->getObject();
-
-				// never compare against ourself.
-				if (thisObj == obj || thisObj == NULL) 
-					continue;
+			const Real *packedX = thisCell->getPackedX();
+			const Real *packedY = thisCell->getPackedY();
+			const Real *packedRadius = thisCell->getPackedRadius();
 
-				// since an object can exist in multiple COIs, we use this to avoid processing
-				// the same one more than once.
-				if (thisMod->friend_getDoneFlag() == theIterFlag)
-					continue;
-				thisMod->friend_setDoneFlag(theIterFlag);
-			
-				Real thisDistSqr;
-				Coord3D distVec;
-				if (!(*distProc)(objPos, objToUse, thisObj->getPosition(), thisObj, thisDistSqr, distVec, closestDistSqr))
-					continue;
+			// the packed arrays are in reverse list order, so go backwards, a chunk at a time.
+			for (Int chunkEnd = thisCell->getCoiCount(); chunkEnd > 0; chunkEnd -= PACKED_CHUNK)
+			{
+				Int chunkStart = maxInt(chunkEnd - PACKED_CHUNK, 0);
+				Int chunkCount = chunkEnd - chunkStart;
 
-				if (!filtersAllow(filters, thisObj))
-					continue;
+				if (reachDistSqr != closestDistSqr)
+				{
+					// we found something closer, so we can tighten up.
+					reachDistSqr = closestDistSqr;
+					reach = sqrtf(closestDistSqr) + myRadius + PACKED_SLOP;
+				}
 
-				// ok, this is within the range, and the filters allow it.
-				// add it to the iter, if we have one....
-				if (iterArg)
+				// no branches in here, so the compiler can do several at once.
+				for (Int j = 0; j < chunkCount; ++j)
 				{
-					iterArg->insert(thisObj, thisDistSqr);
+					Real dx = packedX[chunkStart + j] - objPos->x;
+					Real dy = packedY[chunkStart + j] - objPos->y;
+					Real limit = reach + packedRadius[chunkStart + j] * radiusScale;
+					packedPass[j] = (dx*dx + dy*dy <= limit*limit);
 				}
-				else
+
+				for (Int j = chunkCount - 1; j >= 0; --j)
 				{
-					// hey, this is the new closest object! cool.
-					// (note that we can't break out now 'cuz we have to finish examining the
-					// rest of curRadius)
-					closestObj = thisObj;
-					closestDistSqr = thisDistSqr;
-					closestVec = distVec;
-
-					if (!foundAny)
+					if (!packedPass[j])
+						continue;
+
+					CellAndObjectIntersection *thisCoi = thisCell->getPackedCoi(chunkStart + j);
+					PartitionData *thisMod = thisCoi->getModule();
+					Object *thisObj = thisMod->getObject();
+
+					// never compare against ourself.
+					if (thisObj == obj || thisObj == NULL) 
+						continue;
+
+					// since an object can exist in multiple COIs, we use this to avoid processing
+					// the same one more than once.
+					if (thisMod->friend_getDoneFlag() == theIterFlag)
+						continue;
+					thisMod->friend_setDoneFlag(theIterFlag);
+			
+					Real thisDistSqr;
+					Coord3D distVec;
+					if (!(*distProc)(objPos, objToUse, thisObj->getPosition(), thisObj, thisDistSqr, distVec, closestDistSqr))
+						continue;
+
+					if (!filtersAllow(filters, thisObj))
+						continue;
+
+					// ok, this is within the range, and the filters allow it.
+					// add it to the iter, if we have one....
+					if (iterArg)
 					{
-						// if not adding to iterArg, we want to stop once we have the closest object. 
-						maxRadiusLimit = curRadius;
+						iterArg->insert(thisObj, thisDistSqr);
+					}
+					else
+					{
+						// hey, this is the new closest object! cool.
+						// (note that we can't break out now 'cuz we have to finish examining the
+						// rest of curRadius)
+						closestObj = thisObj;
+						closestDistSqr = thisDistSqr;
+						closestVec = distVec;
+
+						if (!foundAny)
+						{
+							// if not adding to iterArg, we want to stop once we have the closest object. 
+							maxRadiusLimit = curRadius;
+						}
+						foundAny = true;
 					}
-					foundAny = true;
-				}
 
-			} // next coi
+				} // next coi
+			}	// next chunk
 		}	// next cell in this radius
   } // next radius
 
@@ -4554,6 +5062,43 @@ void PartitionManager::crc( Xfer *xfer )
 
 }  // end crc
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PartitionManager::xferCellCRCs( Xfer *xfer, Bool useCache )
+{
+
+	m_cellCRCs.resize( m_totalCellCount );
+	for (Int i=0; i<m_totalCellCount; ++i)
+	{
+		m_cellCRCs[i] = m_cells[i].getCellCRC( useCache );
+	}
+
+	if (m_totalCellCount > 0)
+		xfer->xferUser( &m_cellCRCs[0], m_totalCellCount * sizeof(UnsignedInt) );
+
+}  // end xferCellCRCs
+
+#ifdef DEBUG_CRC
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PartitionManager::verifyCellCRCs( void )
+{
+
+	for (Int i=0; i<m_totalCellCount; ++i)
+	{
+		PartitionCell *cell = &m_cells[i];
+		if (!cell->isCellCRCCached())
+			continue;
+
+		UnsignedInt cachedCRC = cell->getCellCRC( TRUE );
+		UnsignedInt freshCRC = cell->getCellCRC( FALSE );
+		DEBUG_ASSERTCRASH( cachedCRC == freshCRC, ("Cell (%d,%d) has a cached CRC of 0x%8.8X but is really 0x%8.8X - something changed its shroud without marking it dirty\n",
+			cell->getCellX(), cell->getCellY(), cachedCRC, freshCRC) );
+	}
+
+}  // end verifyCellCRCs
+#endif // DEBUG_CRC
+
 // ------------------------------------------------------------------------------------------------
 /** Xfer Method
 	* Version Info:
@@ -30,6 +30,7 @@
 #include "GameLogic/ObjectIter.h"
 
 #include "Common/ThingTemplate.h"
+#include "GameLogic/GameLogic.h"
 #include "GameLogic/Object.h"
 
 
@@ -44,23 +45,13 @@ SimpleObjectIterator::ClumpCompareProc SimpleObjectIterator::theClumpCompareProc
 	SimpleObjectIterator::sortExpensiveToCheap
 };
 
-//=============================================================================
-SimpleObjectIterator::Clump::Clump()
-{
-	m_nextClump = NULL;
-}
-
-//=============================================================================
-SimpleObjectIterator::Clump::~Clump()
-{
-}
-
 //=============================================================================
 SimpleObjectIterator::SimpleObjectIterator()
 {
 	m_firstClump = NULL;
 	m_curClump = NULL;
 	m_clumpCount = 0;
+	m_clumpsInFrameMemory = TheGameLogic && TheGameLogic->canAllocateFrameMemory();
 }
 
 //=============================================================================
@@ -74,7 +65,11 @@ void SimpleObjectIterator::insert(Object *obj, Real numeric)
 {
 	DEBUG_ASSERTCRASH(obj, ("sorry, no nulls allowed here"));
 
-	Clump *clump = newInstance(Clump)();
+	Clump *clump;
+	if (m_clumpsInFrameMemory)
+		clump = (Clump *)TheGameLogic->allocateFrameMemory(sizeof(Clump));
+	else
+		clump = (Clump *)TheDynamicMemoryAllocator->allocateBytesDoNotZero(sizeof(Clump), "SimpleObjectIterator::Clump");
 
 	clump->m_nextClump = m_firstClump;
 	m_firstClump = clump;
@@ -115,7 +110,8 @@ void SimpleObjectIterator::makeEmpty()
 	while (m_firstClump)
 	{
 		Clump *next = m_firstClump->m_nextClump;
-		m_firstClump->deleteInstance();
+		if (!m_clumpsInFrameMemory)
+			TheDynamicMemoryAllocator->freeBytes(m_firstClump);
 		m_firstClump = next;
 		--m_clumpCount;
 	}
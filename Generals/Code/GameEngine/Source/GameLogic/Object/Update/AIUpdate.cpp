@@ -473,6 +473,25 @@ void AIUpdateInterface::doPathfind( PathfindServicesInterface *pathfinder )
 #endif
 }
 
+/* Called by the pathfinder before it gets to us in the pathfind queue, so it can search ahead
+on a worker thread.  Returns true if doPathfind is going to ask for a plain findPath to the returned
+destination.  It's only a guess - the pathfinder checks the actual request before using the result. */
+//-------------------------------------------------------------------------------------------------
+Bool AIUpdateInterface::getPredictedPathRequest( Coord3D *destination )
+{
+	if (!m_waitingForPath) {
+		return false;
+	}
+	if (m_isSafePath || m_isApproachPath || m_isAttackPath || m_isBlockedAndStuck) {
+		return false;
+	}
+	if (canComputeQuickPath()) {
+		return false;
+	}
+	*destination = m_requestedDestination;
+	return true;
+}
+
 /* Requests a path to be found.  Note that if it is possible to do it without having to use the 
 pathfinder (air units just move point to point) it generates the path immediately.  Otherwise the path
 will be processed when we get to the front of the pathfind queue. jba */
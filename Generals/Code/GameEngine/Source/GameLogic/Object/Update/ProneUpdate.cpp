@@ -72,6 +72,13 @@ ProneUpdate::~ProneUpdate( void )
 
 }
 
+//-------------------------------------------------------------------------------------------------
+Bool ProneUpdate::isSelfContainedUpdate() const
+{
+	// only the frame we stop being prone does anything besides count down.
+	return m_proneFrames != 1;
+}
+
 //-------------------------------------------------------------------------------------------------
 /** The update callback. */
 //-------------------------------------------------------------------------------------------------
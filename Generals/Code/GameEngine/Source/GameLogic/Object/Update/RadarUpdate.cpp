@@ -88,6 +88,14 @@ void RadarUpdate::extendRadar( void )
 
 }  // end extendRadar
 
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+Bool RadarUpdate::isSelfContainedUpdate() const
+{
+	// until the extension is finished, update() just watches the clock.
+	return m_extendDoneFrame == 0 || m_extendComplete || TheGameLogic->getFrame() <= m_extendDoneFrame;
+}
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 UpdateSleepTime RadarUpdate::update( void )
@@ -88,6 +88,8 @@
 // damage is ALWAYS 3d
 const DistanceCalculationType DAMAGE_RANGE_CALC_TYPE = FROM_BOUNDINGSPHERE_3D;
 
+UnsignedInt Weapon::s_lastCRCStamp = 0;
+
 //-------------------------------------------------------------------------------------------------
 static void parsePerVetLevelAsciiString( INI* ini, void* /*instance*/, void * store, const void* /*userData*/ )
 {
@@ -1544,6 +1546,7 @@ Weapon::Weapon(const WeaponTemplate* tmpl, WeaponSlotType wslot)
 	m_numShotsForCurBarrel = 	m_template->getShotsPerBarrel();
 	m_lastFireFrame = 0;
 	m_suspendFXFrame = TheGameLogic->getFrame() + m_template->getSuspendFXDelay();
+	touchCRCStamp();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1565,6 +1568,7 @@ Weapon::Weapon(const Weapon& that)
 	this->m_numShotsForCurBarrel = m_template->getShotsPerBarrel();
 	this->m_lastFireFrame = 0;
 	this->m_suspendFXFrame = that.getSuspendFXFrame();
+	touchCRCStamp();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1588,6 +1592,7 @@ Weapon& Weapon::operator=(const Weapon& that)
 		this->m_suspendFXFrame = that.getSuspendFXFrame();
 		this->m_numShotsForCurBarrel = m_template->getShotsPerBarrel();
 		this->m_projectileStreamID = INVALID_ID;
+		touchCRCStamp();
 	}
 	return *this;
 }
@@ -1645,6 +1650,7 @@ void Weapon::setClipPercentFull(Real percent, Bool allowReduction)
 	Int ammo = REAL_TO_INT_FLOOR(m_template->getClipSize() * percent);
 	if (ammo > m_ammoInClip || (allowReduction && ammo < m_ammoInClip))
 	{
+		touchCRCStamp();
 		m_ammoInClip = ammo;
 		m_status = m_ammoInClip ? OUT_OF_AMMO : READY_TO_FIRE;
 		//CRCDEBUG_LOG(("Weapon::setClipPercentFull() just set m_status to %d (ammo in clip is %d)\n", m_status, m_ammoInClip));
@@ -1676,6 +1682,7 @@ void Weapon::reloadWithBonus(const Object *sourceObj, const WeaponBonus& bonus,
 			&& !sourceObj->isReloadTimeShared())
 		return;	// don't restart our reload delay.
 
+	touchCRCStamp();
 	m_ammoInClip = m_template->getClipSize();
 	if (m_ammoInClip <= 0)
 		m_ammoInClip = 0x7fffffff;	// 0 == unlimited (or effectively so)
@@ -2147,6 +2154,7 @@ void Weapon::newProjectileFired(const Object *sourceObj, const Object *projectil
 	Object* projectileStream = TheGameLogic->findObjectByID(m_projectileStreamID);
 	if( projectileStream == NULL )
 	{
+		touchCRCStamp();
 		m_projectileStreamID = INVALID_ID;	// reset, since it might have been "valid" but deleted out from under us
 		const ThingTemplate* pst = TheThingFactory->findTemplate(m_template->getProjectileStreamName());
 		projectileStream = TheThingFactory->newObject( pst, sourceObj->getControllingPlayer()->getDefaultTeam() );
@@ -2210,6 +2218,7 @@ Bool Weapon::privateFireWeapon(
 {
 	//CRCDEBUG_LOG(("Weapon::privateFireWeapon() for %s\n", DescribeObject(sourceObj).str()));
 	//USE_PERF_TIMER(fireWeapon)
+	touchCRCStamp();
 	if (projectileID)
 		*projectileID = INVALID_ID;
 
@@ -3060,6 +3069,9 @@ void Weapon::crc( Xfer *xfer )
 // ------------------------------------------------------------------------------------------------
 void Weapon::xfer( Xfer *xfer )
 {
+	if( xfer->getXferMode() == XFER_LOAD )
+		touchCRCStamp();
+
 	// version
 	const XferVersion currentVersion = 3;
 	XferVersion version = currentVersion;
@@ -3172,6 +3184,7 @@ void Weapon::loadPostProcess( void )
 		if( projectileStream == NULL )
 		{
 			m_projectileStreamID = INVALID_ID;
+			touchCRCStamp();
 		}
 	}
 }
@@ -35,6 +35,7 @@
 #include "Common/GameState.h"
 #include "Common/LatchRestore.h"
 #include "Common/MessageStream.h"
+#include "Common/NameKeyGenerator.h"
 #include "Common/PerfTimer.h"
 #include "Common/Player.h"
 #include "Common/PlayerList.h"
@@ -372,6 +373,7 @@ m_skirmishHumanPlayer(NULL),
 m_fade(FADE_NONE),
 m_freezeByScript(FALSE),
 m_frameObjectCountChanged(0),
+m_conditionIndexEpoch(1),
 //Added By Sadullah Nader
 //Initializations inserted
 m_closeWindowTimer(0),
@@ -394,6 +396,11 @@ m_ChooseVictimAlwaysUsesNormal(false)
 	st_LastCurrentFrame = st_CurrentFrame = 0;
 	// By default, difficulty should be normal.
 	setGlobalDifficulty(DIFFICULTY_NORMAL);
+	m_scriptNameIndexSerial = 0;
+	m_scriptNameIndexBuilt = FALSE;
+#ifdef TEST_NAMED_OBJECT_INDEX
+	m_ranNamedObjectIndexTest = FALSE;
+#endif
 
 }  // end ScriptEngine
 
@@ -4662,6 +4669,13 @@ void ScriptEngine::reset( void )
 	
 	// Clear the named objects list.
  	m_namedObjects.clear();
+	m_namedObjectIndex.clear();
+
+	resetConditionIndex();
+
+	m_scriptNameIndex.clear();
+	m_groupNameIndex.clear();
+	m_scriptNameIndexBuilt = FALSE;
 
 	m_completedVideo.clear();
 	m_testingSpeech.clear();
@@ -4696,6 +4710,8 @@ void ScriptEngine::reset( void )
 //-------------------------------------------------------------------------------------------------
 void ScriptEngine::newMap( void )
 {
+	resetConditionIndex();
+
 	m_numCounters = 1;
 	Int i;
 	for (i=0; i<MAX_COUNTERS; i++) {
@@ -4792,6 +4808,12 @@ void ScriptEngine::update( void )
 	} else {
 		particleEditorUpdate();
 	}
+#ifdef TEST_NAMED_OBJECT_INDEX
+	if (!m_ranNamedObjectIndexTest && !m_namedObjects.empty()) {
+		m_ranNamedObjectIndexTest = TRUE;
+		doNamedObjectIndexTest();
+	}
+#endif
 	
 	if (m_closeWindowTimer>0) {
 		m_closeWindowTimer--;
@@ -4835,6 +4857,11 @@ void ScriptEngine::update( void )
 			// If counter has any time left, decrement.  Counters go to -1 and stop.
 			if (m_counters[i].value >= 0) {
 				m_counters[i].value--;
+				invalidateIndexedConditions(m_counterWatchers[i]);
+				if (m_counters[i].value == 0) {
+					// This is the frame the timer runs out, so wake up anything waiting on it.
+					invalidateIndexedConditions(m_timerWatchers[i]);
+				}
 			}
 		}
 	}
@@ -4863,6 +4890,9 @@ void ScriptEngine::update( void )
 	ThePlayerList->updateTeamStates();
 
 	// Clear the UI Interaction flags.
+	for (ListAsciiStringIt it = m_uiInteractions.begin(); it != m_uiInteractions.end(); ++it) {
+		flagNameChanged(*it);
+	}
 	m_uiInteractions.clear();
 
 	// update all sequential stuff.
@@ -5040,6 +5070,7 @@ void ScriptEngine::clearFlag(const AsciiString &name)
 		for (i=1; i<m_numFlags; i++) {
 			if ((modName==m_flags[i].name)) {
 				m_flags[i].value = FALSE;
+				flagChanged(i);
 			}
 		}
 	}
@@ -5283,12 +5314,30 @@ Object * ScriptEngine::getUnitNamed(const AsciiString& unitName)
 		return m_conditionObject;
 	}
 
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (unitName == (it->first)) {
-			return it->second;
+	Int ndx = findNamedObject(NAMEKEY(unitName));
+	if (ndx < 0) {
+		return NULL;
+	}
+	return m_namedObjects[ndx].second;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** getUnitNamed - same as above, but hashes on the key the parameter interned when it was read. */
+//-------------------------------------------------------------------------------------------------
+Object * ScriptEngine::getUnitNamed(const Parameter *pUnitParm)
+{
+	if (pUnitParm->getString() == THIS_OBJECT) {
+		if (m_callingObject) {
+			return m_callingObject;
 		}
+		return m_conditionObject;
 	}
-	return NULL;
+
+	Int ndx = findNamedObject(pUnitParm->getStringKey());
+	if (ndx < 0) {
+		return NULL;
+	}
+	return m_namedObjects[ndx].second;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5296,13 +5345,223 @@ Object * ScriptEngine::getUnitNamed(const AsciiString& unitName)
 //-------------------------------------------------------------------------------------------------
 Bool ScriptEngine::didUnitExist(const AsciiString& unitName)
 {
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (unitName == (it->first)) {
-			return (it->second == NULL);
+	Int ndx = findNamedObject(NAMEKEY(unitName));
+	if (ndx < 0) {
+		return false;
+	}
+	return (m_namedObjects[ndx].second == NULL);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** didUnitExist */
+//-------------------------------------------------------------------------------------------------
+Bool ScriptEngine::didUnitExist(const Parameter *pUnitParm)
+{
+	Int ndx = findNamedObject(pUnitParm->getStringKey());
+	if (ndx < 0) {
+		return false;
+	}
+	return (m_namedObjects[ndx].second == NULL);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Index of the first m_namedObjects entry with this name, or -1 if there isn't one. */
+//-------------------------------------------------------------------------------------------------
+Int ScriptEngine::findNamedObject(NameKeyType key) const
+{
+	NamedObjectIndexMap::const_iterator it = m_namedObjectIndex.find(key);
+	if (it == m_namedObjectIndex.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Adds an entry to the end of m_namedObjects, and to the index if the name is new. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::pushNamedObject(const AsciiString& name, Object *pObj)
+{
+	NamedRequest req;
+	req.first = name;
+	req.second = pObj;
+	m_namedObjects.push_back(req);
+	namedObjectChanged(name);
+
+	// insert leaves an earlier entry with the same name in place, so lookups still find the first one.
+	m_namedObjectIndex.insert(NamedObjectIndexMap::value_type(NAMEKEY(name), (Int)m_namedObjects.size() - 1));
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Renames an entry in m_namedObjects, and keeps the index pointing at the first entry for both names. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::renameNamedObject(Int ndx, const AsciiString& name)
+{
+	AsciiString oldName = m_namedObjects[ndx].first;
+	m_namedObjects[ndx].first = name;
+	namedObjectChanged(oldName);
+	namedObjectChanged(name);
+
+	NamedObjectIndexMap::iterator it = m_namedObjectIndex.find(NAMEKEY(oldName));
+	if (it != m_namedObjectIndex.end() && it->second == ndx) {
+		// Pass the old name on to the next entry that has it, if there is one.
+		m_namedObjectIndex.erase(it);
+		for (Int i = ndx + 1; i < (Int)m_namedObjects.size(); ++i) {
+			if (m_namedObjects[i].first == oldName) {
+				m_namedObjectIndex[NAMEKEY(oldName)] = i;
+				break;
+			}
 		}
 	}
-	return false;
+
+	it = m_namedObjectIndex.find(NAMEKEY(name));
+	if (it == m_namedObjectIndex.end()) {
+		m_namedObjectIndex[NAMEKEY(name)] = ndx;
+	} else if (it->second > ndx) {
+		it->second = ndx;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Rebuilds the name index from scratch after m_namedObjects has been replaced wholesale. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::rebuildNamedObjectIndex( void )
+{
+	invalidateAllIndexedConditions();
+	m_namedObjectIndex.clear();
+	for (Int i = 0; i < (Int)m_namedObjects.size(); ++i) {
+		m_namedObjectIndex.insert(NamedObjectIndexMap::value_type(NAMEKEY(m_namedObjects[i].first), i));
+	}
+}
+
+#ifdef TEST_NAMED_OBJECT_INDEX
+//-------------------------------------------------------------------------------------------------
+static void runNamedObjectIndexTest(const char *what, const VecNamedRequests& objs, const NamedObjectIndexMap& index,
+																		const std::vector<AsciiString>& names, Int numPasses)
+{
+	Int mismatches = 0;
+
+	UnsignedInt startTime = ::GetTickCount();
+	UnsignedInt linearSum = 0;
+	for (Int pass = 0; pass < numPasses; ++pass) {
+		for (size_t n = 0; n < names.size(); ++n) {
+			for (size_t i = 0; i < objs.size(); ++i) {
+				if (names[n] == objs[i].first) {
+					linearSum += (UnsignedInt)i;
+					break;
+				}
+			}
+		}
+	}
+	UnsignedInt linearTime = ::GetTickCount() - startTime;
+
+	startTime = ::GetTickCount();
+	UnsignedInt indexSum = 0;
+	for (Int pass = 0; pass < numPasses; ++pass) {
+		for (size_t n = 0; n < names.size(); ++n) {
+			NamedObjectIndexMap::const_iterator it = index.find(NAMEKEY(names[n]));
+			if (it != index.end()) {
+				indexSum += (UnsignedInt)it->second;
+			}
+		}
+	}
+	UnsignedInt indexTime = ::GetTickCount() - startTime;
+
+	if (linearSum != indexSum) {
+		++mismatches;
+	}
+	DEBUG_LOG(("NamedObjectIndex test (%s): %d names, %d lookups. linear scan %d ms, name key index %d ms%s\n",
+		what, (Int)objs.size(), (Int)names.size() * numPasses, linearTime, indexTime, mismatches ? " -- RESULTS DIFFER!" : ""));
+	DEBUG_ASSERTCRASH(mismatches == 0, ("NamedObjectIndex test: index and linear scan disagree"));
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The old findScript: first script with the name, side by side, top level scripts first. */
+static Script *scanForScript(const AsciiString& name)
+{
+	for (Int i=0; i<TheSidesList->getNumSides(); i++) {
+		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
+		if (pSL==NULL) continue;
+		Script *pScr;
+		for (pScr = pSL->getScript(); pScr; pScr=pScr->getNext()) {
+			if (name==pScr->getName()) return pScr;
+		}
+		for (ScriptGroup *pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
+			for (pScr = pGroup->getScript(); pScr; pScr=pScr->getNext()) {
+				if (name==pScr->getName()) return pScr;
+			}
+		}
+	}
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The old findGroup: first group with the name, side by side. */
+static ScriptGroup *scanForGroup(const AsciiString& name)
+{
+	for (Int i=0; i<TheSidesList->getNumSides(); i++) {
+		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
+		if (pSL==NULL) continue;
+		for (ScriptGroup *pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
+			if (pGroup->getName() == name) return pGroup;
+		}
+	}
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::doNamedObjectIndexTest( void )
+{
+	// every named unit on this map, plus one that isn't there.
+	{
+		std::vector<AsciiString> names;
+		for (size_t i = 0; i < m_namedObjects.size(); ++i) {
+			names.push_back(m_namedObjects[i].first);
+		}
+		names.push_back("NamedObjectIndexTest_NotThere");
+		runNamedObjectIndexTest("this map", m_namedObjects, m_namedObjectIndex, names, 100);
+	}
+
+	// a big mission: thousands of named units, looked up in a scattered order.
+	{
+		const Int NUM_NAMED = 5000;
+		VecNamedRequests objs;
+		NamedObjectIndexMap index;
+		std::vector<AsciiString> names;
+		for (Int i = 0; i < NUM_NAMED; ++i) {
+			NamedRequest req;
+			req.first.format("Mission_Unit_%04d", i);
+			req.second = NULL;
+			objs.push_back(req);
+			index.insert(NamedObjectIndexMap::value_type(NAMEKEY(req.first), i));
+		}
+		UnsignedInt rnd = 54321;
+		for (Int i = 0; i < 2000; ++i) {
+			rnd = rnd * 1103515245 + 12345;
+			names.push_back(objs[(rnd >> 8) % NUM_NAMED].first);
+		}
+		runNamedObjectIndexTest("simulated", objs, index, names, 10);
+	}
+
+	// every script and group name on this map must find the same one a scan of the lists does.
+	Int mismatches = 0;
+	for (Int i=0; i<TheSidesList->getNumSides(); i++) {
+		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
+		if (pSL==NULL) continue;
+		Script *pScr;
+		for (pScr = pSL->getScript(); pScr; pScr=pScr->getNext()) {
+			if (findScript(pScr->getName()) != scanForScript(pScr->getName())) ++mismatches;
+		}
+		for (ScriptGroup *pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
+			if (findGroup(pGroup->getName()) != scanForGroup(pGroup->getName())) ++mismatches;
+			for (pScr = pGroup->getScript(); pScr; pScr=pScr->getNext()) {
+				if (findScript(pScr->getName()) != scanForScript(pScr->getName())) ++mismatches;
+			}
+		}
+	}
+	DEBUG_LOG(("NamedObjectIndex test: script and group lookups %s\n", mismatches ? "-- RESULTS DIFFER!" : "match"));
+	DEBUG_ASSERTCRASH(mismatches == 0, ("NamedObjectIndex test: %d script or group lookups disagree with the script lists", mismatches));
 }
+#endif
 
 //-------------------------------------------------------------------------------------------------
 /** runScript - Executes a subroutine script, or script group - tests conditions, and executes actions or false actions.  */
@@ -5566,22 +5825,55 @@ Int ScriptEngine::allocateFlag( const AsciiString& name)
 }
 
 //-------------------------------------------------------------------------------------------------
-/** Locates a group by name. */
+/** Rebuilds the script and group name indexes from the script lists.  The first script or group
+	with a name wins, in the same order the lists used to be searched in: side by side, top level
+	scripts before the scripts in groups. */
 //-------------------------------------------------------------------------------------------------
-ScriptGroup  *ScriptEngine::findGroup(const AsciiString& name)
+void ScriptEngine::rebuildScriptNameIndex( void )
 {
+	m_scriptNameIndex.clear();
+	m_groupNameIndex.clear();
+	m_scriptNameIndexSerial = ScriptList::getChangeSerial();
+	m_scriptNameIndexBuilt = TRUE;
+	if (TheSidesList == NULL) return;
+
 	Int i;
 	for (i=0; i<TheSidesList->getNumSides(); i++) {
 		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
 		if (pSL==NULL) continue;
+		Script *pScr;
+		for (pScr = pSL->getScript(); pScr; pScr=pScr->getNext()) {
+			m_scriptNameIndex.insert(ScriptNameIndexMap::value_type(NAMEKEY(pScr->getName()), pScr));
+		}
 		ScriptGroup *pGroup;
 		for (pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
-			if (pGroup->getName() == name) {
-				return pGroup;
+			m_groupNameIndex.insert(ScriptGroupNameIndexMap::value_type(NAMEKEY(pGroup->getName()), pGroup));
+			for (pScr = pGroup->getScript(); pScr; pScr=pScr->getNext()) {
+				m_scriptNameIndex.insert(ScriptNameIndexMap::value_type(NAMEKEY(pScr->getName()), pScr));
 			}
 		}
 	}
-	return 0; // Shouldn't ever happen.
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Locates a group by name. */
+//-------------------------------------------------------------------------------------------------
+ScriptGroup  *ScriptEngine::findGroup(const AsciiString& name)
+{
+	return findGroup(NAMEKEY(name));
+}
+
+//-------------------------------------------------------------------------------------------------
+ScriptGroup  *ScriptEngine::findGroup(NameKeyType key)
+{
+	if (!m_scriptNameIndexBuilt || m_scriptNameIndexSerial != ScriptList::getChangeSerial()) {
+		rebuildScriptNameIndex();
+	}
+	ScriptGroupNameIndexMap::const_iterator it = m_groupNameIndex.find(key);
+	if (it == m_groupNameIndex.end()) {
+		return 0; // Shouldn't ever happen.
+	}
+	return it->second;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5589,26 +5881,20 @@ ScriptGroup  *ScriptEngine::findGroup(const AsciiString& name)
 //-------------------------------------------------------------------------------------------------
 Script  *ScriptEngine::findScript(const AsciiString& name)
 {
-	Int i;
-	for (i=0; i<TheSidesList->getNumSides(); i++) {
-		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
-		if (pSL==NULL) continue;
-		Script *pScr;
-		for (pScr = pSL->getScript(); pScr; pScr=pScr->getNext()) {
-			if ((name==pScr->getName())) {
-				return pScr;
-			}
-		}
-		ScriptGroup *pGroup;
-		for (pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
-			for (pScr = pGroup->getScript(); pScr; pScr=pScr->getNext()) {
-				if ((name==pScr->getName())) {
-					return pScr;
-				}
-			}
-		}
+	return findScript(NAMEKEY(name));
+}
+
+//-------------------------------------------------------------------------------------------------
+Script  *ScriptEngine::findScript(NameKeyType key)
+{
+	if (!m_scriptNameIndexBuilt || m_scriptNameIndexSerial != ScriptList::getChangeSerial()) {
+		rebuildScriptNameIndex();
 	}
-	return 0; // Shouldn't ever happen.
+	ScriptNameIndexMap::const_iterator it = m_scriptNameIndex.find(key);
+	if (it == m_scriptNameIndex.end()) {
+		return 0; // Shouldn't ever happen.
+	}
+	return it->second;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5648,6 +5934,7 @@ void ScriptEngine::setCounter( ScriptAction *pAction )
 	}
 	Int value = pAction->getParameter(1)->getInt();
 	m_counters[counterNdx].value = value;
+	counterChanged(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5716,6 +6003,7 @@ void ScriptEngine::addCounter( ScriptAction *pAction )
 		pAction->getParameter(1)->friend_setInt(counterNdx);
 	}
 	m_counters[counterNdx].value += value;
+	counterChanged(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5731,6 +6019,7 @@ void ScriptEngine::subCounter( ScriptAction *pAction )
 		pAction->getParameter(1)->friend_setInt(counterNdx);
 	}
 	m_counters[counterNdx].value -= value;
+	counterChanged(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5775,6 +6064,7 @@ void ScriptEngine::setFlag( ScriptAction *pAction )
 	}
 	Bool value = pAction->getParameter(1)->getInt();
 	m_flags[flagNdx].value = value;
+	flagChanged(flagNdx);
 }
 
 
@@ -6037,6 +6327,7 @@ void ScriptEngine::setTimer( ScriptAction *pAction, Bool millisecondTimer, Bool
 		m_counters[counterNdx].value = value;
 	}
 	m_counters[counterNdx].isCountdownTimer = true;
+	counterChanged(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6051,6 +6342,7 @@ void ScriptEngine::pauseTimer( ScriptAction *pAction )
 		pAction->getParameter(0)->friend_setInt(counterNdx);
 	}
 	m_counters[counterNdx].isCountdownTimer = false;
+	counterChanged(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6066,6 +6358,7 @@ void ScriptEngine::restartTimer( ScriptAction *pAction )
 	}
 	if (m_counters[counterNdx].value > 0) {
 		m_counters[counterNdx].isCountdownTimer = true;
+		counterChanged(counterNdx);
 	}
 }
 
@@ -6091,6 +6384,7 @@ void ScriptEngine::adjustTimer( ScriptAction *pAction, Bool millisecondTimer, Bo
 			value = -value;
 		m_counters[counterNdx].value += value;
 	}
+	counterChanged(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6099,11 +6393,11 @@ void ScriptEngine::adjustTimer( ScriptAction *pAction, Bool millisecondTimer, Bo
 void ScriptEngine::enableScript( ScriptAction *pAction )
 {
 	DEBUG_ASSERTCRASH(pAction->getNumParameters() >= 1, ("Not enough parameters.\n"));
-	ScriptGroup *pGroup = findGroup(pAction->getParameter(0)->getString());
+	ScriptGroup *pGroup = findGroup(pAction->getParameter(0)->getStringKey());
 	if (pGroup) {
 		pGroup->setActive(true);
 	}
-	Script *pScript = findScript(pAction->getParameter(0)->getString());
+	Script *pScript = findScript(pAction->getParameter(0)->getStringKey());
 	if (pScript) {
 		pScript->setActive(true);
 	}
@@ -6115,11 +6409,11 @@ void ScriptEngine::enableScript( ScriptAction *pAction )
 void ScriptEngine::disableScript( ScriptAction *pAction )
 {
 	DEBUG_ASSERTCRASH(pAction->getNumParameters() >= 1, ("Not enough parameters.\n"));
-	Script *pScript = findScript(pAction->getParameter(0)->getString());
+	Script *pScript = findScript(pAction->getParameter(0)->getStringKey());
 	if (pScript) {
 		pScript->setActive(false);
 	}
-	ScriptGroup *pGroup = findGroup(pAction->getParameter(0)->getString());
+	ScriptGroup *pGroup = findGroup(pAction->getParameter(0)->getStringKey());
 	if (pGroup) {
 		pGroup->setActive(false);
 	}
@@ -6298,7 +6592,7 @@ void ScriptEngine::executeScript( Script *pScript )
 	} else {
 		m_conditionTeam = NULL;
 		// If conditions evaluate to true, execute actions.
-		if (evaluateConditions(pScript)) {
+		if (evaluateIndexedConditions(pScript)) {
 			if (pScript->getAction()) {
 				// Script Debug window
 				_appendMessage(pScript->getName());
@@ -6331,6 +6625,195 @@ void ScriptEngine::executeScript( Script *pScript )
 	m_conditionTeam = pSavConditionTeam;
 }
 
+//-------------------------------------------------------------------------------------------------
+/** Evaluates a script's conditions, reusing the last result if the script is in the condition 
+		index and none of its inputs have changed since.  Only for scripts without a condition team. */
+//-------------------------------------------------------------------------------------------------
+Bool ScriptEngine::evaluateIndexedConditions( Script *pScript )
+{
+	Int slot = pScript->getConditionIndexSlot();
+	if (pScript->getConditionIndexEpoch() != m_conditionIndexEpoch) {
+		slot = indexScriptConditions(pScript);
+	}
+	if (slot < 0) {
+		return evaluateConditions(pScript);
+	}
+
+	IndexedConditions &cached = m_indexedConditions[slot];
+	if (!cached.m_valid) {
+		cached.m_result = evaluateConditions(pScript);
+		cached.m_valid = true;
+	}
+#ifdef TEST_CONDITION_INDEX
+	else {
+		Bool result = evaluateConditions(pScript);
+		DEBUG_ASSERTCRASH(result == cached.m_result, ("Condition index is stale for script '%s'", pScript->getName().str()));
+	}
+#endif
+	return cached.m_result;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Adds a script to the condition index, if everything its conditions look at is something we
+		hear about when it changes.  Returns the script's slot, or -1 if it has to be evaluated every 
+		time. */
+//-------------------------------------------------------------------------------------------------
+Int ScriptEngine::indexScriptConditions( Script *pScript )
+{
+	if (!pScript->getConditionTeamName().isEmpty()) {
+		pScript->setConditionIndexSlot(-1, m_conditionIndexEpoch);
+		return -1;
+	}
+
+	// First make sure we can index every condition, before we register any watchers.
+	OrCondition *pOr;
+	Condition *pCondition;
+	for (pOr = pScript->getOrCondition(); pOr; pOr = pOr->getNextOrCondition()) {
+		for (pCondition = pOr->getFirstAndCondition(); pCondition; pCondition = pCondition->getNext()) {
+			Parameter *pParm = pCondition->getNumParameters() > 0 ? pCondition->getParameter(0) : NULL;
+			switch (pCondition->getConditionType()) {
+				case Condition::CONDITION_FALSE:
+				case Condition::CONDITION_TRUE:
+					break;
+				case Condition::COUNTER:
+				case Condition::TIMER_EXPIRED:
+				case Condition::FLAG:
+					if (pParm->getInt() == 0) {
+						// The counter or flag hasn't been allocated yet.  Leave that to evaluateConditions, 
+						// so they get their numbers in the same order as always, and try again next time.
+						return -1;
+					}
+					if (pCondition->getConditionType() == Condition::FLAG && m_flags[pParm->getInt()].name != pParm->getString()) {
+						pScript->setConditionIndexSlot(-1, m_conditionIndexEpoch);
+						return -1;
+					}
+					break;
+				case Condition::NAMED_DESTROYED:
+				case Condition::NAMED_DYING:
+				case Condition::NAMED_TOTALLY_DEAD:
+				case Condition::NAMED_NOT_DESTROYED:
+					if (pParm->getString() == THIS_OBJECT) {
+						pScript->setConditionIndexSlot(-1, m_conditionIndexEpoch);
+						return -1;
+					}
+					break;
+				default:
+					pScript->setConditionIndexSlot(-1, m_conditionIndexEpoch);
+					return -1;
+			}
+		}
+	}
+
+	Int slot = (Int)m_indexedConditions.size();
+	IndexedConditions cached;
+	cached.m_valid = false;
+	cached.m_result = false;
+	m_indexedConditions.push_back(cached);
+
+	for (pOr = pScript->getOrCondition(); pOr; pOr = pOr->getNextOrCondition()) {
+		for (pCondition = pOr->getFirstAndCondition(); pCondition; pCondition = pCondition->getNext()) {
+			switch (pCondition->getConditionType()) {
+				default:
+					break;
+				case Condition::COUNTER:
+					m_counterWatchers[pCondition->getParameter(0)->getInt()].push_back(slot);
+					break;
+				case Condition::TIMER_EXPIRED:
+					m_timerWatchers[pCondition->getParameter(0)->getInt()].push_back(slot);
+					break;
+				case Condition::FLAG:
+					m_flagWatchers[pCondition->getParameter(0)->getInt()].push_back(slot);
+					break;
+				case Condition::NAMED_DESTROYED:
+				case Condition::NAMED_DYING:
+				case Condition::NAMED_TOTALLY_DEAD:
+				case Condition::NAMED_NOT_DESTROYED:
+					m_namedUnitWatchers[pCondition->getParameter(0)->getStringKey()].push_back(slot);
+					break;
+			}
+		}
+	}
+
+	pScript->setConditionIndexSlot(slot, m_conditionIndexEpoch);
+	return slot;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Empties the condition index.  Scripts put themselves back in it the next time they run. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::resetConditionIndex( void )
+{
+	m_indexedConditions.clear();
+	Int i;
+	for (i=0; i<MAX_COUNTERS; i++) {
+		m_counterWatchers[i].clear();
+		m_timerWatchers[i].clear();
+	}
+	for (i=0; i<MAX_FLAGS; i++) {
+		m_flagWatchers[i].clear();
+	}
+	m_namedUnitWatchers.clear();
+	++m_conditionIndexEpoch;
+}
+
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::invalidateAllIndexedConditions( void )
+{
+	for (size_t i = 0; i < m_indexedConditions.size(); ++i) {
+		m_indexedConditions[i].m_valid = false;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::invalidateIndexedConditions( std::vector<Int>& watchers )
+{
+	for (size_t i = 0; i < watchers.size(); ++i) {
+		m_indexedConditions[watchers[i]].m_valid = false;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A counter's value or timer state was changed by something other than the countdown. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::counterChanged( Int counterNdx )
+{
+	invalidateIndexedConditions(m_counterWatchers[counterNdx]);
+	invalidateIndexedConditions(m_timerWatchers[counterNdx]);
+}
+
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::flagChanged( Int flagNdx )
+{
+	invalidateIndexedConditions(m_flagWatchers[flagNdx]);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A UI interaction with this name came or went, which flag conditions also look at. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::flagNameChanged( const AsciiString& flagName )
+{
+	// Note - flags start at 1.  0 means not assigned.
+	for (Int i=1; i<m_numFlags; i++) {
+		if (flagName == m_flags[i].name) {
+			flagChanged(i);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The named object entry for this name was added, changed or emptied. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::namedObjectChanged( const AsciiString& unitName )
+{
+	if (m_namedUnitWatchers.empty()) {
+		return;
+	}
+	NamedUnitWatcherMap::iterator it = m_namedUnitWatchers.find(NAMEKEY(unitName));
+	if (it != m_namedUnitWatchers.end()) {
+		invalidateIndexedConditions(it->second);
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 /** Evaluates a condition */
 //-------------------------------------------------------------------------------------------------
@@ -6379,35 +6862,36 @@ void ScriptEngine::addObjectToCache(Object* pNewObject)
 		return;
 	}
 
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (it->first == objName) {
-			if (it->second == NULL) {
-				AsciiString newNameForDead;
-				newNameForDead.format("Reassigning dead object's name '%s' to object (%d) of type '%s'\n", objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str());
-				TheScriptEngine->AppendDebugMessage(newNameForDead, FALSE);
-				DEBUG_LOG((newNameForDead.str()));
-				it->second = pNewObject;
-				return;
-			} else {
-				DEBUG_CRASH(("Attempting to assign the name '%s' to object (%d) of type '%s'," 
-										 " but object (%d) of type '%s' already has that name\n",
-										 objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str(), 
-										 it->second->getID(), it->second->getTemplate()->getName().str()));
-				return;
-			}
-		}
-
-		if (pNewObject == (it->second)) {
-			it->first = objName;
+	// If the object is already in the list under another name ahead of any entry with this
+	// name, it just gets renamed.
+	Int nameNdx = findNamedObject(NAMEKEY(objName));
+	Int numToScan = (nameNdx < 0) ? (Int)m_namedObjects.size() : nameNdx;
+	for (Int i = 0; i < numToScan; ++i) {
+		if (pNewObject == m_namedObjects[i].second) {
+			renameNamedObject(i, objName);
 			return;
 		}
 	}
 
-	NamedRequest req;
-	req.first = objName;
-	req.second = pNewObject;
+	if (nameNdx >= 0) {
+		NamedRequest &req = m_namedObjects[nameNdx];
+		if (req.second == NULL) {
+			AsciiString newNameForDead;
+			newNameForDead.format("Reassigning dead object's name '%s' to object (%d) of type '%s'\n", objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str());
+			TheScriptEngine->AppendDebugMessage(newNameForDead, FALSE);
+			DEBUG_LOG((newNameForDead.str()));
+			req.second = pNewObject;
+			namedObjectChanged(objName);
+		} else {
+			DEBUG_CRASH(("Attempting to assign the name '%s' to object (%d) of type '%s'," 
+									 " but object (%d) of type '%s' already has that name\n",
+									 objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str(), 
+									 req.second->getID(), req.second->getTemplate()->getName().str()));
+		}
+		return;
+	}
 
-	m_namedObjects.push_back(req);
+	pushNamedObject(objName, pNewObject);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6418,6 +6902,7 @@ void ScriptEngine::removeObjectFromCache( Object* pDeadObject )
 	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
 		if (pDeadObject == (it->second)) {
 			it->second = NULL;	// Don't remove it, cause we want to check whether we ever knew a name later
+			namedObjectChanged(it->first);
 			break;
 		}
 	}
@@ -6448,26 +6933,23 @@ void ScriptEngine::transferObjectName( const AsciiString& unitName, Object *pNew
 
 	pNewObject->setName(unitName); // make sure it's named the name.
 
-	//Loop through the cached list and find the string entry. If found, change the object
+	//Find the string entry in the cached list. If found, change the object
 	//so it's pointing to the new one.
-	for( VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it )
+	Int ndx = findNamedObject( NAMEKEY( unitName ) );
+	if( ndx >= 0 )
 	{
-		if( !unitName.compare( it->first ) )
+		Object* pOldObj = m_namedObjects[ ndx ].second;
+		if( pOldObj )
 		{
-			Object* pOldObj = it->second;
-			if( pOldObj )
-			{
-				// if you are transferring your name, you should also transfer any custom indicator color you have.
-				if (pOldObj->hasCustomIndicatorColor())
-					pNewObject->setCustomIndicatorColor(pOldObj->getIndicatorColor());
-				else
-					pNewObject->removeCustomIndicatorColor();
-			}
-
-			it->second = pNewObject;
-
-			return;
+			// if you are transferring your name, you should also transfer any custom indicator color you have.
+			if (pOldObj->hasCustomIndicatorColor())
+				pNewObject->setCustomIndicatorColor(pOldObj->getIndicatorColor());
+			else
+				pNewObject->removeCustomIndicatorColor();
 		}
+
+		m_namedObjects[ ndx ].second = pNewObject;
+		namedObjectChanged( unitName );
 	}
 
 }
@@ -6490,6 +6972,22 @@ void ScriptEngine::notifyOfObjectDestruction( Object *pDeadObject )
 	}
 }
 
+//-------------------------------------------------------------------------------------------------
+/** A named object has just become effectively dead (or come back), which the named unit
+		conditions look at. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::notifyOfObjectLivenessChange( Object *pObj )
+{
+	if (m_namedUnitWatchers.empty()) {
+		return;
+	}
+	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
+		if (pObj == it->second) {
+			namedObjectChanged(it->first);
+		}
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 /** Notify the script engine that a video has completed */
 //-------------------------------------------------------------------------------------------------
@@ -6544,6 +7042,7 @@ void ScriptEngine::notifyOfAcquiredScience( Int playerIndex, ScienceType science
 void ScriptEngine::signalUIInteract(const AsciiString& hookName)
 {
 	m_uiInteractions.push_front(hookName);
+	flagNameChanged(hookName);
 #ifdef DEBUG_LOGGING
 	AppendDebugMessage(hookName, false); // don't bother in Release
 #endif
@@ -6995,6 +7494,8 @@ const ConditionTemplate * ScriptEngine::getConditionTemplate( Int ndx )
 void ScriptEngine::createNamedCache( void )
 {
 	m_namedObjects.clear();
+	m_namedObjectIndex.clear();
+	invalidateAllIndexedConditions();
 
 	if( !TheGameLogic )
 	{
@@ -7004,10 +7505,7 @@ void ScriptEngine::createNamedCache( void )
 
 	while (pObj) {
 		if (!pObj->getName().isEmpty()) {
-			NamedRequest req;
-			req.first = pObj->getName();
-			req.second = pObj;
-			m_namedObjects.push_back(req);
+			pushNamedObject(pObj->getName(), pObj);
 		}
 		pObj = pObj->getNextObject();
 	}
@@ -8305,6 +8803,8 @@ void ScriptEngine::xfer( Xfer *xfer )
 
 		}  // end for, i
 
+		rebuildNamedObjectIndex();
+
 	}  // end else, load
 
 	// first update
@@ -8594,6 +9094,9 @@ void ScriptEngine::xfer( Xfer *xfer )
 void ScriptEngine::loadPostProcess( void )
 {
 
+	// Everything the indexed conditions look at has just been replaced.
+	resetConditionIndex();
+
 	// Now that we've loaded everything, go through and set them all back in sync with what we
 	// currently think they should be.
 	TheScriptActions->doEnableOrDisableObjectDifficultyBonuses(m_objectsShouldReceiveDifficultyBonus);
@@ -53,6 +53,7 @@
 #include "Common/DataChunk.h"
 #include "Common/GameState.h"
 #include "Common/KindOf.h"
+#include "Common/NameKeyGenerator.h"
 #include "Common/Radar.h"
 #include "Common/ThingTemplate.h"
 #include "Common/Player.h"
@@ -170,6 +171,7 @@ ScriptList *ScriptList::s_readLists[MAX_PLAYER_COUNT] = {NULL,NULL,NULL,NULL,NUL
 Int					ScriptList::s_numInReadList = 0;
 
 Int ScriptList::m_curId = 0;
+UnsignedInt ScriptList::s_changeSerial = 0;
 
 /**
  ScriptList::updateDefaults -  checks for empty script lists, and adds some default stuff
@@ -212,6 +214,7 @@ ScriptList::ScriptList(void) :
 m_firstGroup(NULL),
 m_firstScript(NULL)
 {
+	noteChanged();
 }
 
 /**
@@ -220,6 +223,7 @@ m_firstScript(NULL)
 */
 ScriptList::~ScriptList(void) 
 {
+	noteChanged();
 	if (m_firstGroup) {
 		m_firstGroup->deleteInstance();
 		m_firstGroup = NULL;
@@ -654,6 +658,7 @@ m_nextGroup(NULL)
 */
 ScriptGroup::~ScriptGroup(void) 
 {
+	ScriptList::noteChanged();
 	if (m_firstScript) {
 		// Delete the first script.  m_firstScript deletes the entire list.
 		m_firstScript->deleteInstance();
@@ -909,6 +914,8 @@ m_hard(true),
 m_delayEvaluationSeconds(0),
 m_conditionTime(0),
 m_conditionExecutedCount(0),
+m_conditionIndexSlot(-1),
+m_conditionIndexEpoch(0),
 m_frameToEvaluateAt(0),
 m_isSubroutine(false),
 m_hasWarnings(false),
@@ -929,6 +936,7 @@ m_curTime(0.0f)
 */
 Script::~Script(void) 
 {
+	ScriptList::noteChanged();
 	if (m_nextScript) {
 		Script *cur = m_nextScript;
 		Script *next;
@@ -1073,6 +1081,7 @@ Script *Script::duplicateAndQualify(const AsciiString& qualifier,
 void Script::updateFrom(Script *pSrc) 
 {
 	this->m_scriptName = pSrc->m_scriptName;
+	ScriptList::noteChanged();
 	this->m_comment = pSrc->m_comment;
 	this->m_conditionComment = pSrc->m_conditionComment;
 	this->m_actionComment = pSrc->m_actionComment;
@@ -1088,6 +1097,7 @@ void Script::updateFrom(Script *pSrc)
 	}
 	this->m_condition = pSrc->m_condition;
 	pSrc->m_condition = NULL;
+	this->m_conditionIndexEpoch = 0;
 	if (this->m_action) {
 		this->m_action->deleteInstance();
 	}
@@ -1783,6 +1793,15 @@ void Parameter::qualify(const AsciiString& qualifier,
 		case SCRIPT_SUBROUTINE: m_string.concat(qualifier); break;
 		default: break;
 	}
+	m_stringKey = NAMEKEY_INVALID;
+}
+
+NameKeyType Parameter::getStringKey(void) const
+{
+	if (m_stringKey == NAMEKEY_INVALID) {
+		m_stringKey = NAMEKEY(m_string);
+	}
+	return m_stringKey;
 }
 
 AsciiString Parameter::getUiText(void) const
@@ -2190,6 +2209,12 @@ Parameter *Parameter::ReadParameter(DataChunkInput &file)
 		}
 	}
 
+	// Intern the names that get looked up while the scripts run.
+	if (pParm->getParameterType() == UNIT || pParm->getParameterType() == BRIDGE)
+	{
+		pParm->getStringKey();
+	}
+
 	return pParm;
 }
 
@@ -54,9 +54,13 @@
 #include "Common/ThingTemplate.h"
 #include "GameClient/Water.h"
 #include "Common/WellKnownKeys.h"
+#include "Common/WorkerThreadPool.h"
 #include "Common/Xfer.h"
 #include "Common/XferCRC.h"
 #include "Common/XferDeepCRC.h"
+#ifdef TEST_XFER_CRC
+#include <chrono>
+#endif
 
 #include "GameClient/ControlBar.h"
 #include "GameClient/Drawable.h"
@@ -128,9 +132,6 @@ FILE *g_UT_commaLog=NULL;
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 #endif
 
-// I'm making this larger now that we know how big our maps are going to be. 
-enum { OBJ_HASH_SIZE	= 8192 };
-
 /// The GameLogic singleton instance
 GameLogic *TheGameLogic = NULL;
 
@@ -236,6 +237,23 @@ GameLogic::GameLogic( void )
 	m_height = 0;
 	m_objList = NULL;
 	m_curUpdateModule = NULL;
+	m_inSelfContainedUpdates = FALSE;
+	for (Int i = 0; i < SLEEPY_WHEEL_BUCKETS; ++i)
+	{
+		m_sleepyWheelHead[i] = NULL;
+		m_sleepyWheelTail[i] = NULL;
+	}
+	m_sleepyWheelFrame = 0;
+	m_sleepySequence = 0;
+#ifdef TEST_SLEEPY_WHEEL
+	m_ranSleepyWheelTest = FALSE;
+#endif
+#ifdef TEST_OBJECT_ID_TABLE
+	m_ranObjectIDTableTest = FALSE;
+#endif
+#ifdef TEST_FRAME_ARENA
+	m_ranFrameArenaTest = FALSE;
+#endif
 	m_nextObjID = INVALID_ID;
 	m_startNewGame = FALSE;
 	m_gameMode = GAME_NONE;
@@ -247,6 +265,8 @@ GameLogic::GameLogic( void )
 	m_forceGameStartByTimeOut = FALSE;
 #ifdef DUMP_PERF_STATS
 	m_overallFailedPathfinds = 0;
+	m_pathCacheHits = 0;
+	m_pathCacheMisses = 0;
 #endif
 }
 
@@ -262,12 +282,18 @@ void GameLogic::setDefaults( Bool saveGame )
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	m_normalUpdates.clear();
 #endif
-	for (std::vector<UpdateModulePtr>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
-	{
-		(*it)->friend_setIndexInLogic(-1);
-	}
-	m_sleepyUpdates.clear();
+	clearSleepyUpdates();
+	m_sleepyWheelFrame = 0;
 	m_curUpdateModule = NULL;
+#ifdef TEST_SLEEPY_WHEEL
+	m_ranSleepyWheelTest = FALSE;
+#endif
+#ifdef TEST_OBJECT_ID_TABLE
+	m_ranObjectIDTableTest = FALSE;
+#endif
+#ifdef TEST_FRAME_ARENA
+	m_ranFrameArenaTest = FALSE;
+#endif
 
 	//
 	// only reset the next object ID allocater counter when we're not loading a save game.
@@ -421,10 +447,17 @@ void GameLogic::reset( void )
 	m_thingTemplateBuildableOverrides.clear();
 	m_controlBarOverrides.clear();
 
-	// set the hash to be rather large. We need to optimize this value later.
-	m_objHash.clear();
-	m_objHash.resize(OBJ_HASH_SIZE);
+	m_objTable.clear();
 	m_gamePaused = FALSE;
+
+	const FrameArenaStats& arenaStats = m_frameArena.getStats();
+	if (arenaStats.m_frames > 0)
+	{
+		DEBUG_LOG(("FrameArena - %d frames, %d allocations (%d bytes) a frame, peak %d (%d bytes), %d bytes reserved\n",
+			arenaStats.m_frames, (Int)(arenaStats.m_totalAllocations / arenaStats.m_frames), (Int)(arenaStats.m_totalBytes / arenaStats.m_frames),
+			arenaStats.m_peakFrameAllocations, arenaStats.m_peakFrameBytes, arenaStats.m_reservedBytes));
+	}
+	m_frameArena.clearStats();
 	m_inputEnabledMemory = TRUE;
 	m_mouseVisibleMemory = TRUE;
 	setFPMode();
@@ -1121,6 +1154,9 @@ void GameLogic::startNewGame( Bool saveGame )
 		TheCampaignManager->SetVictorious(FALSE);
 	m_startNewGame = FALSE;
 
+	// start reading what the last load of this map read, while we get on with it
+	TheFileSystem->beginLoad( TheGlobalData->m_mapName );
+
 	// update the loadscreen 
 	if(m_loadScreen)
 		updateLoadProgress(LOAD_PROGRESS_POST_PARTICLE_INI_LOAD);
@@ -1865,6 +1901,7 @@ void GameLogic::startNewGame( Bool saveGame )
 	}
 
 	updateLoadProgress(LOAD_PROGRESS_END);
+	TheFileSystem->endLoad();
 
 	if(isInMultiplayerGame() && TheNetwork)
 	{
@@ -2170,39 +2207,21 @@ void GameLogic::processDestroyList( void )
 		}
 #endif
 
-		/*
-			this looks odd, but is necessary; since erasing a single entry can shuffle others in the list
-			(in order to maintain its heap-ness), we must do two passes: one to find the updates for this
-			object, another to actually erase 'em. 
-			
-			(in case you're wondering: yes, this is still more efficient than just deleting them
-			and rebalancing the entire heap afterwards, at least for real-world maps, since an individual
-			rebalance is O(log N) and a full rebalance is O(N)... so unless you are deleting the majority
-			of the objects in the world every frame, we come out well ahead this way.)
-		*/
-
-		const Int MAX_SUO = 256;
-		UpdateModulePtr sleepyUpdatesForThisObject[MAX_SUO];
-		Int numSUO = 0;
-
-		for (std::vector<UpdateModulePtr>::iterator it2 = m_sleepyUpdates.begin(); it2 != m_sleepyUpdates.end(); ++it2)
+		// take the object's update modules out of the schedule.
+		for (BehaviorModule** b = currentObject->getBehaviorModules(); *b; ++b)
 		{
-			UpdateModulePtr u = *it2;
-			if (u->friend_getObject() == currentObject && numSUO < MAX_SUO)
+#ifdef DIRECT_UPDATEMODULE_ACCESS
+			// evil, but necessary at this point. (srj)
+			UpdateModulePtr u = (UpdateModulePtr)((*b)->getUpdate());
+#else
+			UpdateModulePtr u = (*b)->getUpdate();
+#endif
+			if (u && u->friend_getIndexInLogic() != -1)
 			{
-				sleepyUpdatesForThisObject[numSUO++] = u;
+				removeSleepyUpdate(u);
 			}
 		}
 
-		for (--numSUO; numSUO >= 0; --numSUO)
-		{
-			// have to re-get idx each time since each call to erase might change others.
-			Int idx = sleepyUpdatesForThisObject[numSUO]->friend_getIndexInLogic();
-			DEBUG_ASSERTCRASH(m_sleepyUpdates[idx] == sleepyUpdatesForThisObject[numSUO], ("Hmm, expected update mismatch here"));
-			eraseSleepyUpdate(idx);
-			DEBUG_ASSERTCRASH(sleepyUpdatesForThisObject[numSUO]->friend_getIndexInLogic() == -1, ("Hmm, expected index to be -1 here"));
-		}
-
 		currentObject->removeFromList(&m_objList);//remove from object list
 
 		// remove object from lookup table
@@ -2426,6 +2445,21 @@ inline void GameLogic::validateSleepyUpdate() const
 			DEBUG_ASSERTCRASH(pri <= pri2, ("sleepyUpdates are munged (2)"));
 		}
 	}
+
+	for (i = 0; i < SLEEPY_WHEEL_BUCKETS; ++i)
+	{
+		UpdateModulePtr prev = NULL;
+		for (UpdateModulePtr u = m_sleepyWheelHead[i]; u; prev = u, u = u->friend_getNextInLogic())
+		{
+			DEBUG_ASSERTCRASH(u->friend_getIndexInLogic() == SLEEPY_IN_WHEEL, ("sleepy wheel index mismatch"));
+			DEBUG_ASSERTCRASH(u->friend_getPrevInLogic() == prev, ("sleepy wheel links are munged"));
+			DEBUG_ASSERTCRASH(prev == NULL || prev->friend_getSequenceInLogic() < u->friend_getSequenceInLogic(), ("sleepy wheel is out of order"));
+			UnsignedInt frame = u->friend_getNextCallFrame();
+			DEBUG_ASSERTCRASH(frame - m_sleepyWheelFrame < SLEEPY_WHEEL_FRAMES, ("sleepy wheel has a module for the wrong frame"));
+			DEBUG_ASSERTCRASH(((frame & (SLEEPY_WHEEL_FRAMES-1))<<2) + u->friend_getNextCallPhase() == i, ("sleepy wheel has a module in the wrong bucket"));
+		}
+		DEBUG_ASSERTCRASH(m_sleepyWheelTail[i] == prev, ("sleepy wheel tail mismatch"));
+	}
 #endif
 }
 
@@ -2459,10 +2493,13 @@ inline Bool isLowerPriority(const UpdateModulePtr a, const UpdateModulePtr b)
 	// return true iff a is lower pri than b.
 	// remember: lower ordinal value means higher priority.
 	// therefore, higher ordinal value means lower priority.
+	// ties go to whoever was scheduled first, so the order never depends on the heap layout.
 	DEBUG_ASSERTCRASH(a && b, ("these may no longer be null"));
 	UnsignedInt f1 = a->friend_getPriority();
 	UnsignedInt f2 = b->friend_getPriority();
-	return f1 > f2;
+	if (f1 != f2)
+		return f1 > f2;
+	return a->friend_getSequenceInLogic() > b->friend_getSequenceInLogic();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -2583,20 +2620,14 @@ void GameLogic::rebalanceSleepyUpdate(Int i)
 }
 
 // ------------------------------------------------------------------------------------------------
-void GameLogic::remakeSleepyUpdate()
+void GameLogic::pushSleepyHeap(UpdateModulePtr u)
 {
 	USE_PERF_TIMER(SleepyMaintenance)
 
-	Int parent = m_sleepyUpdates.size() / 2;
-  while (true) 
-	{
-    rebalanceChildSleepyUpdate(parent);
-    if (parent == 0)
-			break;
-    --parent;
-  }
-
-	validateSleepyUpdate();
+	m_sleepyUpdates.push_back(u);
+	u->friend_setIndexInLogic(m_sleepyUpdates.size() - 1);
+	
+	rebalanceParentSleepyUpdate(m_sleepyUpdates.size()-1);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -2605,48 +2636,319 @@ void GameLogic::pushSleepyUpdate(UpdateModulePtr u)
 	USE_PERF_TIMER(SleepyMaintenance)
 
 	DEBUG_ASSERTCRASH(u != NULL, ("You may not pass null for sleepy update info"));
+	DEBUG_ASSERTCRASH(u->friend_getIndexInLogic() == -1, ("sleepy update is already scheduled"));
 
-	m_sleepyUpdates.push_back(u);
-	u->friend_setIndexInLogic(m_sleepyUpdates.size() - 1);
-	
-	rebalanceParentSleepyUpdate(m_sleepyUpdates.size()-1);
+	u->friend_setSequenceInLogic(m_sleepySequence++);
+
+	UnsignedInt frame = u->friend_getNextCallFrame();
+	if (frame < m_sleepyWheelFrame || frame - m_sleepyWheelFrame >= SLEEPY_WHEEL_FRAMES)
+	{
+		pushSleepyHeap(u);
+		return;
+	}
+
+	// newest goes on the end, so the bucket stays in the order things were scheduled.
+	Int bucket = ((frame & (SLEEPY_WHEEL_FRAMES-1)) << 2) + u->friend_getNextCallPhase();
+	UpdateModulePtr tail = m_sleepyWheelTail[bucket];
+	u->friend_setPrevInLogic(tail);
+	u->friend_setNextInLogic(NULL);
+	if (tail)
+		tail->friend_setNextInLogic(u);
+	else
+		m_sleepyWheelHead[bucket] = u;
+	m_sleepyWheelTail[bucket] = u;
+	u->friend_setIndexInLogic(SLEEPY_IN_WHEEL);
 }
 
 // ------------------------------------------------------------------------------------------------
-UpdateModulePtr GameLogic::peekSleepyUpdate() const
+void GameLogic::removeSleepyUpdate(UpdateModulePtr u)
 {
 	USE_PERF_TIMER(SleepyMaintenance)
 
-	UpdateModulePtr u = m_sleepyUpdates.front();
-	DEBUG_ASSERTCRASH(u->friend_getIndexInLogic() == 0, ("index mismatch: expected %d, got %d\n",0,u->friend_getIndexInLogic()));
-	return u;
+	Int idx = u->friend_getIndexInLogic();
+	if (idx != SLEEPY_IN_WHEEL)
+	{
+		DEBUG_ASSERTCRASH(idx >= 0 && idx < m_sleepyUpdates.size() && m_sleepyUpdates[idx] == u, ("bad sleepy idx"));
+		eraseSleepyUpdate(idx);
+		return;
+	}
+
+	// (this relies on the wake frame not changing while we're in the wheel.)
+	Int bucket = ((u->friend_getNextCallFrame() & (SLEEPY_WHEEL_FRAMES-1)) << 2) + u->friend_getNextCallPhase();
+	UpdateModulePtr prev = u->friend_getPrevInLogic();
+	UpdateModulePtr next = u->friend_getNextInLogic();
+	if (prev)
+		prev->friend_setNextInLogic(next);
+	else
+		m_sleepyWheelHead[bucket] = next;
+	if (next)
+		next->friend_setPrevInLogic(prev);
+	else
+		m_sleepyWheelTail[bucket] = prev;
+
+	u->friend_setPrevInLogic(NULL);
+	u->friend_setNextInLogic(NULL);
+	u->friend_setIndexInLogic(-1);
 }
 
 // ------------------------------------------------------------------------------------------------
-void GameLogic::popSleepyUpdate()
+/**
+	Slide the wheel forward so that it starts at 'now'. Anyone left behind in a frame
+	we pass over is overdue, and goes into the heap (where they will sort ahead of everyone
+	else); sleepers in the heap whose frame comes into range move into the wheel.
+*/
+void GameLogic::advanceSleepyWheel(UnsignedInt now)
 {
 	USE_PERF_TIMER(SleepyMaintenance)
 
-	Int sz = m_sleepyUpdates.size();
-	if (sz == 0)
+	while (m_sleepyWheelFrame < now)
+	{
+		Int bucket = (m_sleepyWheelFrame & (SLEEPY_WHEEL_FRAMES-1)) << 2;
+		for (Int phase = 0; phase < 4; ++phase, ++bucket)
+		{
+			while (m_sleepyWheelHead[bucket])
+			{
+				UpdateModulePtr u = m_sleepyWheelHead[bucket];
+				removeSleepyUpdate(u);
+				pushSleepyHeap(u);
+			}
+		}
+
+		++m_sleepyWheelFrame;
+
+		// the frame that just came into range reuses the buckets we just emptied. it can
+		// only have sleepers in the heap, and they come off the heap in priority-then-schedule
+		// order, so appending 'em keeps the buckets in order. (if there is anything overdue
+		// on top of the heap, we can't get at 'em; that's fine, peekSleepyUpdate looks at
+		// the heap too, so they'll still get called at the right time.)
+		UnsignedInt newFrame = m_sleepyWheelFrame + SLEEPY_WHEEL_FRAMES - 1;
+		while (!m_sleepyUpdates.empty())
+		{
+			UpdateModulePtr u = m_sleepyUpdates.front();
+			if (u->friend_getNextCallFrame() != newFrame)
+				break;
+
+			eraseSleepyUpdate(0);
+
+			bucket = ((newFrame & (SLEEPY_WHEEL_FRAMES-1)) << 2) + u->friend_getNextCallPhase();
+			UpdateModulePtr tail = m_sleepyWheelTail[bucket];
+			u->friend_setPrevInLogic(tail);
+			u->friend_setNextInLogic(NULL);
+			if (tail)
+				tail->friend_setNextInLogic(u);
+			else
+				m_sleepyWheelHead[bucket] = u;
+			m_sleepyWheelTail[bucket] = u;
+			u->friend_setIndexInLogic(SLEEPY_IN_WHEEL);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+/// return the next module due at or before 'now', or null if everyone is asleep.
+UpdateModulePtr GameLogic::peekSleepyUpdate(UnsignedInt now) const
+{
+	USE_PERF_TIMER(SleepyMaintenance)
+
+	UpdateModulePtr u = NULL;
+	if (now - m_sleepyWheelFrame < SLEEPY_WHEEL_FRAMES)
+	{
+		Int bucket = (now & (SLEEPY_WHEEL_FRAMES-1)) << 2;
+		for (Int phase = 0; phase < 4; ++phase, ++bucket)
+		{
+			if (m_sleepyWheelHead[bucket])
+			{
+				u = m_sleepyWheelHead[bucket];
+				break;
+			}
+		}
+	}
+
+	if (!m_sleepyUpdates.empty())
+	{
+		UpdateModulePtr h = m_sleepyUpdates.front();
+		DEBUG_ASSERTCRASH(h->friend_getIndexInLogic() == 0, ("index mismatch: expected %d, got %d\n",0,h->friend_getIndexInLogic()));
+		if (h->friend_getNextCallFrame() <= now && (u == NULL || isLowerPriority(u, h)))
+			u = h;
+	}
+
+	return u;
+}
+
+// ------------------------------------------------------------------------------------------------
+void GameLogic::clearSleepyUpdates()
+{
+	for (std::vector<UpdateModulePtr>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
+	{
+		(*it)->friend_setIndexInLogic(-1);
+	}
+	m_sleepyUpdates.clear();
+
+	for (Int i = 0; i < SLEEPY_WHEEL_BUCKETS; ++i)
 	{
-		DEBUG_CRASH(("should not happen"));
+		UpdateModulePtr next;
+		for (UpdateModulePtr u = m_sleepyWheelHead[i]; u; u = next)
+		{
+			next = u->friend_getNextInLogic();
+			u->friend_setPrevInLogic(NULL);
+			u->friend_setNextInLogic(NULL);
+			u->friend_setIndexInLogic(-1);
+		}
+		m_sleepyWheelHead[i] = NULL;
+		m_sleepyWheelTail[i] = NULL;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// hands out the self contained updates to the worker threads in chunks this size.
+enum { SELF_CONTAINED_UPDATES_PER_JOB = 64 };
+
+struct SelfContainedUpdateBatch
+{
+	UpdateModulePtr*	m_modules;
+	UpdateSleepTime*	m_sleep;
+	Int								m_count;
+};
+
+static void selfContainedUpdateJob(Int jobIndex, Int /*workerIndex*/, void *userData)
+{
+	SelfContainedUpdateBatch* batch = (SelfContainedUpdateBatch*)userData;
+	Int start = jobIndex * SELF_CONTAINED_UPDATES_PER_JOB;
+	Int end = start + SELF_CONTAINED_UPDATES_PER_JOB;
+	if (end > batch->m_count)
+		end = batch->m_count;
+	for (Int i = start; i < end; ++i)
+	{
+		UpdateSleepTime sleepLen = batch->m_modules[i]->update();
+		DEBUG_ASSERTCRASH(sleepLen > 0, ("you may not return 0 from update"));
+		if (sleepLen < 1) 
+			sleepLen = UPDATE_SLEEP_NONE;
+		batch->m_sleep[i] = sleepLen;
+	}
+}
+
+static Bool selfContainedUpdateLess(UpdateModulePtr a, UpdateModulePtr b)
+{
+	return a->friend_getObject()->getID() < b->friend_getObject()->getID();
+}
+
+// ------------------------------------------------------------------------------------------------
+/**
+	Pull every module due this frame that says it is self contained out of the wheel,
+	run them all across the worker threads, and then reschedule them in object ID order,
+	so the outcome doesn't depend on how many threads we had or who finished first.
+	Anything that is disabled (or overdue, and so in the heap) is left for the regular loop.
+*/
+DECLARE_PERF_TIMER(GameLogic_update_selfContained)
+void GameLogic::runSelfContainedUpdates(UnsignedInt now)
+{
+	USE_PERF_TIMER(GameLogic_update_selfContained)
+
+	if (now - m_sleepyWheelFrame >= SLEEPY_WHEEL_FRAMES)
 		return;
+
+	m_selfContainedUpdates.clear();
+	Int bucket = (now & (SLEEPY_WHEEL_FRAMES-1)) << 2;
+	for (Int phase = 0; phase < 4; ++phase, ++bucket)
+	{
+		UpdateModulePtr next;
+		for (UpdateModulePtr u = m_sleepyWheelHead[bucket]; u; u = next)
+		{
+			next = u->friend_getNextInLogic();
+			if (!u->isSelfContainedUpdate())
+				continue;
+
+			DisabledMaskType dis = u->friend_getObject()->getDisabledFlags();
+			if (dis.any() && !dis.anyIntersectionWith(u->getDisabledTypesToProcess()))
+				continue;
+
+			removeSleepyUpdate(u);
+			m_selfContainedUpdates.push_back(u);
+		}
 	}
 
-	m_sleepyUpdates[0]->friend_setIndexInLogic(-1);
-	if (sz > 1)
+	Int count = m_selfContainedUpdates.size();
+	if (count == 0)
+		return;
+
+	std::stable_sort(m_selfContainedUpdates.begin(), m_selfContainedUpdates.end(), selfContainedUpdateLess);
+	m_selfContainedSleep.resize(count);
+
+	m_inSelfContainedUpdates = TRUE;
+#ifdef DEBUG_CRC
+	if (g_verifySelfContainedUpdates)
 	{
-		m_sleepyUpdates[0] = m_sleepyUpdates[sz-1];
-		m_sleepyUpdates[0]->friend_setIndexInLogic(0);
-		m_sleepyUpdates.pop_back();
-		rebalanceChildSleepyUpdate(0);
+		// one at a time, with a CRC of everything else taken on either side. slow, but it
+		// catches anyone who claims to be self contained and isn't.
+		for (Int i = 0; i < count; ++i)
+		{
+			UpdateModulePtr u = m_selfContainedUpdates[i];
+			const Object* obj = u->friend_getObject();
+			UnsignedInt before = calcSharedStateCRC(obj);
+
+			SelfContainedUpdateBatch one = { &m_selfContainedUpdates[i], &m_selfContainedSleep[i], 1 };
+			selfContainedUpdateJob(0, 0, &one);
+
+			UnsignedInt after = calcSharedStateCRC(obj);
+			if (before != after)
+			{
+				DEBUG_CRASH(("%s on object %d (%s) says it is self contained, but changed something else on frame %d",
+					TheNameKeyGenerator->keyToName(u->getModuleNameKey()).str(), obj->getID(), obj->getTemplate()->getName().str(), now));
+				CRCDEBUG_LOG(("%s on object %d is not self contained! (0x%8.8X -> 0x%8.8X)\n",
+					TheNameKeyGenerator->keyToName(u->getModuleNameKey()).str(), obj->getID(), before, after));
+			}
+		}
 	}
 	else
+#endif
 	{
-		m_sleepyUpdates.pop_back();
+		SelfContainedUpdateBatch batch = { &m_selfContainedUpdates[0], &m_selfContainedSleep[0], count };
+		Int numJobs = (count + SELF_CONTAINED_UPDATES_PER_JOB - 1) / SELF_CONTAINED_UPDATES_PER_JOB;
+		if (TheWorkerThreadPool)
+		{
+			TheWorkerThreadPool->parallelFor(numJobs, selfContainedUpdateJob, &batch);
+		}
+		else
+		{
+			for (Int job = 0; job < numJobs; ++job)
+				selfContainedUpdateJob(job, 0, &batch);
+		}
+	}
+	m_inSelfContainedUpdates = FALSE;
+
+	for (Int i = 0; i < count; ++i)
+	{
+		UpdateModulePtr u = m_selfContainedUpdates[i];
+		u->friend_setNextCallFrame(now + m_selfContainedSleep[i]);
+		pushSleepyUpdate(u);
+	}
+}
+
+#ifdef DEBUG_CRC
+// ------------------------------------------------------------------------------------------------
+/// CRC of all the logic state a self contained update on 'skip' is not allowed to change.
+UnsignedInt GameLogic::calcSharedStateCRC(const Object *skip)
+{
+	XferCRC *xferCRC = NEW XferCRC;
+	xferCRC->open("sharedStateCRC");
+
+	for (Object *obj = m_objList; obj; obj = obj->getNextObject())
+	{
+		if (obj != skip)
+			xferCRC->xferSnapshot( obj );
 	}
+	UnsignedInt seed = GetGameLogicRandomSeedCRC();
+	xferCRC->xferUnsignedInt( &seed );
+	xferCRC->xferSnapshot( ThePartitionManager );
+	xferCRC->xferSnapshot( ThePlayerList );
+	xferCRC->xferSnapshot( TheAI );
+
+	xferCRC->close();
+	UnsignedInt theCRC = xferCRC->getCRC();
+	delete xferCRC;
+	return theCRC;
 }
+#endif
 
 // ------------------------------------------------------------------------------------------------
 // this should be called only by UpdateModule, thanks.
@@ -2664,6 +2966,12 @@ void GameLogic::friend_awakenUpdateModule(Object* obj, UpdateModulePtr u, Unsign
 		return;
 	}
 
+	if (m_inSelfContainedUpdates)
+	{
+		DEBUG_CRASH(("Someone called setWakeFrame() from a self contained update, which means it isn't.\n"));
+		return;
+	}
+
 	if (whenToWakeUp == u->friend_getNextCallFrame())
 		return;	// my, that was easy
 
@@ -2680,23 +2988,25 @@ void GameLogic::friend_awakenUpdateModule(Object* obj, UpdateModulePtr u, Unsign
 	Int idx = u->friend_getIndexInLogic();
 	if (obj->isInList(&m_objList))
 	{
-		if (idx < 0 || idx >= m_sleepyUpdates.size())
+		if (idx != SLEEPY_IN_WHEEL)
 		{
-			RELEASE_CRASH("fatal error! sleepy update module illegal index.\n");
-			return;
-		}
+			if (idx < 0 || idx >= m_sleepyUpdates.size())
+			{
+				RELEASE_CRASH("fatal error! sleepy update module illegal index.\n");
+				return;
+			}
 
-		if (m_sleepyUpdates[idx] != u)
-		{
-			RELEASE_CRASH("fatal error! sleepy update module index mismatch.\n");
-			return;
+			if (m_sleepyUpdates[idx] != u)
+			{
+				RELEASE_CRASH("fatal error! sleepy update module index mismatch.\n");
+				return;
+			}
 		}
 
-		// update the value.
+		// unlink, update the value, and reschedule. (this is O(1) unless either end is in the heap.)
+		removeSleepyUpdate(u);
 		u->friend_setNextCallFrame(whenToWakeUp);
-
-		// rebalance.
-		rebalanceSleepyUpdate(idx);
+		pushSleepyUpdate(u);
 		
 		// validate. (harmless except in debug mode)
 		validateSleepyUpdate();
@@ -2719,46 +3029,449 @@ void GameLogic::friend_awakenUpdateModule(Object* obj, UpdateModulePtr u, Unsign
 }
 
 // ------------------------------------------------------------------------------------------------
-#ifdef DO_UNIT_TIMINGS
-	enum {TIME_FRAMES=100};
-static void unitTimings(void)
+#ifdef TEST_SLEEPY_WHEEL
+
+// Real update modules need real objects, so the benchmark runs the two schedulers over
+// stand-ins. Both use the same heap code and the same ordering rule as GameLogic does.
+struct SleepyTestNode
 {
-	static Int settleFrames = 0;
-	static Int timeFrames = 0;
-	enum { INFANTRY, VEHICLE, STRUCTURE, OTHER, END}; 
-	static Int unitTypes = INFANTRY;
-	AsciiString sides[8];
+	UnsignedInt			m_pri;							///< (frame<<2)|phase, just like UpdateModule
+	UnsignedInt64		m_seq;
+	Int							m_idx;							///< heap index, SLEEPY_TEST_IN_WHEEL, or -1
+	SleepyTestNode*	m_prev;
+	SleepyTestNode*	m_next;
+	Int							m_id;
+};
 
+enum { SLEEPY_TEST_IN_WHEEL = -2, SLEEPY_TEST_WHEEL_FRAMES = 256 };
 
-	Int sideCount = 0;
-  #define SINGLE_UNIT "OxFooble."
+class SleepyTestScheduler
+{
+public:
+	SleepyTestScheduler(Bool useWheel) : m_useWheel(useWheel), m_frame(0), m_seq(0)
+	{
+		for (Int i = 0; i < SLEEPY_TEST_WHEEL_FRAMES*4; ++i)
+			m_head[i] = m_tail[i] = NULL;
+	}
 
-#define DO_FACTION
-#ifdef DO_FACTION
-	sides[sideCount++] = "America";
-	sides[sideCount++] = "China";
-	sides[sideCount++] = "GLA";
-#endif
+	static Bool isLower(const SleepyTestNode* a, const SleepyTestNode* b)
+	{
+		if (a->m_pri != b->m_pri)
+			return a->m_pri > b->m_pri;
+		return a->m_seq > b->m_seq;
+	}
 
-#define DO_CIVILIAN
-#ifdef DO_CIVILIAN
-	sides[sideCount++] = "Civilian";
-#endif
+	void heapSwap(Int a, Int b)
+	{
+		SleepyTestNode* t = m_heap[a];
+		m_heap[a] = m_heap[b];
+		m_heap[b] = t;
+		m_heap[a]->m_idx = a;
+		m_heap[b]->m_idx = b;
+	}
 
-	sides[sideCount] = "";
-	static bool veryFirstTime = true;
+	void heapUp(Int i)
+	{
+		while (i > 0 && isLower(m_heap[(i-1)>>1], m_heap[i]))
+		{
+			heapSwap(i, (i-1)>>1);
+			i = (i-1)>>1;
+		}
+	}
 
+	void heapDown(Int i)
+	{
+		Int sz = m_heap.size();
+		for (;;)
+		{
+			Int child = (i<<1)+1;
+			if (child >= sz)
+				break;
+			if (child < sz-1 && isLower(m_heap[child], m_heap[child+1]))
+				++child;
+			if (!isLower(m_heap[i], m_heap[child]))
+				break;
+			heapSwap(i, child);
+			i = child;
+		}
+	}
 
-	static Int side = 0;
+	void heapPush(SleepyTestNode* n)
+	{
+		m_heap.push_back(n);
+		n->m_idx = m_heap.size()-1;
+		heapUp(n->m_idx);
+	}
 
-	const Int FACTOR = 5; // run at TIME_FRAMES/FACTOR so we dont' die of boredom.  jba.
+	void heapErase(Int i)
+	{
+		Int final = m_heap.size()-1;
+		m_heap[i]->m_idx = -1;
+		if (i < final)
+		{
+			m_heap[i] = m_heap[final];
+			m_heap[i]->m_idx = i;
+			m_heap.pop_back();
+			heapUp(i);
+			heapDown(i);
+		}
+		else
+		{
+			m_heap.pop_back();
+		}
+	}
 
-	static __int64 startTime64;
-	static __int64 endTime64,freq64;
-	static int drawCallTotal;
-	static enum { LOGIC, NO_PARTICLES, NO_SPAWN, ALL} mode;
-	static double timeAll, timeAllNoAnim, timeNoPart, timeNoSpawn, timeLogic, timeLogicNoAnim;
-	static float drawCallAll,drawCallNoPart,drawCallNoSpawn,drawCallLogic;
+	void link(SleepyTestNode* n)
+	{
+		Int b = (((n->m_pri>>2) & (SLEEPY_TEST_WHEEL_FRAMES-1))<<2) + (n->m_pri & 3);
+		n->m_prev = m_tail[b];
+		n->m_next = NULL;
+		if (m_tail[b])
+			m_tail[b]->m_next = n;
+		else
+			m_head[b] = n;
+		m_tail[b] = n;
+		n->m_idx = SLEEPY_TEST_IN_WHEEL;
+	}
+
+	void push(SleepyTestNode* n)
+	{
+		n->m_seq = m_seq++;
+		UnsignedInt frame = n->m_pri >> 2;
+		if (!m_useWheel || frame < m_frame || frame - m_frame >= SLEEPY_TEST_WHEEL_FRAMES)
+			heapPush(n);
+		else
+			link(n);
+	}
+
+	void remove(SleepyTestNode* n)
+	{
+		if (n->m_idx != SLEEPY_TEST_IN_WHEEL)
+		{
+			heapErase(n->m_idx);
+			return;
+		}
+		Int b = (((n->m_pri>>2) & (SLEEPY_TEST_WHEEL_FRAMES-1))<<2) + (n->m_pri & 3);
+		if (n->m_prev) n->m_prev->m_next = n->m_next; else m_head[b] = n->m_next;
+		if (n->m_next) n->m_next->m_prev = n->m_prev; else m_tail[b] = n->m_prev;
+		n->m_prev = n->m_next = NULL;
+		n->m_idx = -1;
+	}
+
+	void advance(UnsignedInt now)
+	{
+		if (!m_useWheel)
+			return;
+		while (m_frame < now)
+		{
+			Int b = (m_frame & (SLEEPY_TEST_WHEEL_FRAMES-1))<<2;
+			for (Int p = 0; p < 4; ++p)
+			{
+				while (m_head[b+p])
+				{
+					SleepyTestNode* n = m_head[b+p];
+					remove(n);
+					heapPush(n);
+				}
+			}
+			++m_frame;
+			UnsignedInt newFrame = m_frame + SLEEPY_TEST_WHEEL_FRAMES - 1;
+			while (!m_heap.empty() && (m_heap[0]->m_pri>>2) == newFrame)
+			{
+				SleepyTestNode* n = m_heap[0];
+				heapErase(0);
+				link(n);
+			}
+		}
+	}
+
+	SleepyTestNode* peek(UnsignedInt now) const
+	{
+		SleepyTestNode* n = NULL;
+		if (m_useWheel && now - m_frame < SLEEPY_TEST_WHEEL_FRAMES)
+		{
+			Int b = (now & (SLEEPY_TEST_WHEEL_FRAMES-1))<<2;
+			for (Int p = 0; p < 4 && !n; ++p)
+				n = m_head[b+p];
+		}
+		if (!m_heap.empty() && (m_heap[0]->m_pri>>2) <= now && (n == NULL || isLower(n, m_heap[0])))
+			n = m_heap[0];
+		return n;
+	}
+
+private:
+	Bool													m_useWheel;
+	UnsignedInt										m_frame;
+	UnsignedInt64									m_seq;
+	std::vector<SleepyTestNode*>	m_heap;
+	SleepyTestNode*								m_head[SLEEPY_TEST_WHEEL_FRAMES*4];
+	SleepyTestNode*								m_tail[SLEEPY_TEST_WHEEL_FRAMES*4];
+};
+
+// run numNodes stand-ins for numFrames frames, returning a hash of the order they were called in.
+static UnsignedInt runSleepyTest(Bool useWheel, Int numNodes, Int numFrames, UnsignedInt* time)
+{
+	SleepyTestNode* nodes = MSGNEW("SleepyTest") SleepyTestNode[numNodes];
+	SleepyTestScheduler* sched = MSGNEW("SleepyTest") SleepyTestScheduler(useWheel);
+	UnsignedInt rnd = 12345;
+	#define SLEEPY_TEST_RAND()	(rnd = rnd * 1103515245 + 12345, (rnd >> 8))
+
+	for (Int i = 0; i < numNodes; ++i)
+	{
+		nodes[i].m_id = i;
+		nodes[i].m_idx = -1;
+		nodes[i].m_prev = nodes[i].m_next = NULL;
+		nodes[i].m_pri = ((1 + SLEEPY_TEST_RAND() % 30) << 2) | (i & 3);
+		sched->push(&nodes[i]);
+	}
+
+	UnsignedInt hash = 5381;
+	UnsignedInt startTime = ::GetTickCount();
+	for (UnsignedInt now = 1; now <= (UnsignedInt)numFrames; ++now)
+	{
+		sched->advance(now);
+
+		// a few wake-ups from outside, like setWakeFrame() from some other module.
+		for (Int w = 0; w < numNodes / 100; ++w)
+		{
+			SleepyTestNode* n = &nodes[SLEEPY_TEST_RAND() % numNodes];
+			if (n->m_idx == -1)
+				continue;
+			sched->remove(n);
+			n->m_pri = ((now + 1 + SLEEPY_TEST_RAND() % 10) << 2) | (n->m_pri & 3);
+			sched->push(n);
+		}
+
+		for (;;)
+		{
+			SleepyTestNode* n = sched->peek(now);
+			if (!n)
+				break;
+			sched->remove(n);
+			hash = hash * 33 + n->m_id;
+
+			// mostly short naps, with the odd long sleep that lands outside the wheel.
+			UnsignedInt r = SLEEPY_TEST_RAND() % 100;
+			UnsignedInt sleep = (r < 60) ? 1 : (r < 95) ? 2 + SLEEPY_TEST_RAND() % 60 : 300 + SLEEPY_TEST_RAND() % 3000;
+			n->m_pri = ((now + sleep) << 2) | (n->m_pri & 3);
+			sched->push(n);
+		}
+	}
+	*time = ::GetTickCount() - startTime;
+
+	#undef SLEEPY_TEST_RAND
+	delete sched;
+	delete [] nodes;
+	return hash;
+}
+
+// ------------------------------------------------------------------------------------------------
+void GameLogic::doSleepyWheelTest()
+{
+	const Int NUM_FRAMES = 300;
+	static const Int counts[] = { 1000, 10000, 100000 };
+	for (Int i = 0; i < sizeof(counts)/sizeof(counts[0]); ++i)
+	{
+		UnsignedInt heapTime, wheelTime;
+		UnsignedInt heapHash = runSleepyTest(FALSE, counts[i], NUM_FRAMES, &heapTime);
+		UnsignedInt wheelHash = runSleepyTest(TRUE, counts[i], NUM_FRAMES, &wheelTime);
+		DEBUG_LOG(("SleepyWheelTest - %d modules, %d frames: heap %d ms, wheel %d ms\n",
+			counts[i], NUM_FRAMES, heapTime, wheelTime));
+		DEBUG_ASSERTCRASH(heapHash == wheelHash, ("SleepyWheelTest - wheel called modules in a different order (%08x vs %08x)", heapHash, wheelHash));
+	}
+}
+
+#endif
+
+// ------------------------------------------------------------------------------------------------
+#ifdef TEST_OBJECT_ID_TABLE
+
+typedef std::unordered_map<ObjectID, Object *, rts::hash<ObjectID>, rts::equal_to<ObjectID> > ObjectPtrHash;
+
+// roughly what a hash_map spends: the bucket array, plus a node per entry.
+static UnsignedInt calcObjectPtrHashMemory(const ObjectPtrHash& hash)
+{
+	return sizeof(hash) + hash.bucket_count() * sizeof(void*) 
+		+ hash.size() * (sizeof(ObjectPtrHash::value_type) + 2 * sizeof(void*));
+}
+
+// look up 'numLookups' pseudo-random ids below 'maxID' in both, timing each, and make sure they agree.
+static void runObjectIDTableTest(const char *what, const ObjectIDTable& table, const ObjectPtrHash& hash, UnsignedInt maxID, Int numLookups)
+{
+	const Int NUM_IDS = 4096;
+	ObjectID ids[NUM_IDS];
+	UnsignedInt rnd = 12345;
+	for (Int i = 0; i < NUM_IDS; ++i)
+	{
+		rnd = rnd * 1103515245 + 12345;
+		ids[i] = (ObjectID)(1 + (rnd >> 8) % maxID);
+	}
+
+	UnsignedInt hashSum = 0;
+	UnsignedInt startTime = ::GetTickCount();
+	for (Int i = 0; i < numLookups; ++i)
+	{
+		ObjectPtrHash::const_iterator it = hash.find(ids[i & (NUM_IDS-1)]);
+		if (it != hash.end())
+			hashSum += (UnsignedInt)(uintptr_t)it->second;
+	}
+	UnsignedInt hashTime = ::GetTickCount() - startTime;
+
+	UnsignedInt tableSum = 0;
+	startTime = ::GetTickCount();
+	for (Int i = 0; i < numLookups; ++i)
+	{
+		tableSum += (UnsignedInt)(uintptr_t)table.find(ids[i & (NUM_IDS-1)]);
+	}
+	UnsignedInt tableTime = ::GetTickCount() - startTime;
+
+	DEBUG_LOG(("ObjectIDTableTest - %s: %d objects, ids up to %d, %d lookups: hash %d ms, table %d ms\n",
+		what, table.getCount(), maxID, numLookups, hashTime, tableTime));
+	DEBUG_LOG(("ObjectIDTableTest - %s: hash %d bytes, table %d bytes in %d pages\n",
+		what, calcObjectPtrHashMemory(hash), table.getMemoryUsed(), table.getPageCount()));
+	DEBUG_ASSERTCRASH(hashSum == tableSum && (Int)hash.size() == table.getCount(), ("ObjectIDTableTest - table and hash disagree"));
+}
+
+// ------------------------------------------------------------------------------------------------
+void GameLogic::doObjectIDTableTest()
+{
+	const Int NUM_LOOKUPS = 10000000;
+
+	// the objects in the game right now.
+	{
+		ObjectPtrHash hash;
+		for (Object *obj = m_objList; obj; obj = obj->getNextObject())
+			hash[obj->getID()] = obj;
+		runObjectIDTableTest("this game", m_objTable, hash, (UnsignedInt)m_nextObjID, NUM_LOOKUPS);
+	}
+
+	// a long game: lots of ids handed out, most of them dead. (the pointers are never looked at.)
+	{
+		const Int NUM_MADE = 200000;
+		ObjectIDTable table;
+		ObjectPtrHash hash;
+		UnsignedInt rnd = 54321;
+		for (Int id = 1; id <= NUM_MADE; ++id)
+		{
+			Object *fake = (Object *)(uintptr_t)(id * 16);
+			table.insert((ObjectID)id, fake);
+			hash[(ObjectID)id] = fake;
+
+			// kill off most things soon after, but let some live for a long time.
+			rnd = rnd * 1103515245 + 12345;
+			ObjectID victim = (ObjectID)(1 + (rnd >> 8) % id);
+			if (((rnd >> 4) & 15) != 0)
+			{
+				ObjectPtrHash::iterator it = hash.find(victim);
+				if (it != hash.end())
+				{
+					table.erase(victim, it->second);
+					hash.erase(it);
+				}
+			}
+		}
+		runObjectIDTableTest("simulated", table, hash, NUM_MADE, NUM_LOOKUPS);
+	}
+}
+
+#endif
+
+// ------------------------------------------------------------------------------------------------
+#ifdef TEST_FRAME_ARENA
+void GameLogic::doFrameArenaTest()
+{
+	const Int NUM_FRAMES = 100;
+	const Int NUM_ALLOCS = 20000;		// a busy frame's worth of contact list nodes and iterator clumps
+	const Int SIZES[2] = { 40, 24 };
+
+	std::vector<void *> blocks(NUM_ALLOCS);
+	Int sum[2] = { 0, 0 };
+
+	UnsignedInt startTime = ::GetTickCount();
+	for (Int frame = 0; frame < NUM_FRAMES; ++frame)
+	{
+		for (Int i = 0; i < NUM_ALLOCS; ++i)
+		{
+			Int *p = (Int *)TheDynamicMemoryAllocator->allocateBytesDoNotZero(SIZES[i & 1], "FrameArenaTest");
+			*p = i;
+			blocks[i] = p;
+		}
+		for (Int i = 0; i < NUM_ALLOCS; ++i)
+		{
+			sum[0] += *(Int *)blocks[i];
+			TheDynamicMemoryAllocator->freeBytes(blocks[i]);
+		}
+	}
+	UnsignedInt poolTime = ::GetTickCount() - startTime;
+
+	FrameArena arena;
+	startTime = ::GetTickCount();
+	for (Int frame = 0; frame < NUM_FRAMES; ++frame)
+	{
+		for (Int i = 0; i < NUM_ALLOCS; ++i)
+		{
+			Int *p = (Int *)arena.allocate(SIZES[i & 1]);
+			*p = i;
+			blocks[i] = p;
+		}
+		for (Int i = 0; i < NUM_ALLOCS; ++i)
+		{
+			sum[1] += *(Int *)blocks[i];
+		}
+		arena.endFrame();
+	}
+	UnsignedInt arenaTime = ::GetTickCount() - startTime;
+
+	const FrameArenaStats& stats = arena.getStats();
+	DEBUG_LOG(("FrameArenaTest - %d frames of %d allocations: pools %d ms, arena %d ms\n",
+		NUM_FRAMES, NUM_ALLOCS, poolTime, arenaTime));
+	DEBUG_LOG(("FrameArenaTest - arena took %d bytes a frame and settled at %d bytes reserved\n",
+		stats.m_lastFrameBytes, stats.m_reservedBytes));
+	DEBUG_ASSERTCRASH(sum[0] == sum[1] && stats.m_lastFrameAllocations == NUM_ALLOCS, ("FrameArenaTest - arena and pools disagree"));
+}
+#endif
+
+// ------------------------------------------------------------------------------------------------
+#ifdef DO_UNIT_TIMINGS
+	enum {TIME_FRAMES=100};
+static void unitTimings(void)
+{
+	static Int settleFrames = 0;
+	static Int timeFrames = 0;
+	enum { INFANTRY, VEHICLE, STRUCTURE, OTHER, END}; 
+	static Int unitTypes = INFANTRY;
+	AsciiString sides[8];
+
+
+	Int sideCount = 0;
+  #define SINGLE_UNIT "OxFooble."
+
+#define DO_FACTION
+#ifdef DO_FACTION
+	sides[sideCount++] = "America";
+	sides[sideCount++] = "China";
+	sides[sideCount++] = "GLA";
+#endif
+
+#define DO_CIVILIAN
+#ifdef DO_CIVILIAN
+	sides[sideCount++] = "Civilian";
+#endif
+
+	sides[sideCount] = "";
+	static bool veryFirstTime = true;
+
+
+	static Int side = 0;
+
+	const Int FACTOR = 5; // run at TIME_FRAMES/FACTOR so we dont' die of boredom.  jba.
+
+	static __int64 startTime64;
+	static __int64 endTime64,freq64;
+	static int drawCallTotal;
+	static enum { LOGIC, NO_PARTICLES, NO_SPAWN, ALL} mode;
+	static double timeAll, timeAllNoAnim, timeNoPart, timeNoSpawn, timeLogic, timeLogicNoAnim;
+	static float drawCallAll,drawCallNoPart,drawCallNoSpawn,drawCallLogic;
 	
 	if (settleFrames>0) {
 		settleFrames--;
@@ -3053,6 +3766,36 @@ void GameLogic::update( void )
 #endif
 
 	setFPMode();
+
+#ifdef TEST_SLEEPY_WHEEL
+	if (!m_ranSleepyWheelTest)
+	{
+		m_ranSleepyWheelTest = TRUE;
+		doSleepyWheelTest();
+	}
+#endif
+
+#ifdef TEST_OBJECT_ID_TABLE
+	if (!m_ranObjectIDTableTest && m_frame > LOGICFRAMES_PER_SECOND*10)
+	{
+		m_ranObjectIDTableTest = TRUE;
+		doObjectIDTableTest();
+	}
+#endif
+
+#ifdef TEST_MEMORYPOOL_MAGAZINES
+	// by now the pools it hammers have all been created, and have some real use behind them
+	if (m_frame == LOGICFRAMES_PER_SECOND*10)
+		TheMemoryPoolFactory->doMagazineTest();
+#endif
+
+#ifdef TEST_FRAME_ARENA
+	if (!m_ranFrameArenaTest && m_frame > LOGICFRAMES_PER_SECOND*10)
+	{
+		m_ranFrameArenaTest = TRUE;
+		doFrameArenaTest();
+	}
+#endif
 	
 	/// @todo remove this hack
 	if ( m_startNewGame && !TheDisplay->isMoviePlaying())
@@ -3104,6 +3847,7 @@ void GameLogic::update( void )
 		else 
 		{
 			/// @todo - make sure this never happens during a network game.  jba.
+			m_frameArena.endFrame();
 			return;
 		}
 	}
@@ -3188,22 +3932,17 @@ void GameLogic::update( void )
 #endif
 
 	{
-		while (!m_sleepyUpdates.empty())
-		{
-			UpdateModulePtr u = peekSleepyUpdate();
+		advanceSleepyWheel(now);
+		runSelfContainedUpdates(now);
 
+		for (;;)
+		{
+			// null means we're done, everyone else is sleeping. 
+			UpdateModulePtr u = peekSleepyUpdate(now);
 			if (!u)
-			{
-				DEBUG_CRASH(("Null update. should not happen."));
-				continue;
-			}
-
-			// we're done, everyone else is sleeping. 
-			// break from the loop BEFORE we pop this item off.
-			if (u->friend_getNextCallFrame() > now)
-			{
 				break;
-			}
+
+			removeSleepyUpdate(u);
 
 			UpdateSleepTime sleepLen = UPDATE_SLEEP_NONE;	// default, if it is disabled.
 
@@ -3226,7 +3965,7 @@ void GameLogic::update( void )
 
 			// else defer it till next frame and re-push it
 			u->friend_setNextCallFrame(now + sleepLen);
-			rebalanceSleepyUpdate(0);
+			pushSleepyUpdate(u);
 		}
 	}
 
@@ -3289,6 +4028,9 @@ void GameLogic::update( void )
 	{
 		m_frame++;
 	}
+
+	// throw away this frame's scratch memory
+	m_frameArena.endFrame();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -3310,6 +4052,224 @@ ObjectID GameLogic::allocateObjectID( void )
 	return ret;
 }
 
+// ------------------------------------------------------------------------------------------------
+// ObjectIDTable
+// ------------------------------------------------------------------------------------------------
+ObjectIDTable::ObjectIDTable() : m_numPagesAllocated(0), m_count(0)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+ObjectIDTable::~ObjectIDTable()
+{
+	clear();
+}
+
+// ------------------------------------------------------------------------------------------------
+void ObjectIDTable::insert(ObjectID id, Object *obj)
+{
+	DEBUG_ASSERTCRASH(id != INVALID_ID && obj != NULL, ("ObjectIDTable::insert - bad args"));
+
+	UnsignedInt page = (UnsignedInt)id >> PAGE_SHIFT;
+	if (page >= m_pages.size())
+		m_pages.resize(page + 1, NULL);
+
+	Page *p = m_pages[page];
+	if (p == NULL)
+	{
+		p = MSGNEW("ObjectIDTable") Page;
+		memset(p, 0, sizeof(Page));
+		m_pages[page] = p;
+		++m_numPagesAllocated;
+	}
+
+	Object **slot = &p->m_slots[id & PAGE_MASK];
+	if (*slot == NULL)
+	{
+		++p->m_count;
+		++m_count;
+	}
+	*slot = obj;
+}
+
+// ------------------------------------------------------------------------------------------------
+void ObjectIDTable::erase(ObjectID id, Object *obj)
+{
+	UnsignedInt page = (UnsignedInt)id >> PAGE_SHIFT;
+	if (page >= m_pages.size() || m_pages[page] == NULL)
+		return;
+
+	Page *p = m_pages[page];
+	Object **slot = &p->m_slots[id & PAGE_MASK];
+	if (*slot != obj || obj == NULL)
+		return;
+
+	*slot = NULL;
+	--m_count;
+	if (--p->m_count == 0)
+	{
+		delete p;
+		m_pages[page] = NULL;
+		--m_numPagesAllocated;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void ObjectIDTable::clear()
+{
+	for (std::vector<Page*>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+	{
+		delete *it;
+	}
+	m_pages.clear();
+	m_numPagesAllocated = 0;
+	m_count = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+void ObjectIDTable::iterate( GameLogicFuncPtr proc, void *userData ) const
+{
+	for (std::vector<Page*>::const_iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+	{
+		const Page *p = *it;
+		if (p == NULL)
+			continue;
+
+		for (Int i = 0; i < PAGE_SIZE; ++i)
+		{
+			if (p->m_slots[i])
+				proc(p->m_slots[i], userData);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+UnsignedInt ObjectIDTable::getMemoryUsed() const
+{
+	return sizeof(*this) + m_pages.capacity() * sizeof(Page*) + m_numPagesAllocated * sizeof(Page);
+}
+
+// ------------------------------------------------------------------------------------------------
+// FrameArena
+// ------------------------------------------------------------------------------------------------
+FrameArena::FrameArena() : 
+	m_firstChunk(NULL), 
+	m_curChunk(NULL), 
+	m_cur(NULL), 
+	m_end(NULL), 
+	m_frameAllocations(0), 
+	m_frameBytes(0),
+	m_ownerThread(std::this_thread::get_id())
+{
+	m_stats.clear();
+}
+
+// ------------------------------------------------------------------------------------------------
+FrameArena::~FrameArena()
+{
+	freeChunks();
+}
+
+// ------------------------------------------------------------------------------------------------
+FrameArena::Chunk *FrameArena::newChunk(size_t size)
+{
+	Chunk *chunk = (Chunk *)TheDynamicMemoryAllocator->allocateBytesDoNotZero((Int)size, "FrameArena");
+	chunk->m_next = NULL;
+	chunk->m_size = size;
+	m_stats.m_reservedBytes += (UnsignedInt)size;
+	return chunk;
+}
+
+// ------------------------------------------------------------------------------------------------
+void FrameArena::freeChunks()
+{
+	Chunk *next;
+	for (Chunk *chunk = m_firstChunk; chunk; chunk = next)
+	{
+		next = chunk->m_next;
+		TheDynamicMemoryAllocator->freeBytes(chunk);
+	}
+	m_firstChunk = NULL;
+	m_curChunk = NULL;
+	m_cur = NULL;
+	m_end = NULL;
+	m_stats.m_reservedBytes = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+void *FrameArena::allocateFromNewChunk(size_t bytes)
+{
+	const size_t headerSize = (sizeof(Chunk) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+
+	// double up each time, so a big frame doesn't take too many chunks to get through
+	size_t size = MIN_CHUNK_SIZE;
+	if (m_curChunk && m_curChunk->m_size * 2 > size)
+		size = m_curChunk->m_size * 2;
+	if (size < headerSize + bytes)
+		size = headerSize + bytes;
+
+	Chunk *chunk = newChunk(size);
+	if (m_curChunk)
+		m_curChunk->m_next = chunk;
+	else
+		m_firstChunk = chunk;
+	m_curChunk = chunk;
+	m_cur = (char *)chunk + headerSize;
+	m_end = (char *)chunk + size;
+
+	void *p = m_cur;
+	m_cur += bytes;
+	return p;
+}
+
+// ------------------------------------------------------------------------------------------------
+void FrameArena::endFrame()
+{
+	++m_stats.m_frames;
+	m_stats.m_lastFrameAllocations = m_frameAllocations;
+	m_stats.m_lastFrameBytes = m_frameBytes;
+	if (m_frameAllocations > m_stats.m_peakFrameAllocations)
+		m_stats.m_peakFrameAllocations = m_frameAllocations;
+	if (m_frameBytes > m_stats.m_peakFrameBytes)
+		m_stats.m_peakFrameBytes = m_frameBytes;
+	m_stats.m_totalAllocations += m_frameAllocations;
+	m_stats.m_totalBytes += m_frameBytes;
+	m_frameAllocations = 0;
+	m_frameBytes = 0;
+
+	if (m_firstChunk == NULL)
+		return;
+
+	const size_t headerSize = (sizeof(Chunk) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+
+	if (m_firstChunk->m_next)
+	{
+		// this frame didn't fit in one chunk, so swap them all for one that it would have.
+		size_t size = m_stats.m_reservedBytes;
+		freeChunks();
+		m_firstChunk = newChunk(size);
+	}
+#ifdef MEMORYPOOL_DEBUG
+	else
+	{
+		// make anyone who hangs on to frame memory past its frame find out about it quickly
+		memset((char *)m_firstChunk + headerSize, 0xdd, m_cur - ((char *)m_firstChunk + headerSize));
+	}
+#endif
+
+	m_curChunk = m_firstChunk;
+	m_cur = (char *)m_curChunk + headerSize;
+	m_end = (char *)m_curChunk + m_curChunk->m_size;
+}
+
+// ------------------------------------------------------------------------------------------------
+void FrameArena::clearStats()
+{
+	UnsignedInt reservedBytes = m_stats.m_reservedBytes;
+	m_stats.clear();
+	m_stats.m_reservedBytes = reservedBytes;
+}
+
 // ------------------------------------------------------------------------------------------------
 /** Add object ID to the lookup table */
 // ------------------------------------------------------------------------------------------------
@@ -3321,7 +4281,7 @@ void GameLogic::addObjectToLookupTable( Object *obj )
 		return;
 
 	// add to lookup
-	m_objHash[ obj->getID() ] = obj;
+	m_objTable.insert( obj->getID(), obj );
 
 }  // end addObjectToLookupTable
 
@@ -3336,7 +4296,7 @@ void GameLogic::removeObjectFromLookupTable( Object *obj )
 		return;
 
 	// remove from lookup table
-	m_objHash.erase( obj->getID() );
+	m_objTable.erase( obj->getID(), obj );
 
 }  // end removeObjectFromLookupTable
 
@@ -3455,6 +4415,85 @@ void GameLogic::destroyObject( Object *obj )
 
 }  // end destroyObject
 
+#ifdef TEST_XFER_CRC
+// ------------------------------------------------------------------------------------------------
+static Bool s_comparingXferCRC = FALSE;
+static Bool s_useReferenceXferCRC = FALSE;
+
+/** Work out the CRC both the old way and the new, on the real game state, and check they agree.
+	Keeps a running total of the time each takes. */
+static UnsignedInt compareXferCRC( GameLogic *logic )
+{
+	static Bool s_ranXferCRCTest = FALSE;
+	static double s_refSeconds = 0.0;
+	static double s_fastSeconds = 0.0;
+	static Int s_numCRCs = 0;
+
+	if (!s_ranXferCRCTest)
+	{
+		s_ranXferCRCTest = TRUE;
+		doXferCRCTest();
+	}
+
+	s_comparingXferCRC = TRUE;
+
+	s_useReferenceXferCRC = TRUE;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	UnsignedInt refCRC = logic->getCRC( CRC_RECALC );
+	s_refSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	s_useReferenceXferCRC = FALSE;
+	start = std::chrono::steady_clock::now();
+	UnsignedInt theCRC = logic->getCRC( CRC_RECALC );
+	s_fastSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	s_comparingXferCRC = FALSE;
+
+	DEBUG_ASSERTCRASH( theCRC == refCRC, ("XferCRC gives 0x%8.8X, the reference gives 0x%8.8X on frame %d\n",
+		theCRC, refCRC, logic->getFrame()) );
+
+	if (++s_numCRCs % 100 == 0)
+	{
+		DEBUG_LOG(( "XferCRC - %d game CRCs, %.3fms each (reference %.3fms), %.2fx\n", s_numCRCs,
+			s_fastSeconds * 1000.0 / s_numCRCs, s_refSeconds * 1000.0 / s_numCRCs,
+			s_fastSeconds > 0.0 ? s_refSeconds / s_fastSeconds : 0.0 ));
+	}
+
+	return theCRC;
+}
+#endif
+
+#ifdef DEBUG_CRC
+// ------------------------------------------------------------------------------------------------
+/** Crash if the object's cached CRC doesn't match what it really is now: something changed a
+	bit of state that Object::crc looks at without calling markCRCDirty. */
+// ------------------------------------------------------------------------------------------------
+static void verifyObjectCRC( Object *obj, void * )
+{
+	if (!obj->isObjectCRCCached())
+		return;
+
+	UnsignedInt cachedCRC = obj->getObjectCRC( TRUE );
+	UnsignedInt freshCRC = obj->getObjectCRC( FALSE );
+	DEBUG_ASSERTCRASH( cachedCRC == freshCRC, ("Object %d (%s) has a cached CRC of 0x%8.8X but is really 0x%8.8X - something changed it without marking it dirty\n",
+		obj->getID(), obj->getTemplate()->getName().str(), cachedCRC, freshCRC) );
+}
+#endif // DEBUG_CRC
+
+// ------------------------------------------------------------------------------------------------
+struct ObjectCRCGatherInfo
+{
+	std::vector<UnsignedInt> *crcs;
+	Bool useCache;
+};
+
+// ------------------------------------------------------------------------------------------------
+static void gatherObjectCRC( Object *obj, void *userData )
+{
+	ObjectCRCGatherInfo *info = (ObjectCRCGatherInfo *)userData;
+	info->crcs->push_back( obj->getObjectCRC( info->useCache ) );
+}
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 Bool inCRCGen = FALSE;
@@ -3463,6 +4502,11 @@ UnsignedInt GameLogic::getCRC( Int mode, AsciiString deepCRCFileName )
 	if (mode != CRC_RECALC)
 		return m_CRC;
 
+#ifdef TEST_XFER_CRC
+	if (deepCRCFileName.isEmpty() && !s_comparingXferCRC)
+		return compareXferCRC( this );
+#endif
+
 	setFPMode();
 
 	LatchRestore<Bool> latch(inCRCGen, !isInGameLogicUpdate());
@@ -3486,6 +4530,11 @@ UnsignedInt GameLogic::getCRC( Int mode, AsciiString deepCRCFileName )
 		else
 #endif // DEBUG_CRC
 		{
+#ifdef TEST_XFER_CRC
+			if (s_useReferenceXferCRC)
+				xferCRC = NEW XferCRCReference;
+			else
+#endif
 			xferCRC = NEW XferCRC;
 			crcName = "lightCRC";
 		}
@@ -3500,11 +4549,44 @@ UnsignedInt GameLogic::getCRC( Int mode, AsciiString deepCRCFileName )
 		CRCGEN_LOG(("CRC at start of frame %d is 0x%8.8X\n", m_frame, xferCRC->getCRC()));
 	}
 
+	//
+	// The light CRC adds up one CRC per object, in ID order, and objects keep theirs from one
+	// CRC to the next until something about them changes.  Only the CRC done as part of the
+	// logic update may refresh the caches, so every machine refreshes them on the same frames
+	// no matter who else asks for a CRC in between.  The deep CRC still walks everything, and
+	// checks the caches against it while it's there.
+	//
+	Bool incremental = (xferCRC->getXferMode() == XFER_CRC);
 	marker = "MARKER:Objects";
 	xferCRC->xferAsciiString(&marker);
-	for( obj = m_objList; obj; obj=obj->getNextObject() )
+	if (incremental)
+	{
+#ifdef DEBUG_CRC
+		if (g_verifyIncrementalCRC)
+			m_objTable.iterate( verifyObjectCRC, NULL );
+#endif // DEBUG_CRC
+
+		ObjectCRCGatherInfo info;
+		info.crcs = &m_objectCRCs;
+		info.useCache = isInGameLogicUpdate();
+#ifdef DEBUG_CRC
+		if (g_logObjectCRCs)
+			info.useCache = FALSE;	// so every object gets logged
+#endif // DEBUG_CRC
+		m_objectCRCs.clear();
+		m_objTable.iterate( gatherObjectCRC, &info );
+		if (!m_objectCRCs.empty())
+			xferCRC->xferUser( &m_objectCRCs[0], m_objectCRCs.size() * sizeof(UnsignedInt) );
+	}
+	else
 	{
-		xferCRC->xferSnapshot( obj );
+		for( obj = m_objList; obj; obj=obj->getNextObject() )
+		{
+#ifdef DEBUG_CRC
+			verifyObjectCRC( obj, NULL );
+#endif // DEBUG_CRC
+			xferCRC->xferSnapshot( obj );
+		}
 	}
 	UnsignedInt seed = GetGameLogicRandomSeedCRC();
 	if (isInGameLogicUpdate())
@@ -3522,7 +4604,21 @@ UnsignedInt GameLogic::getCRC( Int mode, AsciiString deepCRCFileName )
 	}
 	marker = "MARKER:ThePartitionManager";
 	xferCRC->xferAsciiString(&marker);
-	xferCRC->xferSnapshot( ThePartitionManager );
+	if (incremental)
+	{
+#ifdef DEBUG_CRC
+		if (g_verifyIncrementalCRC)
+			ThePartitionManager->verifyCellCRCs();
+#endif // DEBUG_CRC
+		ThePartitionManager->xferCellCRCs( xferCRC, isInGameLogicUpdate() );
+	}
+	else
+	{
+#ifdef DEBUG_CRC
+		ThePartitionManager->verifyCellCRCs();
+#endif // DEBUG_CRC
+		xferCRC->xferSnapshot( ThePartitionManager );
+	}
 	if (isInGameLogicUpdate())
 	{
 		CRCGEN_LOG(("CRC after partition manager for frame %d is 0x%8.8X\n", m_frame, xferCRC->getCRC()));
@@ -3879,7 +4975,8 @@ Bool GameLogic::findControlBarOverride(const AsciiString& commandSetName, Int sl
 
 #ifdef DUMP_PERF_STATS
 // ------------------------------------------------------------------------------------------------
-void GameLogic::getAIMetricsStatistics( UnsignedInt *numAI, UnsignedInt *numMoving, UnsignedInt *numAttacking, UnsignedInt *numWaitingForPath, UnsignedInt *overallFailedPathfinds )
+void GameLogic::getAIMetricsStatistics( UnsignedInt *numAI, UnsignedInt *numMoving, UnsignedInt *numAttacking, UnsignedInt *numWaitingForPath, UnsignedInt *overallFailedPathfinds,
+	UnsignedInt *pathCacheHits, UnsignedInt *pathCacheMisses )
 {
 	Object *obj;
 	*numAI = 0;
@@ -3908,6 +5005,8 @@ void GameLogic::getAIMetricsStatistics( UnsignedInt *numAI, UnsignedInt *numMovi
 		}
 	}
 	*overallFailedPathfinds = m_overallFailedPathfinds;
+	*pathCacheHits = m_pathCacheHits;
+	*pathCacheMisses = m_pathCacheMisses;
 }
 #endif
 
@@ -4467,11 +5566,8 @@ void GameLogic::loadPostProcess( void )
 			m_nextObjID = (ObjectID)((UnsignedInt)obj->getID() + 1);
 
 	// blow away the sleepy update and normal update module lists
-	for (std::vector<UpdateModulePtr>::iterator it = m_sleepyUpdates.begin(); it != m_sleepyUpdates.end(); ++it)
-	{
-		(*it)->friend_setIndexInLogic(-1);
-	}
-	m_sleepyUpdates.clear();
+	clearSleepyUpdates();
+	m_sleepyWheelFrame = TheGameLogic->getFrame();
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	m_normalUpdates.clear();
 #else
@@ -4513,17 +5609,13 @@ void GameLogic::loadPostProcess( void )
 				u->friend_setNextCallFrame(now);
 #endif
 			{
-				m_sleepyUpdates.push_back(u);
-				u->friend_setIndexInLogic(m_sleepyUpdates.size() - 1);
+				pushSleepyUpdate(u);
 			}
 				
 		}  // end for, u
 
 	}  // end for, obj
 
-	// re-sort the priority queue all at once now that all modules are on it
-	remakeSleepyUpdate();
-
 }  // end loadPostProcess
 
 
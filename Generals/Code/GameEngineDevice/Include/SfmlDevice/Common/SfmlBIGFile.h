@@ -35,14 +35,73 @@
 #include "Common/ArchiveFile.h"
 #include "Common/AsciiString.h"
 
+//#define TEST_BIG_ARCHIVE        ///< time mounting the archives and opening every file in them, the old way and the new
+
+#include <cstddef>
+#include <vector>
+
 class SfmlBIGFile : public ArchiveFile
 {
 public:
+        enum { MAX_PATH_LENGTH = 1024 };
+
+        /// One file in the archive.  The paths all live in one block of names, lower case, with '\\' between directories.
+        struct IndexEntry
+        {
+                UnsignedInt m_nameOffset;
+                UnsignedInt m_offset;
+                UnsignedInt m_size;
+        };
+
         SfmlBIGFile();
         virtual ~SfmlBIGFile();
 
         void initializeMetadata(const AsciiString& name, const AsciiString& path);
 
+        /// Which archive on disk this is, and the size and time it had when its index was made.
+        void setArchiveStamp(const AsciiString& filename, UnsignedInt64 size, UnsignedInt64 time);
+        const AsciiString& getArchiveFilename(void) const { return m_archiveFilename; }
+        UnsignedInt64 getArchiveSize(void) const { return m_archiveSize; }
+        UnsignedInt64 getArchiveTime(void) const { return m_archiveTime; }
+
+        /// Map the whole archive into memory, so its files can be read straight out of it.
+        Bool mapImage(const Char* filename);
+        const unsigned char* getImage(void) const { return m_image; }
+        size_t getImageSize(void) const { return m_imageSize; }
+
+        /// Don't open the archive until the first time a file is opened out of it.
+        void openArchiveLater(Bool mapImage);
+        Bool isArchiveOpen(void) const { return !m_openLater; }
+
+        /// Add a file to the index.  The index has to be sorted before anything is looked up in it.
+        void addIndexEntry(const char* path, UnsignedInt offset, UnsignedInt size);
+        void sortIndex(void);
+
+        /// Use an index that was made earlier.  It isn't copied, so it has to stay put until makeIndexOwned().
+        void useIndex(const IndexEntry* entries, Int numEntries, const char* names, Int namesSize);
+        void makeIndexOwned(void);
+        Bool isIndexOwned(void) const { return m_indexEntries == m_index.data() || m_numIndexEntries == 0; }
+
+        Int getNumIndexEntries(void) const { return m_numIndexEntries; }
+        const IndexEntry* getIndexEntries(void) const { return m_indexEntries; }
+        const char* getIndexNames(void) const { return m_indexNames; }
+        Int getIndexNamesSize(void) const { return m_indexNamesSize; }
+        const char* getIndexPath(const IndexEntry& entry) const { return m_indexNames + entry.m_nameOffset; }
+        const IndexEntry* findIndexEntry(const Char* filename) const;
+
+        /// Lower case, with '\\' between directories and no empty directories.  Returns the length, or -1 if it doesn't fit.
+        static Int normalizePath(const char* src, char* dest, Int destSize);
+
+        /// The start of every normalized path in directory.  Returns its length, or -1 if it doesn't fit.
+        static Int makeDirectoryPrefix(const AsciiString& directory, char* prefix, Int prefixSize);
+
+        /// Add a normalized path to filenameList if it matches searchName, named the way getFileListInDirectory() names things.
+        static void addToFileList(const char* path, Int prefixLength, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList& filenameList);
+
+        /// Map a whole file into memory, read only.  Returns NULL if it can't.
+        static const unsigned char* mapFile(const Char* filename, size_t* size);
+        static void unmapFile(const unsigned char* image, size_t size);
+
         virtual File* openFile(const Char* filename, Int access = 0);
         virtual void closeAllFiles(void);
         virtual AsciiString getName(void);
@@ -50,10 +109,39 @@ public:
         virtual void setSearchPriority(Int new_priority);
         virtual void close(void);
         virtual Bool getFileInfo(const AsciiString& filename, FileInfo* fileInfo) const;
+        virtual Bool getFileLocation(const AsciiString& filename, UnsignedInt* offset, UnsignedInt* size) const;
+        virtual void getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList& filenameList, Bool searchSubdirectories) const;
+
+#ifdef TEST_BIG_ARCHIVE
+        File* openFileFromDirectoryTree(const Char* filename);     ///< the way files were opened before the index, for comparison
+#endif
 
 protected:
+        typedef std::vector<IndexEntry> IndexEntryList;
+
+        Bool openArchive(void);
+        void unmapImage(void);
+        void useOwnedIndex(void);
+
         AsciiString m_name;
         AsciiString m_path;
+
+        AsciiString m_archiveFilename;
+        UnsignedInt64 m_archiveSize;
+        UnsignedInt64 m_archiveTime;
+        Bool m_openLater;                       ///< archive hasn't been opened yet
+        Bool m_mapWhenOpened;
+
+        IndexEntryList m_index;                 ///< the index, if we made it ourselves
+        std::vector<char> m_names;
+
+        const IndexEntry* m_indexEntries;       ///< the index we use, sorted by path
+        Int m_numIndexEntries;
+        const char* m_indexNames;
+        Int m_indexNamesSize;
+
+        const unsigned char* m_image;           ///< the whole archive, if it could be mapped
+        size_t m_imageSize;
 };
 
 #endif // __SFMLBIGFILE_H
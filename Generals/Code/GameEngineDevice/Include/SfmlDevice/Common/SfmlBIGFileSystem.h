@@ -34,6 +34,12 @@
 #define __SFMLBIGFILESYSTEM_H
 
 #include "Common/ArchiveFileSystem.h"
+#include "SfmlDevice/Common/SfmlBIGFile.h"
+
+#include <map>
+#include <vector>
+
+//#define TEST_BIG_INDEX_CACHE        ///< check the archive index cache notices archives being added, removed and changed
 
 class SfmlBIGFileSystem : public ArchiveFileSystem
 {
@@ -51,7 +57,66 @@ public:
         virtual void closeAllArchiveFiles(void);
         virtual void closeAllFiles(void);
 
+        virtual File* openFile(const Char* filename, Int access = 0);
+        virtual Bool doesFileExist(const Char* filename) const;
+        virtual void getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList& filenameList, Bool searchSubdirectories) const;
+        virtual AsciiString getArchiveFilenameForFile(const AsciiString& filename) const;
+
         virtual Bool loadBigFilesFromDirectory(AsciiString dir, AsciiString fileMask, Bool overwrite = FALSE);
+
+protected:
+        /// A file in one of the mounted archives, the one that wins if it's in more than one of them.
+        struct MergedIndexEntry
+        {
+                SfmlBIGFile* m_archive;
+                Int m_entry;                            ///< in m_archive's index
+        };
+
+        typedef std::vector<MergedIndexEntry> MergedIndexEntryList;
+
+        /// An archive's index, as it was saved in the index cache.
+        struct CachedArchiveIndex
+        {
+                UnsignedInt64 m_archiveSize;
+                UnsignedInt64 m_archiveTime;
+                const SfmlBIGFile::IndexEntry* m_entries;
+                Int m_numEntries;
+                const char* m_names;
+                Int m_namesSize;
+                Bool m_used;                            ///< an archive was mounted with this index
+        };
+
+        typedef std::map<AsciiString, CachedArchiveIndex> CachedArchiveIndexMap;
+
+        virtual void loadIntoDirectoryTree(const ArchiveFile* archiveFile, const AsciiString& archiveFilename, Bool overwrite = FALSE);
+
+        Bool mountArchive(const AsciiString& filename, Bool overwrite);
+        const MergedIndexEntry* findMergedIndexEntry(const Char* filename) const;
+        const char* getMergedIndexPath(const MergedIndexEntry& entry) const;
+
+        void openIndexCache(void);
+        void closeIndexCache(void);
+        void saveIndexCache(void);
+
+#ifdef TEST_BIG_ARCHIVE
+        SfmlBIGFile* openArchiveFileOneEntryAtATime(const Char* filename);
+        void doArchiveTest(void);
+#endif
+#ifdef TEST_BIG_INDEX_CACHE
+        static void doIndexCacheTest(void);
+#endif
+
+        Bool m_useMappedArchives;               ///< map the archives into memory, rather than reading files out of them
+        MergedIndexEntryList m_mergedIndex;     ///< every file in every mounted archive, sorted by path
+
+        Bool m_useIndexCache;                   ///< keep the archives' indexes on disk, so they don't have to be read from the archives
+        AsciiString m_indexCacheFilename;
+        const unsigned char* m_indexCacheImage; ///< the index cache, mapped into memory
+        size_t m_indexCacheImageSize;
+        CachedArchiveIndexMap m_indexCache;
+        Bool m_indexCacheChanged;               ///< an archive was added, removed or changed since the cache was saved
+        Int m_indexCacheHits;
+        Int m_indexCacheMisses;
 };
 
 #endif // __SFMLBIGFILESYSTEM_H
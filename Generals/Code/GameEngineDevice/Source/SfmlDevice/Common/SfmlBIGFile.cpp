@@ -31,14 +31,45 @@
 #include "SfmlDevice/Common/SfmlBIGFile.h"
 
 #include "Common/ArchiveFile.h"
+#include "Common/Debug.h"
 #include "Common/File.h"
 #include "Common/GameMemory.h"
 #include "Common/LocalFileSystem.h"
+#include "Common/MappedArchiveFile.h"
 #include "Common/RAMFile.h"
 #include "Common/StreamingArchiveFile.h"
 
-SfmlBIGFile::SfmlBIGFile() = default;
-SfmlBIGFile::~SfmlBIGFile() = default;
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SfmlBIGFile::SfmlBIGFile()
+        : m_archiveSize(0),
+          m_archiveTime(0),
+          m_openLater(FALSE),
+          m_mapWhenOpened(FALSE),
+          m_indexEntries(NULL),
+          m_numIndexEntries(0),
+          m_indexNames(NULL),
+          m_indexNamesSize(0),
+          m_image(NULL),
+          m_imageSize(0)
+{
+}
+
+SfmlBIGFile::~SfmlBIGFile()
+{
+        unmapImage();
+}
 
 void SfmlBIGFile::initializeMetadata(const AsciiString& name, const AsciiString& path)
 {
@@ -46,37 +77,321 @@ void SfmlBIGFile::initializeMetadata(const AsciiString& name, const AsciiString&
         m_path = path;
 }
 
-File* SfmlBIGFile::openFile(const Char* filename, Int access)
+// "Data/INI//Foo.ini" and "data\\ini\\foo.ini" both come out as the latter
+Int SfmlBIGFile::normalizePath(const char* src, char* dest, Int destSize)
 {
-        const ArchivedFileInfo* fileInfo = getArchivedFileInfo(AsciiString(filename));
-        if (fileInfo == NULL)
+        Int length = 0;
+        Bool needSeparator = FALSE;
+        for (; *src != '\0'; ++src)
+        {
+                if (*src == '\\' || *src == '/')
+                {
+                        needSeparator = (length > 0);
+                        continue;
+                }
+
+                if (length + (needSeparator ? 2 : 1) >= destSize)
+                {
+                        return -1;
+                }
+
+                if (needSeparator)
+                {
+                        dest[length++] = '\\';
+                        needSeparator = FALSE;
+                }
+                dest[length++] = static_cast<char>(std::tolower(static_cast<unsigned char>(*src)));
+        }
+
+        dest[length] = '\0';
+        return length;
+}
+
+const unsigned char* SfmlBIGFile::mapFile(const Char* filename, size_t* size)
+{
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
         {
                 return NULL;
         }
 
-        RAMFile* ramFile = NULL;
-        if (BitTest(access, File::STREAMING))
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
         {
-                ramFile = newInstance(StreamingArchiveFile);
+                mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
         }
-        else
+        CloseHandle(file);
+        if (mapping == NULL)
         {
-                ramFile = newInstance(RAMFile);
+                return NULL;
         }
 
-        if (ramFile == NULL)
+        // the view keeps the mapping alive
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == NULL)
         {
                 return NULL;
         }
 
-        ramFile->deleteOnClose();
-        if (ramFile->openFromArchive(m_file, fileInfo->m_filename, fileInfo->m_offset, fileInfo->m_size) == FALSE)
+        *size = static_cast<size_t>(fileSize.QuadPart);
+        return static_cast<const unsigned char*>(view);
+#else
+        int fd = ::open(filename, O_RDONLY);
+        if (fd == -1)
+        {
+                return NULL;
+        }
+
+        struct stat fileStat;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+        {
+                view = mmap(NULL, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (view == MAP_FAILED)
+        {
+                return NULL;
+        }
+
+        *size = static_cast<size_t>(fileStat.st_size);
+        return static_cast<const unsigned char*>(view);
+#endif
+}
+
+void SfmlBIGFile::unmapFile(const unsigned char* image, size_t size)
+{
+        if (image == NULL)
+        {
+                return;
+        }
+
+#if defined(_WIN32)
+        UnmapViewOfFile(image);
+#else
+        munmap(const_cast<unsigned char*>(image), size);
+#endif
+}
+
+void SfmlBIGFile::setArchiveStamp(const AsciiString& filename, UnsignedInt64 size, UnsignedInt64 time)
+{
+        m_archiveFilename = filename;
+        m_archiveSize = size;
+        m_archiveTime = time;
+}
+
+Bool SfmlBIGFile::mapImage(const Char* filename)
+{
+        unmapImage();
+
+        m_image = mapFile(filename, &m_imageSize);
+        if (m_image == NULL)
+        {
+                m_imageSize = 0;
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+void SfmlBIGFile::unmapImage(void)
+{
+        unmapFile(m_image, m_imageSize);
+        m_image = NULL;
+        m_imageSize = 0;
+}
+
+void SfmlBIGFile::openArchiveLater(Bool mapImage)
+{
+        m_openLater = TRUE;
+        m_mapWhenOpened = mapImage;
+}
+
+Bool SfmlBIGFile::openArchive(void)
+{
+        m_openLater = FALSE;
+
+        if (m_mapWhenOpened)
+        {
+                mapImage(m_archiveFilename.str());
+        }
+
+        File* fp = TheLocalFileSystem->openFile(m_archiveFilename.str(), File::READ | File::BINARY);
+        if (fp == NULL)
+        {
+                DEBUG_CRASH(("Could not open archive file %s", m_archiveFilename.str()));
+                unmapImage();
+                return FALSE;
+        }
+
+        attachFile(fp);
+        return TRUE;
+}
+
+void SfmlBIGFile::addIndexEntry(const char* path, UnsignedInt offset, UnsignedInt size)
+{
+        DEBUG_ASSERTCRASH(isIndexOwned(), ("Can't add to an index that was made earlier"));
+
+        char normalized[MAX_PATH_LENGTH];
+        const Int length = normalizePath(path, normalized, MAX_PATH_LENGTH);
+        if (length <= 0)
+        {
+                DEBUG_CRASH(("Bad file name '%s' in archive %s", path, m_name.str()));
+                return;
+        }
+
+        IndexEntry entry;
+        entry.m_nameOffset = static_cast<UnsignedInt>(m_names.size());
+        entry.m_offset = offset;
+        entry.m_size = size;
+        m_index.push_back(entry);
+
+        m_names.insert(m_names.end(), normalized, normalized + length + 1);
+}
+
+void SfmlBIGFile::sortIndex(void)
+{
+        const std::vector<char>& names = m_names;
+        std::stable_sort(m_index.begin(), m_index.end(), [&names](const IndexEntry& a, const IndexEntry& b)
+        {
+                return std::strcmp(&names[a.m_nameOffset], &names[b.m_nameOffset]) < 0;
+        });
+
+        // if a file is in the archive twice, the last one wins, same as it always has
+        IndexEntryList unique;
+        unique.reserve(m_index.size());
+        for (size_t i = 0; i < m_index.size(); ++i)
+        {
+                if (i + 1 < m_index.size() && std::strcmp(&names[m_index[i].m_nameOffset], &names[m_index[i + 1].m_nameOffset]) == 0)
+                {
+                        continue;
+                }
+                unique.push_back(m_index[i]);
+        }
+        m_index.swap(unique);
+
+        useOwnedIndex();
+}
+
+void SfmlBIGFile::useOwnedIndex(void)
+{
+        m_indexEntries = m_index.data();
+        m_numIndexEntries = static_cast<Int>(m_index.size());
+        m_indexNames = m_names.data();
+        m_indexNamesSize = static_cast<Int>(m_names.size());
+}
+
+void SfmlBIGFile::useIndex(const IndexEntry* entries, Int numEntries, const char* names, Int namesSize)
+{
+        m_index.clear();
+        m_names.clear();
+
+        m_indexEntries = entries;
+        m_numIndexEntries = numEntries;
+        m_indexNames = names;
+        m_indexNamesSize = namesSize;
+}
+
+void SfmlBIGFile::makeIndexOwned(void)
+{
+        if (isIndexOwned())
+        {
+                return;
+        }
+
+        m_index.assign(m_indexEntries, m_indexEntries + m_numIndexEntries);
+        m_names.assign(m_indexNames, m_indexNames + m_indexNamesSize);
+        useOwnedIndex();
+}
+
+const SfmlBIGFile::IndexEntry* SfmlBIGFile::findIndexEntry(const Char* filename) const
+{
+        char normalized[MAX_PATH_LENGTH];
+        if (normalizePath(filename, normalized, MAX_PATH_LENGTH) <= 0)
         {
-                ramFile->close();
-                ramFile = NULL;
                 return NULL;
         }
 
+        const char* names = m_indexNames;
+        const IndexEntry* end = m_indexEntries + m_numIndexEntries;
+        const IndexEntry* it = std::lower_bound(m_indexEntries, end, normalized, [names](const IndexEntry& entry, const char* path)
+        {
+                return std::strcmp(names + entry.m_nameOffset, path) < 0;
+        });
+
+        if (it == end || std::strcmp(getIndexPath(*it), normalized) != 0)
+        {
+                return NULL;
+        }
+
+        return it;
+}
+
+File* SfmlBIGFile::openFile(const Char* filename, Int access)
+{
+        const IndexEntry* entry = findIndexEntry(filename);
+        if (entry == NULL)
+        {
+                return NULL;
+        }
+
+        if (m_openLater && openArchive() == FALSE)
+        {
+                return NULL;
+        }
+
+        // archived files have always gone by just their file name, without the directories
+        const char* path = getIndexPath(*entry);
+        const char* name = std::strrchr(path, '\\');
+        AsciiString archivedName(name != NULL ? name + 1 : path);
+
+        RAMFile* ramFile = NULL;
+        if (m_image != NULL)
+        {
+                if (static_cast<size_t>(entry->m_offset) + entry->m_size > m_imageSize)
+                {
+                        DEBUG_CRASH(("%s runs past the end of archive %s", filename, m_archiveFilename.str()));
+                        return NULL;
+                }
+
+                // straight out of the mapped archive, streaming or not
+                MappedArchiveFile* mappedFile = newInstance(MappedArchiveFile);
+                mappedFile->deleteOnClose();
+                if (mappedFile->openFromImage(archivedName, reinterpret_cast<const char*>(m_image) + entry->m_offset, entry->m_size) == FALSE)
+                {
+                        mappedFile->close();
+                        return NULL;
+                }
+                ramFile = mappedFile;
+        }
+        else
+        {
+                if (BitTest(access, File::STREAMING))
+                {
+                        ramFile = newInstance(StreamingArchiveFile);
+                }
+                else
+                {
+                        ramFile = newInstance(RAMFile);
+                }
+
+                if (ramFile == NULL)
+                {
+                        return NULL;
+                }
+
+                ramFile->deleteOnClose();
+                if (ramFile->openFromArchive(m_file, archivedName, entry->m_offset, entry->m_size) == FALSE)
+                {
+                        ramFile->close();
+                        ramFile = NULL;
+                        return NULL;
+                }
+        }
+
         if ((access & File::WRITE) == 0)
         {
                 return ramFile;
@@ -94,6 +409,27 @@ File* SfmlBIGFile::openFile(const Char* filename, Int access)
         return localFile;
 }
 
+#ifdef TEST_BIG_ARCHIVE
+File* SfmlBIGFile::openFileFromDirectoryTree(const Char* filename)
+{
+        const ArchivedFileInfo* fileInfo = getArchivedFileInfo(AsciiString(filename));
+        if (fileInfo == NULL)
+        {
+                return NULL;
+        }
+
+        RAMFile* ramFile = newInstance(RAMFile);
+        ramFile->deleteOnClose();
+        if (ramFile->openFromArchive(m_file, fileInfo->m_filename, fileInfo->m_offset, fileInfo->m_size) == FALSE)
+        {
+                ramFile->close();
+                return NULL;
+        }
+
+        return ramFile;
+}
+#endif
+
 void SfmlBIGFile::closeAllFiles(void)
 {
 }
@@ -119,15 +455,85 @@ void SfmlBIGFile::close(void)
 
 Bool SfmlBIGFile::getFileInfo(const AsciiString& filename, FileInfo* fileInfo) const
 {
-        const ArchivedFileInfo* tempFileInfo = getArchivedFileInfo(filename);
-        if (tempFileInfo == NULL)
+        const IndexEntry* entry = findIndexEntry(filename.str());
+        if (entry == NULL)
         {
                 return FALSE;
         }
 
-        TheLocalFileSystem->getFileInfo(AsciiString(m_file->getName()), fileInfo);
+        TheLocalFileSystem->getFileInfo(m_archiveFilename, fileInfo);
         fileInfo->sizeHigh = 0;
-        fileInfo->sizeLow = tempFileInfo->m_size;
+        fileInfo->sizeLow = entry->m_size;
 
         return TRUE;
 }
+
+Bool SfmlBIGFile::getFileLocation(const AsciiString& filename, UnsignedInt* offset, UnsignedInt* size) const
+{
+        const IndexEntry* entry = findIndexEntry(filename.str());
+        if (entry == NULL)
+        {
+                return FALSE;
+        }
+
+        *offset = entry->m_offset;
+        *size = entry->m_size;
+        return TRUE;
+}
+
+Int SfmlBIGFile::makeDirectoryPrefix(const AsciiString& directory, char* prefix, Int prefixSize)
+{
+        Int prefixLength = normalizePath(directory.str(), prefix, prefixSize - 1);
+        if (prefixLength > 0)
+        {
+                prefix[prefixLength++] = '\\';
+                prefix[prefixLength] = '\0';
+        }
+
+        return prefixLength;
+}
+
+void SfmlBIGFile::addToFileList(const char* path, Int prefixLength, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList& filenameList)
+{
+        // like the directory tree this replaces, subdirectories are always searched
+        const char* relativePath = path + prefixLength;
+        const char* name = std::strrchr(relativePath, '\\');
+        if (searchStringMatches(AsciiString(name != NULL ? name + 1 : relativePath), searchName) == FALSE)
+        {
+                return;
+        }
+
+        AsciiString filename = originalDirectory;
+        if ((filename.getLength() > 0) && (!filename.endsWith("\\")))
+        {
+                filename.concat('\\');
+        }
+        filename.concat(relativePath);
+        filenameList.insert(filename);
+}
+
+void SfmlBIGFile::getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList& filenameList, Bool searchSubdirectories) const
+{
+        (void)currentDirectory;
+        (void)searchSubdirectories;
+
+        char prefix[MAX_PATH_LENGTH];
+        const Int prefixLength = makeDirectoryPrefix(originalDirectory, prefix, MAX_PATH_LENGTH);
+        if (prefixLength < 0)
+        {
+                return;
+        }
+
+        // everything in the directory sorts together, starting at the first path with the prefix
+        const char* names = m_indexNames;
+        const IndexEntry* end = m_indexEntries + m_numIndexEntries;
+        const IndexEntry* it = std::lower_bound(m_indexEntries, end, prefix, [names](const IndexEntry& entry, const char* path)
+        {
+                return std::strcmp(names + entry.m_nameOffset, path) < 0;
+        });
+
+        for (; it != end && std::strncmp(getIndexPath(*it), prefix, prefixLength) == 0; ++it)
+        {
+                addToFileList(getIndexPath(*it), prefixLength, originalDirectory, searchName, filenameList);
+        }
+}
@@ -43,30 +43,135 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstring>
+#include <filesystem>
 #include <string>
+#include <vector>
 
 namespace
 {
 
-UnsignedInt readBigEndianUInt32(File* file)
+enum { BIG_HEADER_SIZE = 0x10 };        ///< "BIGF", archive size, number of files, offset of the first file
+
+const UnsignedInt INDEX_CACHE_MAGIC = 0x58444942;       ///< "BIDX"
+const UnsignedInt INDEX_CACHE_VERSION = 1;
+
+/// Start of the index cache.  It's followed by one IndexCacheRecord for each archive.
+struct IndexCacheHeader
 {
-        std::array<unsigned char, 4> buffer{};
-        if (file->read(buffer.data(), static_cast<Int>(buffer.size())) != static_cast<Int>(buffer.size()))
+        UnsignedInt m_magic;
+        UnsignedInt m_version;
+        UnsignedInt m_numArchives;
+        UnsignedInt m_reserved;
+};
+
+/// One archive in the index cache.  It's followed by the archive's filename, its index entries and
+/// its names, each padded out to 4 bytes.  Everything is offsets, so it can be used where it's mapped.
+struct IndexCacheRecord
+{
+        UnsignedInt m_recordSize;               ///< including this
+        UnsignedInt m_filenameSize;             ///< including the terminator
+        UnsignedInt m_numEntries;
+        UnsignedInt m_namesSize;
+        UnsignedInt m_archiveSizeLow;
+        UnsignedInt m_archiveSizeHigh;
+        UnsignedInt m_archiveTimeLow;
+        UnsignedInt m_archiveTimeHigh;
+};
+
+const char* const INDEX_CACHE_FILENAME = "ArchiveIndexCache.dat";
+
+UnsignedInt padToUInt32(UnsignedInt size)
+{
+        return (size + 3) & ~3u;
+}
+
+/// Size and last write time of an archive, which is what says whether its cached index is still good.
+Bool getArchiveStamp(const Char* filename, UnsignedInt64* size, UnsignedInt64* time)
+{
+        std::string pathString(filename);
+        std::replace(pathString.begin(), pathString.end(), '\\', std::filesystem::path::preferred_separator);
+        const std::filesystem::path path(pathString);
+
+        std::error_code ec;
+        const uintmax_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec)
         {
-                return 0;
+                return FALSE;
         }
 
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, ec);
+        if (ec)
+        {
+                return FALSE;
+        }
+
+        *size = static_cast<UnsignedInt64>(fileSize);
+        *time = static_cast<UnsignedInt64>(writeTime.time_since_epoch().count());
+        return TRUE;
+}
+
+void writeCacheData(std::vector<char>& out, const void* src, UnsignedInt size)
+{
+        out.insert(out.end(), static_cast<const char*>(src), static_cast<const char*>(src) + size);
+        out.resize(padToUInt32(static_cast<UnsignedInt>(out.size())), 0);
+}
+
+UnsignedInt readBigEndianUInt32(const unsigned char* buffer)
+{
         return (static_cast<UnsignedInt>(buffer[0]) << 24) |
                (static_cast<UnsignedInt>(buffer[1]) << 16) |
                (static_cast<UnsignedInt>(buffer[2]) << 8) |
                static_cast<UnsignedInt>(buffer[3]);
 }
 
+#ifdef TEST_BIG_ARCHIVE
+using Clock = std::chrono::steady_clock;
+
+UnsignedInt microsecondsSince(Clock::time_point startTime)
+{
+        return static_cast<UnsignedInt>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime).count());
+}
+
+UnsignedInt readBigEndianUInt32(File* file)
+{
+        std::array<unsigned char, 4> buffer{};
+        if (file->read(buffer.data(), static_cast<Int>(buffer.size())) != static_cast<Int>(buffer.size()))
+        {
+                return 0;
+        }
+
+        return readBigEndianUInt32(buffer.data());
+}
+#endif
+
 } // anonymous namespace
 
-SfmlBIGFileSystem::SfmlBIGFileSystem() = default;
-SfmlBIGFileSystem::~SfmlBIGFileSystem() = default;
+SfmlBIGFileSystem::SfmlBIGFileSystem()
+        : m_useMappedArchives(TRUE),
+          m_useIndexCache(TRUE),
+          m_indexCacheFilename(INDEX_CACHE_FILENAME),
+          m_indexCacheImage(NULL),
+          m_indexCacheImageSize(0),
+          m_indexCacheChanged(FALSE),
+          m_indexCacheHits(0),
+          m_indexCacheMisses(0)
+{
+}
+
+SfmlBIGFileSystem::~SfmlBIGFileSystem()
+{
+        // the archives may still be looking at indexes in the cache
+        for (ArchiveFileMap::iterator it = m_archiveFileMap.begin(); it != m_archiveFileMap.end(); ++it)
+        {
+                delete it->second;
+        }
+        m_archiveFileMap.clear();
+        m_mergedIndex.clear();
+
+        closeIndexCache();
+}
 
 void SfmlBIGFileSystem::init(void)
 {
@@ -76,7 +181,18 @@ void SfmlBIGFileSystem::init(void)
                 return;
         }
 
+#ifdef TEST_BIG_INDEX_CACHE
+        doIndexCacheTest();
+#endif
+
+        openIndexCache();
         loadBigFilesFromDirectory("", "*.big");
+        DEBUG_LOG(("SfmlBIGFileSystem::init - mounted %d archives with %d files, %d indexes came from the index cache and %d were read from their archives\n",
+                static_cast<Int>(m_archiveFileMap.size()), static_cast<Int>(m_mergedIndex.size()), m_indexCacheHits, m_indexCacheMisses));
+
+#ifdef TEST_BIG_ARCHIVE
+        doArchiveTest();
+#endif
 }
 
 void SfmlBIGFileSystem::reset(void)
@@ -89,42 +205,191 @@ void SfmlBIGFileSystem::update(void)
 
 void SfmlBIGFileSystem::postProcessLoad(void)
 {
+        // mods are mounted by now, so this is everything that's going to be in the cache
+        saveIndexCache();
 }
 
-ArchiveFile* SfmlBIGFileSystem::openArchiveFile(const Char* filename)
+void SfmlBIGFileSystem::openIndexCache(void)
 {
-        File* fp = TheLocalFileSystem->openFile(filename, File::READ | File::BINARY);
-        if (fp == NULL)
+        closeIndexCache();
+        if (m_useIndexCache == FALSE)
         {
-                DEBUG_CRASH(("Could not open archive file %s for parsing", filename));
-                return NULL;
+                return;
         }
 
-        AsciiString archiveFileName(filename);
-        archiveFileName.toLower();
+        m_indexCacheImage = SfmlBIGFile::mapFile(m_indexCacheFilename.str(), &m_indexCacheImageSize);
+        if (m_indexCacheImage == NULL)
+        {
+                DEBUG_LOG(("SfmlBIGFileSystem::openIndexCache - no archive index cache in '%s', starting a new one\n", m_indexCacheFilename.str()));
+                m_indexCacheImageSize = 0;
+                m_indexCacheChanged = TRUE;
+                return;
+        }
 
-        const char bigIdentifier[] = "BIGF";
-        std::array<char, 1024> buffer{};
-        fp->read(buffer.data(), 4);
-        buffer[4] = 0;
+        // every size and offset is checked before anything is used, a damaged cache just gets thrown away
+        const unsigned char* pos = m_indexCacheImage;
+        const unsigned char* end = m_indexCacheImage + m_indexCacheImageSize;
+        IndexCacheHeader header;
+        Bool valid = (m_indexCacheImageSize >= sizeof(header));
+        if (valid)
+        {
+                std::memcpy(&header, pos, sizeof(header));
+                pos += sizeof(header);
+                valid = (header.m_magic == INDEX_CACHE_MAGIC && header.m_version == INDEX_CACHE_VERSION);
+        }
 
-        if (std::strncmp(buffer.data(), bigIdentifier, 4) != 0)
+        for (UnsignedInt i = 0; valid && i < header.m_numArchives; ++i)
         {
-                DEBUG_CRASH(("Error reading BIG file identifier in file %s", filename));
-                fp->close();
-                return NULL;
+                IndexCacheRecord record;
+                if (static_cast<size_t>(end - pos) < sizeof(record))
+                {
+                        valid = FALSE;
+                        break;
+                }
+                std::memcpy(&record, pos, sizeof(record));
+
+                const UnsignedInt filenameOffset = sizeof(record);
+                const UnsignedInt entriesOffset = filenameOffset + padToUInt32(record.m_filenameSize);
+                const UnsignedInt namesOffset = entriesOffset + record.m_numEntries * sizeof(SfmlBIGFile::IndexEntry);
+                if (record.m_filenameSize == 0 || record.m_filenameSize > SfmlBIGFile::MAX_PATH_LENGTH ||
+                                record.m_numEntries > (m_indexCacheImageSize / sizeof(SfmlBIGFile::IndexEntry)) ||
+                                record.m_namesSize > m_indexCacheImageSize ||
+                                record.m_recordSize != namesOffset + padToUInt32(record.m_namesSize) ||
+                                record.m_recordSize > static_cast<size_t>(end - pos))
+                {
+                        valid = FALSE;
+                        break;
+                }
+
+                const char* filename = reinterpret_cast<const char*>(pos + filenameOffset);
+                const SfmlBIGFile::IndexEntry* entries = reinterpret_cast<const SfmlBIGFile::IndexEntry*>(pos + entriesOffset);
+                const char* names = reinterpret_cast<const char*>(pos + namesOffset);
+                valid = (filename[record.m_filenameSize - 1] == '\0') && (record.m_namesSize == 0 || names[record.m_namesSize - 1] == '\0');
+                for (UnsignedInt entry = 0; valid && entry < record.m_numEntries; ++entry)
+                {
+                        valid = (entries[entry].m_nameOffset < record.m_namesSize);
+                }
+                if (valid == FALSE)
+                {
+                        break;
+                }
+
+                CachedArchiveIndex& cached = m_indexCache[AsciiString(filename)];
+                cached.m_archiveSize = (static_cast<UnsignedInt64>(record.m_archiveSizeHigh) << 32) | record.m_archiveSizeLow;
+                cached.m_archiveTime = (static_cast<UnsignedInt64>(record.m_archiveTimeHigh) << 32) | record.m_archiveTimeLow;
+                cached.m_entries = entries;
+                cached.m_numEntries = static_cast<Int>(record.m_numEntries);
+                cached.m_names = names;
+                cached.m_namesSize = static_cast<Int>(record.m_namesSize);
+                cached.m_used = FALSE;
+
+                pos += record.m_recordSize;
+        }
+
+        if (valid == FALSE)
+        {
+                DEBUG_LOG(("SfmlBIGFileSystem::openIndexCache - archive index cache '%s' is out of date or damaged, starting a new one\n", m_indexCacheFilename.str()));
+                closeIndexCache();
+                m_indexCacheChanged = TRUE;
+                return;
         }
 
-        const Int archiveFileSize = static_cast<Int>(readBigEndianUInt32(fp));
-        (void)archiveFileSize;
+        DEBUG_LOG(("SfmlBIGFileSystem::openIndexCache - %d archives in index cache '%s'\n", static_cast<Int>(m_indexCache.size()), m_indexCacheFilename.str()));
+}
 
-        const Int numLittleFiles = static_cast<Int>(readBigEndianUInt32(fp));
+void SfmlBIGFileSystem::closeIndexCache(void)
+{
+        m_indexCache.clear();
+        SfmlBIGFile::unmapFile(m_indexCacheImage, m_indexCacheImageSize);
+        m_indexCacheImage = NULL;
+        m_indexCacheImageSize = 0;
+}
 
-        fp->seek(0x10, File::START);
+void SfmlBIGFileSystem::saveIndexCache(void)
+{
+        if (m_useIndexCache == FALSE)
+        {
+                return;
+        }
+
+        // archives that weren't mounted this time have gone away, or aren't wanted any more
+        for (CachedArchiveIndexMap::const_iterator it = m_indexCache.begin(); it != m_indexCache.end(); ++it)
+        {
+                if (it->second.m_used == FALSE)
+                {
+                        m_indexCacheChanged = TRUE;
+                }
+        }
+
+        if (m_indexCacheChanged == FALSE)
+        {
+                return;
+        }
+
+        // the cache is about to be overwritten, so nothing can be looking at it any more
+        for (ArchiveFileMap::iterator it = m_archiveFileMap.begin(); it != m_archiveFileMap.end(); ++it)
+        {
+                static_cast<SfmlBIGFile*>(it->second)->makeIndexOwned();
+        }
+        closeIndexCache();
+
+        std::vector<char> out;
+        IndexCacheHeader header;
+        header.m_magic = INDEX_CACHE_MAGIC;
+        header.m_version = INDEX_CACHE_VERSION;
+        header.m_numArchives = 0;
+        header.m_reserved = 0;
+        writeCacheData(out, &header, sizeof(header));
+
+        for (ArchiveFileMap::const_iterator it = m_archiveFileMap.begin(); it != m_archiveFileMap.end(); ++it)
+        {
+                const SfmlBIGFile* archive = static_cast<const SfmlBIGFile*>(it->second);
+                const AsciiString& filename = archive->getArchiveFilename();
+                if (archive->getArchiveSize() == 0 || filename.getLength() >= SfmlBIGFile::MAX_PATH_LENGTH)
+                {
+                        continue;       // we couldn't tell when it changes, so it can't be cached
+                }
+
+                IndexCacheRecord record;
+                record.m_filenameSize = filename.getLength() + 1;
+                record.m_numEntries = static_cast<UnsignedInt>(archive->getNumIndexEntries());
+                record.m_namesSize = static_cast<UnsignedInt>(archive->getIndexNamesSize());
+                record.m_recordSize = sizeof(record) + padToUInt32(record.m_filenameSize) +
+                        record.m_numEntries * sizeof(SfmlBIGFile::IndexEntry) + padToUInt32(record.m_namesSize);
+                record.m_archiveSizeLow = static_cast<UnsignedInt>(archive->getArchiveSize());
+                record.m_archiveSizeHigh = static_cast<UnsignedInt>(archive->getArchiveSize() >> 32);
+                record.m_archiveTimeLow = static_cast<UnsignedInt>(archive->getArchiveTime());
+                record.m_archiveTimeHigh = static_cast<UnsignedInt>(archive->getArchiveTime() >> 32);
+
+                writeCacheData(out, &record, sizeof(record));
+                writeCacheData(out, filename.str(), record.m_filenameSize);
+                writeCacheData(out, archive->getIndexEntries(), record.m_numEntries * sizeof(SfmlBIGFile::IndexEntry));
+                writeCacheData(out, archive->getIndexNames(), record.m_namesSize);
+                ++header.m_numArchives;
+        }
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        File* file = TheLocalFileSystem->openFile(m_indexCacheFilename.str(), File::WRITE | File::CREATE | File::TRUNCATE | File::BINARY);
+        if (file != NULL && file->write(out.data(), static_cast<Int>(out.size())) == static_cast<Int>(out.size()))
+        {
+                DEBUG_LOG(("SfmlBIGFileSystem::saveIndexCache - wrote %d archives (%d bytes) to index cache '%s'\n",
+                        header.m_numArchives, static_cast<Int>(out.size()), m_indexCacheFilename.str()));
+        }
+        else
+        {
+                DEBUG_LOG(("SfmlBIGFileSystem::saveIndexCache - could not write index cache '%s'\n", m_indexCacheFilename.str()));
+        }
+        if (file != NULL)
+        {
+                file->close();
+        }
+
+        m_indexCacheChanged = FALSE;
+}
 
-        ArchivedFileInfo* fileInfo = NEW ArchivedFileInfo;
+ArchiveFile* SfmlBIGFileSystem::openArchiveFile(const Char* filename)
+{
         SfmlBIGFile* sfmlBigFile = NEW SfmlBIGFile;
-        ArchiveFile* archiveFile = sfmlBigFile;
 
         std::string fullPathString(filename);
         const std::string::size_type lastSeparator = fullPathString.find_last_of("\\/");
@@ -143,14 +408,136 @@ ArchiveFile* SfmlBIGFileSystem::openArchiveFile(const Char* filename)
 
         sfmlBigFile->initializeMetadata(archiveName, archivePath);
 
+        UnsignedInt64 stampSize = 0;
+        UnsignedInt64 stampTime = 0;
+        const Bool haveStamp = getArchiveStamp(filename, &stampSize, &stampTime);
+        sfmlBigFile->setArchiveStamp(AsciiString(filename), stampSize, stampTime);
+
+        // if the archive hasn't changed since we last saw it, its index can come straight out of the cache,
+        // and the archive itself doesn't need opening until something is read out of it
+        if (m_useIndexCache && haveStamp)
+        {
+                CachedArchiveIndexMap::iterator cached = m_indexCache.find(AsciiString(filename));
+                if (cached != m_indexCache.end() && cached->second.m_archiveSize == stampSize && cached->second.m_archiveTime == stampTime)
+                {
+                        sfmlBigFile->useIndex(cached->second.m_entries, cached->second.m_numEntries, cached->second.m_names, cached->second.m_namesSize);
+                        sfmlBigFile->openArchiveLater(m_useMappedArchives);
+                        cached->second.m_used = TRUE;
+                        ++m_indexCacheHits;
+                        return sfmlBigFile;
+                }
+
+                m_indexCacheChanged = TRUE;
+        }
+        ++m_indexCacheMisses;
+
+        File* fp = TheLocalFileSystem->openFile(filename, File::READ | File::BINARY);
+        if (fp == NULL)
+        {
+                DEBUG_CRASH(("Could not open archive file %s for parsing", filename));
+                delete sfmlBigFile;
+                return NULL;
+        }
+
+        // With the archive mapped, the header is already sitting in memory.  Otherwise it's
+        // everything up to the first file, so it can be pulled in with one read.
+        const Int archiveSize = fp->size();
+        std::vector<unsigned char> headerBuffer;
+        const unsigned char* header = NULL;
+        Int headerSize = 0;
+        if (m_useMappedArchives && sfmlBigFile->mapImage(filename))
+        {
+                header = sfmlBigFile->getImage();
+                headerSize = static_cast<Int>(sfmlBigFile->getImageSize());
+        }
+        else
+        {
+                headerBuffer.resize(BIG_HEADER_SIZE);
+                headerSize = fp->read(headerBuffer.data(), BIG_HEADER_SIZE);
+                if (headerSize == BIG_HEADER_SIZE)
+                {
+                        UnsignedInt firstFileOffset = readBigEndianUInt32(&headerBuffer[12]);
+                        if (firstFileOffset <= BIG_HEADER_SIZE || firstFileOffset > static_cast<UnsignedInt>(archiveSize))
+                        {
+                                firstFileOffset = archiveSize;
+                        }
+
+                        headerBuffer.resize(firstFileOffset);
+                        const Int bytesRead = fp->read(headerBuffer.data() + BIG_HEADER_SIZE, firstFileOffset - BIG_HEADER_SIZE);
+                        headerSize += (bytesRead > 0) ? bytesRead : 0;
+                }
+                header = headerBuffer.data();
+        }
+
+        if (headerSize < BIG_HEADER_SIZE || std::strncmp(reinterpret_cast<const char*>(header), "BIGF", 4) != 0)
+        {
+                DEBUG_CRASH(("Error reading BIG file identifier in file %s", filename));
+                delete sfmlBigFile;
+                fp->close();
+                return NULL;
+        }
+
+        const Int numLittleFiles = static_cast<Int>(readBigEndianUInt32(header + 8));
+
+        // each entry is the file's offset and size, then its path
+        const unsigned char* pos = header + BIG_HEADER_SIZE;
+        const unsigned char* end = header + headerSize;
         for (Int i = 0; i < numLittleFiles; ++i)
         {
-                const Int fileOffset = static_cast<Int>(readBigEndianUInt32(fp));
-                const Int fileSize = static_cast<Int>(readBigEndianUInt32(fp));
+                const unsigned char* path = pos + 8;
+                const unsigned char* pathEnd = NULL;
+                if (end - pos > 8)
+                {
+                        pathEnd = static_cast<const unsigned char*>(std::memchr(path, 0, end - path));
+                }
+                if (pathEnd == NULL)
+                {
+                        DEBUG_CRASH(("BIG file %s has a damaged header, it ends at file %d of %d", filename, i, numLittleFiles));
+                        break;
+                }
+
+                const UnsignedInt fileOffset = readBigEndianUInt32(pos);
+                const UnsignedInt fileSize = readBigEndianUInt32(pos + 4);
+                pos = pathEnd + 1;
+
+                if (fileOffset > static_cast<UnsignedInt>(archiveSize) || fileSize > static_cast<UnsignedInt>(archiveSize) - fileOffset)
+                {
+                        DEBUG_CRASH(("%s in BIG file %s runs past the end of the archive", path, filename));
+                        continue;
+                }
+
+                sfmlBigFile->addIndexEntry(reinterpret_cast<const char*>(path), fileOffset, fileSize);
+        }
+
+        sfmlBigFile->sortIndex();
+        sfmlBigFile->attachFile(fp);
+
+        return sfmlBigFile;
+}
+
+#ifdef TEST_BIG_ARCHIVE
+/// How openArchiveFile() used to do it, a few bytes at a time into a directory tree, for doArchiveTest().
+SfmlBIGFile* SfmlBIGFileSystem::openArchiveFileOneEntryAtATime(const Char* filename)
+{
+        File* fp = TheLocalFileSystem->openFile(filename, File::READ | File::BINARY);
+        if (fp == NULL)
+        {
+                return NULL;
+        }
+
+        std::array<char, 1024> buffer{};
+        fp->read(buffer.data(), 4);
+        readBigEndianUInt32(fp);
+        const Int numLittleFiles = static_cast<Int>(readBigEndianUInt32(fp));
+        fp->seek(0x10, File::START);
 
-                fileInfo->m_archiveFilename = archiveFileName;
-                fileInfo->m_offset = fileOffset;
-                fileInfo->m_size = fileSize;
+        SfmlBIGFile* sfmlBigFile = NEW SfmlBIGFile;
+        ArchivedFileInfo fileInfo;
+        for (Int i = 0; i < numLittleFiles; ++i)
+        {
+                fileInfo.m_archiveFilename = filename;
+                fileInfo.m_offset = readBigEndianUInt32(fp);
+                fileInfo.m_size = readBigEndianUInt32(fp);
 
                 Int pathIndex = -1;
                 do
@@ -165,19 +552,343 @@ ArchiveFile* SfmlBIGFileSystem::openArchiveFile(const Char* filename)
                         --filenameIndex;
                 }
 
-                fileInfo->m_filename = (char*)(buffer.data() + filenameIndex + 1);
-                fileInfo->m_filename.toLower();
+                fileInfo.m_filename = (char*)(buffer.data() + filenameIndex + 1);
+                fileInfo.m_filename.toLower();
                 buffer[filenameIndex + 1] = 0;
 
                 AsciiString path(buffer.data());
-                archiveFile->addFile(path, fileInfo);
+                sfmlBigFile->addFile(path, &fileInfo);
+        }
+
+        sfmlBigFile->attachFile(fp);
+        return sfmlBigFile;
+}
+
+/// Mount every archive three ways -- the old way, with one read for the header, and mapped -- and open
+/// every file in it from each of them, checking they all agree on what's in there.
+void SfmlBIGFileSystem::doArchiveTest(void)
+{
+        const Int MOUNT_PASSES = 4;
+        const Int CHECK_BYTES = 64;
+
+        // every mount here has to actually read the archive
+        const Bool useMappedArchives = m_useMappedArchives;
+        const Bool useIndexCache = m_useIndexCache;
+        const Int indexCacheHits = m_indexCacheHits;
+        const Int indexCacheMisses = m_indexCacheMisses;
+        m_useIndexCache = FALSE;
+
+        UnsignedInt totalMountTime[3] = { 0, 0, 0 };
+        UnsignedInt totalOpenTime[3] = { 0, 0, 0 };
+        Int totalFiles = 0;
+
+        for (ArchiveFileMap::const_iterator archiveIt = m_archiveFileMap.begin(); archiveIt != m_archiveFileMap.end(); ++archiveIt)
+        {
+                const Char* archiveFilename = archiveIt->first.str();
+
+                // 0 is the old way, 1 reads the header in one go, 2 maps the archive
+                ArchiveFile* archives[3] = { NULL, NULL, NULL };
+                UnsignedInt mountTime[3] = { 0, 0, 0 };
+                for (Int pass = 0; pass < MOUNT_PASSES; ++pass)
+                {
+                        for (Int way = 0; way < 3; ++way)
+                        {
+                                delete archives[way];
+
+                                const Clock::time_point startTime = Clock::now();
+                                if (way == 0)
+                                {
+                                        archives[way] = openArchiveFileOneEntryAtATime(archiveFilename);
+                                }
+                                else
+                                {
+                                        m_useMappedArchives = (way == 2);
+                                        archives[way] = openArchiveFile(archiveFilename);
+                                }
+                                mountTime[way] += microsecondsSince(startTime);
+                        }
+                }
+                m_useMappedArchives = useMappedArchives;
+
+                if (archives[0] == NULL || archives[1] == NULL || archives[2] == NULL)
+                {
+                        DEBUG_CRASH(("BIGArchiveTest - couldn't mount %s all three ways", archiveFilename));
+                        for (Int way = 0; way < 3; ++way)
+                        {
+                                delete archives[way];
+                        }
+                        continue;
+                }
+
+                // the index has to list the same files the directory tree did
+                FilenameList treeList;
+                FilenameList indexList;
+                archives[0]->ArchiveFile::getFileListInDirectory(AsciiString(""), AsciiString(""), AsciiString("*"), treeList, TRUE);
+                archives[2]->getFileListInDirectory(AsciiString(""), AsciiString(""), AsciiString("*"), indexList, TRUE);
+                DEBUG_ASSERTCRASH(treeList == indexList, ("BIGArchiveTest - %s: the directory tree has %d files, the index has %d",
+                        archiveFilename, static_cast<Int>(treeList.size()), static_cast<Int>(indexList.size())));
+
+                UnsignedInt openTime[3] = { 0, 0, 0 };
+                for (FilenameListIter it = treeList.begin(); it != treeList.end(); ++it)
+                {
+                        char firstBytes[3][CHECK_BYTES];
+                        Int sizes[3] = { -1, -1, -1 };
+                        for (Int way = 0; way < 3; ++way)
+                        {
+                                const Clock::time_point startTime = Clock::now();
+                                File* file = (way == 0) ? static_cast<SfmlBIGFile*>(archives[way])->openFileFromDirectoryTree(it->str()) : archives[way]->openFile(it->str());
+                                if (file != NULL)
+                                {
+                                        sizes[way] = file->size();
+                                        file->read(firstBytes[way], std::min(sizes[way], static_cast<Int>(CHECK_BYTES)));
+                                        file->close();
+                                }
+                                openTime[way] += microsecondsSince(startTime);
+                        }
+
+                        DEBUG_ASSERTCRASH(sizes[0] >= 0 && sizes[0] == sizes[1] && sizes[0] == sizes[2] &&
+                                std::memcmp(firstBytes[0], firstBytes[1], std::min(sizes[0], static_cast<Int>(CHECK_BYTES))) == 0 &&
+                                std::memcmp(firstBytes[0], firstBytes[2], std::min(sizes[0], static_cast<Int>(CHECK_BYTES))) == 0,
+                                ("BIGArchiveTest - %s: %s doesn't come out the same every way", archiveFilename, it->str()));
+                }
+
+                DEBUG_LOG(("BIGArchiveTest - %s: %d files, mount x%d %u/%u/%u us, open every file %u/%u/%u us (old/one read/mapped)\n",
+                        archiveFilename, static_cast<Int>(treeList.size()), MOUNT_PASSES, mountTime[0], mountTime[1], mountTime[2],
+                        openTime[0], openTime[1], openTime[2]));
+
+                totalFiles += static_cast<Int>(treeList.size());
+                for (Int way = 0; way < 3; ++way)
+                {
+                        totalMountTime[way] += mountTime[way];
+                        totalOpenTime[way] += openTime[way];
+                        delete archives[way];
+                }
+        }
+
+        DEBUG_LOG(("BIGArchiveTest - %d archives, %d files, mount x%d %u/%u/%u us, open every file %u/%u/%u us (old/one read/mapped)\n",
+                static_cast<Int>(m_archiveFileMap.size()), totalFiles, MOUNT_PASSES, totalMountTime[0], totalMountTime[1], totalMountTime[2],
+                totalOpenTime[0], totalOpenTime[1], totalOpenTime[2]));
+
+        m_useIndexCache = useIndexCache;
+        m_indexCacheHits = indexCacheHits;
+        m_indexCacheMisses = indexCacheMisses;
+}
+#endif
+
+#ifdef TEST_BIG_INDEX_CACHE
+namespace
+{
+
+void writeBigEndianUInt32(std::vector<char>& out, UnsignedInt value)
+{
+        out.push_back(static_cast<char>(value >> 24));
+        out.push_back(static_cast<char>(value >> 16));
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value));
+}
+
+/// Write a BIG file holding the given files, each one a path followed by its contents.
+void writeTestArchive(const Char* filename, const std::vector<std::pair<std::string, std::string> >& files)
+{
+        UnsignedInt headerSize = BIG_HEADER_SIZE;
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+                headerSize += 8 + static_cast<UnsignedInt>(files[i].first.size()) + 1;
+        }
+
+        UnsignedInt archiveSize = headerSize;
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+                archiveSize += static_cast<UnsignedInt>(files[i].second.size());
         }
 
-        archiveFile->attachFile(fp);
-        delete fileInfo;
+        // the header is little endian for the archive size, big endian for everything else
+        std::vector<char> out;
+        out.insert(out.end(), { 'B', 'I', 'G', 'F' });
+        const char archiveSizeBytes[4] = { static_cast<char>(archiveSize), static_cast<char>(archiveSize >> 8), static_cast<char>(archiveSize >> 16), static_cast<char>(archiveSize >> 24) };
+        out.insert(out.end(), archiveSizeBytes, archiveSizeBytes + 4);
+        writeBigEndianUInt32(out, static_cast<UnsignedInt>(files.size()));
+        writeBigEndianUInt32(out, headerSize);
+
+        UnsignedInt offset = headerSize;
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+                writeBigEndianUInt32(out, offset);
+                writeBigEndianUInt32(out, static_cast<UnsignedInt>(files[i].second.size()));
+                out.insert(out.end(), files[i].first.c_str(), files[i].first.c_str() + files[i].first.size() + 1);
+                offset += static_cast<UnsignedInt>(files[i].second.size());
+        }
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+                out.insert(out.end(), files[i].second.begin(), files[i].second.end());
+        }
+
+        File* file = TheLocalFileSystem->openFile(filename, File::WRITE | File::CREATE | File::TRUNCATE | File::BINARY);
+        if (file != NULL)
+        {
+                file->write(out.data(), static_cast<Int>(out.size()));
+                file->close();
+        }
+}
+
+std::string readTestFile(SfmlBIGFileSystem* fileSystem, const Char* filename)
+{
+        File* file = fileSystem->openFile(filename, File::READ | File::BINARY);
+        if (file == NULL)
+        {
+                return std::string();
+        }
+
+        std::string contents(static_cast<size_t>(file->size()), '\0');
+        file->read(&contents[0], file->size());
+        file->close();
+        return contents;
+}
+
+} // anonymous namespace
+
+/// Mount some small made up archives over and over with the index cache, adding, changing and removing
+/// them between passes, and check the cache gets used only when it should and always gives the right files.
+void SfmlBIGFileSystem::doIndexCacheTest(void)
+{
+        const char* const TEST_DIRECTORY = "IndexCacheTest";
+        const char* const ARCHIVE_A = "IndexCacheTest/a.big";
+        const char* const ARCHIVE_B = "IndexCacheTest/b.big";
+        const char* const ARCHIVE_C = "IndexCacheTest/c.big";
+
+        std::error_code ec;
+        std::filesystem::remove_all(TEST_DIRECTORY, ec);
+        std::filesystem::create_directories(TEST_DIRECTORY, ec);
+
+        typedef std::vector<std::pair<std::string, std::string> > TestFiles;
+        TestFiles filesA;
+        filesA.push_back(std::make_pair(std::string("Data\\INI\\One.ini"), std::string("one")));
+        filesA.push_back(std::make_pair(std::string("Data\\INI\\Shared.ini"), std::string("shared from a")));
+        TestFiles filesB;
+        filesB.push_back(std::make_pair(std::string("Data/INI/Two.ini"), std::string("two")));
+        filesB.push_back(std::make_pair(std::string("data\\ini\\shared.ini"), std::string("shared from b")));
+        TestFiles filesC;
+        filesC.push_back(std::make_pair(std::string("Data\\INI\\Three.ini"), std::string("three")));
+
+        writeTestArchive(ARCHIVE_A, filesA);
+        writeTestArchive(ARCHIVE_B, filesB);
+
+        struct Pass
+        {
+                const char* m_description;
+                Int m_expectedHits;
+                Int m_expectedMisses;
+        };
+        const Pass passes[] =
+        {
+                { "cold start", 0, 2 },
+                { "warm start", 2, 0 },
+                { "b.big changed size", 1, 1 },
+                { "b.big changed, same size", 1, 1 },
+                { "c.big added", 2, 1 },
+                { "a.big removed", 2, 0 },
+                { "nothing changed", 2, 0 },
+        };
+        const Int numPasses = static_cast<Int>(sizeof(passes) / sizeof(passes[0]));
+
+        Int failures = 0;
+        for (Int pass = 0; pass < numPasses; ++pass)
+        {
+                // change things on disk before mounting
+                if (pass == 2)
+                {
+                        filesB[0].second = "two, but longer";
+                        writeTestArchive(ARCHIVE_B, filesB);
+                }
+                else if (pass == 3)
+                {
+                        filesB[0].second = "TWO, but longer";
+                        writeTestArchive(ARCHIVE_B, filesB);
+                        std::filesystem::last_write_time(ARCHIVE_B, std::filesystem::last_write_time(ARCHIVE_B, ec) + std::chrono::seconds(10), ec);
+                }
+                else if (pass == 4)
+                {
+                        writeTestArchive(ARCHIVE_C, filesC);
+                }
+                else if (pass == 5)
+                {
+                        std::filesystem::remove(ARCHIVE_A, ec);
+                }
+
+                SfmlBIGFileSystem* fileSystem = NEW SfmlBIGFileSystem;
+                fileSystem->m_indexCacheFilename = "IndexCacheTest/ArchiveIndexCache.dat";
+                fileSystem->openIndexCache();
+
+                const Bool haveA = (pass < 5);
+                const Bool haveC = (pass >= 4);
+                if (haveA)
+                {
+                        fileSystem->mountArchive(AsciiString(ARCHIVE_A), FALSE);
+                }
+                fileSystem->mountArchive(AsciiString(ARCHIVE_B), FALSE);
+                if (haveC)
+                {
+                        fileSystem->mountArchive(AsciiString(ARCHIVE_C), FALSE);
+                }
+
+                Bool ok = (fileSystem->m_indexCacheHits == passes[pass].m_expectedHits && fileSystem->m_indexCacheMisses == passes[pass].m_expectedMisses);
+                DEBUG_ASSERTCRASH(ok, ("IndexCacheTest - %s: %d hits and %d misses, expected %d and %d", passes[pass].m_description,
+                        fileSystem->m_indexCacheHits, fileSystem->m_indexCacheMisses, passes[pass].m_expectedHits, passes[pass].m_expectedMisses));
+
+                // looking things up mustn't need the archives open
+                const Bool foundOne = fileSystem->doesFileExist("data\\ini\\one.ini");
+                FilenameList filenameList;
+                fileSystem->getFileListInDirectory(AsciiString(""), AsciiString("Data\\INI\\"), AsciiString("*.ini"), filenameList, TRUE);
+                if (pass == 1)
+                {
+                        for (ArchiveFileMap::const_iterator it = fileSystem->m_archiveFileMap.begin(); it != fileSystem->m_archiveFileMap.end(); ++it)
+                        {
+                                const Bool isOpen = static_cast<const SfmlBIGFile*>(it->second)->isArchiveOpen();
+                                DEBUG_ASSERTCRASH(isOpen == FALSE, ("IndexCacheTest - %s: %s was opened just to look in its index", passes[pass].m_description, it->first.str()));
+                                ok = ok && (isOpen == FALSE);
+                        }
+                }
+
+                const Int expectedFiles = 2 + (haveA ? 1 : 0) + (haveC ? 1 : 0);   // Two.ini and Shared.ini are always there
+                const Bool listOk = (static_cast<Int>(filenameList.size()) == expectedFiles);
+                DEBUG_ASSERTCRASH(listOk, ("IndexCacheTest - %s: listed %d files, expected %d", passes[pass].m_description,
+                        static_cast<Int>(filenameList.size()), expectedFiles));
+                ok = ok && listOk && (foundOne == haveA);
+                DEBUG_ASSERTCRASH(foundOne == haveA, ("IndexCacheTest - %s: One.ini %s", passes[pass].m_description, haveA ? "is missing" : "is still there"));
+
+                // whichever archive was mounted first keeps a file they both have
+                const std::string shared = readTestFile(fileSystem, "Data/INI/Shared.ini");
+                const std::string two = readTestFile(fileSystem, "DATA\\INI\\TWO.INI");
+                const Bool contentsOk = (shared == (haveA ? "shared from a" : "shared from b")) && (two == filesB[0].second) &&
+                        (haveC == FALSE || readTestFile(fileSystem, "Data\\INI\\Three.ini") == "three");
+                DEBUG_ASSERTCRASH(contentsOk, ("IndexCacheTest - %s: got the wrong contents, Shared.ini is '%s' and Two.ini is '%s'",
+                        passes[pass].m_description, shared.c_str(), two.c_str()));
+                ok = ok && contentsOk;
+
+                fileSystem->saveIndexCache();
+                if (pass == numPasses - 1)
+                {
+                        fileSystem->openIndexCache();
+                        const Bool cacheOk = (fileSystem->m_indexCache.size() == 2);
+                        DEBUG_ASSERTCRASH(cacheOk, ("IndexCacheTest - %s: the index cache has %d archives in it, expected 2",
+                                passes[pass].m_description, static_cast<Int>(fileSystem->m_indexCache.size())));
+                        ok = ok && cacheOk;
+                }
+
+                DEBUG_LOG(("IndexCacheTest - %s: %d hits, %d misses, %d files listed, %s\n", passes[pass].m_description,
+                        fileSystem->m_indexCacheHits, fileSystem->m_indexCacheMisses, static_cast<Int>(filenameList.size()), ok ? "ok" : "FAILED"));
+                if (ok == FALSE)
+                {
+                        ++failures;
+                }
+
+                delete fileSystem;
+        }
 
-        return archiveFile;
+        DEBUG_LOG(("IndexCacheTest - %d of %d passes failed\n", failures, numPasses));
+        std::filesystem::remove_all(TEST_DIRECTORY, ec);
 }
+#endif
 
 void SfmlBIGFileSystem::closeArchiveFile(const Char* filename)
 {
@@ -192,6 +903,13 @@ void SfmlBIGFileSystem::closeArchiveFile(const Char* filename)
                 TheAudio->stopAudio(AudioAffect_Music);
         }
 
+        // its files are gone too
+        const SfmlBIGFile* archive = static_cast<const SfmlBIGFile*>(it->second);
+        m_mergedIndex.erase(std::remove_if(m_mergedIndex.begin(), m_mergedIndex.end(), [archive](const MergedIndexEntry& entry)
+        {
+                return entry.m_archive == archive;
+        }), m_mergedIndex.end());
+
         delete it->second;
         m_archiveFileMap.erase(it);
 }
@@ -204,6 +922,19 @@ void SfmlBIGFileSystem::closeAllFiles(void)
 {
 }
 
+Bool SfmlBIGFileSystem::mountArchive(const AsciiString& filename, Bool overwrite)
+{
+        ArchiveFile* archiveFile = openArchiveFile(filename.str());
+        if (archiveFile == NULL)
+        {
+                return FALSE;
+        }
+
+        loadIntoDirectoryTree(archiveFile, filename, overwrite);
+        m_archiveFileMap[filename] = archiveFile;
+        return TRUE;
+}
+
 Bool SfmlBIGFileSystem::loadBigFilesFromDirectory(AsciiString dir, AsciiString fileMask, Bool overwrite)
 {
         FilenameList filenameList;
@@ -212,14 +943,143 @@ Bool SfmlBIGFileSystem::loadBigFilesFromDirectory(AsciiString dir, AsciiString f
         Bool actuallyAdded = FALSE;
         for (FilenameListIter it = filenameList.begin(); it != filenameList.end(); ++it)
         {
-                ArchiveFile* archiveFile = openArchiveFile((*it).str());
-                if (archiveFile != NULL)
+                if (mountArchive(*it, overwrite))
                 {
-                        loadIntoDirectoryTree(archiveFile, *it, overwrite);
-                        m_archiveFileMap[*it] = archiveFile;
                         actuallyAdded = TRUE;
                 }
         }
 
         return actuallyAdded;
 }
+
+void SfmlBIGFileSystem::loadIntoDirectoryTree(const ArchiveFile* archiveFile, const AsciiString& archiveFilename, Bool overwrite)
+{
+        (void)archiveFilename;
+
+        // Both indexes are sorted by path, so this is a merge.  A file that's already in another archive
+        // stays where it is unless we're overwriting, same as the directory tree this replaces.
+        SfmlBIGFile* archive = const_cast<SfmlBIGFile*>(static_cast<const SfmlBIGFile*>(archiveFile));
+        const SfmlBIGFile::IndexEntry* entries = archive->getIndexEntries();
+        const Int numEntries = archive->getNumIndexEntries();
+
+        MergedIndexEntryList merged;
+        merged.reserve(m_mergedIndex.size() + numEntries);
+
+        size_t existing = 0;
+        Int added = 0;
+        while (existing < m_mergedIndex.size() || added < numEntries)
+        {
+                Int compare = 0;
+                if (added == numEntries)
+                {
+                        compare = -1;
+                }
+                else if (existing == m_mergedIndex.size())
+                {
+                        compare = 1;
+                }
+                else
+                {
+                        compare = std::strcmp(getMergedIndexPath(m_mergedIndex[existing]), archive->getIndexPath(entries[added]));
+                }
+
+                if (compare < 0 || (compare == 0 && overwrite == FALSE))
+                {
+                        merged.push_back(m_mergedIndex[existing]);
+                }
+                else
+                {
+                        MergedIndexEntry entry;
+                        entry.m_archive = archive;
+                        entry.m_entry = added;
+                        merged.push_back(entry);
+                }
+
+                if (compare <= 0)
+                {
+                        ++existing;
+                }
+                if (compare >= 0)
+                {
+                        ++added;
+                }
+        }
+
+        m_mergedIndex.swap(merged);
+}
+
+const char* SfmlBIGFileSystem::getMergedIndexPath(const MergedIndexEntry& entry) const
+{
+        return entry.m_archive->getIndexPath(entry.m_archive->getIndexEntries()[entry.m_entry]);
+}
+
+const SfmlBIGFileSystem::MergedIndexEntry* SfmlBIGFileSystem::findMergedIndexEntry(const Char* filename) const
+{
+        char normalized[SfmlBIGFile::MAX_PATH_LENGTH];
+        if (SfmlBIGFile::normalizePath(filename, normalized, SfmlBIGFile::MAX_PATH_LENGTH) <= 0)
+        {
+                return NULL;
+        }
+
+        MergedIndexEntryList::const_iterator it = std::lower_bound(m_mergedIndex.begin(), m_mergedIndex.end(), normalized, [this](const MergedIndexEntry& entry, const char* path)
+        {
+                return std::strcmp(getMergedIndexPath(entry), path) < 0;
+        });
+
+        if (it == m_mergedIndex.end() || std::strcmp(getMergedIndexPath(*it), normalized) != 0)
+        {
+                return NULL;
+        }
+
+        return &(*it);
+}
+
+File* SfmlBIGFileSystem::openFile(const Char* filename, Int access)
+{
+        const MergedIndexEntry* entry = findMergedIndexEntry(filename);
+        if (entry == NULL)
+        {
+                return NULL;
+        }
+
+        return entry->m_archive->openFile(filename, access);
+}
+
+Bool SfmlBIGFileSystem::doesFileExist(const Char* filename) const
+{
+        return findMergedIndexEntry(filename) != NULL;
+}
+
+AsciiString SfmlBIGFileSystem::getArchiveFilenameForFile(const AsciiString& filename) const
+{
+        const MergedIndexEntry* entry = findMergedIndexEntry(filename.str());
+        if (entry == NULL)
+        {
+                return AsciiString::TheEmptyString;
+        }
+
+        return entry->m_archive->getArchiveFilename();
+}
+
+void SfmlBIGFileSystem::getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList& filenameList, Bool searchSubdirectories) const
+{
+        (void)currentDirectory;
+        (void)searchSubdirectories;
+
+        char prefix[SfmlBIGFile::MAX_PATH_LENGTH];
+        const Int prefixLength = SfmlBIGFile::makeDirectoryPrefix(originalDirectory, prefix, SfmlBIGFile::MAX_PATH_LENGTH);
+        if (prefixLength < 0)
+        {
+                return;
+        }
+
+        MergedIndexEntryList::const_iterator it = std::lower_bound(m_mergedIndex.begin(), m_mergedIndex.end(), prefix, [this](const MergedIndexEntry& entry, const char* path)
+        {
+                return std::strcmp(getMergedIndexPath(entry), path) < 0;
+        });
+
+        for (; it != m_mergedIndex.end() && std::strncmp(getMergedIndexPath(*it), prefix, prefixLength) == 0; ++it)
+        {
+                SfmlBIGFile::addToFileList(getMergedIndexPath(*it), prefixLength, originalDirectory, searchName, filenameList);
+        }
+}
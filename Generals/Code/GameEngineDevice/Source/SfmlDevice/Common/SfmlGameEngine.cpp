@@ -118,6 +118,11 @@ void SfmlGameEngine::execute(void)
                         }
                         catch (INIException e)
                         {
+                                // the replay is written in the background, so get it all out before we go
+                                if (TheRecorder)
+                                {
+                                        TheRecorder->flushRecording();
+                                }
                                 if (e.mFailureMessage)
                                 {
                                         RELEASE_CRASH((e.mFailureMessage));
@@ -131,6 +136,10 @@ void SfmlGameEngine::execute(void)
                         {
                                 try
                                 {
+                                        if (TheRecorder)
+                                        {
+                                                TheRecorder->flushRecording();
+                                        }
                                         if (TheRecorder && TheRecorder->getMode() == RECORDERMODETYPE_RECORD && TheRecorder->isMultiplayer())
                                         {
                                                 TheRecorder->cleanUpReplayFile();
@@ -105,6 +105,7 @@ static void drawFramerateBar(void);
 #include "GameLogic/ScriptEngine.h"		// For TheScriptEngine - jkmcd
 #include "GameLogic/GameLogic.h"
 #ifdef DUMP_PERF_STATS
+#include "GameLogic/AI.h"
 #include "GameLogic/PartitionManager.h"
 #endif
 
@@ -221,8 +222,9 @@ void StatDumpClass::dumpStats()
 	fprintf( m_fp, "Objects: %d in world (%d onscreen)\n", objCount, objScreenCount );
 
 	//AI stats
-	UnsignedInt numAI, numMoving, numAttacking, numWaitingForPath, overallFailedPathfinds;
-	TheGameLogic->getAIMetricsStatistics( &numAI, &numMoving, &numAttacking, &numWaitingForPath, &overallFailedPathfinds );
+	UnsignedInt numAI, numMoving, numAttacking, numWaitingForPath, overallFailedPathfinds, pathCacheHits, pathCacheMisses;
+	TheGameLogic->getAIMetricsStatistics( &numAI, &numMoving, &numAttacking, &numWaitingForPath, &overallFailedPathfinds,
+		&pathCacheHits, &pathCacheMisses );
 	fprintf( m_fp, "\n" );
 	fprintf( m_fp, "AI Statistics:\n" );
 	fprintf( m_fp, "  Total AI Objects: %d\n", numAI );
@@ -230,6 +232,7 @@ void StatDumpClass::dumpStats()
 	fprintf( m_fp, "    -attacking: %d\n", numAttacking );
 	fprintf( m_fp, "    -waiting for path: %d\n", numWaitingForPath );
 	fprintf( m_fp, "  Total failed pathfinds: %d\n", overallFailedPathfinds );
+	fprintf( m_fp, "  Path cache hits: %d, misses: %d\n", pathCacheHits, pathCacheMisses );
 	fprintf( m_fp, "\n" );
 
 	// Script stats
@@ -244,6 +247,15 @@ void StatDumpClass::dumpStats()
 
 
 
+	//Pathfinder stats
+	const PathfindQueueStats &pathStats = TheAI->pathfinder()->getQueueStats();
+	fprintf(m_fp, "Pathfinder Statistics:\n");
+	fprintf(m_fp, "  Queue depth: %d, paths processed: %d, cells examined: %d\n", 
+		pathStats.m_queueDepth, pathStats.m_pathsProcessed, pathStats.m_cellsExamined);
+	fprintf(m_fp, "  Speculative searches: %d (%d used)\n", pathStats.m_speculativeSearches, pathStats.m_speculativeHits);
+	fprintf(m_fp, "  Time in pathfind queue this frame is %.5f msec\n", pathStats.m_wallTimeMS);
+	fprintf( m_fp, "\n" );
+
 	//PartitionMgr stats
 	double gcoTimeThisFrameTotal, gcoTimeThisFrameAvg;
 	ThePartitionManager->getPMStats(gcoTimeThisFrameTotal, gcoTimeThisFrameAvg);
@@ -30,8 +30,6 @@ enum CompressionType
 	COMPRESSION_MIN = 0,
 	COMPRESSION_NONE = COMPRESSION_MIN,
 	COMPRESSION_REFPACK,
-	COMPRESSION_MAX = COMPRESSION_REFPACK,
-	COMPRESSION_NOXLZH,
 	COMPRESSION_ZLIB1,
 	COMPRESSION_ZLIB2,
 	COMPRESSION_ZLIB3,
@@ -41,6 +39,9 @@ enum CompressionType
 	COMPRESSION_ZLIB7,
 	COMPRESSION_ZLIB8,
 	COMPRESSION_ZLIB9,
+	COMPRESSION_LZ4,				///< LZ4 block format, fast both ways, for when ratio matters less than time
+	COMPRESSION_MAX = COMPRESSION_LZ4,
+	COMPRESSION_NOXLZH,			///< these aren't built any more
 	COMPRESSION_BTREE,
 	COMPRESSION_HUFF,
 };
@@ -64,6 +65,73 @@ public:
 	static const char *getDecompressionNameByType( CompressionType compType );
 
 	static CompressionType getPreferredCompression( void );
+	static void setPreferredCompression( CompressionType compType );
+};
+
+//-------------------------------------------------------------------------------------------------
+// Streaming.  A stream is a header, then the data cut into chunks, each compressed on its own
+// with compressData() and preceded by its compressed length, then a zero length.  Neither end
+// ever holds more than a chunk, so big payloads don't need whole-buffer allocations.
+//-------------------------------------------------------------------------------------------------
+
+typedef Bool (*CompressionWriteProc)( const void *data, Int len, void *userData );	///< FALSE on error
+typedef Int (*CompressionReadProc)( void *data, Int len, void *userData );					///< bytes read, less than len at the end
+
+class CompressionStreamWriter
+{
+public:
+	enum { DEFAULT_CHUNK_SIZE = 256 * 1024 };
+
+	CompressionStreamWriter( CompressionType compType, CompressionWriteProc writeProc, void *userData, Int chunkSize = DEFAULT_CHUNK_SIZE );
+	~CompressionStreamWriter();
+
+	Bool write( const void *data, Int len );	///< compresses and writes out each chunk as it fills up.  FALSE on error
+	Bool finish( void );											///< write out what's left, and the end of the stream.  FALSE on error
+
+	Int getBytesIn( void ) const { return m_bytesIn; }
+	Int getBytesOut( void ) const { return m_bytesOut; }
+
+private:
+	Bool flushChunk( void );
+	Bool writeOut( const void *data, Int len );
+	Int getMaxCompressedSizeForStream( void ) const;	///< a compressed chunk can't be bigger than this
+
+	CompressionType				m_compType;
+	CompressionWriteProc	m_writeProc;
+	void									*m_userData;
+	Int										m_chunkSize;
+	UnsignedByte					*m_chunk;					///< uncompressed data waiting to fill a chunk
+	Int										m_chunkUsed;
+	UnsignedByte					*m_compressed;		///< big enough for a compressed chunk, and its length
+	Int										m_bytesIn;
+	Int										m_bytesOut;
+	Bool									m_ok;
+};
+
+class CompressionStreamReader
+{
+public:
+	CompressionStreamReader( CompressionReadProc readProc, void *userData );
+	~CompressionStreamReader();
+
+	Int read( void *dest, Int len );		///< bytes decompressed into dest, less than len only at the end.  -1 on error
+
+	static Bool isStream( const void *mem, Int len );	///< does this look like the start of a stream
+
+private:
+	Bool nextChunk( void );
+
+	CompressionReadProc		m_readProc;
+	void									*m_userData;
+	CompressionType				m_compType;
+	Int										m_chunkSize;			///< 0 until we've read the header
+	Int										m_maxCompressedSize;
+	UnsignedByte					*m_chunk;					///< the current chunk, decompressed
+	Int										m_chunkUsed;
+	Int										m_chunkPos;
+	UnsignedByte					*m_compressed;
+	Bool									m_done;
+	Bool									m_ok;
 };
 
 #endif // __COMPRESSION_H__
@@ -20,23 +20,35 @@
 #include "EAC/codex.h"
 #include "EAC/refcodex.h"
 
+// zlib has its own (unsigned) Byte, which would clash with ours
+#define Byte ZLibByte
+#include <zlib.h>
+#undef Byte
+
 #include <algorithm>
 #include <cstring>
+#include <vector>
 
 namespace
 {
 constexpr char kRefPackTag[4] = {'E', 'A', 'R', '\0'};
+constexpr char kZLibTag[4] = {'Z', 'L', '0', '\0'};    // the 0 is the level
+constexpr char kLZ4Tag[4] = {'L', 'Z', '4', '\0'};
+constexpr char kStreamTag[4] = {'E', 'A', 'S', '\0'};
+constexpr Int kHeaderSize = 8;                          // tag, then the uncompressed length
+constexpr Int kStreamHeaderSize = 12;                   // tag, chunk size, compression type
+constexpr Int kMaxStreamChunkSize = 64 * 1024 * 1024;
 
-inline bool HasRefPackHeader(const void* data, Int length)
+CompressionType s_preferredCompression = COMPRESSION_REFPACK;
+
+inline bool HasTag(const void* data, Int length, const char* tag)
 {
-    if (data == nullptr || length < 4)
-    {
-        return false;
-    }
+    return data != nullptr && length >= 4 && std::memcmp(data, tag, 4) == 0;
+}
 
-    const auto* bytes = static_cast<const UnsignedByte*>(data);
-    return bytes[0] == kRefPackTag[0] && bytes[1] == kRefPackTag[1] &&
-           bytes[2] == kRefPackTag[2] && bytes[3] == kRefPackTag[3];
+inline bool HasRefPackHeader(const void* data, Int length)
+{
+    return HasTag(data, length, kRefPackTag);
 }
 
 inline Int ReadStoredLength(const void* data)
@@ -52,32 +64,261 @@ inline void WriteStoredLength(void* data, Int value)
     auto* bytes = static_cast<UnsignedByte*>(data);
     std::memcpy(bytes, &value, sizeof(value));
 }
+
+inline bool IsZLib(CompressionType compType)
+{
+    return compType >= COMPRESSION_ZLIB1 && compType <= COMPRESSION_ZLIB9;
+}
+
+// ---------------------------------------------------------------------------------------
+// LZ4 block format.  Each sequence is a token (literal count in the high nibble, match
+// length - 4 in the low one, 15 meaning more bytes follow), the literals, then a 2 byte
+// little endian offset back to the match.  The last sequence is literals only, and the
+// last 5 bytes are always literals.
+// ---------------------------------------------------------------------------------------
+constexpr Int kLZ4MinMatch = 4;
+constexpr Int kLZ4LastLiterals = 5;
+constexpr Int kLZ4MatchFindLimit = 12;                  // no match starts closer than this to the end
+constexpr Int kLZ4HashBits = 16;
+constexpr Int kLZ4MaxOffset = 65535;
+
+inline UnsignedInt ReadUInt32(const UnsignedByte* p)
+{
+    UnsignedInt value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline UnsignedInt LZ4Hash(UnsignedInt sequence)
+{
+    return (sequence * 2654435761u) >> (32 - kLZ4HashBits);
+}
+
+inline Int LZ4MaxCompressedSize(Int length)
+{
+    return length + length / 255 + 16;
+}
+
+inline UnsignedByte* LZ4WriteLength(UnsignedByte* op, Int length)
+{
+    for (length -= 15; length >= 255; length -= 255)
+    {
+        *op++ = 255;
+    }
+    *op++ = static_cast<UnsignedByte>(length);
+    return op;
+}
+
+UnsignedByte* LZ4WriteSequence(UnsignedByte* op, const UnsignedByte* opEnd, const UnsignedByte* literals, Int literalLength, Int offset, Int matchLength)
+{
+    // worst case for the token, both lengths, and the offset
+    if (opEnd - op < 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1)
+    {
+        return nullptr;
+    }
+
+    UnsignedByte* token = op++;
+    *token = static_cast<UnsignedByte>(std::min(literalLength, 15) << 4);
+    if (literalLength >= 15)
+    {
+        op = LZ4WriteLength(op, literalLength);
+    }
+    std::memcpy(op, literals, static_cast<std::size_t>(literalLength));
+    op += literalLength;
+
+    if (offset > 0)
+    {
+        *op++ = static_cast<UnsignedByte>(offset);
+        *op++ = static_cast<UnsignedByte>(offset >> 8);
+        *token |= static_cast<UnsignedByte>(std::min(matchLength, 15));
+        if (matchLength >= 15)
+        {
+            op = LZ4WriteLength(op, matchLength);
+        }
+    }
+    return op;
+}
+
+Int LZ4Compress(const UnsignedByte* src, Int srcLen, UnsignedByte* dest, Int destLen)
+{
+    const UnsignedByte* const end = src + srcLen;
+    const UnsignedByte* const matchLimit = end - kLZ4LastLiterals;
+    const UnsignedByte* const opEnd = dest + destLen;
+    const UnsignedByte* anchor = src;
+    UnsignedByte* op = dest;
+
+    if (srcLen > kLZ4MatchFindLimit)
+    {
+        std::vector<Int> table(static_cast<std::size_t>(1) << kLZ4HashBits, -1);
+        const UnsignedByte* const matchFindLimit = end - kLZ4MatchFindLimit;
+        const UnsignedByte* ip = src;
+        while (ip <= matchFindLimit)
+        {
+            const UnsignedInt sequence = ReadUInt32(ip);
+            Int& entry = table[LZ4Hash(sequence)];
+            const Int candidate = entry;
+            entry = static_cast<Int>(ip - src);
+            if (candidate < 0 || entry - candidate > kLZ4MaxOffset || ReadUInt32(src + candidate) != sequence)
+            {
+                ++ip;
+                continue;
+            }
+
+            // grow the match both ways
+            const UnsignedByte* match = src + candidate;
+            while (ip > anchor && match > src && ip[-1] == match[-1])
+            {
+                --ip;
+                --match;
+            }
+            const UnsignedByte* matchEnd = ip + kLZ4MinMatch;
+            while (matchEnd < matchLimit && *matchEnd == match[matchEnd - ip])
+            {
+                ++matchEnd;
+            }
+
+            op = LZ4WriteSequence(op, opEnd, anchor, static_cast<Int>(ip - anchor), static_cast<Int>(ip - match), static_cast<Int>(matchEnd - ip) - kLZ4MinMatch);
+            if (op == nullptr)
+            {
+                return 0;
+            }
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    op = LZ4WriteSequence(op, opEnd, anchor, static_cast<Int>(end - anchor), 0, 0);
+    return op != nullptr ? static_cast<Int>(op - dest) : 0;
+}
+
+Int LZ4Decompress(const UnsignedByte* src, Int srcLen, UnsignedByte* dest, Int destLen)
+{
+    const UnsignedByte* ip = src;
+    const UnsignedByte* const ipEnd = src + srcLen;
+    UnsignedByte* op = dest;
+    UnsignedByte* const opEnd = dest + destLen;
+
+    // every length and offset is checked, so bad data fails rather than scribbling
+    while (ip < ipEnd)
+    {
+        const UnsignedByte token = *ip++;
+        Int literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            UnsignedByte more;
+            do
+            {
+                if (ip >= ipEnd || literalLength > destLen)
+                {
+                    return 0;
+                }
+                more = *ip++;
+                literalLength += more;
+            } while (more == 255);
+        }
+        if (literalLength > ipEnd - ip || literalLength > opEnd - op)
+        {
+            return 0;
+        }
+        std::memcpy(op, ip, static_cast<std::size_t>(literalLength));
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == ipEnd)
+        {
+            return static_cast<Int>(op - dest);
+        }
+
+        if (ipEnd - ip < 2)
+        {
+            return 0;
+        }
+        const Int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dest)
+        {
+            return 0;
+        }
+
+        Int matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            UnsignedByte more;
+            do
+            {
+                if (ip >= ipEnd || matchLength > destLen)
+                {
+                    return 0;
+                }
+                more = *ip++;
+                matchLength += more;
+            } while (more == 255);
+        }
+        matchLength += kLZ4MinMatch;
+        if (matchLength > opEnd - op)
+        {
+            return 0;
+        }
+
+        // the match can overlap what it's writing, so a byte at a time
+        const UnsignedByte* match = op - offset;
+        for (Int i = 0; i < matchLength; ++i)
+        {
+            op[i] = match[i];
+        }
+        op += matchLength;
+    }
+
+    return 0;
+}
 }
 
 const char* CompressionManager::getCompressionNameByType(CompressionType compType)
 {
-    switch (compType)
+    static const char* s_compressionNames[COMPRESSION_MAX + 1] = {
+        "No compression",
+        "RefPack",
+        "ZLib 1 (fast)",
+        "ZLib 2",
+        "ZLib 3",
+        "ZLib 4",
+        "ZLib 5",
+        "ZLib 6 (default)",
+        "ZLib 7",
+        "ZLib 8",
+        "ZLib 9 (slow)",
+        "LZ4",
+    };
+
+    if (compType < COMPRESSION_MIN || compType > COMPRESSION_MAX)
     {
-    case COMPRESSION_NONE:
-        return "No compression";
-    case COMPRESSION_REFPACK:
-        return "RefPack";
-    default:
         return "Unsupported";
     }
+    return s_compressionNames[compType];
 }
 
 const char* CompressionManager::getDecompressionNameByType(CompressionType compType)
 {
-    switch (compType)
+    static const char* s_decompressionNames[COMPRESSION_MAX + 1] = {
+        "d_None",
+        "d_RefPack",
+        "d_ZLib1",
+        "d_ZLib2",
+        "d_ZLib3",
+        "d_ZLib4",
+        "d_ZLib5",
+        "d_ZLib6",
+        "d_ZLib7",
+        "d_ZLib8",
+        "d_ZLib9",
+        "d_LZ4",
+    };
+
+    if (compType < COMPRESSION_MIN || compType > COMPRESSION_MAX)
     {
-    case COMPRESSION_NONE:
-        return "d_None";
-    case COMPRESSION_REFPACK:
-        return "d_RefPack";
-    default:
         return "d_Unsupported";
     }
+    return s_decompressionNames[compType];
 }
 
 Bool CompressionManager::isDataCompressed(const void* mem, Int len)
@@ -87,7 +328,15 @@ Bool CompressionManager::isDataCompressed(const void* mem, Int len)
 
 CompressionType CompressionManager::getPreferredCompression(void)
 {
-    return COMPRESSION_REFPACK;
+    return s_preferredCompression;
+}
+
+void CompressionManager::setPreferredCompression(CompressionType compType)
+{
+    if (compType >= COMPRESSION_MIN && compType <= COMPRESSION_MAX)
+    {
+        s_preferredCompression = compType;
+    }
 }
 
 CompressionType CompressionManager::getCompressionType(const void* mem, Int len)
@@ -97,6 +346,20 @@ CompressionType CompressionManager::getCompressionType(const void* mem, Int len)
         return COMPRESSION_REFPACK;
     }
 
+    if (HasTag(mem, len, kLZ4Tag))
+    {
+        return COMPRESSION_LZ4;
+    }
+
+    if (mem != nullptr && len >= 4)
+    {
+        const auto* bytes = static_cast<const UnsignedByte*>(mem);
+        if (bytes[0] == kZLibTag[0] && bytes[1] == kZLibTag[1] && bytes[2] >= '1' && bytes[2] <= '9' && bytes[3] == '\0')
+        {
+            return static_cast<CompressionType>(COMPRESSION_ZLIB1 + (bytes[2] - '1'));
+        }
+    }
+
     return COMPRESSION_NONE;
 }
 
@@ -112,9 +375,16 @@ Int CompressionManager::getMaxCompressedSize(Int uncompressedLen, CompressionTyp
     case COMPRESSION_NONE:
         return uncompressedLen;
     case COMPRESSION_REFPACK:
-        // Original implementation stored an 8 byte header before the payload.
-        return uncompressedLen + 8;
+        // Literals go out in runs of up to 112 with a control byte each, and REF_encode
+        // writes its own few bytes of header, all after our 8 byte one.
+        return uncompressedLen + uncompressedLen / 112 + 16 + kHeaderSize;
+    case COMPRESSION_LZ4:
+        return LZ4MaxCompressedSize(uncompressedLen) + kHeaderSize;
     default:
+        if (IsZLib(compType))
+        {
+            return static_cast<Int>(compressBound(static_cast<uLong>(uncompressedLen))) + kHeaderSize;
+        }
         return 0;
     }
 }
@@ -126,7 +396,7 @@ Int CompressionManager::getUncompressedSize(const void* mem, Int len)
         return 0;
     }
 
-    if (HasRefPackHeader(mem, len) && len >= 8)
+    if (getCompressionType(mem, len) != COMPRESSION_NONE && len >= kHeaderSize)
     {
         return ReadStoredLength(static_cast<const UnsignedByte*>(mem) + 4);
     }
@@ -162,7 +432,8 @@ Int CompressionManager::compressData(CompressionType compType,
 
     case COMPRESSION_REFPACK:
     {
-        if (destLen < srcLen + 8)
+        // REF_encode doesn't know how much room it has, so make sure of the worst case
+        if (destLen < getMaxCompressedSize(srcLen, COMPRESSION_REFPACK))
         {
             return 0;
         }
@@ -170,17 +441,54 @@ Int CompressionManager::compressData(CompressionType compType,
         std::memcpy(dest, kRefPackTag, sizeof(kRefPackTag));
         WriteStoredLength(dest + 4, srcLen);
 
-        int compressedSize = REF_encode(dest + 8, src, srcLen, nullptr);
+        int compressedSize = REF_encode(dest + kHeaderSize, src, srcLen, nullptr);
+        if (compressedSize <= 0)
+        {
+            return 0;
+        }
+
+        return compressedSize + kHeaderSize;
+    }
+
+    case COMPRESSION_LZ4:
+    {
+        if (destLen <= kHeaderSize)
+        {
+            return 0;
+        }
+
+        std::memcpy(dest, kLZ4Tag, sizeof(kLZ4Tag));
+        WriteStoredLength(dest + 4, srcLen);
+
+        const Int compressedSize = LZ4Compress(src, srcLen, dest + kHeaderSize, destLen - kHeaderSize);
         if (compressedSize <= 0)
         {
             return 0;
         }
 
-        return compressedSize + 8;
+        return compressedSize + kHeaderSize;
     }
 
     default:
-        return 0;
+    {
+        if (!IsZLib(compType) || destLen <= kHeaderSize)
+        {
+            return 0;
+        }
+
+        const int level = compType - COMPRESSION_ZLIB1 + 1;
+        std::memcpy(dest, kZLibTag, sizeof(kZLibTag));
+        dest[2] = static_cast<UnsignedByte>('0' + level);
+        WriteStoredLength(dest + 4, srcLen);
+
+        uLongf compressedSize = static_cast<uLongf>(destLen - kHeaderSize);
+        if (compress2(dest + kHeaderSize, &compressedSize, src, static_cast<uLong>(srcLen), level) != Z_OK)
+        {
+            return 0;
+        }
+
+        return static_cast<Int>(compressedSize) + kHeaderSize;
+    }
     }
 }
 
@@ -213,13 +521,13 @@ Int CompressionManager::decompressData(void* srcVoid,
 
     case COMPRESSION_REFPACK:
     {
-        if (srcLen < 8)
+        if (srcLen < kHeaderSize)
         {
             return 0;
         }
 
-        int compressedSize = srcLen - 8;
-        int decoded = REF_decode(dest, src + 8, &compressedSize);
+        int compressedSize = srcLen - kHeaderSize;
+        int decoded = REF_decode(dest, src + kHeaderSize, &compressedSize);
         if (decoded <= 0 || decoded > destLen)
         {
             return 0;
@@ -228,7 +536,264 @@ Int CompressionManager::decompressData(void* srcVoid,
         return decoded;
     }
 
+    case COMPRESSION_LZ4:
+    {
+        if (srcLen <= kHeaderSize)
+        {
+            return 0;
+        }
+
+        const Int expected = ReadStoredLength(src + 4);
+        if (expected <= 0 || expected > destLen)
+        {
+            return 0;
+        }
+
+        const Int decoded = LZ4Decompress(src + kHeaderSize, srcLen - kHeaderSize, dest, expected);
+        return decoded == expected ? decoded : 0;
+    }
+
     default:
-        return 0;
+    {
+        if (!IsZLib(type) || srcLen <= kHeaderSize)
+        {
+            return 0;
+        }
+
+        uLongf decoded = static_cast<uLongf>(destLen);
+        if (uncompress(dest, &decoded, src + kHeaderSize, static_cast<uLong>(srcLen - kHeaderSize)) != Z_OK)
+        {
+            return 0;
+        }
+
+        return static_cast<Int>(decoded);
+    }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// CompressionStreamWriter
+// ---------------------------------------------------------------------------------------
+
+CompressionStreamWriter::CompressionStreamWriter(CompressionType compType, CompressionWriteProc writeProc, void* userData, Int chunkSize)
+    : m_compType(compType),
+      m_writeProc(writeProc),
+      m_userData(userData),
+      m_chunkSize(std::min(std::max(chunkSize, 1), kMaxStreamChunkSize)),
+      m_chunk(nullptr),
+      m_chunkUsed(0),
+      m_compressed(nullptr),
+      m_bytesIn(0),
+      m_bytesOut(0),
+      m_ok(compType >= COMPRESSION_MIN && compType <= COMPRESSION_MAX && writeProc != nullptr)
+{
+    m_chunk = new UnsignedByte[m_chunkSize];
+    m_compressed = new UnsignedByte[sizeof(Int) + getMaxCompressedSizeForStream()];
+
+    UnsignedByte header[kStreamHeaderSize];
+    std::memcpy(header, kStreamTag, sizeof(kStreamTag));
+    WriteStoredLength(header + 4, m_chunkSize);
+    WriteStoredLength(header + 8, static_cast<Int>(m_compType));
+    writeOut(header, kStreamHeaderSize);
+}
+
+CompressionStreamWriter::~CompressionStreamWriter()
+{
+    delete[] m_chunk;
+    delete[] m_compressed;
+}
+
+Bool CompressionStreamWriter::write(const void* data, Int len)
+{
+    const auto* bytes = static_cast<const UnsignedByte*>(data);
+    while (m_ok && len > 0)
+    {
+        const Int copyLen = std::min(len, m_chunkSize - m_chunkUsed);
+        std::memcpy(m_chunk + m_chunkUsed, bytes, static_cast<std::size_t>(copyLen));
+        m_chunkUsed += copyLen;
+        m_bytesIn += copyLen;
+        bytes += copyLen;
+        len -= copyLen;
+
+        if (m_chunkUsed == m_chunkSize)
+        {
+            flushChunk();
+        }
+    }
+    return m_ok;
+}
+
+Bool CompressionStreamWriter::finish(void)
+{
+    flushChunk();
+
+    const Int endOfStream = 0;
+    writeOut(&endOfStream, sizeof(endOfStream));
+    return m_ok;
+}
+
+Bool CompressionStreamWriter::flushChunk(void)
+{
+    if (!m_ok || m_chunkUsed == 0)
+    {
+        return m_ok;
+    }
+
+    // each chunk is an ordinary compressed buffer, with its length in front
+    Int compressedLen = m_chunkUsed;
+    if (m_compType == COMPRESSION_NONE)
+    {
+        std::memcpy(m_compressed + sizeof(Int), m_chunk, static_cast<std::size_t>(m_chunkUsed));
+    }
+    else
+    {
+        compressedLen = CompressionManager::compressData(m_compType, m_chunk, m_chunkUsed, m_compressed + sizeof(Int), getMaxCompressedSizeForStream());
+    }
+    m_chunkUsed = 0;
+
+    if (compressedLen <= 0)
+    {
+        m_ok = FALSE;
+        return FALSE;
+    }
+
+    WriteStoredLength(m_compressed, compressedLen);
+    return writeOut(m_compressed, static_cast<Int>(sizeof(Int)) + compressedLen);
+}
+
+Bool CompressionStreamWriter::writeOut(const void* data, Int len)
+{
+    if (m_ok && !m_writeProc(data, len, m_userData))
+    {
+        m_ok = FALSE;
+    }
+    if (m_ok)
+    {
+        m_bytesOut += len;
+    }
+    return m_ok;
+}
+
+Int CompressionStreamWriter::getMaxCompressedSizeForStream(void) const
+{
+    return std::max(CompressionManager::getMaxCompressedSize(m_chunkSize, m_compType), m_chunkSize);
+}
+
+// ---------------------------------------------------------------------------------------
+// CompressionStreamReader
+// ---------------------------------------------------------------------------------------
+
+CompressionStreamReader::CompressionStreamReader(CompressionReadProc readProc, void* userData)
+    : m_readProc(readProc),
+      m_userData(userData),
+      m_compType(COMPRESSION_NONE),
+      m_chunkSize(0),
+      m_maxCompressedSize(0),
+      m_chunk(nullptr),
+      m_chunkUsed(0),
+      m_chunkPos(0),
+      m_compressed(nullptr),
+      m_done(FALSE),
+      m_ok(readProc != nullptr)
+{
+}
+
+CompressionStreamReader::~CompressionStreamReader()
+{
+    delete[] m_chunk;
+    delete[] m_compressed;
+}
+
+Bool CompressionStreamReader::isStream(const void* mem, Int len)
+{
+    return len >= kStreamHeaderSize && HasTag(mem, len, kStreamTag);
+}
+
+Int CompressionStreamReader::read(void* dest, Int len)
+{
+    auto* bytes = static_cast<UnsignedByte*>(dest);
+    Int copied = 0;
+    while (m_ok && copied < len)
+    {
+        if (m_chunkPos == m_chunkUsed && (m_done || !nextChunk()))
+        {
+            break;
+        }
+
+        const Int copyLen = std::min(len - copied, m_chunkUsed - m_chunkPos);
+        std::memcpy(bytes + copied, m_chunk + m_chunkPos, static_cast<std::size_t>(copyLen));
+        m_chunkPos += copyLen;
+        copied += copyLen;
     }
+    return m_ok ? copied : -1;
+}
+
+Bool CompressionStreamReader::nextChunk(void)
+{
+    // the header comes first, and says how big the buffers need to be
+    if (m_chunk == nullptr)
+    {
+        UnsignedByte header[kStreamHeaderSize];
+        if (m_readProc(header, kStreamHeaderSize, m_userData) != kStreamHeaderSize || !isStream(header, kStreamHeaderSize))
+        {
+            m_ok = FALSE;
+            return FALSE;
+        }
+
+        m_chunkSize = ReadStoredLength(header + 4);
+        m_compType = static_cast<CompressionType>(ReadStoredLength(header + 8));
+        if (m_chunkSize <= 0 || m_chunkSize > kMaxStreamChunkSize || m_compType < COMPRESSION_MIN || m_compType > COMPRESSION_MAX)
+        {
+            m_ok = FALSE;
+            return FALSE;
+        }
+
+        m_maxCompressedSize = std::max(CompressionManager::getMaxCompressedSize(m_chunkSize, m_compType), m_chunkSize);
+        m_chunk = new UnsignedByte[m_chunkSize];
+        m_compressed = new UnsignedByte[m_maxCompressedSize];
+    }
+
+    Int compressedLen = 0;
+    if (m_readProc(&compressedLen, sizeof(compressedLen), m_userData) != static_cast<Int>(sizeof(compressedLen)) ||
+        compressedLen < 0 || compressedLen > m_maxCompressedSize)
+    {
+        m_ok = FALSE;
+        return FALSE;
+    }
+
+    if (compressedLen == 0)
+    {
+        m_done = TRUE;
+        return FALSE;
+    }
+
+    if (m_readProc(m_compressed, compressedLen, m_userData) != compressedLen)
+    {
+        m_ok = FALSE;
+        return FALSE;
+    }
+
+    if (m_compType == COMPRESSION_NONE)
+    {
+        m_chunkUsed = std::min(compressedLen, m_chunkSize);
+        std::memcpy(m_chunk, m_compressed, static_cast<std::size_t>(m_chunkUsed));
+    }
+    else
+    {
+        const Int expected = CompressionManager::getUncompressedSize(m_compressed, compressedLen);
+        if (CompressionManager::getCompressionType(m_compressed, compressedLen) != m_compType || expected <= 0 || expected > m_chunkSize)
+        {
+            m_ok = FALSE;
+            return FALSE;
+        }
+        m_chunkUsed = CompressionManager::decompressData(m_compressed, compressedLen, m_chunk, expected);
+        if (m_chunkUsed != expected)
+        {
+            m_ok = FALSE;
+            return FALSE;
+        }
+    }
+
+    m_chunkPos = 0;
+    return TRUE;
 }
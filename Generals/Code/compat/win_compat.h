@@ -1,3 +1,4 @@
+#pragma once
 
 #if defined(__linux__) || defined(__unix__) || defined(__APPLE__) || defined(FORCE_WIN32_COMPAT)
 